@@ -4,11 +4,19 @@
 #ifndef DUNE_PDELAB_ADAPTIVITY_HH
 #define DUNE_PDELAB_ADAPTIVITY_HH
 
+#include<dune/common/array.hh>
 #include<dune/common/exceptions.hh>
 
+#include<algorithm>
+#include<cassert>
+#include<cmath>
+#include<cstddef>
+#include<functional>
 #include<limits>
 #include<vector>
 #include<map>
+#include<set>
+#include<utility>
 #include<dune/geometry/quadraturerules.hh>
 #include<dune/pdelab/gridfunctionspace/genericdatahandle.hh>
 #include<dune/pdelab/gridfunctionspace/localfunctionspace.hh>
@@ -278,6 +286,111 @@ namespace Dune {
 
 
 
+    /*! @class CoefficientTransferBuffer
+     *
+     * @brief The local coefficients of many elements in one contiguous buffer
+     *
+     *        Stores the coefficients of each element behind the coefficients of the
+     *        element appended before.  An element is found by a binary search over
+     *        the sorted table of ids, so apart from the buffer and the table no
+     *        memory is allocated per element.
+     *
+     * @tparam IdType Type of the persistent ids identifying the elements
+     * @tparam T      Type of the coefficients
+     */
+    template<class IdType, class T>
+    class CoefficientTransferBuffer
+    {
+      struct Entry
+      {
+        IdType id;
+        std::size_t offset;
+        std::size_t size;
+
+        bool operator< (const Entry& other) const
+        {
+          return id < other.id;
+        }
+      };
+
+    public:
+
+      CoefficientTransferBuffer() : sorted(true) {}
+
+      //! Append the coefficients of the element with the given id.
+      template<class Container>
+      void append (const IdType& id, const Container& coeffs)
+      {
+        Entry entry;
+        entry.id = id;
+        entry.offset = buffer.size();
+        entry.size = coeffs.size();
+        buffer.insert(buffer.end(),coeffs.begin(),coeffs.end());
+        sorted = sorted && (entries.empty() || entries.back() < entry);
+        entries.push_back(entry);
+      }
+
+      //! Append all elements of another buffer.
+      void append (const CoefficientTransferBuffer& other)
+      {
+        const std::size_t shift = buffer.size();
+        buffer.insert(buffer.end(),other.buffer.begin(),other.buffer.end());
+        for (std::size_t i = 0; i < other.entries.size(); ++i)
+          {
+            Entry entry = other.entries[i];
+            entry.offset += shift;
+            sorted = sorted && (entries.empty() || entries.back() < entry);
+            entries.push_back(entry);
+          }
+      }
+
+      //! Sort the table of ids, required before calling find().
+      void sort ()
+      {
+        if (!sorted)
+          std::sort(entries.begin(),entries.end());
+        sorted = true;
+      }
+
+      /*! @brief Look up the coefficients of the element with the given id.
+       *
+       * @param[in]  id   The id of the element
+       * @param[out] size The number of coefficients
+       * @return Pointer to the coefficients, 0 if the buffer has no data for id
+       */
+      const T* find (const IdType& id, std::size_t& size) const
+      {
+        assert(sorted);
+        Entry key;
+        key.id = id;
+        typename std::vector<Entry>::const_iterator it = std::lower_bound(entries.begin(),entries.end(),key);
+        if (it == entries.end() || key < *it)
+          return 0;
+        size = it->size;
+        return size > 0 ? &buffer[it->offset] : &empty;
+      }
+
+      //! The number of elements with data.
+      std::size_t size () const
+      {
+        return entries.size();
+      }
+
+      //! Remove all data and release the memory.
+      void clear ()
+      {
+        std::vector<Entry>().swap(entries);
+        std::vector<T>().swap(buffer);
+        sorted = true;
+      }
+
+    private:
+      std::vector<Entry> entries;
+      std::vector<T> buffer;
+      bool sorted;
+      T empty;
+    };
+
     /*! @class GridAdaptor
      *
      * @brief Class for automatic adaptation of the grid.
@@ -309,9 +422,78 @@ namespace Dune {
       typedef InterpolateBackendStandard IB;
       typedef CoeffsToLocalFunctionAdapter<typename U::ElementType,DGF,FEM,Element> CTLFA;
       typedef typename FEM::Traits::FiniteElementType::Traits::LocalBasisType::Traits::RangeType RangeType;
+      typedef typename Element::HierarchicIterator HierarchicIterator;
+      typedef typename U::ElementType CoeffType;
+      typedef typename Grid::ctype ctype;
+      enum { dim = Grid::dimension };
+
+      /* Identifies the transfer between an ancestor and one of its descendants.
+       * For affine geometries the transfer matrices only depend on the finite
+       * elements and on the position of the descendant inside the ancestor,
+       * given by its corners in local coordinates of the ancestor.  There
+       * are at most 2^dim corners, unused entries are zero.
+       */
+      struct TransferKey
+      {
+        enum { maxCorners = 1 << dim };
+
+        const void* coarseFE;
+        const void* fineFE;
+        Dune::GeometryType coarseType;
+        Dune::GeometryType fineType;
+        Dune::array<long,maxCorners*dim> corners;
+
+        bool operator< (const TransferKey& other) const
+        {
+          if (coarseFE != other.coarseFE) return std::less<const void*>()(coarseFE,other.coarseFE);
+          if (fineFE != other.fineFE) return std::less<const void*>()(fineFE,other.fineFE);
+          if (coarseType != other.coarseType) return coarseType < other.coarseType;
+          if (fineType != other.fineType) return fineType < other.fineType;
+          return std::lexicographical_compare(corners.begin(),corners.end(),
+                                              other.corners.begin(),other.corners.end());
+        }
+      };
+
+      // dense matrix mapping local coefficients between an ancestor and a descendant
+      struct TransferMatrix
+      {
+        std::size_t rows;
+        std::size_t cols;
+        std::vector<CoeffType> values;
+
+        TransferMatrix() : rows(0), cols(0) {}
+
+        void resize (std::size_t r, std::size_t c)
+        {
+          rows = r;
+          cols = c;
+          values.assign(r*c,0.);
+        }
+
+        CoeffType& operator() (std::size_t i, std::size_t j)
+        {
+          return values[i*cols+j];
+        }
+
+        // y += A x
+        void umv (const CoeffType* x, CoeffType* y) const
+        {
+          const CoeffType* a = values.empty() ? 0 : &values[0];
+          for (std::size_t i = 0; i < rows; ++i, a += cols)
+            {
+              CoeffType sum = 0.;
+              for (std::size_t j = 0; j < cols; ++j)
+                sum += a[j] * x[j];
+              y[i] += sum;
+            }
+        }
+      };
+
+      typedef std::map<TransferKey,TransferMatrix> TransferMatrixMap;
 
     public:
       typedef std::map<IdType,std::vector<typename U::ElementType> > MapType;
+      typedef CoefficientTransferBuffer<IdType,typename U::ElementType> TransferBuffer;
 
 
       /*! @brief The constructor.
@@ -483,6 +665,279 @@ namespace Dune {
             lfsu.vadd(ulc,uc);
           }
 
+        average(gfsu,leafView,u,uc);
+      }
+
+      /*! @brief Save the solution before adaptation in a flat buffer
+       *
+       *        Stores the local coefficients of all interior leaf elements and the L2 projection
+       *        onto all ancestors which might vanish.  The restriction matrices of the projection
+       *        are computed once per pair of finite elements and position of the child, as long
+       *        as both geometries are affine.
+       *
+       * @param[in]  u              The solution that will be saved
+       * @param[out] transferBuffer The buffer containing the solution during adaptation
+       */
+      void backupData(Grid& grid, GFSU& gfsu, Projection& projection, U& u, TransferBuffer& transferBuffer)
+      {
+        const IdSet& idset = grid.globalIdSet();
+        LFSU lfsu(gfsu);
+        const FEM& fem = gfsu.finiteElementMap();
+        std::vector<CoeffType> ul;
+        std::vector<std::pair<IdType,ElementPointer> > fathers;
+
+        // save the local coeffs of all elems
+        LeafGridView leafView = grid.leafView();
+        for (LeafIterator it = leafView.template begin<0,Dune::Interior_Partition>();
+             it!=leafView.template end<0,Dune::Interior_Partition>(); ++it)
+          {
+            const Element& e = *it;
+            lfsu.bind(e);
+            lfsu.vread(u,ul);
+            transferBuffer.append(idset.id(e),ul);
+
+            // remember the ancestors which might vanish
+            if (e.mightVanish())
+              {
+                ElementPointer father = e.father();
+                const IdType fatherId = idset.id(*father);
+                // siblings are usually visited one after the other
+                if (fathers.empty() || !(fathers.back().first == fatherId))
+                  fathers.push_back(std::make_pair(fatherId,father));
+
+                // conforming grids may need this
+                while ((*father).mightVanish())
+                  {
+                    father = (*father).father();
+                    fathers.push_back(std::make_pair(idset.id(*father),father));
+                  }
+              }
+          }
+        std::sort(fathers.begin(),fathers.end(),compareFirst);
+        fathers.erase(std::unique(fathers.begin(),fathers.end(),equalFirst),fathers.end());
+        transferBuffer.sort();
+
+        // project the coeffs of the leafs below each vanishing ancestor
+        TransferBuffer coarseBuffer;
+        TransferMatrix scratch;
+        std::vector<CoeffType> uCoarse;
+        for (typename std::vector<std::pair<IdType,ElementPointer> >::const_iterator fit = fathers.begin();
+             fit != fathers.end(); ++fit)
+          {
+            const Element& father = *(fit->second);
+            uCoarse.assign(fem.find(father).localBasis().size(),0.);
+            const HierarchicIterator hend = father.hend(grid.maxLevel());
+            for (HierarchicIterator hit = father.hbegin(grid.maxLevel()); hit != hend; ++hit)
+              {
+                // only evaluate on entities with data
+                if (!(*hit).isLeaf())
+                  continue;
+
+                std::size_t size = 0;
+                const CoeffType* uFine = transferBuffer.find(idset.id(*hit),size);
+                if (uFine == 0)
+                  {
+                    // leaf outside of the interior partition
+                    lfsu.bind(*hit);
+                    lfsu.vread(u,ul);
+                    size = ul.size();
+                    uFine = size > 0 ? &ul[0] : 0;
+                  }
+                if (size == 0)
+                  continue;
+
+                const TransferMatrix& R = restriction(projection,fem,father,*hit,scratch);
+                assert(R.rows == uCoarse.size() && R.cols == size);
+                R.umv(uFine,&uCoarse[0]);
+              }
+            coarseBuffer.append(fit->first,uCoarse);
+          }
+        transferBuffer.append(coarseBuffer);
+        transferBuffer.sort();
+      }
+
+      /*! @brief Rebuild the solution after adaptation from a flat buffer
+       *
+       *        New elements interpolate the coefficients of their nearest ancestor with data.  The
+       *        prolongation matrices are computed once per pair of finite elements and position
+       *        of the child, as long as both geometries are affine.
+       *
+       * @param[out] u              The solution after adaptation
+       * @param[in]  transferBuffer The buffer that contains the information for the rebuild of u
+       */
+      void replayData(Grid& grid, GFSU& gfsu, Projection& projection, U& u, TransferBuffer& transferBuffer)
+      {
+        const IdSet& idset = grid.globalIdSet();
+        LFSU lfsu(gfsu);
+        const FEM& fem = gfsu.finiteElementMap();
+        std::vector<CoeffType> ul;
+        std::vector<CoeffType> ulc;
+        U uc(gfsu,0.0);
+        TransferMatrix scratch;
+        transferBuffer.sort();
+
+        // iterate over all elems
+        LeafGridView leafView = grid.leafView();
+        for (LeafIterator it = leafView.template begin<0,Dune::Interior_Partition>();
+             it!=leafView.template end<0,Dune::Interior_Partition>(); ++it)
+          {
+            const Element& e = *it;
+            lfsu.bind(e);
+            std::size_t size = 0;
+            const CoeffType* data = 0;
+
+            if (e.isNew()) // id is not in buffer, we have to interpolate
+              {
+                // find ancestor with data
+                ElementPointer pAncestor = e.father();
+                while ((data = transferBuffer.find(idset.id(*pAncestor),size)) == 0)
+                  {
+                    //this ancestor does not have data, check next one
+                    if ((*pAncestor).level() == 0)
+                      DUNE_THROW(Dune::Exception,
+                                 "transfer buffer of GridAdaptor didn't contain ancestor of element with id " << idset.id(e));
+                    pAncestor = (*pAncestor).father();
+                  }
+
+                const TransferMatrix& P = prolongation(fem,*pAncestor,e,scratch);
+                assert(P.cols == size);
+                ul.assign(P.rows,0.);
+                if (P.rows > 0)
+                  P.umv(data,&ul[0]);
+              }
+            else // this entity is not new and should have data
+              {
+                data = transferBuffer.find(idset.id(e),size);
+                if (data == 0)
+                  DUNE_THROW(Dune::Exception,
+                             "transfer buffer of GridAdaptor didn't contain element with id " << idset.id(e));
+                ul.assign(data,data+size);
+              }
+            lfsu.vadd(ul,u);
+
+            ulc.assign(lfsu.size(),1.0);
+            lfsu.vadd(ulc,uc);
+          }
+
+        average(gfsu,leafView,u,uc);
+      }
+
+    private:
+
+      static bool compareFirst (const std::pair<IdType,ElementPointer>& a, const std::pair<IdType,ElementPointer>& b)
+      {
+        return a.first < b.first;
+      }
+
+      static bool equalFirst (const std::pair<IdType,ElementPointer>& a, const std::pair<IdType,ElementPointer>& b)
+      {
+        return a.first == b.first;
+      }
+
+      TransferKey transferKey (const FEM& fem, const Element& coarse, const Element& fine) const
+      {
+        TransferKey key;
+        key.coarseFE = &fem.find(coarse);
+        key.fineFE = &fem.find(fine);
+        key.coarseType = coarse.type();
+        key.fineType = fine.type();
+
+        // the corners are rounded to make the key robust against round-off
+        const int corners = fine.geometry().corners();
+        assert(corners <= TransferKey::maxCorners);
+        key.corners.fill(0);
+        for (int c = 0; c < corners; ++c)
+          {
+            const Dune::FieldVector<ctype,dim> local = coarse.geometry().local(fine.geometry().corner(c));
+            for (int d = 0; d < dim; ++d)
+              key.corners[c*dim+d] = static_cast<long>(std::floor(local[d]*1048576.0+0.5));
+          }
+        return key;
+      }
+
+      /* The matrix R with R(i,j) being the L2 projection of basis function j on the
+       * fine element onto basis function i on the coarse one.  Cached for affine
+       * geometries, otherwise computed into scratch.
+       */
+      const TransferMatrix& restriction (Projection& projection, const FEM& fem,
+                                         const Element& coarse, const Element& fine, TransferMatrix& scratch)
+      {
+        const bool cache = coarse.geometry().affine() && fine.geometry().affine();
+        TransferKey key;
+        if (cache)
+          {
+            key = transferKey(fem,coarse,fine);
+            typename TransferMatrixMap::const_iterator it = restrictions.find(key);
+            if (it != restrictions.end())
+              return it->second;
+          }
+        TransferMatrix& R = cache ? restrictions[key] : scratch;
+
+        const std::size_t n = fem.find(coarse).localBasis().size();
+        const std::size_t m = fem.find(fine).localBasis().size();
+        R.resize(n,m);
+        std::vector<CoeffType> fineBasis(m,0.);
+        std::vector<CoeffType> coarseBasis(n,0.);
+        CTLFA fineFunction(fineBasis,fem,fine,fine);
+        CTLFA coarseFunction(coarseBasis,fem,coarse,fine);
+        for (std::size_t i = 0; i < n; ++i)
+          {
+            coarseBasis = projection.template inverseMassMatrix<CTLFA,FEM>(coarse,fem,i);
+            for (std::size_t j = 0; j < m; ++j)
+              {
+                fineBasis[j] = 1.;
+                projection.template apply<CTLFA,CTLFA>(coarse,fine,fineFunction,coarseFunction,R(i,j));
+                fineBasis[j] = 0.;
+              }
+          }
+        return R;
+      }
+
+      /* The matrix P with column j being the interpolation of basis function j on
+       * the coarse element into the finite element of the fine one.  Cached for
+       * affine geometries, otherwise computed into scratch.
+       */
+      const TransferMatrix& prolongation (const FEM& fem, const Element& coarse, const Element& fine,
+                                          TransferMatrix& scratch)
+      {
+        const bool cache = coarse.geometry().affine() && fine.geometry().affine();
+        TransferKey key;
+        if (cache)
+          {
+            key = transferKey(fem,coarse,fine);
+            typename TransferMatrixMap::const_iterator it = prolongations.find(key);
+            if (it != prolongations.end())
+              return it->second;
+          }
+        TransferMatrix& P = cache ? prolongations[key] : scratch;
+
+        IB ib = IB();
+        const std::size_t n = fem.find(coarse).localBasis().size();
+        const std::size_t m = fem.find(fine).localBasis().size();
+        P.resize(m,n);
+        std::vector<CoeffType> coarseBasis(n,0.);
+        std::vector<CoeffType> ul;
+        CTLFA coarseFunction(coarseBasis,fem,coarse,fine);
+        for (std::size_t j = 0; j < n; ++j)
+          {
+            coarseBasis[j] = 1.;
+            ul.clear();
+            ib.interpolate(fem.find(fine),coarseFunction,ul);
+            assert(ul.size() == m);
+            for (std::size_t i = 0; i < m; ++i)
+              P(i,j) = ul[i];
+            coarseBasis[j] = 0.;
+          }
+        return P;
+      }
+
+      // sum up the contributions of all processes and average the coeffs shared by several elems
+      void average (GFSU& gfsu, LeafGridView& leafView, U& u, U& uc)
+      {
+        LFSU lfsu(gfsu);
+        std::vector<typename U::ElementType> ul;
+        std::vector<typename U::ElementType> ulc;
+
         typedef Dune::PDELab::AddDataHandle<GFSU,U> Handle;
         Handle addHandle1(gfsu,u);
         leafView.communicate (addHandle1,
@@ -515,6 +970,8 @@ namespace Dune {
           }
       }
 
+      TransferMatrixMap restrictions;
+      TransferMatrixMap prolongations;
     };
 
 
@@ -538,8 +995,8 @@ namespace Dune {
       grid.preAdapt();
       
       // save u
-      typename GridAdaptor<Grid,GFS,X,Projection>::MapType transferMap1;
-      grid_adaptor.backupData(grid,gfs,projection,x1,transferMap1);
+      typename GridAdaptor<Grid,GFS,X,Projection>::TransferBuffer transferBuffer1;
+      grid_adaptor.backupData(grid,gfs,projection,x1,transferBuffer1);
       
       // adapt the grid
       grid.adapt();
@@ -549,7 +1006,7 @@ namespace Dune {
       
       // reset u
       x1 = X(gfs,0.0);
-      grid_adaptor.replayData(grid,gfs,projection,x1,transferMap1);
+      grid_adaptor.replayData(grid,gfs,projection,x1,transferBuffer1);
       
       // clean up
       grid.postAdapt();
@@ -575,10 +1032,10 @@ namespace Dune {
       grid.preAdapt();
       
       // save solution
-      typename GridAdaptor<Grid,GFS,X,Projection>::MapType transferMap1;
-      grid_adaptor.backupData(grid,gfs,projection,x1,transferMap1);
-      typename GridAdaptor<Grid,GFS,X,Projection>::MapType transferMap2;
-      grid_adaptor.backupData(grid,gfs,projection,x2,transferMap2);
+      typename GridAdaptor<Grid,GFS,X,Projection>::TransferBuffer transferBuffer1;
+      grid_adaptor.backupData(grid,gfs,projection,x1,transferBuffer1);
+      typename GridAdaptor<Grid,GFS,X,Projection>::TransferBuffer transferBuffer2;
+      grid_adaptor.backupData(grid,gfs,projection,x2,transferBuffer2);
       
       // adapt the grid
       grid.adapt();
@@ -588,116 +1045,518 @@ namespace Dune {
       
       // interpolate solution
       x1 = X(gfs,0.0);
-      grid_adaptor.replayData(grid,gfs,projection,x1,transferMap1);
+      grid_adaptor.replayData(grid,gfs,projection,x1,transferBuffer1);
       x2 = X(gfs,0.0);
-      grid_adaptor.replayData(grid,gfs,projection,x2,transferMap2);
+      grid_adaptor.replayData(grid,gfs,projection,x2,transferBuffer2);
       
       // clean up
       grid.postAdapt();
     }
 
 
-    template<typename T>
-    void error_fraction(const T& x, typename T::ElementType alpha, typename T::ElementType beta,
-                        typename T::ElementType& eta_alpha, typename T::ElementType& eta_beta, int verbose=0)
+    /*! @class MigrationDataHandle
+     *
+     * @brief Data handle moving the solution with the elements during load balancing
+     *
+     *        Saves the local coefficients of all registered vectors on the interior leaf
+     *        elements, sends those of migrating elements with Grid::loadBalance() and
+     *        rebuilds the vectors on the new partition.  The coefficients of all vectors
+     *        are sent in one message per element.
+     *
+     * @tparam Grid Type of the grid
+     * @tparam GFS  Type of the function space of the vectors
+     * @tparam X    Container class of the vectors
+     */
+    template<class Grid, class GFS, class X>
+    class MigrationDataHandle
+      : public Dune::CommDataHandleIF<MigrationDataHandle<Grid,GFS,X>,typename X::ElementType>
     {
-      if (verbose>0) 
-        std::cout << "+++ error fraction: alpha=" << alpha << " beta=" << beta << std::endl;
-      const int steps=20; // max number of bisection steps
-      typedef typename T::ElementType NumberType;
-      NumberType total_error = x.one_norm();
-      NumberType max_error = x.infinity_norm();
-      NumberType eta_alpha_left = 0.0;
-      NumberType eta_alpha_right = max_error;
-      NumberType eta_beta_left = 0.0;
-      NumberType eta_beta_right = max_error;
-      for (int j=1; j<=steps; j++)
+      typedef typename Grid::LeafGridView LeafGridView;
+      typedef typename LeafGridView::template Codim<0>
+      ::template Partition<Dune::Interior_Partition>::Iterator LeafIterator;
+      typedef typename Grid::GlobalIdSet IdSet;
+      typedef typename IdSet::IdType IdType;
+      typedef LocalFunctionSpace<GFS> LFS;
+      typedef CoefficientTransferBuffer<IdType,typename X::ElementType> Buffer;
+
+    public:
+      //! export type of data for message buffer
+      typedef typename X::ElementType DataType;
+
+      MigrationDataHandle (Grid& grid_, GFS& gfs_) : grid(grid_), gfs(gfs_) {}
+
+      //! register a vector which is moved with the elements
+      void addVector (X& x)
+      {
+        vectors.push_back(&x);
+      }
+
+      //! save the local coefficients of the registered vectors, call before Grid::loadBalance()
+      void backup ()
+      {
+        const IdSet& idset = grid.globalIdSet();
+        LFS lfs(gfs);
+        std::vector<DataType> ul;
+        std::vector<DataType> ue;
+        discard();
+
+        LeafGridView leafView = grid.leafView();
+        for (LeafIterator it = leafView.template begin<0,Dune::Interior_Partition>();
+             it!=leafView.template end<0,Dune::Interior_Partition>(); ++it)
+          {
+            lfs.bind(*it);
+            ue.clear();
+            for (std::size_t v = 0; v < vectors.size(); ++v)
+              {
+                lfs.vread(*vectors[v],ul);
+                ue.insert(ue.end(),ul.begin(),ul.end());
+              }
+            buffer.append(idset.id(*it),ue);
+          }
+        buffer.sort();
+      }
+
+      //! rebuild the registered vectors on the new partition, call after GFS::update()
+      void restore ()
+      {
+        buffer.append(received);
+        received.clear();
+        buffer.sort();
+
+        for (std::size_t v = 0; v < vectors.size(); ++v)
+          *vectors[v] = X(gfs,0.0);
+
+        const IdSet& idset = grid.globalIdSet();
+        LFS lfs(gfs);
+        std::vector<DataType> ul;
+        LeafGridView leafView = grid.leafView();
+        for (LeafIterator it = leafView.template begin<0,Dune::Interior_Partition>();
+             it!=leafView.template end<0,Dune::Interior_Partition>(); ++it)
+          {
+            lfs.bind(*it);
+            std::size_t size = 0;
+            const DataType* data = buffer.find(idset.id(*it),size);
+            if (data == 0)
+              DUNE_THROW(Dune::Exception,
+                         "MigrationDataHandle didn't receive data for element with id " << idset.id(*it));
+            const std::size_t n = lfs.size();
+            if (size != n*vectors.size())
+              DUNE_THROW(Dune::Exception,"size mismatch in MigrationDataHandle");
+            for (std::size_t v = 0; v < vectors.size(); ++v)
+              {
+                ul.assign(data+v*n,data+(v+1)*n);
+                lfs.vwrite(ul,*vectors[v]);
+              }
+          }
+        buffer.clear();
+
+        // update the degrees of freedom outside of the interior
+        for (std::size_t v = 0; v < vectors.size(); ++v)
+          {
+            CopyDataHandle<GFS,X> handle(gfs,*vectors[v]);
+            leafView.communicate(handle,Dune::InteriorBorder_All_Interface,Dune::ForwardCommunication);
+          }
+      }
+
+      //! drop the saved coefficients, e.g. if the grid did not change
+      void discard ()
+      {
+        buffer.clear();
+        received.clear();
+      }
+
+      //! returns true if data for this codim should be communicated
+      bool contains (int dim, int codim) const
+      {
+        return codim == 0;
+      }
+
+      //! returns true if size per entity of given dim and codim is a constant
+      bool fixedsize (int dim, int codim) const
+      {
+        return false;
+      }
+
+      //! how many objects of type DataType have to be sent for a given entity
+      template<class EntityType>
+      size_t size (EntityType& e) const
+      {
+        std::size_t n = 0;
+        return buffer.find(grid.globalIdSet().id(e),n) ? n : 0;
+      }
+
+      //! pack data from user to message buffer
+      template<class MessageBuffer, class EntityType>
+      void gather (MessageBuffer& buff, const EntityType& e) const
+      {
+        std::size_t n = 0;
+        const DataType* data = buffer.find(grid.globalIdSet().id(e),n);
+        for (std::size_t i = 0; i < n; ++i)
+          buff.write(data[i]);
+      }
+
+      /*! unpack data from message buffer to user
+
+        n is the number of objects sent by the sender
+      */
+      template<class MessageBuffer, class EntityType>
+      void scatter (MessageBuffer& buff, const EntityType& e, size_t n)
+      {
+        scratch.resize(n);
+        for (std::size_t i = 0; i < n; ++i)
+          buff.read(scratch[i]);
+        received.append(grid.globalIdSet().id(e),scratch);
+      }
+
+    private:
+      Grid& grid;
+      GFS& gfs;
+      std::vector<X*> vectors;
+      Buffer buffer;
+      Buffer received;
+      std::vector<DataType> scratch;
+    };
+
+
+    /*! @brief The load imbalance of a grid view
+     *
+     * @return The largest number of interior elements on a process divided by the mean
+     */
+    template<class GV>
+    double load_imbalance (const GV& gv)
+    {
+      typedef typename GV::template Codim<0>::template Partition<Dune::Interior_Partition>::Iterator Iterator;
+      double elements = 0.0;
+      for (Iterator it = gv.template begin<0,Dune::Interior_Partition>();
+           it != gv.template end<0,Dune::Interior_Partition>(); ++it)
+        elements += 1.0;
+      const double mean = gv.comm().sum(elements)/gv.comm().size();
+      const double max = gv.comm().max(elements);
+      return mean > 0.0 ? max/mean : 1.0;
+    }
+
+
+    /*! grid load balancing as a function
+     *
+     * @brief redistribute a grid and move the vectors registered with the data handle along
+     *
+     * @param handle  The data handle the vectors to move are registered with
+     * @param verbose Print the load imbalance before and after balancing if > 0
+     * @return true if the grid has changed
+     */
+    template<class Grid, class GFS, class X>
+    bool balance_grid (Grid& grid, GFS& gfs, MigrationDataHandle<Grid,GFS,X>& handle, int verbose=0)
+    {
+      // the imbalance needs global communication, only measure it if printed
+      double before = 0.0;
+      if (verbose>0)
+        before = load_imbalance(grid.leafView());
+
+      // save the vectors and redistribute the grid
+      handle.backup();
+      const bool changed = grid.loadBalance(handle);
+
+      // update the function spaces and rebuild the vectors
+      if (changed)
         {
-          eta_alpha = 0.5*(eta_alpha_left+eta_alpha_right);
-          eta_beta = 0.5*(eta_beta_left+eta_beta_right);
-          NumberType sum_alpha=0.0;
-          NumberType sum_beta=0.0;
-          unsigned int alpha_count = 0;
-          unsigned int beta_count = 0;
-          for (unsigned int i=0; i<x.N(); i++)
-            {
-              if (x[i]>=eta_alpha) { sum_alpha += x[i]; alpha_count++;}
-              if (x[i]< eta_beta) { sum_beta += x[i]; beta_count++;}
-            }
-          if (verbose>1)
-            {
-              std::cout << "+++ " << j << " eta_alpha=" << eta_alpha << " alpha_fraction=" << sum_alpha/total_error 
-                        << " elements: " << alpha_count << " of " << x.N() << std::endl;
-              std::cout << "+++ " << j << " eta_beta=" << eta_beta << " beta_fraction=" << sum_beta/total_error 
-                        << " elements: " << beta_count << " of " << x.N() << std::endl;
-            }
-          if (std::abs(alpha-sum_alpha/total_error) <= 0.01 && std::abs(beta-sum_beta/total_error) <= 0.01) break;
-          if (sum_alpha>alpha*total_error)
-            eta_alpha_left = eta_alpha;
-          else
-            eta_alpha_right = eta_alpha;
-          if (sum_beta>beta*total_error) 
-            eta_beta_right = eta_beta;
-          else
-            eta_beta_left = eta_beta;
+          gfs.update();
+          handle.restore();
         }
+      else
+        handle.discard();
+
       if (verbose>0)
+        {
+          const double after = load_imbalance(grid.leafView());
+          if (grid.comm().rank()==0)
+            std::cout << "+++ load balance: imbalance before=" << before
+                      << " after=" << after << std::endl;
+        }
+      return changed;
+    }
+
+    /*! grid load balancing as a function
+     *
+     * @brief redistribute a grid, update the function space and move a solution vector along
+     */
+    template<class Grid, class GFS, class X>
+    bool balance_grid (Grid& grid, GFS& gfs, X& x1, int verbose=0)
+    {
+      MigrationDataHandle<Grid,GFS,X> handle(grid,gfs);
+      handle.addVector(x1);
+      return balance_grid(grid,gfs,handle,verbose);
+    }
+
+    /*! grid load balancing as a function
+     *
+     * @brief redistribute a grid, update the function space and move two solution vectors along
+     */
+    template<class Grid, class GFS, class X>
+    bool balance_grid (Grid& grid, GFS& gfs, X& x1, X& x2, int verbose=0)
+    {
+      MigrationDataHandle<Grid,GFS,X> handle(grid,gfs);
+      handle.addVector(x1);
+      handle.addVector(x2);
+      return balance_grid(grid,gfs,handle,verbose);
+    }
+
+    /*! grid adaptation and load balancing as a function
+     *
+     * @brief adapt a grid, redistribute it and update the function space and solution vector
+     *
+     * Assumes that the grid's elements have been marked for refinement and coarsening appropriately before
+     */
+    template<class Grid, class GFS, class X, class Projection=L2Projection<GFS,X> >
+    void adapt_and_balance_grid (Grid& grid, GFS& gfs, X& x1, Projection projection=L2Projection<GFS,X>(),
+                                 int verbose=0)
+    {
+      adapt_grid(grid,gfs,x1,projection);
+      balance_grid(grid,gfs,x1,verbose);
+    }
+
+    /*! grid adaptation and load balancing as a function
+     *
+     * @brief adapt a grid, redistribute it and update the function space and solution vectors
+     *
+     * Assumes that the grid's elements have been marked for refinement and coarsening appropriately before
+     */
+    template<class Grid, class GFS, class X, class Projection=L2Projection<GFS,X> >
+    void adapt_and_balance_grid (Grid& grid, GFS& gfs, X& x1, X& x2, Projection projection=L2Projection<GFS,X>(),
+                                 int verbose=0)
+    {
+      adapt_grid(grid,gfs,x1,x2,projection);
+      balance_grid(grid,gfs,x1,x2,verbose);
+    }
+
+#ifndef DOXYGEN
+    namespace AdaptivityImp {
+
+      // collective communication on a single process
+      struct SequentialCommunication
+      {
+        int rank () const { return 0; }
+        template<typename T> T sum (const T& t) const { return t; }
+        template<typename T> int sum (T*, int) const { return 0; }
+        template<typename T> T min (const T& t) const { return t; }
+        template<typename T> T max (const T& t) const { return t; }
+      };
+
+      /* Find the threshold eta for which the weight of all values >= eta
+       * (above) or < eta (!above), summed over all processes, matches target
+       * up to tolerance.  The weight of a value is the value itself or one
+       * (count).  Each round sums a histogram of the remaining candidates
+       * over all processes and keeps only the candidates in the bin the
+       * target falls into, so the local work is linear in the number of
+       * values.  The candidates are overwritten.
+       */
+      template<typename NumberType, typename CC>
+      NumberType fraction_threshold (std::vector<NumberType>& candidates, NumberType target, NumberType tolerance,
+                                     bool above, bool count, const CC& comm, int verbose)
+      {
+        const std::size_t bins = 1024;
+        const int rounds = 8;
+
+        NumberType lo = std::numeric_limits<NumberType>::max();
+        NumberType hi = -std::numeric_limits<NumberType>::max();
+        for (std::size_t i=0; i<candidates.size(); i++)
+          {
+            lo = std::min(lo,candidates[i]);
+            hi = std::max(hi,candidates[i]);
+          }
+        lo = comm.min(lo);
+        hi = comm.max(hi);
+
+        // nothing to select
+        if (lo > hi) return 0.0;
+        if (target <= 0.0) return above ? std::numeric_limits<NumberType>::max() : lo;
+
+        std::vector<NumberType> histogram(2*bins);
+        for (int round=1; ; round++)
+          {
+            // number of candidates and their weight per bin
+            const NumberType width = (hi-lo)/bins;
+            std::fill(histogram.begin(),histogram.end(),0.0);
+            for (std::size_t i=0; i<candidates.size(); i++)
+              {
+                const std::size_t k = width > 0.0 ? std::min(bins-1,std::size_t((candidates[i]-lo)/width)) : 0;
+                histogram[k] += 1.0;
+                histogram[bins+k] += count ? 1.0 : candidates[i];
+              }
+            comm.sum(&histogram[0],int(2*bins));
+
+            // the bin in which the accumulated weight reaches the target
+            NumberType before = 0.0;
+            std::size_t k = bins;
+            for (std::size_t j=0; j<bins; j++)
+              {
+                const std::size_t b = above ? bins-1-j : j;
+                const NumberType after = before + histogram[bins+b];
+                if (above ? after >= target : after > target) { k = b; break; }
+                before = after;
+              }
+            // the target exceeds the total weight
+            if (k == bins) return above ? lo : std::numeric_limits<NumberType>::max();
+
+            // keep the candidates in that bin
+            std::size_t n = 0;
+            for (std::size_t i=0; i<candidates.size(); i++)
+              {
+                const std::size_t b = width > 0.0 ? std::min(bins-1,std::size_t((candidates[i]-lo)/width)) : 0;
+                if (b == k) candidates[n++] = candidates[i];
+              }
+            candidates.resize(n);
+            NumberType binlo = std::numeric_limits<NumberType>::max();
+            NumberType binhi = -std::numeric_limits<NumberType>::max();
+            for (std::size_t i=0; i<candidates.size(); i++)
+              {
+                binlo = std::min(binlo,candidates[i]);
+                binhi = std::max(binhi,candidates[i]);
+              }
+            lo = comm.min(binlo);
+            hi = comm.max(binhi);
+
+            if (verbose>1 && comm.rank()==0)
+              std::cout << "+++ " << round << " candidates=" << histogram[k]
+                        << " in [" << lo << "," << hi << "]" << std::endl;
+
+            // the smallest candidate in the bin separates it from the bins
+            // below, the weight of the bin bounds the error
+            if (histogram[bins+k] <= tolerance || histogram[k] <= 1.0 || hi <= lo || round == rounds)
+              return lo;
+            target -= before;
+          }
+      }
+
+      // copy the indicators of the interior elements and return their sum
+      template<typename T>
+      typename T::ElementType interior_values (const T& x, const std::vector<bool>& interior,
+                                               std::vector<typename T::ElementType>& values)
+      {
+        assert(interior.size() == x.N());
+        typename T::ElementType sum = 0.0;
+        values.clear();
+        for (unsigned int i=0; i<x.N(); i++)
+          if (interior[i])
+            {
+              values.push_back(x[i]);
+              sum += x[i];
+            }
+        return sum;
+      }
+
+    } // end namespace AdaptivityImp
+#endif // DOXYGEN
+
+    /*! @brief Select the interior elements of a leaf grid view
+     *
+     * Sets interior[i] to true if the element with leaf index i belongs to
+     * the interior partition.  Error indicators are indexed the same way,
+     * see mark_grid(), so every element is counted by exactly one process.
+     */
+    template<typename GV>
+    void interior_elements (const GV& gv, std::vector<bool>& interior)
+    {
+      typedef typename GV::template Codim<0>::template Partition<Dune::Interior_Partition>::Iterator Iterator;
+      interior.assign(gv.indexSet().size(0),false);
+      for (Iterator it = gv.template begin<0,Dune::Interior_Partition>();
+           it != gv.template end<0,Dune::Interior_Partition>(); ++it)
+        interior[gv.indexSet().index(*it)] = true;
+    }
+
+    //! Sum of the error indicators of the interior elements over all processes of comm
+    template<typename T, typename CC>
+    typename T::ElementType interior_error (const T& x, const std::vector<bool>& interior, const CC& comm)
+    {
+      std::vector<typename T::ElementType> values;
+      return comm.sum(AdaptivityImp::interior_values(x,interior,values));
+    }
+
+    /*! @brief Compute thresholds for marking a given fraction of the error
+     *
+     * Determines eta_alpha such that the elements with x[i] >= eta_alpha
+     * carry the fraction alpha of the total error and eta_beta such that
+     * the elements with x[i] < eta_beta carry the fraction beta, both up
+     * to 1% of the total error.  The thresholds are computed over all
+     * processes of comm, which therefore all mark their elements
+     * consistently.  Only the interior elements are taken into account,
+     * so overlap and ghost elements are not counted twice.  The local
+     * work is linear in x.N().
+     *
+     * @param x        The error indicators of the elements
+     * @param interior Whether an element is interior, e.g. from interior_elements()
+     * @param comm     The collective communication, e.g. grid.comm()
+     */
+    template<typename T, typename CC>
+    void error_fraction(const T& x, typename T::ElementType alpha, typename T::ElementType beta,
+                        typename T::ElementType& eta_alpha, typename T::ElementType& eta_beta,
+                        const std::vector<bool>& interior, const CC& comm, int verbose=0)
+    {
+      if (verbose>0 && comm.rank()==0)
+        std::cout << "+++ error fraction: alpha=" << alpha << " beta=" << beta << std::endl;
+      typedef typename T::ElementType NumberType;
+      std::vector<NumberType> values;
+      NumberType total_error = comm.sum(AdaptivityImp::interior_values(x,interior,values));
+      std::vector<NumberType> candidates(values);
+      eta_alpha = AdaptivityImp::fraction_threshold(candidates,alpha*total_error,0.01*total_error,
+                                                    true,false,comm,verbose);
+      eta_beta = AdaptivityImp::fraction_threshold(values,beta*total_error,0.01*total_error,
+                                                   false,false,comm,verbose);
+      if (verbose>0 && comm.rank()==0)
         {
           std::cout << "+++ refine_threshold=" << eta_alpha 
                     << " coarsen_threshold=" << eta_beta << std::endl;
         }
     }
 
-
+    //! Compute thresholds for marking a given fraction of the error on a single process
     template<typename T>
+    void error_fraction(const T& x, typename T::ElementType alpha, typename T::ElementType beta,
+                        typename T::ElementType& eta_alpha, typename T::ElementType& eta_beta, int verbose=0)
+    {
+      error_fraction(x,alpha,beta,eta_alpha,eta_beta,std::vector<bool>(x.N(),true),
+                     AdaptivityImp::SequentialCommunication(),verbose);
+    }
+
+
+    /*! @brief Compute thresholds for marking a given fraction of the elements
+     *
+     * Like error_fraction(), but alpha and beta are fractions of the
+     * number of interior elements instead of the total error.
+     *
+     * @param x        The error indicators of the elements
+     * @param interior Whether an element is interior, e.g. from interior_elements()
+     * @param comm     The collective communication, e.g. grid.comm()
+     */
+    template<typename T, typename CC>
     void element_fraction(const T& x, typename T::ElementType alpha, typename T::ElementType beta,
-                          typename T::ElementType& eta_alpha, typename T::ElementType& eta_beta, int verbose=0)
+                          typename T::ElementType& eta_alpha, typename T::ElementType& eta_beta,
+                          const std::vector<bool>& interior, const CC& comm, int verbose=0)
     {
-      const int steps=20; // max number of bisection steps
       typedef typename T::ElementType NumberType;
-      NumberType total_error =x.N();
-      NumberType max_error = x.infinity_norm();
-      NumberType eta_alpha_left = 0.0;
-      NumberType eta_alpha_right = max_error;
-      NumberType eta_beta_left = 0.0;
-      NumberType eta_beta_right = max_error;
-      for (int j=1; j<=steps; j++)
-        {
-          eta_alpha = 0.5*(eta_alpha_left+eta_alpha_right);
-          eta_beta = 0.5*(eta_beta_left+eta_beta_right);
-          NumberType sum_alpha=0.0;
-          NumberType sum_beta=0.0;
-          unsigned int alpha_count = 0;
-          unsigned int beta_count = 0;
-          for (unsigned int i=0; i<x.N(); i++)
-            {
-              if (x[i]>=eta_alpha) { sum_alpha += 1.0; alpha_count++;}
-              if (x[i]< eta_beta) { sum_beta +=1.0; beta_count++;}
-            }
-          if (verbose>1)
-            {
-              std::cout << j << " eta_alpha=" << eta_alpha << " alpha_fraction=" << sum_alpha/total_error 
-                        << " elements: " << alpha_count << " of " << x.N() << std::endl;
-              std::cout << j << " eta_beta=" << eta_beta << " beta_fraction=" << sum_beta/total_error 
-                        << " elements: " << beta_count << " of " << x.N() << std::endl;
-            }
-          if (std::abs(alpha-sum_alpha/total_error) <= 0.01 && std::abs(beta-sum_beta/total_error) <= 0.01) break;
-          if (sum_alpha>alpha*total_error)
-            eta_alpha_left = eta_alpha;
-          else
-            eta_alpha_right = eta_alpha;
-          if (sum_beta>beta*total_error) 
-            eta_beta_right = eta_beta;
-          else
-            eta_beta_left = eta_beta;
-        }
-      if (verbose>0)
+      std::vector<NumberType> values;
+      AdaptivityImp::interior_values(x,interior,values);
+      NumberType total_elements = comm.sum(NumberType(values.size()));
+      std::vector<NumberType> candidates(values);
+      eta_alpha = AdaptivityImp::fraction_threshold(candidates,alpha*total_elements,0.01*total_elements,
+                                                    true,true,comm,verbose);
+      eta_beta = AdaptivityImp::fraction_threshold(values,beta*total_elements,0.01*total_elements,
+                                                   false,true,comm,verbose);
+      if (verbose>0 && comm.rank()==0)
         {
           std::cout << "+++ refine_threshold=" << eta_alpha 
                     << " coarsen_threshold=" << eta_beta << std::endl;
         }
     }
 
+    //! Compute thresholds for marking a given fraction of the elements on a single process
+    template<typename T>
+    void element_fraction(const T& x, typename T::ElementType alpha, typename T::ElementType beta,
+                          typename T::ElementType& eta_alpha, typename T::ElementType& eta_beta, int verbose=0)
+    {
+      element_fraction(x,alpha,beta,eta_alpha,eta_beta,std::vector<bool>(x.N(),true),
+                       AdaptivityImp::SequentialCommunication(),verbose);
+    }
+
     /** Compute error distribution
      */
     template<typename T>
@@ -986,8 +1845,11 @@ namespace Dune {
         adapt_grid=false;
         newdt=dt;
         
-        double spatial_error = eta_space.one_norm();
-        double temporal_error = scaling*eta_time.one_norm();
+        // every element is counted by the process it is interior to
+        std::vector<bool> interior;
+        Dune::PDELab::interior_elements(grid.leafView(),interior);
+        double spatial_error = Dune::PDELab::interior_error(eta_space,interior,grid.comm());
+        double temporal_error = scaling*Dune::PDELab::interior_error(eta_time,interior,grid.comm());
         double sum = spatial_error + temporal_error;
         //double allowed = optimistic_factor*(tol*tol-accumulated_estimated_error_squared)*dt/(T-time);
         double allowed = tol*tol*(energy_timeslab+minenergy_rate*dt);
@@ -1047,7 +1909,8 @@ namespace Dune {
                     if (verbose>1) std::cout << "+++ mark grid for coarsening" << std::endl;
                     //error_distribution(eta_space,20);
                     Dune::PDELab::error_fraction(eta_space,coarsen_fraction_while_coarsening,
-                                                 coarsen_fraction_while_coarsening,eta_refine,eta_coarsen);
+                                                 coarsen_fraction_while_coarsening,eta_refine,eta_coarsen,
+                                                 interior,grid.comm());
                     Dune::PDELab::mark_grid_for_coarsening(grid,eta_space,eta_refine,eta_coarsen,verbose);
                     adapt_grid = true;
                   }
@@ -1101,7 +1964,8 @@ namespace Dune {
                 if (verbose>1) std::cout << "+++ BINGO mark grid for refinement and coarsening" << std::endl;
                 //error_distribution(eta_space,20);
                 Dune::PDELab::error_fraction(eta_space,refine_fraction_while_refinement,
-                                             coarsen_fraction_while_refinement,eta_refine,eta_coarsen,0);
+                                             coarsen_fraction_while_refinement,eta_refine,eta_coarsen,
+                                             interior,grid.comm(),0);
                 Dune::PDELab::mark_grid(grid,eta_space,eta_refine,eta_coarsen,verbose);
                 adapt_grid = true;
               }
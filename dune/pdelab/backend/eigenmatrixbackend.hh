@@ -124,6 +124,14 @@ namespace Dune
       // individual element access
       //==========================
 
+      //! storage which an Accessor may reuse from element to element
+      /**
+       * The Eigen accessor does not need any.
+       */
+      template<typename E>
+      struct AccessorScratch
+      {};
+
       template<typename LFSV, typename LFSU, typename E>
        struct Accessor
        {
@@ -138,6 +146,13 @@ namespace Dune
            , _lfsu(lfsu)
          {}
 
+         Accessor(Matrix& matrix, const LFSV& lfsv, const LFSU& lfsu,
+                  typename Backend::template AccessorScratch<ElementType>&)
+           : _matrix(matrix)
+           , _lfsv(lfsv)
+           , _lfsu(lfsu)
+         {}
+
          void set(size_type i, size_type j, const typename Matrix::ElementType& v)
          {
            Backend::access(_matrix,_lfsv.globalIndex(i),_lfsu.globalIndex(j)) = v;
@@ -169,6 +184,14 @@ namespace Dune
            return Backend::access(_matrix,gi,gj);
          }
 
+         //! add values[j] to the entry (i,j) for all DOFs j of lfsu, skipping zeros
+         void addRow(size_type i, const typename Matrix::ElementType* values)
+         {
+           for (size_type j=0; j<_lfsu.size(); ++j)
+             if (values[j] != 0.0)
+               add(i,j,values[j]);
+         }
+
          Matrix& _matrix;
          const LFSV& _lfsv;
          const LFSU& _lfsu;
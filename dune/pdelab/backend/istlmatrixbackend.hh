@@ -2,11 +2,15 @@
 #ifndef DUNE_ISTLMATRIXBACKEND_HH
 #define DUNE_ISTLMATRIXBACKEND_HH
 
+#include<algorithm>
+#include<cstddef>
+#include<limits>
 #include<utility>
 #include<vector>
 #include<set>
 
 #include<dune/common/fmatrix.hh>
+#include<dune/common/stdstreams.hh>
 #include<dune/istl/bvector.hh>
 #include<dune/istl/bcrsmatrix.hh>
 
@@ -24,6 +28,25 @@ namespace Dune {
       //! The size type
       typedef typename Dune::BCRSMatrix< Dune::FieldMatrix<float,1,1> >::size_type size_type;
 
+      //! memory consumption of the matrix setup, all sizes are in bytes
+      struct PatternStatistics
+      {
+        PatternStatistics ()
+          : rows(0), nonzeros(0), pattern_memory(0), matrix_memory(0), peak_memory(0)
+        {}
+
+        //! number of block rows
+        std::size_t rows;
+        //! number of nonzero blocks
+        std::size_t nonzeros;
+        //! memory occupied by the sparsity pattern
+        std::size_t pattern_memory;
+        //! estimated memory of the BCRSMatrix (row headers, column indices and blocks)
+        std::size_t matrix_memory;
+        //! memory held while the pattern is copied into the matrix
+        std::size_t peak_memory;
+      };
+
       //! container construction
       template<typename E>
       class Matrix : public Dune::BCRSMatrix< Dune::FieldMatrix<E,ROWBLOCKSIZE,COLBLOCKSIZE> >
@@ -44,33 +67,40 @@ namespace Dune {
         {
           Pattern pattern(t.globalSizeV()/ROWBLOCKSIZE,t.globalSizeU()/COLBLOCKSIZE);
           t.fill_pattern(pattern);
+          pattern.finalize();
 
-          // first dummy code: build full matrix
-          for (size_t i=0; i<pattern.size(); ++i)
-            {
-              //              std::cout << i << " row size " << pattern[i].size() << std::endl;
-              this->setrowsize(i,pattern[i].size());
-            }
+          for (size_type i=0; i<pattern.size(); ++i)
+            this->setrowsize(i,pattern[i].size());
           this->endrowsizes();
 
-          for (size_t i=0; i<pattern.size(); ++i)
+          // the matrix and the pattern coexist from here on
+          statistics.rows = pattern.size();
+          statistics.nonzeros = pattern.nonzeros();
+          statistics.pattern_memory = pattern.memory();
+          statistics.matrix_memory = pattern.size() * sizeof(typename BaseT::row_type)
+            + statistics.nonzeros * (sizeof(FM) + sizeof(size_type));
+          statistics.peak_memory = statistics.pattern_memory + statistics.matrix_memory;
+
+          // the rows of the pattern are sorted, so addindex() never has to shift entries
+          for (size_type i=0; i<pattern.size(); ++i)
             {
-              for (typename std::set<size_type>::iterator it=pattern[i].begin();
+              for (typename Pattern::Row::const_iterator it=pattern[i].begin();
                    it!=pattern[i].end(); ++it)
                 this->addindex(i,*it);
+              pattern.release(i);
             }
           this->endindices();
 
-          // code for full matrix
-          //       for (int i=0; i<t.globalSizeV(); ++i)
-          //         this->setrowsize(i,t.globalSizeU());
-          //       this->endrowsizes();
-
-          //       for (int i=0; i<t.globalSizeV(); ++i)
-          //         for (int j=0; j<t.globalSizeU(); ++j)
-          //           this->addindex(i,j);
-          //       this->endindices();
+          Dune::dinfo << "ISTLBCRSMatrixBackend: " << statistics.nonzeros << " nonzero blocks in "
+                      << statistics.rows << " rows, pattern " << statistics.pattern_memory
+                      << " bytes, matrix " << statistics.matrix_memory << " bytes, peak "
+                      << statistics.peak_memory << " bytes" << std::endl;
+        }
 
+        //! memory statistics recorded while setting up the sparsity pattern
+        const PatternStatistics& patternStatistics () const
+        {
+          return statistics;
         }
 
         //! set from element
@@ -91,6 +121,9 @@ namespace Dune {
         {
           return *this;
         }
+
+      private:
+        PatternStatistics statistics;
       };
 
       //! extract type of container element
@@ -101,10 +134,20 @@ namespace Dune {
       };
 
       //! type to store sparsity pattern of block indices
-      class Pattern : public std::vector< std::set<size_type> >
+      /**
+       * Every row is stored as a vector of column block indices. Compared
+       * to a std::set per row this avoids one heap node per entry. Links
+       * are appended in the order in which they are added, only repeated
+       * links are skipped on the fly; finalize() sorts every row once and
+       * removes the remaining duplicates. The rows are sorted only after
+       * finalize() has been called.
+       */
+      class Pattern : public std::vector< std::vector<size_type> >
       {
-        typedef std::vector< std::set<size_type> > BaseT;
+        typedef std::vector< std::vector<size_type> > BaseT;
       public:
+        typedef std::vector<size_type> Row;
+
         Pattern (size_type m_, size_type n_)
         {
           this->resize(m_);
@@ -112,8 +155,45 @@ namespace Dune {
 
         void add_link (size_type i, size_type j)
         {
-          //std::cout<<"adding index " << i << "," << j << " (" << i/ROWBLOCKSIZE << "," << j/COLBLOCKSIZE << ")" << std::endl;
-          (*this)[i/ROWBLOCKSIZE].insert(j/COLBLOCKSIZE);
+          Row& row = (*this)[i/ROWBLOCKSIZE];
+          const size_type col = j/COLBLOCKSIZE;
+          // the entries of a block are linked one after the other
+          if (row.empty() || row.back() != col)
+            row.push_back(col);
+        }
+
+        //! sort all rows and remove duplicate links
+        void finalize ()
+        {
+          for (typename BaseT::iterator it = this->begin(); it != this->end(); ++it)
+            {
+              std::sort(it->begin(),it->end());
+              it->erase(std::unique(it->begin(),it->end()),it->end());
+            }
+        }
+
+        //! number of nonzero blocks
+        std::size_t nonzeros () const
+        {
+          std::size_t n = 0;
+          for (typename BaseT::const_iterator it = this->begin(); it != this->end(); ++it)
+            n += it->size();
+          return n;
+        }
+
+        //! number of bytes allocated by the pattern
+        std::size_t memory () const
+        {
+          std::size_t bytes = this->capacity() * sizeof(Row);
+          for (typename BaseT::const_iterator it = this->begin(); it != this->end(); ++it)
+            bytes += it->capacity() * sizeof(size_type);
+          return bytes;
+        }
+
+        //! free the memory of row i
+        void release (size_type i)
+        {
+          Row().swap((*this)[i]);
         }
       };
 
@@ -206,6 +286,20 @@ namespace Dune {
         access(c,i,i) = diag_val;
       }
 
+      //! storage which an Accessor reuses from element to element
+      /**
+       * The local assembler engines keep one of these and hand it to
+       * the accessors they create, so scattering a local matrix does
+       * not allocate once the storage has grown to the largest local
+       * function space.
+       */
+      template<typename E>
+      struct AccessorScratch
+      {
+        //! matrix block of each local column in the current block row
+        std::vector<typename Matrix<E>::block_type*> blocks;
+      };
+
       template<typename LFSV, typename LFSU, typename E>
       struct Accessor
       {
@@ -213,11 +307,26 @@ namespace Dune {
         typedef ISTLBCRSMatrixBackend<ROWBLOCKSIZE,COLBLOCKSIZE> Backend;
         typedef typename Backend::size_type size_type;
         typedef typename Backend::template Matrix<ElementType> Matrix;
+        typedef typename Backend::template AccessorScratch<ElementType> Scratch;
 
+        typedef typename Matrix::block_type Block;
+
+        //! accessor with its own storage for addRow()
         Accessor(Matrix& matrix, const LFSV& lfsv, const LFSU& lfsu)
           : _matrix(matrix)
           , _lfsv(lfsv)
           , _lfsu(lfsu)
+          , _blocks(_own_scratch.blocks)
+          , _block_row(invalid())
+        {}
+
+        //! accessor which keeps the storage for addRow() in scratch
+        Accessor(Matrix& matrix, const LFSV& lfsv, const LFSU& lfsu, Scratch& scratch)
+          : _matrix(matrix)
+          , _lfsv(lfsv)
+          , _lfsu(lfsu)
+          , _blocks(scratch.blocks)
+          , _block_row(invalid())
         {}
 
         void set(size_type i, size_type j, const typename Matrix::field_type& v)
@@ -250,10 +359,69 @@ namespace Dune {
           return Backend::access(_matrix,gi,gj);
         }
 
+        //! add values[j] to the entry (i,j) for all DOFs j of lfsu
+        /**
+         * Zero values are skipped, so they need not be present in the
+         * sparsity pattern. The blocks of the columns are looked up once
+         * per block row of the matrix, and consecutive rows in the same
+         * block row (as produced by blockwise DOF orderings) reuse them.
+         */
+        void addRow(size_type i, const typename Matrix::field_type* values)
+        {
+          const size_type gi = _lfsv.globalIndex(i);
+          if (gi/ROWBLOCKSIZE != _block_row)
+            resolveColumns(gi/ROWBLOCKSIZE);
+          const size_type ii = gi%ROWBLOCKSIZE;
+          for (size_type j=0; j<_lfsu.size(); ++j)
+            {
+              if (values[j] == 0.0)
+                continue;
+              Block* block = _blocks[j];
+              if (block)
+                (*block)[ii][_lfsu.globalIndex(j)%COLBLOCKSIZE] += values[j];
+              else
+                // raises the usual error for entries missing from the pattern
+                Backend::access(_matrix,gi,_lfsu.globalIndex(j)) += values[j];
+            }
+        }
+
         Matrix& _matrix;
         const LFSV& _lfsv;
         const LFSU& _lfsu;
 
+      private:
+
+        static size_type invalid()
+        {
+          return std::numeric_limits<size_type>::max();
+        }
+
+        //! look up the blocks of all local columns in block row bi
+        void resolveColumns(size_type bi)
+        {
+          const size_type n = _lfsu.size();
+          // only grows, so a reused scratch stops allocating
+          if (_blocks.size() < n)
+            _blocks.resize(n);
+
+          typedef typename Matrix::row_type::iterator ColIterator;
+          const ColIterator cend = _matrix[bi].end();
+          for (size_type j=0; j<n; ++j)
+            {
+              // binary search in the sorted column indices of the row
+              const ColIterator cit = _matrix[bi].find(_lfsu.globalIndex(j)/COLBLOCKSIZE);
+              _blocks[j] = (cit != cend) ? &(*cit) : 0;
+            }
+          _block_row = bi;
+        }
+
+        //! storage of an accessor constructed without scratch
+        Scratch _own_scratch;
+        //! matrix block of each local column in the current block row
+        std::vector<Block*>& _blocks;
+        //! block row for which the column blocks have been resolved
+        size_type _block_row;
+
       };
 
       template<typename C>
@@ -7,6 +7,7 @@
 
 #include <dune/common/deprecated.hh>
 #include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/shared_ptr.hh>
 
 #include <dune/grid/common/gridenums.hh>
 
@@ -21,6 +22,7 @@
 #include <dune/istl/solvers.hh>
 #include <dune/istl/superlu.hh>
 
+#include "../gridfunctionspace/communicationplan.hh"
 #include "istlvectorbackend.hh"
 #include "parallelistlhelper.hh"
 #include "seqistlsolverbackend.hh"
@@ -66,20 +68,18 @@ namespace Dune {
        * \param gfs_    GridFunctionsSpace for the vectors.
        * \param A       Matrix for this operator.  This should be the locally
        *                assembled matrix.
-       * \param helper_ Helper for parallel communication (not used).
+       * \param helper_ Helper for parallel communication, the operator uses
+       *                its communication plan.
        *
        * \note The constructed object stores references to all the objects
        *       given as parameters here.  They should be valid for as long as
        *       the constructed object is used.  They are not needed to
        *       destruct the constructed object.
-       *
-       * \deprecated The helper_ parameter is unused.  Use the constructor
-       *             without the helper_ parameter instead.
        */
       NonoverlappingOperator (const GFS& gfs_, const M& A,
                               const ParallelISTLHelper<GFS>& helper_)
-        DUNE_DEPRECATED
-        : gfs(gfs_), _A_(A)
+        : gfs(gfs_), _A_(A),
+          plan(helper_.communicationPlan(Dune::InteriorBorder_InteriorBorder_Interface))
       {
       }
 
@@ -93,9 +93,15 @@ namespace Dune {
        *       given as parameters here.  They should be valid for as long as
        *       the constructed object is used.  They are not needed to
        *       destruct the constructed object.
+       *
+       * The operator sets up a communication plan of its own, prefer the
+       * constructor taking the helper if several operators are applied.
        */
       NonoverlappingOperator (const GFS& gfs_, const M& A)
-        : gfs(gfs_), _A_(A)
+        : gfs(gfs_), _A_(A),
+          ownPlan(new Plan(gfs_,Dune::InteriorBorder_InteriorBorder_Interface,
+                           Dune::ForwardCommunication)),
+          plan(*ownPlan)
       { }
 
       //! apply operator
@@ -110,9 +116,7 @@ namespace Dune {
         _A_.mv(x,y);
 
         // accumulate y on border
-        Dune::PDELab::AddDataHandle<GFS,Y> adddh(gfs,y);
-        if (gfs.gridView().comm().size()>1)
-          gfs.gridView().communicate(adddh,Dune::InteriorBorder_InteriorBorder_Interface,Dune::ForwardCommunication);
+        plan.communicate(y,Dune::PDELab::AddGatherScatter());
       }
 
       //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
@@ -127,9 +131,7 @@ namespace Dune {
         _A_.usmv(alpha,x,y);
 
         // accumulate y on border
-        Dune::PDELab::AddDataHandle<GFS,Y> adddh(gfs,y);
-        if (gfs.gridView().comm().size()>1)
-          gfs.gridView().communicate(adddh,Dune::InteriorBorder_InteriorBorder_Interface,Dune::ForwardCommunication);
+        plan.communicate(y,Dune::PDELab::AddGatherScatter());
       }
 
       //! extract the matrix
@@ -139,8 +141,12 @@ namespace Dune {
       }
 
     private:
+      typedef typename ParallelISTLHelper<GFS>::Plan Plan;
+
       const GFS& gfs;
       const M& _A_;
+      Dune::shared_ptr<Plan> ownPlan;
+      const Plan& plan;
     };
 
     // parallel scalar product assuming no overlap
@@ -385,7 +391,7 @@ namespace Dune {
       void apply(M& A, V& z, W& r, typename V::ElementType reduction)
       {
         typedef Dune::PDELab::NonoverlappingOperator<GFS,M,V,W> POP;
-        POP pop(gfs,A);
+        POP pop(gfs,A,phelper);
         typedef Dune::PDELab::NonoverlappingScalarProduct<GFS,V> PSP;
         PSP psp(gfs,phelper);
         typedef Dune::PDELab::NonoverlappingRichardson<GFS,V,W> PRICH;
@@ -474,7 +480,7 @@ namespace Dune {
       void apply(M& A, V& z, W& r, typename V::ElementType reduction)
       {
         typedef NonoverlappingOperator<GFS,M,V,W> POP;
-        POP pop(gfs,A);
+        POP pop(gfs,A,phelper);
         typedef NonoverlappingScalarProduct<GFS,V> PSP;
         PSP psp(gfs,phelper);
 
@@ -542,7 +548,7 @@ namespace Dune {
       void apply(M& A, V& z, W& r, typename V::ElementType reduction)
       {
         typedef Dune::PDELab::NonoverlappingOperator<GFS,M,V,W> POP;
-        POP pop(gfs,A);
+        POP pop(gfs,A,phelper);
         typedef Dune::PDELab::NonoverlappingScalarProduct<GFS,V> PSP;
         PSP psp(gfs,phelper);
         typedef Dune::PDELab::NonoverlappingRichardson<GFS,V,W> PRICH;
@@ -616,7 +622,7 @@ namespace Dune {
       void apply(M& A, V& z, W& r, typename V::ElementType reduction)
       {
         typedef Dune::PDELab::NonoverlappingOperator<GFS,M,V,W> POP;
-        POP pop(gfs,A);
+        POP pop(gfs,A,phelper);
         typedef Dune::PDELab::NonoverlappingScalarProduct<GFS,V> PSP;
         PSP psp(gfs,phelper);
 
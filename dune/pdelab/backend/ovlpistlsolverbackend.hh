@@ -5,6 +5,7 @@
 
 #include <dune/common/deprecated.hh>
 #include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/shared_ptr.hh>
 
 #include <dune/istl/owneroverlapcopy.hh>
 #include <dune/istl/solvercategory.hh>
@@ -17,6 +18,7 @@
 #include <dune/istl/io.hh>
 #include <dune/istl/superlu.hh>
 
+#include "../gridfunctionspace/communicationplan.hh"
 #include "istlvectorbackend.hh"
 #include "parallelistlhelper.hh"
 #include "seqistlsolverbackend.hh"
@@ -148,7 +150,8 @@ namespace Dune {
       //! Constructor.
       OverlappingWrappedPreconditioner (const GFS& gfs_, P& prec_, const CC& cc_,
                                         const ParallelISTLHelper<GFS>& helper_)
-        : gfs(gfs_), prec(prec_), cc(cc_), helper(helper_)
+        : gfs(gfs_), prec(prec_), cc(cc_), helper(helper_),
+          plan(helper_.communicationPlan(Dune::All_All_Interface))
       {}
 
       /*!
@@ -167,9 +170,7 @@ namespace Dune {
         range_type dd(d);
         set_constrained_dofs(cc,0.0,dd);
         prec.apply(v,dd);
-        Dune::PDELab::AddDataHandle<GFS,domain_type,typename domain_type::field_type> adddh(gfs,v);
-        if (gfs.gridView().comm().size()>1)
-          gfs.gridView().communicate(adddh,Dune::All_All_Interface,Dune::ForwardCommunication);
+        plan.communicate(v,Dune::PDELab::AddGatherScatter());
       }
 
       /*!
@@ -185,6 +186,7 @@ namespace Dune {
       P& prec;
       const CC& cc;
       const ParallelISTLHelper<GFS>& helper;
+      const typename ParallelISTLHelper<GFS>::Plan& plan;
     };
 
 
@@ -215,9 +217,27 @@ namespace Dune {
         Constructor gets all parameters to operate the prec.
         \param gfs_ The grid function space.
         \param A_ The matrix to operate on.
+
+        Sets up a communication plan of its own, prefer the constructor
+        taking the parallel istl helper if several solvers are used.
       */
       SuperLUSubdomainSolver (const GFS& gfs_, const M& A_)
-        : gfs(gfs_), A(A_), solver(A_,false) // this does the decomposition
+        : gfs(gfs_), A(A_), solver(A_,false), // this does the decomposition
+          ownPlan(new Plan(gfs_,Dune::All_All_Interface,Dune::ForwardCommunication)),
+          plan(*ownPlan)
+      {}
+
+      /*! \brief Constructor.
+
+        Constructor gets all parameters to operate the prec.
+        \param gfs_ The grid function space.
+        \param A_ The matrix to operate on.
+        \param helper_ The parallel istl helper, whose communication plan is used.
+      */
+      SuperLUSubdomainSolver (const GFS& gfs_, const M& A_,
+                              const ParallelISTLHelper<GFS>& helper_)
+        : gfs(gfs_), A(A_), solver(A_,false), // this does the decomposition
+          plan(helper_.communicationPlan(Dune::All_All_Interface))
       {}
 
       /*!
@@ -239,9 +259,7 @@ namespace Dune {
         std::stringstream s2;
         s2 << "v p" << gfs.gridView().comm().rank();
         // printvector(std::cout,v.base(),s2.str(),s2.str(),8,10,2);
-        Dune::PDELab::AddDataHandle<GFS,X> adddh(gfs,v);
-        if (gfs.gridView().comm().size()>1)
-          gfs.gridView().communicate(adddh,Dune::All_All_Interface,Dune::ForwardCommunication);
+        plan.communicate(v,Dune::PDELab::AddGatherScatter());
         std::stringstream s3;
         s3 << "cv p" << gfs.gridView().comm().rank();
         // printvector(std::cout,v.base(),s3.str(),s3.str(),8,10,2);
@@ -253,9 +271,13 @@ namespace Dune {
       virtual void post (X& x) {}
 
     private:
+      typedef typename ParallelISTLHelper<GFS>::Plan Plan;
+
       const GFS& gfs;
       const M& A;
       Dune::SuperLU<ISTLM> solver;
+      Dune::shared_ptr<Plan> ownPlan;
+      const Plan& plan;
     };
 
     // exact subdomain solves with SuperLU as preconditioner
@@ -288,7 +310,8 @@ namespace Dune {
       */
       RestrictedSuperLUSubdomainSolver (const GFS& gfs_, const M& A_,
                                         const ParallelISTLHelper<GFS>& helper_)
-        : gfs(gfs_), A(A_), solver(A_,false), helper(helper_) // this does the decomposition
+        : gfs(gfs_), A(A_), solver(A_,false), helper(helper_), // this does the decomposition
+          plan(helper_.communicationPlan(Dune::InteriorBorder_All_Interface))
       {}
 
       /*!
@@ -305,9 +328,7 @@ namespace Dune {
         Y b(d); // need copy, since solver overwrites right hand side
         solver.apply(v,b,stat);
         helper.mask(v);
-        Dune::PDELab::AddDataHandle<GFS,X> adddh(gfs,v);
-        if (gfs.gridView().comm().size()>1)
-          gfs.gridView().communicate(adddh,Dune::InteriorBorder_All_Interface,Dune::ForwardCommunication);
+        plan.communicate(v,Dune::PDELab::AddGatherScatter());
       }
 
       /*!
@@ -320,6 +341,7 @@ namespace Dune {
       const M& A;
       Dune::SuperLU<ISTLM> solver;
       const ParallelISTLHelper<GFS>& helper;
+      const typename ParallelISTLHelper<GFS>::Plan& plan;
     };
 #endif
 
@@ -609,7 +631,7 @@ namespace Dune {
         PSP psp(*this);
 #if HAVE_SUPERLU
         typedef Dune::PDELab::SuperLUSubdomainSolver<GFS,M,V,W> PREC;
-        PREC prec(gfs,A);
+        PREC prec(gfs,A,this->parallelHelper());
         int verb=0;
         if (gfs.gridView().comm().rank()==0) verb=verbose;
         Solver<V> solver(pop,psp,prec,reduction,maxiter,verb);
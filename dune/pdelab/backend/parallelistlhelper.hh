@@ -3,8 +3,11 @@
 #ifndef DUNE_PARALLELISTLHELPER_HH
 #define DUNE_PARALLELISTLHELPER_HH
 
+#include <map>
+
 #include <dune/common/deprecated.hh>
 #include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/shared_ptr.hh>
 #include <dune/common/static_assert.hh>
 #include <dune/common/stdstreams.hh>
 
@@ -20,6 +23,7 @@
 #include <dune/istl/superlu.hh>
 
 #include "../constraints/constraints.hh"
+#include "../gridfunctionspace/communicationplan.hh"
 #include "../gridfunctionspace/genericdatahandle.hh"
 #include "istlvectorbackend.hh"
 
@@ -183,6 +187,8 @@ namespace Dune {
       typedef typename Dune::PDELab::BackendVectorSelector<GFS,double>::Type V;
 
     public:
+      //! the plan for exchanging the dofs of vectors of double on GFS, others use the grid communication
+      typedef CommunicationPlan<GFS> Plan;
 
       ParallelISTLHelper (const GFS& gfs_, int verbose_=1)
         : gfs(gfs_), v(gfs,(double)gfs.gridView().comm().rank()), g(gfs,0.0), verbose(verbose_)
@@ -230,6 +236,15 @@ namespace Dune {
         return g.base()[i][j];
       }
 
+      //! the plan for forward communication over iftype, shared by all users of this helper
+      const Plan& communicationPlan (Dune::InterfaceType iftype) const
+      {
+        Dune::shared_ptr<Plan>& plan = plans[iftype];
+        if (!plan)
+          plan.reset(new Plan(gfs,iftype,Dune::ForwardCommunication));
+        return *plan;
+      }
+
 #if HAVE_MPI
 
       /**
@@ -251,6 +266,7 @@ namespace Dune {
       V v; // vector to identify unique decomposition
       V g; //vector to identify ghost dofs
       int verbose; //verbosity
+      mutable std::map<Dune::InterfaceType,Dune::shared_ptr<Plan> > plans;
     };
 
 
@@ -488,6 +488,13 @@ namespace Dune {
         _vals[i * _cols.size() + j] += v;
       }
 
+      void addRow(size_type i, const PetscScalar* values)
+      {
+        for (size_type j = 0; j < _N; ++j)
+          if (values[j] != 0.0)
+            add(i,j,values[j]);
+      }
+
       void setGlobal(size_type gi, size_type gj, const typename Matrix::field_type& v)
       {
         DUNE_THROW(NotImplemented,"Non-Dirichlet constraint is not yet implemented for PETSc backend.");
@@ -673,6 +680,14 @@ namespace Dune {
     {
     public:
 
+      //! storage which an Accessor may reuse from element to element
+      /**
+       * The PETSc accessors keep their index lists themselves.
+       */
+      template<typename E>
+      struct AccessorScratch
+      {};
+
       template<typename LFSV, typename LFSU, typename E>
       class Accessor
         : public PetscMatrixAccessor<LFSV,LFSU>
@@ -684,6 +699,10 @@ namespace Dune {
           : PetscMatrixAccessor<LFSV,LFSU>(m,lfsv,lfsu)
         {}
 
+        Accessor(PetscMatrixContainer& m, const LFSV& lfsv, const LFSU& lfsu, AccessorScratch<E>&)
+          : PetscMatrixAccessor<LFSV,LFSU>(m,lfsv,lfsu)
+        {}
+
       };
 
       template<typename E>
@@ -832,6 +851,13 @@ namespace Dune {
         a.add(i,j,v);
       }
 
+      void addRow(size_type i, const PetscScalar* values)
+      {
+        for (size_type j = 0; j < _lfsu.size(); ++j)
+          if (values[j] != 0.0)
+            add(i,j,values[j]);
+      }
+
     private:
 
       PetscNestedMatrixContainer& _m;
@@ -883,6 +909,10 @@ namespace Dune {
           : PetscNestedMatrixAccessor<LFSV,LFSU>(m,lfsv,lfsu)
         {}
 
+        Accessor(PetscNestedMatrixContainer& m, const LFSV& lfsv, const LFSU& lfsu, AccessorScratch<E>&)
+          : PetscNestedMatrixAccessor<LFSV,LFSU>(m,lfsv,lfsu)
+        {}
+
       };
 
 
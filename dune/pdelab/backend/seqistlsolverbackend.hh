@@ -3,6 +3,8 @@
 #ifndef DUNE_SEQISTLSOLVERBACKEND_HH
 #define DUNE_SEQISTLSOLVERBACKEND_HH
 
+#include <algorithm>
+
 #include <dune/common/deprecated.hh>
 #include <dune/common/parallel/mpihelper.hh>
 
@@ -62,6 +64,125 @@ namespace Dune {
       GOS& gos;
     };
 
+    //! Linear operator which applies the jacobian of a GridOperator without assembling it
+    /**
+     * In contrast to OnTheFlyOperator, constrained rows act as rows of
+     * the identity and the columns of constrained DOFs are transformed
+     * just like in the matrix assembled by GridOperator::jacobian(), so
+     * both representations of the operator coincide.
+     *
+     * \note jacobian_apply() evaluates the jacobian independently of a
+     * linearization point, so this operator is restricted to linear
+     * problems.
+     *
+     * \tparam GO The grid operator.
+     */
+    template<typename GO>
+    class ISTLMatrixFreeOperator
+      : public Dune::LinearOperator<typename GO::Traits::Domain, typename GO::Traits::Range>
+    {
+    public:
+      typedef typename GO::Traits::Domain domain_type;
+      typedef typename GO::Traits::Range range_type;
+      typedef typename domain_type::field_type field_type;
+
+      enum {category=Dune::SolverCategory::sequential};
+
+      ISTLMatrixFreeOperator (const GO& go_)
+        : go(go_), xc(go_.trialGridFunctionSpace()), temp(go_.testGridFunctionSpace())
+      {}
+
+      virtual void apply (const domain_type& x, range_type& y) const
+      {
+        typedef typename GO::Traits::TrialGridFunctionSpaceConstraints CU;
+        typedef typename GO::Traits::TestGridFunctionSpaceConstraints CV;
+        typedef typename domain_type::Backend BX;
+        typedef typename range_type::Backend BY;
+
+        // the assembled matrix moves the columns of constrained DOFs to
+        // the DOFs they depend on, Dirichlet columns are kept
+        const CU& cu = go.localAssembler().trialConstraints();
+        const domain_type* xp = &x;
+        if (!cu.empty())
+          {
+            xc = x;
+            typedef typename CU::value_type::second_type::const_iterator RowIterator;
+            for (typename CU::const_iterator cit=cu.begin(); cit!=cu.end(); ++cit)
+              {
+                if (cit->second.empty())
+                  continue;
+                field_type v = 0.0;
+                for (RowIterator rit=cit->second.begin(); rit!=cit->second.end(); ++rit)
+                  v += rit->second * BX::access(x,rit->first);
+                BX::access(xc,cit->first) = v;
+              }
+            xp = &xc;
+          }
+
+        y = 0.0;
+        go.jacobian_apply(*xp,y);
+
+        const CV& cv = go.localAssembler().testConstraints();
+        for (typename CV::const_iterator cit=cv.begin(); cit!=cv.end(); ++cit)
+          BY::access(y,cit->first) = BX::access(x,cit->first);
+      }
+
+      virtual void applyscaleadd (field_type alpha, const domain_type& x, range_type& y) const
+      {
+        apply(x,temp);
+        y.axpy(alpha,temp);
+      }
+
+    private:
+      const GO& go;
+      //! scratch vector for the coefficients with interpolated constrained DOFs
+      mutable domain_type xc;
+      //! scratch vector for the result of apply() in applyscaleadd()
+      mutable range_type temp;
+    };
+
+    //! Block Jacobi preconditioner built from the element diagonal blocks of the jacobian
+    /**
+     * The block structure is set up on first use and whenever the trial
+     * space has been updated since, even if its size did not change.
+     *
+     * \tparam GO The grid operator.
+     */
+    template<typename GO>
+    class ISTLBlockJacobiPreconditioner
+      : public Dune::Preconditioner<typename GO::Traits::Domain, typename GO::Traits::Range>
+    {
+    public:
+      typedef typename GO::Traits::Domain domain_type;
+      typedef typename GO::Traits::Range range_type;
+      typedef typename domain_type::field_type field_type;
+      typedef typename GO::BlockDiagonal BlockDiagonal;
+
+      enum {category=Dune::SolverCategory::sequential};
+
+      //! assemble and factorize the blocks of the jacobian at x
+      ISTLBlockJacobiPreconditioner (const GO& go, const domain_type& x, BlockDiagonal& diagonal_)
+        : diagonal(diagonal_)
+      {
+        if (diagonal.updateCount() != go.trialGridFunctionSpace().updateCount())
+          diagonal.update(go.trialGridFunctionSpace());
+        go.jacobian_block_diagonal(x,diagonal);
+        diagonal.factorize();
+      }
+
+      virtual void pre (domain_type& x, range_type& b) {}
+
+      virtual void apply (domain_type& v, const range_type& d)
+      {
+        diagonal.solve(v,d);
+      }
+
+      virtual void post (domain_type& x) {}
+
+    private:
+      BlockDiagonal& diagonal;
+    };
+
     //==============================================================================
     // Here we add some standard linear solvers conforming to the linear solver
     // interface required to solve linear and nonlinear problems.
@@ -459,6 +580,129 @@ namespace Dune {
       }
     };
 
+    //! Matrix-free solver based on GridOperator::jacobian_apply() and a block Jacobi preconditioner
+    /**
+     * Only the element diagonal blocks of the jacobian are stored, which
+     * for high order DG spaces is a fraction of the memory of the
+     * assembled matrix. The blocks are reassembled on every call of
+     * apply().
+     *
+     * \note GridOperator::jacobian_apply() has no linearization point,
+     * the local operators evaluate the jacobian at the vector it is
+     * applied to. The backend is therefore restricted to linear problems,
+     * for nonlinear problems use a matrix based backend.
+     *
+     * \tparam GO The grid operator, it must provide jacobian_block_diagonal().
+     * \tparam Solver The ISTL Krylov solver.
+     */
+    template<class GO, template<class> class Solver>
+    class ISTLBackend_SEQ_MatrixFree_Base
+      : public SequentialNorm, public LinearResultStorage
+    {
+    public:
+      /*! \brief make a linear solver object
+
+        \param[in] go_ the grid operator
+        \param[in] maxiter_ maximum number of iterations to do
+        \param[in] verbose_ print messages if true
+      */
+      explicit ISTLBackend_SEQ_MatrixFree_Base(const GO& go_, unsigned maxiter_=5000, int verbose_=1)
+        : go(go_), maxiter(maxiter_), verbose(verbose_)
+      {}
+
+      /*! \brief solve the linear system given by the jacobian of the grid operator
+
+        \param[out] z the solution vector to be computed
+        \param[in] r right hand side
+        \param[in] reduction to be achieved
+      */
+      template<class V, class W>
+      void apply(V& z, W& r, typename W::ElementType reduction)
+      {
+        ISTLMatrixFreeOperator<GO> opa(go);
+        ISTLBlockJacobiPreconditioner<GO> jac(go,z,diagonal);
+        Solver<V> solver(opa, jac, reduction, maxiter, verbose);
+        Dune::InverseOperatorResult stat;
+        solver.apply(z, r, stat);
+        res.converged  = stat.converged;
+        res.iterations = stat.iterations;
+        res.elapsed    = stat.elapsed;
+        res.reduction  = stat.reduction;
+        res.conv_rate  = stat.conv_rate;
+      }
+
+      /*! \brief solve with the interface of the matrix based backends
+
+        Allows to use the backend with solvers like
+        StationaryLinearProblemSolver or Newton, which pass the assembled
+        jacobian. The matrix is ignored and the jacobian is applied by the
+        grid operator instead, so it must represent the same operator.
+        These solvers still assemble the matrix, the savings of the matrix
+        free approach are only obtained by calling apply(z,r,reduction).
+        The current iterate of a Newton method is not passed to the linear
+        solver, so the backend must not be used with Newton for nonlinear
+        problems.
+
+        \param[in] A the assembled matrix, not used
+        \param[out] z the solution vector to be computed
+        \param[in] r right hand side
+        \param[in] reduction to be achieved
+      */
+      template<class M, class V, class W>
+      void apply(M& A, V& z, W& r, typename W::ElementType reduction)
+      {
+        apply(z,r,reduction);
+      }
+
+      //! The element diagonal blocks used by the preconditioner
+      const typename GO::BlockDiagonal& blockDiagonal() const
+      {
+        return diagonal;
+      }
+
+    private:
+      const GO& go;
+      typename GO::BlockDiagonal diagonal;
+      unsigned maxiter;
+      int verbose;
+    };
+
+    /**
+     * @brief Matrix-free backend for sequential conjugate gradient solver with block Jacobi preconditioner.
+     */
+    template<class GO>
+    class ISTLBackend_SEQ_MatrixFree_CG_BlockJac
+      : public ISTLBackend_SEQ_MatrixFree_Base<GO,Dune::CGSolver>
+    {
+    public:
+      /*! \brief make a linear solver object
+        \param[in] go_ the grid operator
+        \param[in] maxiter_ maximum number of iterations to do
+        \param[in] verbose_ print messages if true
+      */
+      explicit ISTLBackend_SEQ_MatrixFree_CG_BlockJac (const GO& go_, unsigned maxiter_=5000, int verbose_=1)
+        : ISTLBackend_SEQ_MatrixFree_Base<GO,Dune::CGSolver>(go_, maxiter_, verbose_)
+      {}
+    };
+
+    /**
+     * @brief Matrix-free backend for sequential BiCGSTAB solver with block Jacobi preconditioner.
+     */
+    template<class GO>
+    class ISTLBackend_SEQ_MatrixFree_BCGS_BlockJac
+      : public ISTLBackend_SEQ_MatrixFree_Base<GO,Dune::BiCGSTABSolver>
+    {
+    public:
+      /*! \brief make a linear solver object
+        \param[in] go_ the grid operator
+        \param[in] maxiter_ maximum number of iterations to do
+        \param[in] verbose_ print messages if true
+      */
+      explicit ISTLBackend_SEQ_MatrixFree_BCGS_BlockJac (const GO& go_, unsigned maxiter_=5000, int verbose_=1)
+        : ISTLBackend_SEQ_MatrixFree_Base<GO,Dune::BiCGSTABSolver>(go_, maxiter_, verbose_)
+      {}
+    };
+
     //! \} Sequential Solvers
 
     /**
@@ -467,6 +711,21 @@ namespace Dune {
      */
     struct ISTLAMGStatistics
     {
+      /** @brief How the AMG hierarchy was obtained for a solve. */
+      enum HierarchySetup {
+        //! aggregation and Galerkin products were computed from scratch
+        fullSetup,
+        //! the Galerkin products were recomputed on the old aggregates
+        galerkinUpdate,
+        //! the hierarchy of a previous solve was used unchanged
+        keptHierarchy
+      };
+
+      ISTLAMGStatistics()
+        : tprepare(0.0), levels(0), tsolve(0.0), tsetup(0.0), iterations(0),
+          directCoarseLevelSolver(false), setup(fullSetup), setupIterations(0)
+      {}
+
       /** 
        * @brief The needed for computing the parallel information and
        * for adapting the linear system.
@@ -476,14 +735,49 @@ namespace Dune {
       int levels;
       /** @brief The time spent in solving the system (without building the hierarchy. */
       double tsolve;
-      /** @brief The time needed for building the AMG hierarchy (coarsening). */
+      /** @brief The time needed for building the AMG hierarchy (coarsening), zero if it was kept. */
       double tsetup;
       /** @brief The number of iterations performed until convergence was reached. */
       int iterations;
       /** @brief True if a direct solver was used on the coarset level. */
       bool directCoarseLevelSolver;
+      /** @brief How the hierarchy was obtained for the last solve. */
+      HierarchySetup setup;
+      /** @brief The number of iterations of the first solve after the last full setup. */
+      int setupIterations;
     };
       
+    /**
+     * @brief Whether an AMG smoother works on the matrix it was set up with.
+     *
+     * Such smoothers see new matrix values after
+     * AMG::recalculateHierarchy(), while smoothers which copy or factorize
+     * the matrix, like ILU, keep the old ones.
+     */
+    template<class S>
+    struct SmootherRefersToMatrix
+    {
+      static const bool value = false;
+    };
+
+    template<class M, class X, class Y, int l>
+    struct SmootherRefersToMatrix<Dune::SeqJac<M,X,Y,l> >
+    {
+      static const bool value = true;
+    };
+
+    template<class M, class X, class Y, int l>
+    struct SmootherRefersToMatrix<Dune::SeqSOR<M,X,Y,l> >
+    {
+      static const bool value = true;
+    };
+
+    template<class M, class X, class Y, int l>
+    struct SmootherRefersToMatrix<Dune::SeqSSOR<M,X,Y,l> >
+    {
+      static const bool value = true;
+    };
+
     template<class GO, template<class,class,class,int> class Preconditioner, template<class> class Solver,
               bool skipBlocksizeCheck = false>
     class ISTLBackend_SEQ_AMG : public LinearResultStorage
@@ -503,7 +797,9 @@ namespace Dune {
       ISTLBackend_SEQ_AMG(unsigned maxiter_=5000, int verbose_=1,
                           bool reuse_=false, bool usesuperlu_=true)
         : maxiter(maxiter_), params(15,2000), verbose(verbose_),
-          reuse(reuse_), firstapply(true), usesuperlu(usesuperlu_)
+          reuse(reuse_), firstapply(true), usesuperlu(usesuperlu_),
+          adaptive(false), keep_growth(1.5), rebuild_growth(3.0),
+          matrix(0), rows(0), nonzeroes(0)
       {
         params.setDefaultValuesIsotropic(GFS::Traits::GridViewType::Traits::Grid::dimension);
         params.setDebugLevel(verbose_);
@@ -527,6 +823,37 @@ namespace Dune {
         params = params_;
       }
 
+      /*! \brief choose the reuse of the AMG hierarchy from the iteration counts
+
+        The number of iterations of the first solve after a full setup
+        serves as reference. As long as a solve needs at most
+        keep_growth_ times as many iterations, the next solve keeps the
+        hierarchy. Up to rebuild_growth_ times as many iterations, the
+        Galerkin products of the coarse levels are recomputed on the old
+        aggregates. Beyond that, after a solve which did not converge,
+        or if a different matrix is passed, the hierarchy is set up from
+        scratch. The decision is reported in statistics().setup.
+
+        recalculateHierarchy() does not set up the smoothers and the
+        coarse solver again. The Galerkin update is therefore only used
+        with Jacobi, SOR or SSOR smoothers, which work on the matrices
+        of the hierarchy, and with an iterative coarse solver. With ILU
+        smoothers or the SuperLU coarse solver, which keep a
+        factorization of the old matrices, the hierarchy is set up from
+        scratch instead.
+
+        Overrides the reuse flag of the constructor.
+
+        \param[in] keep_growth_ largest iteration growth for keeping the hierarchy
+        \param[in] rebuild_growth_ largest iteration growth for a Galerkin update
+      */
+      void setAdaptiveReuse(double keep_growth_ = 1.5, double rebuild_growth_ = 3.0)
+      {
+        adaptive = true;
+        keep_growth = keep_growth_;
+        rebuild_growth = rebuild_growth_;
+      }
+
       /*! \brief compute global norm of a vector
 
         \param[in] v the given vector
@@ -554,22 +881,41 @@ namespace Dune {
         smootherArgs.relaxationFactor = 1;
 
         Criterion criterion(params);
-        Operator oop(mat);
-        //only construct a new AMG if the matrix changes
-        if (reuse==false || firstapply==true){
-          amg.reset(new AMG(oop, criterion, smootherArgs));
-          firstapply = false;
-          stats.tsetup = watch.elapsed();
-          stats.levels = amg->maxlevels();
-          stats.directCoarseLevelSolver=amg->usesDirectCoarseLevelSolver();
-        }
+        stats.setup = hierarchySetup(mat);
+        switch (stats.setup)
+          {
+          case ISTLAMGStatistics::fullSetup:
+            // the hierarchy keeps a pointer to the fine level operator
+            amg.reset();
+            oop.reset(new Operator(mat));
+            amg.reset(new AMG(*oop, criterion, smootherArgs));
+            firstapply = false;
+            matrix = &mat;
+            rows = mat.N();
+            nonzeroes = mat.nonzeroes();
+            stats.tsetup = watch.elapsed();
+            stats.levels = amg->maxlevels();
+            stats.directCoarseLevelSolver=amg->usesDirectCoarseLevelSolver();
+            break;
+          case ISTLAMGStatistics::galerkinUpdate:
+            amg->recalculateHierarchy();
+            stats.tsetup = watch.elapsed();
+            break;
+          case ISTLAMGStatistics::keptHierarchy:
+            stats.tsetup = 0.0;
+            break;
+          }
         watch.reset();
         Dune::InverseOperatorResult stat;
 
-        Solver<VectorType> solver(oop,*amg,reduction,maxiter,verbose);
+        Operator op(mat);
+        Solver<VectorType> solver(op,*amg,reduction,maxiter,verbose);
         solver.apply(BlockProcessor<GFS,skipBlocksizeCheck>::getVector(z),
             BlockProcessor<GFS,skipBlocksizeCheck>::getVector(r),stat);
         stats.tsolve= watch.elapsed();
+        stats.iterations = stat.iterations;
+        if (stats.setup == ISTLAMGStatistics::fullSetup)
+          stats.setupIterations = stat.iterations;
         res.converged  = stat.converged;
         res.iterations = stat.iterations;
         res.elapsed    = stat.elapsed;
@@ -588,12 +934,43 @@ namespace Dune {
       }
       
     private:
+      // decide how to obtain the hierarchy for the next solve with mat
+      ISTLAMGStatistics::HierarchySetup hierarchySetup(const MatrixType& mat) const
+      {
+        if (firstapply)
+          return ISTLAMGStatistics::fullSetup;
+        if (!adaptive)
+          return reuse ? ISTLAMGStatistics::keptHierarchy : ISTLAMGStatistics::fullSetup;
+        if (&mat != matrix || mat.N() != rows || mat.nonzeroes() != nonzeroes
+            || !res.converged)
+          return ISTLAMGStatistics::fullSetup;
+        const double growth = double(res.iterations) / std::max(stats.setupIterations,1);
+        if (growth <= keep_growth)
+          return ISTLAMGStatistics::keptHierarchy;
+        if (growth <= rebuild_growth && galerkinUpdatePossible())
+          return ISTLAMGStatistics::galerkinUpdate;
+        return ISTLAMGStatistics::fullSetup;
+      }
+
+      // whether recalculateHierarchy() updates everything the solve uses
+      bool galerkinUpdatePossible() const
+      {
+        return SmootherRefersToMatrix<Smoother>::value && !amg->usesDirectCoarseLevelSolver();
+      }
+
       unsigned maxiter;
       Parameters params;
       int verbose;
       bool reuse;
       bool firstapply;
       bool usesuperlu;
+      bool adaptive;
+      double keep_growth;
+      double rebuild_growth;
+      const MatrixType* matrix;
+      std::size_t rows;
+      std::size_t nonzeroes;
+      Dune::shared_ptr<Operator> oop;
       Dune::shared_ptr<AMG> amg;
       ISTLAMGStatistics stats;
     };
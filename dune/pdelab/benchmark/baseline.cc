@@ -0,0 +1,464 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<algorithm>
+#include<fstream>
+#include<iostream>
+#include<limits>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/common/shared_ptr.hh>
+#include<dune/common/ios_state.hh>
+#include<dune/common/parametertreeparser.hh>
+#include<dune/geometry/type.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/grid/io/file/vtk/vtkwriter.hh>
+
+#include"../common/clock.hh"
+#include"../common/function.hh"
+#include"../common/vtkexport.hh"
+#include"../finiteelementmap/conformingconstraints.hh"
+#include"../finiteelementmap/opbfem.hh"
+#include"../finiteelementmap/p0fem.hh"
+#include"../finiteelementmap/pkfem.hh"
+#include"../finiteelementmap/q1fem.hh"
+#include"../finiteelementmap/q22dfem.hh"
+#include"../finiteelementmap/qkdg.hh"
+#include"../gridfunctionspace/gridfunctionspace.hh"
+#include"../gridfunctionspace/gridfunctionspaceutilities.hh"
+#include"../constraints/constraints.hh"
+#include"../gridoperator/gridoperator.hh"
+#include"../backend/istlvectorbackend.hh"
+#include"../backend/istlmatrixbackend.hh"
+#include"../backend/seqistlsolverbackend.hh"
+#include"../localoperator/convectiondiffusionparameter.hh"
+#include"../localoperator/convectiondiffusionfem.hh"
+#include"../localoperator/convectiondiffusiondg.hh"
+#include"../localoperator/laplacedirichletccfv.hh"
+
+#include"../test/gridexamples.hh"
+
+// the parameter file read if none is passed, the build sets it to the
+// copy in the source directory
+#ifndef BASELINE_INI
+#define BASELINE_INI "baseline.ini"
+#endif
+
+//===============================================================
+//===============================================================
+// Performance baseline for the main code paths of PDELab
+//
+// For every enabled discretization this times, separately and
+// repeated over several runs,
+//  - GridFunctionSpace::update()
+//  - the construction of the matrix including its sparsity pattern
+//  - residual, jacobian and jacobian_apply of the grid operator
+//  - a linear solve with BiCGStab and SSOR
+//  - VTK output of the solution
+// and writes the minimum and average times together with the DOF
+// throughput and the memory per DOF as JSON.
+//===============================================================
+//===============================================================
+
+// Dirichlet values for the cell centered finite volume scheme
+template<typename GV, typename RF>
+class G
+  : public Dune::PDELab::AnalyticGridFunctionBase<Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1>,
+                                                  G<GV,RF> >
+{
+public:
+  typedef Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1> Traits;
+  typedef Dune::PDELab::AnalyticGridFunctionBase<Traits,G<GV,RF> > BaseT;
+
+  G (const GV& gv) : BaseT(gv) {}
+  inline void evaluateGlobal (const typename Traits::DomainType& x,
+                              typename Traits::RangeType& y) const
+  {
+    typename Traits::DomainType center(0.5);
+    center -= x;
+    y = exp(-center.two_norm2());
+  }
+};
+
+// wall time in seconds
+double wallTime ()
+{
+  const Dune::PDELab::TimeSpec t = Dune::PDELab::getWallTime();
+  return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+// timings of one phase over all runs
+struct PhaseTiming
+{
+  PhaseTiming ()
+    : min(std::numeric_limits<double>::max()), sum(0.0), runs(0)
+  {}
+
+  void add (double t)
+  {
+    min = std::min(min,t);
+    sum += t;
+    ++runs;
+  }
+
+  double min;
+  double sum;
+  std::size_t runs;
+};
+
+// writes the results of all benchmarks as one JSON document
+class Report
+{
+public:
+  Report (std::ostream& s_)
+    : s(s_), saver(s_), first_benchmark(true), first_phase(true), dof_count(0)
+  {
+    s.precision(6);
+    s << "{\n  \"benchmarks\": [";
+  }
+
+  ~Report ()
+  {
+    s << "\n  ]\n}" << std::endl;
+  }
+
+  void begin (const std::string& name, int dim, std::size_t cells, std::size_t dofs,
+              std::size_t nonzeroes, double bytes_per_dof, std::size_t runs)
+  {
+    s << (first_benchmark ? "\n" : ",\n")
+      << "    {\n"
+      << "      \"name\": \"" << name << "\",\n"
+      << "      \"dim\": " << dim << ",\n"
+      << "      \"cells\": " << cells << ",\n"
+      << "      \"dofs\": " << dofs << ",\n"
+      << "      \"nonzeroes\": " << nonzeroes << ",\n"
+      << "      \"bytes_per_dof\": " << bytes_per_dof << ",\n"
+      << "      \"runs\": " << runs << ",\n"
+      << "      \"phases\": {";
+    first_benchmark = false;
+    first_phase = true;
+    dof_count = dofs;
+  }
+
+  void phase (const std::string& name, const PhaseTiming& timing)
+  {
+    s << (first_phase ? "\n" : ",\n")
+      << "        \"" << name << "\": {"
+      << " \"min\": " << timing.min
+      << ", \"avg\": " << timing.sum / timing.runs
+      << ", \"dofs_per_second\": ";
+    // a phase faster than the resolution of the timer has no rate
+    if (timing.min > 0.0)
+      s << dof_count / timing.min;
+    else
+      s << "null";
+    s << " }";
+    first_phase = false;
+  }
+
+  void end ()
+  {
+    s << "\n      }\n    }";
+  }
+
+private:
+  std::ostream& s;
+  Dune::ios_base_all_saver saver;
+  bool first_benchmark;
+  bool first_phase;
+  std::size_t dof_count;
+};
+
+//===============================================================
+// Time all phases for one discretization
+//===============================================================
+
+template<typename CON, typename GV, typename FEM, typename LOP, typename CP>
+void benchmark (const std::string& name, const GV& gv, const FEM& fem, LOP& lop, const CP& cp,
+                std::size_t runs, Report& report)
+{
+  std::cout << name << ":" << std::flush;
+
+  typedef Dune::PDELab::GridFunctionSpace<GV,FEM,CON,Dune::PDELab::ISTLVectorBackend<1> > GFS;
+  GFS gfs(gv,fem);
+
+  typedef typename GFS::template ConstraintsContainer<double>::Type CC;
+  CC cc;
+  Dune::PDELab::constraints(cp,gfs,cc);
+
+  typedef Dune::PDELab::GridOperator<GFS,GFS,LOP,Dune::PDELab::ISTLBCRSMatrixBackend<1,1>,
+    double,double,double,CC,CC> GO;
+  GO go(gfs,cc,gfs,cc,lop);
+
+  typedef typename GO::Traits::Domain V;
+  typedef typename GO::Traits::Jacobian M;
+
+  V x(gfs,0.0);
+  for (std::size_t i = 0; i < x.flatsize(); ++i)
+    x.base()[i] = 1.0 + 0.1 * (i % 13);
+  V r(gfs,0.0);
+  V y(gfs,0.0);
+  V z(gfs,0.0);
+
+  Dune::PDELab::ISTLBackend_SEQ_BCGS_SSOR solver(5000,0);
+
+  PhaseTiming update, pattern, residual, jacobian, jacobian_apply, solve, vtk;
+  Dune::shared_ptr<M> m;
+  for (std::size_t run = 0; run < runs; ++run)
+    {
+      double start = wallTime();
+      gfs.update();
+      update.add(wallTime() - start);
+
+      m.reset();
+      start = wallTime();
+      m.reset(new M(go));
+      pattern.add(wallTime() - start);
+
+      r = 0.0;
+      start = wallTime();
+      go.residual(x,r);
+      residual.add(wallTime() - start);
+
+      *m = 0.0;
+      start = wallTime();
+      go.jacobian(x,*m);
+      jacobian.add(wallTime() - start);
+
+      y = 0.0;
+      start = wallTime();
+      go.jacobian_apply(x,y);
+      jacobian_apply.add(wallTime() - start);
+
+      z = 0.0;
+      start = wallTime();
+      solver.apply(*m,z,r,1e-8);
+      solve.add(wallTime() - start);
+
+      start = wallTime();
+      typedef Dune::PDELab::DiscreteGridFunction<GFS,V> DGF;
+      DGF dgf(gfs,z);
+      Dune::VTKWriter<GV> vtkwriter(gv,Dune::VTK::nonconforming);
+      vtkwriter.addVertexData(new Dune::PDELab::VTKGridFunctionAdapter<DGF>(dgf,"solution"));
+      vtkwriter.write("baseline_" + name,Dune::VTK::appendedraw);
+      vtk.add(wallTime() - start);
+
+      std::cout << "." << std::flush;
+    }
+  std::cout << std::endl;
+
+  // the matrix in compressed row storage and one coefficient vector
+  const std::size_t dofs = gfs.globalSize();
+  const std::size_t nonzeroes = m->base().nonzeroes();
+  const double bytes_per_dof =
+    double(nonzeroes * (sizeof(double) + sizeof(std::size_t)) + dofs * sizeof(double)) / dofs;
+
+  report.begin(name,GV::dimension,gv.size(0),dofs,nonzeroes,bytes_per_dof,runs);
+  report.phase("update",update);
+  report.phase("pattern",pattern);
+  report.phase("residual",residual);
+  report.phase("jacobian",jacobian);
+  report.phase("jacobian_apply",jacobian_apply);
+  report.phase("solve",solve);
+  report.phase("vtk",vtk);
+  report.end();
+}
+
+//===============================================================
+// Discretizations
+//===============================================================
+
+// conforming finite elements
+template<typename GV, typename FEM>
+void cg (const std::string& name, const GV& gv, const FEM& fem, std::size_t runs, Report& report)
+{
+  typedef Dune::PDELab::ConvectionDiffusionModelProblem<GV,double> Param;
+  Param param;
+  Dune::PDELab::ConvectionDiffusionBoundaryConditionAdapter<Param> bcadapter(gv,param);
+  typedef Dune::PDELab::ConvectionDiffusionFEM<Param,FEM> LOP;
+  LOP lop(param);
+  benchmark<Dune::PDELab::ConformingDirichletConstraints>(name,gv,fem,lop,bcadapter,runs,report);
+}
+
+// symmetric interior penalty discontinuous Galerkin
+template<typename GV, typename FEM>
+void dg (const std::string& name, const GV& gv, const FEM& fem, std::size_t runs, Report& report)
+{
+  typedef Dune::PDELab::ConvectionDiffusionModelProblem<GV,double> Param;
+  Param param;
+  Dune::PDELab::ConvectionDiffusionBoundaryConditionAdapter<Param> bcadapter(gv,param);
+  typedef Dune::PDELab::ConvectionDiffusionDG<Param,FEM> LOP;
+  LOP lop(param,Dune::PDELab::ConvectionDiffusionDGMethod::SIPG,
+          Dune::PDELab::ConvectionDiffusionDGWeights::weightsOn,2.0);
+  benchmark<Dune::PDELab::NoConstraints>(name,gv,fem,lop,bcadapter,runs,report);
+}
+
+// cell centered finite volumes
+template<typename GV>
+void ccfv (const std::string& name, const GV& gv, std::size_t runs, Report& report)
+{
+  typedef Dune::PDELab::P0LocalFiniteElementMap<typename GV::Grid::ctype,double,GV::dimension> FEM;
+  FEM fem(Dune::GeometryType(Dune::GeometryType::cube,GV::dimension));
+  typedef G<GV,double> GType;
+  GType g(gv);
+  typedef Dune::PDELab::LaplaceDirichletCCFV<GType> LOP;
+  LOP lop(g);
+  Dune::PDELab::NoConstraintsParameters cp;
+  benchmark<Dune::PDELab::NoConstraints>(name,gv,fem,lop,cp,runs,report);
+}
+
+//===============================================================
+// Grids
+//===============================================================
+
+// whether the benchmark has a section in the parameter file and is enabled
+bool enabled (const Dune::ParameterTree& params, const std::string& name)
+{
+  return params.hasSub(name) && params.get<bool>(name + ".enabled");
+}
+
+// number of runs for a benchmark
+std::size_t runs (const Dune::ParameterTree& params, const std::string& name)
+{
+  return params.get(name + ".runs",params.get<std::size_t>("global.runs",3));
+}
+
+template<int dim>
+Dune::shared_ptr<Dune::YaspGrid<dim> > yaspGrid (const Dune::ParameterTree& params, const std::string& name)
+{
+  Dune::FieldVector<double,dim> L(1.0);
+  Dune::FieldVector<int,dim> N(1);
+  Dune::FieldVector<bool,dim> B(false);
+  Dune::shared_ptr<Dune::YaspGrid<dim> > grid(new Dune::YaspGrid<dim>(L,N,B,0));
+  grid->globalRefine(params.get<int>(name + ".refine"));
+  return grid;
+}
+
+// the discretizations available on cubes of any dimension
+template<int dim>
+void yasp (const Dune::ParameterTree& params, Report& report)
+{
+  typedef Dune::YaspGrid<dim> Grid;
+  typedef typename Grid::LeafGridView GV;
+  const std::string d = dim == 2 ? "_2D" : "_3D";
+
+  std::string name = "Q1" + d;
+  if (enabled(params,name))
+    {
+      Dune::shared_ptr<Grid> grid = yaspGrid<dim>(params,name);
+      typedef Dune::PDELab::Q1LocalFiniteElementMap<double,double,dim> FEM;
+      FEM fem;
+      cg(name,grid->leafView(),fem,runs(params,name),report);
+    }
+
+  name = "QkDG2" + d;
+  if (enabled(params,name))
+    {
+      Dune::shared_ptr<Grid> grid = yaspGrid<dim>(params,name);
+      typedef Dune::PDELab::QkDGLocalFiniteElementMap<double,double,2,dim> FEM;
+      FEM fem;
+      dg(name,grid->leafView(),fem,runs(params,name),report);
+    }
+
+  name = "OPB2" + d;
+  if (enabled(params,name))
+    {
+      Dune::shared_ptr<Grid> grid = yaspGrid<dim>(params,name);
+      typedef Dune::PDELab::OPBLocalFiniteElementMap<double,double,2,dim,Dune::GeometryType::cube> FEM;
+      FEM fem;
+      dg(name,grid->leafView(),fem,runs(params,name),report);
+    }
+
+  name = "CCFV" + d;
+  if (enabled(params,name))
+    {
+      Dune::shared_ptr<Grid> grid = yaspGrid<dim>(params,name);
+      ccfv(name,grid->leafView(),runs(params,name),report);
+    }
+}
+
+//===============================================================
+// Main program
+//===============================================================
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    Dune::ParameterTree params;
+
+    if (argc == 1)
+      {
+        std::cerr << "no parameter file passed, defaulting to " << BASELINE_INI << "..." << std::endl;
+        Dune::ParameterTreeParser::readINITree(BASELINE_INI,params);
+      }
+    else if (argc == 2)
+      {
+        std::cerr << "reading parameters from " << argv[1] << "..." << std::endl;
+        Dune::ParameterTreeParser::readINITree(argv[1],params);
+      }
+    else
+      {
+        std::cerr << "Usage: " << argv[0] << " [parameter file]" << std::endl;
+        return 64;
+      }
+
+    std::ofstream output(params.get<std::string>("global.output","baseline.json").c_str());
+    Report report(output);
+
+    yasp<2>(params,report);
+
+    // there is no Q2 finite element map for 3D in PDELab
+    if (enabled(params,"Q2_2D"))
+      {
+        Dune::shared_ptr<Dune::YaspGrid<2> > grid = yaspGrid<2>(params,"Q2_2D");
+        typedef Dune::PDELab::Q22DLocalFiniteElementMap<double,double> FEM;
+        FEM fem;
+        cg("Q2_2D",grid->leafView(),fem,runs(params,"Q2_2D"),report);
+      }
+
+    yasp<3>(params,report);
+
+    // Lagrange elements on simplices need a simplex grid
+#if HAVE_UG
+    if (enabled(params,"Pk2_2D"))
+      {
+        Dune::shared_ptr<Dune::UGGrid<2> > grid(TriangulatedUnitSquareMaker<Dune::UGGrid<2> >::create());
+        grid->globalRefine(params.get<int>("Pk2_2D.refine"));
+        typedef Dune::UGGrid<2>::LeafGridView GV;
+        const GV gv = grid->leafView();
+        typedef Dune::PDELab::PkLocalFiniteElementMap<GV,double,double,2,2> FEM;
+        FEM fem(gv);
+        cg("Pk2_2D",gv,fem,runs(params,"Pk2_2D"),report);
+      }
+
+    if (enabled(params,"Pk2_3D"))
+      {
+        Dune::shared_ptr<Dune::UGGrid<3> > grid(TriangulatedUnitCubeMaker<Dune::UGGrid<3> >::create());
+        grid->globalRefine(params.get<int>("Pk2_3D.refine"));
+        typedef Dune::UGGrid<3>::LeafGridView GV;
+        const GV gv = grid->leafView();
+        typedef Dune::PDELab::PkLocalFiniteElementMap<GV,double,double,2,3> FEM;
+        FEM fem(gv);
+        cg("Pk2_3D",gv,fem,runs(params,"Pk2_3D"),report);
+      }
+#endif
+
+    return 0;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,145 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+
+#ifndef DUNE_PDELAB_COMMON_ALIGNEDALLOCATOR_HH
+#define DUNE_PDELAB_COMMON_ALIGNEDALLOCATOR_HH
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+/** \file
+ * \brief An allocator returning memory aligned for SIMD loads and stores
+ */
+
+//! Alignment in bytes of the storage of the local containers
+/**
+ * The default of 32 bytes matches AVX registers. It has to be a power of
+ * two and a multiple of sizeof(void*).
+ */
+#ifndef DUNE_PDELAB_SIMD_ALIGNMENT
+#define DUNE_PDELAB_SIMD_ALIGNMENT 32
+#endif
+
+namespace Dune {
+  namespace PDELab {
+
+    //! \addtogroup PDELab
+    //! \{
+
+    //! Number of entries of type T that fit into one SIMD register, at least one
+    template<typename T>
+    struct SIMDWidth
+    {
+      static const std::size_t value =
+        sizeof(T) < DUNE_PDELAB_SIMD_ALIGNMENT ? DUNE_PDELAB_SIMD_ALIGNMENT / sizeof(T) : 1;
+    };
+
+    //! Rounds n up to a multiple of the SIMD width of T
+    template<typename T>
+    inline std::size_t simdPadded (std::size_t n)
+    {
+      const std::size_t w = SIMDWidth<T>::value;
+      return (n + w - 1) / w * w;
+    }
+
+    //! \brief Standard conforming allocator that aligns all blocks to
+    //!        DUNE_PDELAB_SIMD_ALIGNMENT bytes
+    /**
+     * The memory is obtained from std::malloc(). Each block is over-allocated
+     * by the alignment, and the pointer returned by std::malloc() is stored
+     * in front of the aligned block so that deallocate() can release it.
+     */
+    template<typename T>
+    class AlignedAllocator
+    {
+    public:
+      typedef T value_type;
+      typedef T* pointer;
+      typedef const T* const_pointer;
+      typedef T& reference;
+      typedef const T& const_reference;
+      typedef std::size_t size_type;
+      typedef std::ptrdiff_t difference_type;
+
+      //! the alignment of all blocks in bytes
+      static const std::size_t alignment = DUNE_PDELAB_SIMD_ALIGNMENT;
+
+      template<typename U>
+      struct rebind
+      {
+        typedef AlignedAllocator<U> other;
+      };
+
+      AlignedAllocator ()
+      {}
+
+      template<typename U>
+      AlignedAllocator (const AlignedAllocator<U>&)
+      {}
+
+      pointer address (reference x) const
+      {
+        return &x;
+      }
+
+      const_pointer address (const_reference x) const
+      {
+        return &x;
+      }
+
+      pointer allocate (size_type n, const void* = 0)
+      {
+        if (n > max_size())
+          throw std::bad_alloc();
+        void* raw = std::malloc(n * sizeof(T) + alignment);
+        if (!raw)
+          throw std::bad_alloc();
+        // there is always room for the stored pointer, as the raw block is
+        // at least aligned to sizeof(void*)
+        std::size_t aligned = (reinterpret_cast<std::size_t>(raw) + alignment) & ~(alignment - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<pointer>(aligned);
+      }
+
+      void deallocate (pointer p, size_type)
+      {
+        if (p)
+          std::free(reinterpret_cast<void**>(p)[-1]);
+      }
+
+      size_type max_size () const
+      {
+        return (std::numeric_limits<size_type>::max() - alignment) / sizeof(T);
+      }
+
+      void construct (pointer p, const T& value)
+      {
+        new (static_cast<void*>(p)) T(value);
+      }
+
+      void destroy (pointer p)
+      {
+        p->~T();
+      }
+    };
+
+    template<typename T, typename U>
+    bool operator== (const AlignedAllocator<T>&, const AlignedAllocator<U>&)
+    {
+      return true;
+    }
+
+    template<typename T, typename U>
+    bool operator!= (const AlignedAllocator<T>&, const AlignedAllocator<U>&)
+    {
+      return false;
+    }
+
+    //! \} group PDELab
+
+  } // namespace PDELab
+} // namespace Dune
+
+#endif // DUNE_PDELAB_COMMON_ALIGNEDALLOCATOR_HH
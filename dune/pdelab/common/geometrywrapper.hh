@@ -19,10 +19,16 @@ namespace Dune {
 	  typedef typename E::Geometry Geometry;
       //! \todo Please doc me!
 	  typedef E Entity;
+      //! coordinate type of the geometry
+      typedef typename Geometry::ctype ctype;
+      //! type of a position in the reference element
+      typedef typename Geometry::LocalCoordinate LocalCoordinate;
+      //! type of the transposed inverse of the jacobian of the geometry mapping
+      typedef typename Geometry::JacobianInverseTransposed JacobianInverseTransposed;
 
       //! \todo Please doc me!
 	  ElementGeometry (const E& e_)
-		: e(e_)
+		: e(e_), affine_known(false), affine_(false), cached(false)
 	  {}
 
       //! \todo Please doc me!
@@ -42,9 +48,70 @@ namespace Dune {
 	  {
 		return e;
 	  }
-  
+
+      //! whether the geometry mapping of the element is affine
+      /**
+       * The jacobian and the integration element of an affine geometry
+       * do not depend on the position, e.g. on YaspGrid and on simplices.
+       */
+      bool affine () const
+      {
+        if (!affine_known)
+          {
+            affine_ = e.geometry().affine();
+            affine_known = true;
+          }
+        return affine_;
+      }
+
+      //! transposed inverse of the jacobian of the geometry mapping at x
+      /**
+       * For affine geometries, the value is computed only once per
+       * element, so local operators may call this at every quadrature
+       * point instead of eg.geometry().jacobianInverseTransposed(x).
+       *
+       * \note The returned reference is only valid until the next call.
+       */
+      const JacobianInverseTransposed& jacobianInverseTransposed (const LocalCoordinate& x) const
+      {
+        if (affine())
+          {
+            cache(x);
+            return jit;
+          }
+        jit = e.geometry().jacobianInverseTransposed(x);
+        return jit;
+      }
+
+      //! integration element of the geometry mapping at x, computed only once per element for affine geometries
+      ctype integrationElement (const LocalCoordinate& x) const
+      {
+        if (affine())
+          {
+            cache(x);
+            return integration_element;
+          }
+        return e.geometry().integrationElement(x);
+      }
+
 	private:
+      void cache (const LocalCoordinate& x) const
+      {
+        if (!cached)
+          {
+            const Geometry geometry = e.geometry();
+            jit = geometry.jacobianInverseTransposed(x);
+            integration_element = geometry.integrationElement(x);
+            cached = true;
+          }
+      }
+
 	  const E& e;
+      mutable bool affine_known;
+      mutable bool affine_;
+      mutable bool cached;
+      mutable JacobianInverseTransposed jit;
+      mutable ctype integration_element;
 	};
 
 
@@ -71,9 +138,12 @@ namespace Dune {
       //! \todo Please doc me!
 	  enum { dimensionworld=Entity::dimensionworld };
 
+      //! type of the transposed inverse of the jacobian of the inside and outside elements
+      typedef typename Entity::Geometry::JacobianInverseTransposed JacobianInverseTransposed;
+
       //! \todo Please doc me!
       IntersectionGeometry (const I& i_, unsigned int index_)
-        : i(i_), index(index_)
+        : i(i_), index(index_), affine_known(false), affine_(false), cached(false)
 	  {}
 
       //! \todo Please doc me!
@@ -246,9 +316,99 @@ namespace Dune {
         return index;
       }
 
+      //! whether the geometry mapping of the intersection is affine
+      bool affine () const
+      {
+        if (!affine_known)
+          {
+            affine_ = i.geometry().affine();
+            affine_known = true;
+          }
+        return affine_;
+      }
+
+      //! integration element of the intersection at x, computed only once per intersection if it is affine
+      ctype integrationElement (const Dune::FieldVector<ctype, dimension-1>& x) const
+      {
+        if (affine())
+          {
+            if (!cached)
+              {
+                integration_element = i.geometry().integrationElement(x);
+                cached = true;
+              }
+            return integration_element;
+          }
+        return i.geometry().integrationElement(x);
+      }
+
+      //! transposed inverse of the jacobian of inside() at x, given in its local coordinates
+      /**
+       * For affine elements, the value is computed only once per
+       * intersection.
+       *
+       * \note The returned reference is only valid until the next call.
+       */
+      const JacobianInverseTransposed& insideJacobianInverseTransposed (const Dune::FieldVector<ctype, dimension>& x) const
+      {
+        // a cached value does not need the entity pointer
+        if (inside_jacobian.cached)
+          return inside_jacobian.jit;
+        return inside_jacobian.evaluate(i.inside(),x);
+      }
+
+      //! transposed inverse of the jacobian of outside() at x, given in its local coordinates
+      /**
+       * For affine elements, the value is computed only once per
+       * intersection.
+       *
+       * \note The returned reference is only valid until the next call.
+       */
+      const JacobianInverseTransposed& outsideJacobianInverseTransposed (const Dune::FieldVector<ctype, dimension>& x) const
+      {
+        // a cached value does not need the entity pointer
+        if (outside_jacobian.cached)
+          return outside_jacobian.jit;
+        return outside_jacobian.evaluate(i.outside(),x);
+      }
+
     private:
+
+      // jacobian of one of the elements of the intersection, cached if it is
+      // affine; callers check cached before obtaining the entity pointer
+      struct ElementJacobian
+      {
+        ElementJacobian ()
+          : affine_known(false), affine(false), cached(false)
+        {}
+
+        const JacobianInverseTransposed& evaluate (const EntityPointer& ep, const Dune::FieldVector<ctype, dimension>& x)
+        {
+          const typename Entity::Geometry geometry = ep->geometry();
+          if (!affine_known)
+            {
+              affine = geometry.affine();
+              affine_known = true;
+            }
+          jit = geometry.jacobianInverseTransposed(x);
+          cached = affine;
+          return jit;
+        }
+
+        bool affine_known;
+        bool affine;
+        bool cached;
+        JacobianInverseTransposed jit;
+      };
+
 	  const I& i;
       const unsigned int index;
+      mutable bool affine_known;
+      mutable bool affine_;
+      mutable bool cached;
+      mutable ctype integration_element;
+      mutable ElementJacobian inside_jacobian;
+      mutable ElementJacobian outside_jacobian;
 	};
 
   }
@@ -0,0 +1,212 @@
+// -*- tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=8 sw=2 sts=2:
+
+#ifndef DUNE_PDELAB_COMMON_INSTRUMENTATION_HH
+#define DUNE_PDELAB_COMMON_INSTRUMENTATION_HH
+
+#include <cstddef>
+#include <ostream>
+
+#include <dune/common/ios_state.hh>
+
+#include <dune/pdelab/common/clock.hh>
+
+/** \file
+ * \brief Timing and call counts of the phases of grid operator assembly
+ *
+ * The assemblers record into the process wide assemblyProfile() if
+ * DUNE_PDELAB_INSTRUMENTATION is defined to a non-zero value before
+ * this header is included. Otherwise the timers do nothing and the
+ * profile stays zero, so uninstrumented builds pay nothing.
+ */
+
+#ifndef DUNE_PDELAB_INSTRUMENTATION
+#define DUNE_PDELAB_INSTRUMENTATION 0
+#endif
+
+namespace Dune {
+  namespace PDELab {
+
+    //! \addtogroup PDELab
+    //! \{
+
+    //! The phases of assembly distinguished by AssemblyProfile
+    struct AssemblyPhase
+    {
+      enum Type {
+        //! binding of local function spaces and the engines' bind notifications
+        bind,
+        //! reading the local coefficients of the solution
+        loadCoefficients,
+        //! volume terms, including the post skeleton terms
+        volume,
+        //! skeleton terms
+        skeleton,
+        //! boundary and processor boundary terms
+        boundary,
+        //! the engines' unbind notifications, which scatter into the global containers
+        scatter,
+        //! post processing of the constraints after the traversal
+        constraints,
+        //! complete assembly calls
+        total
+      };
+
+      //! number of phases
+      static const std::size_t size = total + 1;
+
+      //! name of the phase as used in reports
+      static const char* name (Type phase)
+      {
+        static const char* names[size] = {
+          "bind", "loadCoefficients", "volume", "skeleton",
+          "boundary", "scatter", "constraints", "total"
+        };
+        return names[phase];
+      }
+    };
+
+    //! Accumulated wall time and call counts per assembly phase
+    class AssemblyProfile
+    {
+    public:
+      AssemblyProfile ()
+      {
+        reset();
+      }
+
+      //! set all times and counts to zero
+      void reset ()
+      {
+        for (std::size_t p = 0; p < AssemblyPhase::size; ++p)
+          {
+            _time[p] = 0.0;
+            _calls[p] = 0;
+          }
+      }
+
+      //! record a call of the given phase which took t seconds
+      void add (AssemblyPhase::Type phase, double t)
+      {
+        _time[phase] += t;
+        ++_calls[phase];
+      }
+
+      //! add the records of another profile, e.g. of a thread
+      void merge (const AssemblyProfile& other)
+      {
+        for (std::size_t p = 0; p < AssemblyPhase::size; ++p)
+          {
+            _time[p] += other._time[p];
+            _calls[p] += other._calls[p];
+          }
+      }
+
+      //! accumulated wall time of a phase in seconds
+      double time (AssemblyPhase::Type phase) const
+      {
+        return _time[phase];
+      }
+
+      //! number of recorded calls of a phase
+      unsigned long calls (AssemblyPhase::Type phase) const
+      {
+        return _calls[phase];
+      }
+
+      //! \brief write the minimum, maximum and average over all ranks as JSON
+      /**
+       * This is a collective operation on comm, e.g. gridView().comm().
+       * Every rank has to call it, but only rank 0 writes to s.
+       */
+      template<typename Comm>
+      void report (std::ostream& s, const Comm& comm) const
+      {
+        const int n = 2*AssemblyPhase::size;
+        double min[n], max[n], sum[n];
+        for (std::size_t p = 0; p < AssemblyPhase::size; ++p)
+          {
+            min[2*p] = max[2*p] = sum[2*p] = _time[p];
+            min[2*p+1] = max[2*p+1] = sum[2*p+1] = _calls[p];
+          }
+        comm.min(min,n);
+        comm.max(max,n);
+        comm.sum(sum,n);
+        if (comm.rank() != 0)
+          return;
+
+        ios_base_all_saver saver(s);
+        s.precision(9);
+        const int ranks = comm.size();
+        s << "{\n  \"ranks\": " << ranks << ",\n  \"phases\": {";
+        for (std::size_t p = 0; p < AssemblyPhase::size; ++p)
+          {
+            s << (p > 0 ? ",\n" : "\n")
+              << "    \"" << AssemblyPhase::name(AssemblyPhase::Type(p)) << "\": {"
+              << " \"time\": { \"min\": " << min[2*p]
+              << ", \"max\": " << max[2*p]
+              << ", \"avg\": " << sum[2*p]/ranks << " },"
+              << " \"calls\": { \"min\": " << min[2*p+1]
+              << ", \"max\": " << max[2*p+1]
+              << ", \"avg\": " << sum[2*p+1]/ranks << " } }";
+          }
+        s << "\n  }\n}" << std::endl;
+      }
+
+    private:
+      double _time[AssemblyPhase::size];
+      unsigned long _calls[AssemblyPhase::size];
+    };
+
+    //! \brief The profile the assemblers record into
+    /**
+     * Threaded assemblers record into private profiles and merge them
+     * into this one at the end of each assembly.
+     */
+    inline AssemblyProfile& assemblyProfile ()
+    {
+      static AssemblyProfile profile;
+      return profile;
+    }
+
+    //! \brief Adds the lifetime of the object to a phase of a profile
+    /**
+     * There is only one definition of this class, whether
+     * instrumentation is enabled or not. Without instrumentation the
+     * constructor and the destructor do nothing, and the compiler drops
+     * the object.
+     */
+    class AssemblyPhaseTimer
+    {
+    public:
+      //! whether the timers of this build record into the profiles
+      static const bool enabled = (DUNE_PDELAB_INSTRUMENTATION != 0);
+
+      AssemblyPhaseTimer (AssemblyProfile& profile, AssemblyPhase::Type phase)
+        : _profile(profile), _phase(phase), _start(enabled ? seconds() : 0.0)
+      {}
+
+      ~AssemblyPhaseTimer ()
+      {
+        if (enabled)
+          _profile.add(_phase,seconds() - _start);
+      }
+
+    private:
+      static double seconds ()
+      {
+        const TimeSpec t = getWallTime();
+        return t.tv_sec + 1e-9*t.tv_nsec;
+      }
+
+      AssemblyProfile& _profile;
+      const AssemblyPhase::Type _phase;
+      const double _start;
+    };
+
+    //! \} group PDELab
+
+  } // namespace PDELab
+} // namespace Dune
+
+#endif // DUNE_PDELAB_COMMON_INSTRUMENTATION_HH
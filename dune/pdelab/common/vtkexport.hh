@@ -8,8 +8,11 @@
 #include<string>
 #include<vector>
 
+#include<dune/common/fvector.hh>
 #include<dune/common/shared_ptr.hh>
 
+#include<dune/geometry/type.hh>
+
 #include<dune/grid/io/file/vtk/vtkwriter.hh>
 
 #include<dune/pdelab/common/range.hh>
@@ -25,6 +28,7 @@ namespace Dune {
       typedef typename T::Traits::GridViewType::Grid::ctype DF;
       enum {n=T::Traits::GridViewType::dimension};
       typedef typename T::Traits::GridViewType::Grid::template Codim<0>::Entity Entity;
+      typedef typename T::Traits::GridViewType::IndexSet::IndexType Index;
 
     public:
       //! construct a VTKGridFunctionAdapter
@@ -47,7 +51,7 @@ namespace Dune {
       VTKGridFunctionAdapter(const T& t_, std::string s_,
                              const std::vector<std::size_t> &remap_ =
                                rangeVector(std::size_t(T::Traits::dimRange)))
-        : t(stackobject_to_shared_ptr(t_)), s(s_), remap(remap_)
+        : t(stackobject_to_shared_ptr(t_)), s(s_), remap(remap_), valid(false)
       {}
 
       //! construct a VTKGridFunctionAdapter
@@ -67,7 +71,7 @@ namespace Dune {
       VTKGridFunctionAdapter(const shared_ptr<const T>& t_, std::string s_,
                              const std::vector<std::size_t> &remap_ =
                                rangeVector(std::size_t(T::Traits::dimRange)))
-        : t(t_), s(s_), remap(remap_)
+        : t(t_), s(s_), remap(remap_), valid(false)
       { }
 
       virtual int ncomps () const
@@ -75,14 +79,26 @@ namespace Dune {
         return remap.size();;
       }
 
+      //! evaluate component comp at position xi of cell e
+      /**
+       * The VTKWriter asks for all components of a point in a row, starting
+       * with component 0.  The grid function is evaluated for component 0
+       * only, the other components of the same point reuse its value.
+       */
       virtual double evaluate (int comp, const Entity& e, const Dune::FieldVector<DF,n>& xi) const
       {
-        typename T::Traits::DomainType x;
-        typename T::Traits::RangeType y;
-
-        for (int i=0; i<n; i++)
-          x[i] = xi[i];
-        t->evaluate(e,x,y);
+        const Index index = t->getGridView().indexSet().index(e);
+        if (comp == 0 || !valid || index != lastIndex || e.type() != lastType || xi != lastXi)
+          {
+            typename T::Traits::DomainType x;
+            for (int i=0; i<n; i++)
+              x[i] = xi[i];
+            t->evaluate(e,x,y);
+            valid = true;
+            lastIndex = index;
+            lastType = e.type();
+            lastXi = xi;
+          }
         return y[remap[comp]];
       }
 
@@ -95,6 +111,12 @@ namespace Dune {
       shared_ptr<const T> t;
       std::string s;
       std::vector<std::size_t> remap;
+      // value of the last point evaluated
+      mutable bool valid;
+      mutable Index lastIndex;
+      mutable Dune::GeometryType lastType;
+      mutable Dune::FieldVector<DF,n> lastXi;
+      mutable typename T::Traits::RangeType y;
     };
 
     //! construct a VTKGridFunctionAdapter
@@ -657,9 +657,9 @@ namespace Dune {
         // print result
         if(verbose){
           std::cout << "constraints:" << std::endl;
-          typedef typename CG::iterator global_col_iterator;
+          typedef typename CG::const_iterator global_col_iterator;
           typedef typename CG::value_type::second_type global_row_type;
-          typedef typename global_row_type::iterator global_row_iterator;
+          typedef typename global_row_type::const_iterator global_row_iterator;
 
           std::cout << cg.size() << " constrained degrees of freedom" << std::endl;
 
@@ -671,6 +671,9 @@ namespace Dune {
             std::cout << std::endl;
           }
         }
+
+        // build the flat representation used during assembly
+        cg.compress();
       }
     }; // end ConstraintsAssemblerHelper
 
@@ -831,6 +834,16 @@ namespace Dune {
       typedef typename CG::value_type::second_type::const_iterator global_row_iterator;
       typedef typename XG::Backend B;
 
+      if (cg.compressed())
+        {
+          for (std::size_t p=0; p<cg.constrainedIndices().size(); ++p)
+            for (std::size_t k=0; k<cg.rowSize(p); ++k)
+              B::access(xg,cg.rowIndices(p)[k]) += cg.rowWeights(p)[k] * B::access(xg,cg.constrainedIndices()[p]);
+          for (std::size_t p=0; p<cg.constrainedIndices().size(); ++p)
+            B::access(xg,cg.constrainedIndices()[p]) = 0;
+          return;
+        }
+
       for (global_col_iterator cit=cg.begin(); cit!=cg.end(); ++cit)
         for(global_row_iterator rit = cit->second.begin(); rit!=cit->second.end(); ++rit)
           B::access(xg,rit->first) += rit->second * B::access(xg,cit->first);
@@ -869,7 +882,7 @@ namespace Dune {
     {
       typedef typename XG::Backend B;
       for (typename XG::size_type i=0; i<xg.flatsize(); ++i)
-        if (cg.find(i)==cg.end())
+        if (!cg.isConstrained(i))
           B::access(xg,i) = x;
     }
 
@@ -884,7 +897,7 @@ namespace Dune {
     {
       typedef typename XG::Backend B;
       for (typename XG::size_type i=0; i<xgin.flatsize(); ++i)
-        if (cg.find(i)==cg.end())
+        if (!cg.isConstrained(i))
           B::access(xgout,i) = B::access(xgin,i);
     }
 
@@ -899,8 +912,13 @@ namespace Dune {
       typedef typename XG::Backend B;
       typedef typename CG::const_iterator global_col_iterator;
       for (typename XG::size_type i=0; i<xg.flatsize(); ++i){
+        if (!cg.isConstrained(i))
+          {
+            B::access(xg,i) = x;
+            continue;
+          }
         global_col_iterator it = cg.find(i);
-        if (it == cg.end() || it->second.size() > 0)
+        if (it->second.size() > 0)
           B::access(xg,i) = x;
       }
     }
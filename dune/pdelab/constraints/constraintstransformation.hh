@@ -3,7 +3,12 @@
 #ifndef DUNE_PDELAB_GRIDFUNCTIONSPACE_CONSTRAINTSTRANSFORMATION_HH
 #define DUNE_PDELAB_GRIDFUNCTIONSPACE_CONSTRAINTSTRANSFORMATION_HH
 
+#include <algorithm>
+#include <cstddef>
+#include <limits>
 #include <map>
+#include <utility>
+#include <vector>
 
 namespace Dune {
   namespace PDELab {
@@ -13,17 +18,302 @@ namespace Dune {
     //! \{
 
     //! \brief a class holding transformation for constrained spaces
+    /**
+     * The constraints are assembled into the nested maps. Afterwards,
+     * compress() stores them a second time in flat arrays: the sorted
+     * constrained indices and their rows in compressed row format. A
+     * bitmap over all indices up to the largest constrained one and the
+     * number of constrained indices before every word of the bitmap
+     * answer isConstrained() and position() in constant time, at two
+     * bits per index instead of a table entry per index.
+     *
+     * The map interface is inherited, but the container only hands out
+     * const iterators, also through its iterator type, so reading the
+     * maps never affects the compressed representation. The maps can
+     * only be modified through operator[](), insert() and erase(), and
+     * each of them drops the compressed representation, after which the
+     * queries fall back to the maps until compress() is called again.
+     * clear() and swap() keep both representations consistent.
+     * constraints() compresses the container when it has assembled it.
+     *
+     * \note Modifications through a reference to the std::map base
+     * class bypass these members and are not detected.
+     */
     template<typename S, typename T>
     class ConstraintsTransformation
       : public std::map<S,std::map<S,T> >
     {
+      typedef std::map<S,std::map<S,T> > BaseT;
+
     public:
       //! export ElementType
       typedef T ElementType;
       //! export RowType
       typedef std::map<S,T> RowType;
+
+      typedef typename BaseT::key_type key_type;
+      typedef typename BaseT::mapped_type mapped_type;
+      typedef typename BaseT::value_type value_type;
+      typedef typename BaseT::size_type size_type;
+      typedef typename BaseT::const_iterator const_iterator;
+      typedef typename BaseT::const_reverse_iterator const_reverse_iterator;
+      //! the rows must not be modified through iterators
+      typedef const_iterator iterator;
+      typedef const_reverse_iterator reverse_iterator;
+
+      //! marks an index which is not constrained
+      static const std::size_t npos = ~std::size_t(0);
+
+      //! an empty container is compressed
+      ConstraintsTransformation ()
+        : _offsets(1,0), _valid(true)
+      {}
+
+      //! \brief build the compressed representation from the maps
+      void compress ()
+      {
+        _constrained.clear();
+        _offsets.assign(1,0);
+        _indices.clear();
+        _weights.clear();
+        _bits.clear();
+        _ranks.clear();
+        for (const_iterator cit = BaseT::begin(); cit != BaseT::end(); ++cit)
+          {
+            _constrained.push_back(cit->first);
+            for (typename RowType::const_iterator rit = cit->second.begin(); rit != cit->second.end(); ++rit)
+              {
+                _indices.push_back(rit->first);
+                _weights.push_back(rit->second);
+              }
+            _offsets.push_back(_indices.size());
+          }
+        if (!_constrained.empty())
+          _bits.assign(std::size_t(_constrained.back())/bits+1,0);
+        for (std::size_t k = 0; k < _constrained.size(); ++k)
+          {
+            const std::size_t i = std::size_t(_constrained[k]);
+            _bits[i/bits] |= std::size_t(1) << (i%bits);
+          }
+        _ranks.reserve(_bits.size());
+        std::size_t rank = 0;
+        for (std::size_t w = 0; w < _bits.size(); ++w)
+          {
+            _ranks.push_back(rank);
+            rank += popcount(_bits[w]);
+          }
+        _valid = true;
+      }
+
+      //! \brief whether the compressed representation matches the maps
+      /**
+       * False after every modification of the maps until compress() is
+       * called, see the class documentation.
+       */
+      bool compressed () const
+      {
+        return _valid;
+      }
+
+      //! \brief whether the index i is constrained
+      /**
+       * Takes constant time if the container is compressed.
+       */
+      bool isConstrained (const key_type& i) const
+      {
+        if (!_valid)
+          return BaseT::find(i) != BaseT::end();
+        const std::size_t k = std::size_t(i);
+        return k/bits < _bits.size() && (_bits[k/bits] & (std::size_t(1) << (k%bits)));
+      }
+
+      //! \name Compressed representation, only valid if compressed()
+      //! \{
+
+      //! position of i among the constrained indices or npos
+      std::size_t position (const key_type& i) const
+      {
+        const std::size_t k = std::size_t(i);
+        const std::size_t w = k/bits;
+        if (w >= _bits.size())
+          return npos;
+        const std::size_t mask = std::size_t(1) << (k%bits);
+        if (!(_bits[w] & mask))
+          return npos;
+        return _ranks[w] + popcount(_bits[w] & (mask-1));
+      }
+
+      //! the constrained indices in ascending order
+      const std::vector<S>& constrainedIndices () const
+      {
+        return _constrained;
+      }
+
+      //! number of entries in the row of the constrained index at position p
+      std::size_t rowSize (std::size_t p) const
+      {
+        return _offsets[p+1] - _offsets[p];
+      }
+
+      //! indices of the row at position p, an empty row marks a Dirichlet constraint
+      const S* rowIndices (std::size_t p) const
+      {
+        return _indices.empty() ? 0 : &_indices[0] + _offsets[p];
+      }
+
+      //! weights of the row at position p
+      const T* rowWeights (std::size_t p) const
+      {
+        return _weights.empty() ? 0 : &_weights[0] + _offsets[p];
+      }
+
+      //! \}
+
+      //! \name Modifying map interface
+      //! \{
+
+      mapped_type& operator[] (const key_type& i)
+      {
+        _valid = false;
+        return BaseT::operator[](i);
+      }
+
+      std::pair<iterator,bool> insert (const value_type& v)
+      {
+        _valid = false;
+        return BaseT::insert(v);
+      }
+
+      iterator insert (iterator hint, const value_type& v)
+      {
+        _valid = false;
+        return BaseT::insert(v).first;
+      }
+
+      template<typename InputIterator>
+      void insert (InputIterator first, InputIterator last)
+      {
+        _valid = false;
+        BaseT::insert(first,last);
+      }
+
+      void erase (iterator position)
+      {
+        _valid = false;
+        BaseT::erase(position->first);
+      }
+
+      size_type erase (const key_type& i)
+      {
+        _valid = false;
+        return BaseT::erase(i);
+      }
+
+      void erase (iterator first, iterator last)
+      {
+        _valid = false;
+        while (first != last)
+          BaseT::erase((first++)->first);
+      }
+
+      void clear ()
+      {
+        BaseT::clear();
+        compress();
+      }
+
+      void swap (ConstraintsTransformation& other)
+      {
+        BaseT::swap(other);
+        _constrained.swap(other._constrained);
+        _offsets.swap(other._offsets);
+        _indices.swap(other._indices);
+        _weights.swap(other._weights);
+        _bits.swap(other._bits);
+        _ranks.swap(other._ranks);
+        std::swap(_valid,other._valid);
+      }
+
+      //! \}
+
+      //! \name Read-only map interface
+      //! \{
+
+      const_iterator begin () const
+      {
+        return BaseT::begin();
+      }
+
+      const_iterator end () const
+      {
+        return BaseT::end();
+      }
+
+      const_reverse_iterator rbegin () const
+      {
+        return BaseT::rbegin();
+      }
+
+      const_reverse_iterator rend () const
+      {
+        return BaseT::rend();
+      }
+
+      const_iterator find (const key_type& i) const
+      {
+        return BaseT::find(i);
+      }
+
+      const_iterator lower_bound (const key_type& i) const
+      {
+        return BaseT::lower_bound(i);
+      }
+
+      const_iterator upper_bound (const key_type& i) const
+      {
+        return BaseT::upper_bound(i);
+      }
+
+      std::pair<const_iterator,const_iterator> equal_range (const key_type& i) const
+      {
+        return BaseT::equal_range(i);
+      }
+
+      //! \}
+
+    private:
+      //! number of bits in a word of the bitmap
+      static const std::size_t bits = std::numeric_limits<std::size_t>::digits;
+
+      static std::size_t popcount (std::size_t w)
+      {
+#ifdef __GNUC__
+        return __builtin_popcountll(w);
+#else
+        std::size_t n = 0;
+        for (; w; w &= w-1)
+          ++n;
+        return n;
+#endif
+      }
+
+      std::vector<S> _constrained;
+      std::vector<std::size_t> _offsets;
+      std::vector<S> _indices;
+      std::vector<T> _weights;
+      //! one bit per index, set for the constrained ones
+      std::vector<std::size_t> _bits;
+      //! number of constrained indices before each word of the bitmap
+      std::vector<std::size_t> _ranks;
+      bool _valid;
     };
 
+    template<typename S, typename T>
+    const std::size_t ConstraintsTransformation<S,T>::npos;
+
+    template<typename S, typename T>
+    const std::size_t ConstraintsTransformation<S,T>::bits;
+
     class EmptyTransformation : public ConstraintsTransformation<int,float>
     {
     };
@@ -0,0 +1,397 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef DUNE_PDELAB_QKSUMFACTORIZATION_HH
+#define DUNE_PDELAB_QKSUMFACTORIZATION_HH
+
+#include<cmath>
+#include<cstddef>
+#include<vector>
+
+#include<dune/common/fvector.hh>
+#include<dune/geometry/type.hh>
+#include<dune/geometry/quadraturerules.hh>
+
+#include<dune/pdelab/finiteelementmap/qkdg.hh>
+
+namespace Dune {
+  namespace PDELab {
+
+    //! \brief sum-factorized evaluation of Q_k bases at tensor-product Gauss points
+    /**
+     * The basis functions of QkLocalBasis are products of one-dimensional
+     * Lagrange polynomials, and the quadrature rules of cubes are tensor
+     * products of one-dimensional Gauss rules. Evaluating a finite element
+     * function at all quadrature points, or integrating against all basis
+     * functions, therefore factors into d successive contractions with
+     * the one-dimensional basis matrices. This costs O(k^(d+1)) per
+     * element instead of the O(k^(2d)) of the point-by-point evaluation.
+     *
+     * Volume points are numbered with the first direction running
+     * fastest, like the basis functions. Face points are numbered by the
+     * tangential directions of the face in increasing order, which agrees
+     * with the parameterization of the faces of the reference cube, see
+     * canonicalFace().
+     *
+     * All gradients are taken with respect to the reference element; the
+     * transformation to the real element is left to the caller.
+     *
+     * The intermediate tensors are kept in scratch buffers of the object,
+     * so after the first element no memory is allocated.  For the same
+     * reason an object must not be used by several threads at once.
+     *
+     * \tparam D Domain field type
+     * \tparam R Range field type
+     * \tparam k Polynomial degree
+     * \tparam d Dimension of the cube
+     */
+    template<class D, class R, int k, int d>
+    class QkSumFactorization
+    {
+    public:
+      enum { dim = d };
+      enum { degree = k };
+
+      typedef Dune::FieldVector<D,d> DomainType;
+      typedef Dune::FieldVector<R,d> GradientType;
+
+      //! \brief tabulate the one-dimensional basis for a Gauss rule exact up to intorder
+      explicit QkSumFactorization (int intorder)
+      {
+        const Dune::QuadratureRule<D,1>& rule =
+          Dune::QuadratureRules<D,1>::rule(Dune::GeometryType(Dune::GeometryType::cube,1),intorder);
+        nq = rule.size();
+        std::vector<D> x1d, w1d;
+        for (typename Dune::QuadratureRule<D,1>::const_iterator it = rule.begin(); it != rule.end(); ++it)
+          {
+            x1d.push_back(it->position()[0]);
+            w1d.push_back(it->weight());
+          }
+
+        // one-dimensional basis at the Gauss points and at both ends
+        values = Matrix(nq,k+1);
+        derivatives = Matrix(nq,k+1);
+        for (std::size_t q = 0; q < nq; ++q)
+          for (int i = 0; i <= k; ++i)
+            {
+              values(q,i) = QkStuff::p<D,R,k>(i,x1d[q]);
+              derivatives(q,i) = QkStuff::dp<D,R,k>(i,x1d[q]);
+            }
+        for (int c = 0; c < 2; ++c)
+          {
+            tracevalues[c] = Matrix(1,k+1);
+            tracederivatives[c] = Matrix(1,k+1);
+            for (int i = 0; i <= k; ++i)
+              {
+                tracevalues[c](0,i) = QkStuff::p<D,R,k>(i,D(c));
+                tracederivatives[c](0,i) = QkStuff::dp<D,R,k>(i,D(c));
+              }
+          }
+        transposedvalues = values.transposed();
+        transposedderivatives = derivatives.transposed();
+        for (int c = 0; c < 2; ++c)
+          {
+            transposedtracevalues[c] = tracevalues[c].transposed();
+            transposedtracederivatives[c] = tracederivatives[c].transposed();
+          }
+
+        // tensor-product points and weights
+        std::size_t n = 1;
+        for (int j = 0; j < d; ++j)
+          n *= nq;
+        positions.resize(n);
+        weights.resize(n);
+        for (std::size_t q = 0; q < n; ++q)
+          {
+            std::size_t index = q;
+            weights[q] = 1.0;
+            for (int j = 0; j < d; ++j)
+              {
+                positions[q][j] = x1d[index % nq];
+                weights[q] *= w1d[index % nq];
+                index /= nq;
+              }
+          }
+        facepositions.resize(n/nq);
+        faceweights.resize(n/nq);
+        for (std::size_t q = 0; q < n/nq; ++q)
+          {
+            std::size_t index = q;
+            faceweights[q] = 1.0;
+            for (int j = 0; j < d-1; ++j)
+              {
+                facepositions[q].push_back(x1d[index % nq]);
+                faceweights[q] *= w1d[index % nq];
+                index /= nq;
+              }
+          }
+      }
+
+      //! number of basis functions
+      std::size_t size () const
+      {
+        return QkStuff::QkSize<k,d>::value;
+      }
+
+      //! number of quadrature points in the element
+      std::size_t points () const
+      {
+        return weights.size();
+      }
+
+      //! number of quadrature points on a face
+      std::size_t facePoints () const
+      {
+        return faceweights.size();
+      }
+
+      //! position of volume point q in the reference element
+      const DomainType& position (std::size_t q) const
+      {
+        return positions[q];
+      }
+
+      //! weight of volume point q
+      D weight (std::size_t q) const
+      {
+        return weights[q];
+      }
+
+      //! position of point q of the given face in the reference element
+      DomainType facePosition (int face, std::size_t q) const
+      {
+        DomainType x;
+        for (int j = 0, t = 0; j < d; ++j)
+          x[j] = (j == face/2) ? D(face%2) : facepositions[q][t++];
+        return x;
+      }
+
+      //! weight of face point q, with respect to the reference face
+      D faceWeight (std::size_t q) const
+      {
+        return faceweights[q];
+      }
+
+      //! \brief evaluate function values and reference gradients at all volume points
+      void evaluate (const std::vector<R>& coefficients,
+                     std::vector<R>& u, std::vector<GradientType>& gradu) const
+      {
+        const Matrix* m[d];
+        const Matrix* dm[d];
+        for (int j = 0; j < d; ++j)
+          {
+            m[j] = &values;
+            dm[j] = &derivatives;
+          }
+        evaluate(m,dm,coefficients,u,gradu);
+      }
+
+      //! \brief integrate against all basis functions and their reference gradients
+      /**
+       * Computes r_i = sum_q ( f_q phi_i(x_q) + g_q * grad phi_i(x_q) ),
+       * so the quadrature weights have to be contained in f and g.
+       */
+      void integrate (const std::vector<R>& f, const std::vector<GradientType>& g,
+                      std::vector<R>& r) const
+      {
+        const Matrix* m[d];
+        const Matrix* dm[d];
+        for (int j = 0; j < d; ++j)
+          {
+            m[j] = &transposedvalues;
+            dm[j] = &transposedderivatives;
+          }
+        integrate(m,dm,f,g,r);
+      }
+
+      //! \brief evaluate function values and reference gradients at the points of a face
+      void evaluateFace (int face, const std::vector<R>& coefficients,
+                         std::vector<R>& u, std::vector<GradientType>& gradu) const
+      {
+        const Matrix* m[d];
+        const Matrix* dm[d];
+        for (int j = 0; j < d; ++j)
+          {
+            m[j] = &values;
+            dm[j] = &derivatives;
+          }
+        m[face/2] = &tracevalues[face%2];
+        dm[face/2] = &tracederivatives[face%2];
+        evaluate(m,dm,coefficients,u,gradu);
+      }
+
+      //! \brief integrate over a face against all basis functions and their reference gradients
+      void integrateFace (int face, const std::vector<R>& f, const std::vector<GradientType>& g,
+                          std::vector<R>& r) const
+      {
+        const Matrix* m[d];
+        const Matrix* dm[d];
+        for (int j = 0; j < d; ++j)
+          {
+            m[j] = &transposedvalues;
+            dm[j] = &transposedderivatives;
+          }
+        m[face/2] = &transposedtracevalues[face%2];
+        dm[face/2] = &transposedtracederivatives[face%2];
+        integrate(m,dm,f,g,r);
+      }
+
+      //! \brief check whether a face embedding is the one of the reference cube
+      /**
+       * \param face              The index of the face in the element.
+       * \param geometryInElement ig.geometryInInside() or ig.geometryInOutside().
+       *
+       * Returns false for faces of nonconforming intersections or for
+       * elements whose neighbors are rotated against each other; the face
+       * points of both sides then do not coincide.
+       */
+      template<typename FaceGeometry>
+      static bool canonicalFace (int face, const FaceGeometry& geometryInElement)
+      {
+        if (geometryInElement.corners() != (1<<(d-1)))
+          return false;
+        for (int c = 0; c < geometryInElement.corners(); ++c)
+          {
+            const DomainType corner = geometryInElement.corner(c);
+            for (int j = 0, t = 0; j < d; ++j)
+              {
+                const D expected = (j == face/2) ? D(face%2) : D((c>>(t++))&1);
+                if (std::abs(corner[j] - expected) > 1e-8)
+                  return false;
+              }
+          }
+        return true;
+      }
+
+    private:
+      //! dense row-major matrix of one-dimensional basis values
+      struct Matrix
+      {
+        Matrix () : rows(0), cols(0) {}
+        Matrix (std::size_t rows_, std::size_t cols_)
+          : rows(rows_), cols(cols_), entries(rows_*cols_,R(0))
+        {}
+
+        R& operator() (std::size_t i, std::size_t j) { return entries[i*cols+j]; }
+        const R& operator() (std::size_t i, std::size_t j) const { return entries[i*cols+j]; }
+
+        Matrix transposed () const
+        {
+          Matrix t(cols,rows);
+          for (std::size_t i = 0; i < rows; ++i)
+            for (std::size_t j = 0; j < cols; ++j)
+              t(j,i) = (*this)(i,j);
+          return t;
+        }
+
+        std::size_t rows, cols;
+        std::vector<R> entries;
+      };
+
+      void evaluate (const Matrix* const m[], const Matrix* const dm[], const std::vector<R>& coefficients,
+                     std::vector<R>& u, std::vector<GradientType>& gradu) const
+      {
+        apply(m,coefficients,u);
+        gradu.resize(u.size());
+        const Matrix* mj[d];
+        for (int j = 0; j < d; ++j)
+          {
+            for (int l = 0; l < d; ++l)
+              mj[l] = (l == j) ? dm[l] : m[l];
+            apply(mj,coefficients,component);
+            for (std::size_t q = 0; q < component.size(); ++q)
+              gradu[q][j] = component[q];
+          }
+      }
+
+      void integrate (const Matrix* const m[], const Matrix* const dm[], const std::vector<R>& f,
+                      const std::vector<GradientType>& g, std::vector<R>& r) const
+      {
+        apply(m,f,r);
+        const Matrix* mj[d];
+        component.resize(g.size());
+        for (int j = 0; j < d; ++j)
+          {
+            for (int l = 0; l < d; ++l)
+              mj[l] = (l == j) ? dm[l] : m[l];
+            for (std::size_t q = 0; q < g.size(); ++q)
+              component[q] = g[q][j];
+            apply(mj,component,contribution);
+            for (std::size_t i = 0; i < r.size(); ++i)
+              r[i] += contribution[i];
+          }
+      }
+
+      //! multiply with the tensor product of m[d-1],...,m[0]
+      void apply (const Matrix* const m[], const std::vector<R>& in, std::vector<R>& out) const
+      {
+        std::size_t extents[d];
+        for (int j = 0; j < d; ++j)
+          extents[j] = m[j]->cols;
+        const std::vector<R>* a = &in;
+        for (int j = 0; j < d; ++j)
+          {
+            std::vector<R>& b = (j == d-1) ? out : work[j%2];
+            contract(*m[j],j,extents,*a,b);
+            extents[j] = m[j]->rows;
+            a = &b;
+          }
+      }
+
+      //! apply m along direction dir of a tensor with the given extents
+      static void contract (const Matrix& m, int dir, const std::size_t* extents,
+                            const std::vector<R>& in, std::vector<R>& out)
+      {
+        std::size_t stride = 1, outer = 1;
+        for (int j = 0; j < dir; ++j)
+          stride *= extents[j];
+        for (int j = dir+1; j < d; ++j)
+          outer *= extents[j];
+        out.assign(outer*m.rows*stride,R(0));
+        for (std::size_t o = 0; o < outer; ++o)
+          for (std::size_t a = 0; a < m.rows; ++a)
+            {
+              R* y = &out[(o*m.rows+a)*stride];
+              for (std::size_t b = 0; b < m.cols; ++b)
+                {
+                  const R c = m(a,b);
+                  // the traces of the Lagrange basis are mostly zero
+                  if (c == R(0))
+                    continue;
+                  const R* x = &in[(o*m.cols+b)*stride];
+                  for (std::size_t s = 0; s < stride; ++s)
+                    y[s] += c*x[s];
+                }
+            }
+      }
+
+      std::size_t nq;
+      Matrix values, derivatives;
+      Matrix transposedvalues, transposedderivatives;
+      Matrix tracevalues[2], tracederivatives[2];
+      Matrix transposedtracevalues[2], transposedtracederivatives[2];
+      std::vector<DomainType> positions;
+      std::vector<D> weights;
+      std::vector<std::vector<D> > facepositions;
+      std::vector<D> faceweights;
+
+      // scratch buffers of evaluate(), integrate() and apply()
+      mutable std::vector<R> component, contribution;
+      mutable std::vector<R> work[2];
+    };
+
+    //! \brief select the sum factorization kernel for a local basis
+    /**
+     * Only specialized for bases with tensor-product structure.
+     */
+    template<class LocalBasis>
+    struct QkSumFactorizationSelector;
+
+    template<class D, class R, int k, int d>
+    struct QkSumFactorizationSelector<Dune::QkStuff::QkLocalBasis<D,R,k,d> >
+    {
+      typedef QkSumFactorization<D,R,k,d> Type;
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,283 @@
+// -*- tab-width: 4; indent-tabs-mode: nil -*-
+#ifndef DUNE_PDELAB_QUADRATUREBASISCACHE_HH
+#define DUNE_PDELAB_QUADRATUREBASISCACHE_HH
+
+#include<cmath>
+#include<cstddef>
+#include<deque>
+#include<vector>
+
+#include<dune/common/exceptions.hh>
+#include<dune/geometry/quadraturerules.hh>
+
+namespace Dune {
+  namespace PDELab {
+
+    //! \brief store values of basis functions and gradients for whole quadrature rules
+    /**
+     * In contrast to LocalBasisCache, the tabulated values are not looked
+     * up by position but by quadrature rule and point index: on the first
+     * request for a rule, the basis functions and their Jacobians are
+     * evaluated at all of its points and stored in two contiguous arrays.
+     * Later requests for the same rule return this table, so the
+     * quadrature loop only has to index into it.
+     *
+     * Rules are identified by their address, which is stable for the
+     * rules handed out by Dune::QuadratureRules. Face rules are tabulated
+     * at their embedding into the element, which is identified by the
+     * corners of the geometryInInside() or geometryInOutside() of the
+     * intersection, so each face and orientation gets a table of its own.
+     *
+     * Tabulation can be switched off with setEnabled(false). The basis is
+     * then evaluated anew on every request, which gives the uncached
+     * reference values, e.g. for comparisons in tests. In this mode a
+     * returned table stays valid until the second next request.
+     *
+     * \note Like LocalBasisCache, the cache is filled on demand from const
+     * methods and is therefore not safe for concurrent use.
+     */
+    template<class LocalBasisType>
+    class QuadratureBasisCache
+    {
+    public:
+      typedef typename LocalBasisType::Traits::DomainFieldType DomainFieldType;
+      typedef typename LocalBasisType::Traits::DomainType DomainType;
+      typedef typename LocalBasisType::Traits::RangeType RangeType;
+      typedef typename LocalBasisType::Traits::JacobianType JacobianType;
+
+      enum { dim = LocalBasisType::Traits::dimDomain };
+
+      typedef Dune::QuadratureRule<DomainFieldType,dim> VolumeRule;
+      typedef Dune::QuadratureRule<DomainFieldType,dim-1> FaceRule;
+
+      //! tabulated basis functions and Jacobians at all points of a rule
+      class Table
+      {
+        friend class QuadratureBasisCache;
+
+      public:
+        Table () : _points(0), _basis_size(0) {}
+
+        //! number of quadrature points
+        std::size_t size () const
+        {
+          return _points;
+        }
+
+        //! number of basis functions
+        std::size_t basisSize () const
+        {
+          return _basis_size;
+        }
+
+        //! values of all basis functions at quadrature point q
+        const RangeType* function (std::size_t q) const
+        {
+          return &_functions[q*_basis_size];
+        }
+
+        //! Jacobians of all basis functions at quadrature point q
+        const JacobianType* jacobian (std::size_t q) const
+        {
+          return &_jacobians[q*_basis_size];
+        }
+
+        //! values for all points, ordered by point and then by basis function
+        const std::vector<RangeType>& functions () const
+        {
+          return _functions;
+        }
+
+        //! Jacobians for all points, ordered by point and then by basis function
+        const std::vector<JacobianType>& jacobians () const
+        {
+          return _jacobians;
+        }
+
+      private:
+        void reset (std::size_t basis_size)
+        {
+          _points = 0;
+          _basis_size = basis_size;
+          _functions.clear();
+          _jacobians.clear();
+        }
+
+        void append (const DomainType& position, const LocalBasisType& localbasis,
+                     std::vector<RangeType>& values, std::vector<JacobianType>& jacobians)
+        {
+          localbasis.evaluateFunction(position,values);
+          localbasis.evaluateJacobian(position,jacobians);
+          _functions.insert(_functions.end(),values.begin(),values.end());
+          _jacobians.insert(_jacobians.end(),jacobians.begin(),jacobians.end());
+          ++_points;
+        }
+
+        std::size_t _points;
+        std::size_t _basis_size;
+        std::vector<RangeType> _functions;
+        std::vector<JacobianType> _jacobians;
+      };
+
+      //! \brief constructor
+      QuadratureBasisCache () : last(0), enabled(true), next(0) {}
+
+      //! \brief copy constructor, the lookup hint must not refer to the other cache
+      QuadratureBasisCache (const QuadratureBasisCache& other)
+        : entries(other.entries), last(0), enabled(other.enabled), next(0)
+      {}
+
+      QuadratureBasisCache& operator= (const QuadratureBasisCache& other)
+      {
+        entries = other.entries;
+        last = 0;
+        enabled = other.enabled;
+        return *this;
+      }
+
+      //! switch the tabulation on or off; switching it off drops all tables
+      void setEnabled (bool enabled_)
+      {
+        enabled = enabled_;
+        if (!enabled)
+          {
+            entries.clear();
+            last = 0;
+          }
+      }
+
+      //! whether tables are kept between requests
+      bool isEnabled () const
+      {
+        return enabled;
+      }
+
+      //! tabulate the basis at the points of a volume rule
+      const Table& tabulate (const VolumeRule& rule, const LocalBasisType& localbasis) const
+      {
+        if (!enabled)
+          {
+            Table& table = scratchTable(localbasis);
+            for (typename VolumeRule::const_iterator it = rule.begin(); it != rule.end(); ++it)
+              table.append(it->position(),localbasis,values,jacobians);
+            return table;
+          }
+
+        if (last && last->rule == &rule && last->corners.empty())
+          return last->table;
+
+        for (typename EntryContainer::iterator it = entries.begin(); it != entries.end(); ++it)
+          if (it->rule == &rule && it->corners.empty())
+            {
+              last = &(*it);
+              return it->table;
+            }
+
+        Entry& entry = insert(&rule,localbasis);
+        for (typename VolumeRule::const_iterator it = rule.begin(); it != rule.end(); ++it)
+          entry.table.append(it->position(),localbasis,values,jacobians);
+        return entry.table;
+      }
+
+      //! \brief tabulate the basis at the points of a face rule
+      /**
+       * \param rule              The quadrature rule on the reference face.
+       * \param geometryInElement The embedding of the face into the reference
+       *                          element, i.e. ig.geometryInInside() or
+       *                          ig.geometryInOutside().
+       * \param localbasis        The local basis of the element.
+       */
+      template<typename FaceGeometry>
+      const Table& tabulate (const FaceRule& rule, const FaceGeometry& geometryInElement,
+                             const LocalBasisType& localbasis) const
+      {
+        if (!enabled)
+          {
+            Table& table = scratchTable(localbasis);
+            for (typename FaceRule::const_iterator it = rule.begin(); it != rule.end(); ++it)
+              table.append(geometryInElement.global(it->position()),localbasis,values,jacobians);
+            return table;
+          }
+
+        if (last && last->rule == &rule && sameEmbedding(*last,geometryInElement))
+          return last->table;
+
+        for (typename EntryContainer::iterator it = entries.begin(); it != entries.end(); ++it)
+          if (it->rule == &rule && sameEmbedding(*it,geometryInElement))
+            {
+              last = &(*it);
+              return it->table;
+            }
+
+        Entry& entry = insert(&rule,localbasis);
+        for (int i = 0; i < geometryInElement.corners(); ++i)
+          entry.corners.push_back(geometryInElement.corner(i));
+        for (typename FaceRule::const_iterator it = rule.begin(); it != rule.end(); ++it)
+          entry.table.append(geometryInElement.global(it->position()),localbasis,values,jacobians);
+        return entry.table;
+      }
+
+      //! number of tables held by the cache
+      std::size_t size () const
+      {
+        return entries.size();
+      }
+
+    private:
+      struct Entry
+      {
+        const void* rule;
+        std::vector<DomainType> corners;
+        Table table;
+      };
+
+      // a deque does not invalidate references to its elements on growth
+      typedef std::deque<Entry> EntryContainer;
+
+      Entry& insert (const void* rule, const LocalBasisType& localbasis) const
+      {
+        entries.push_back(Entry());
+        Entry& entry = entries.back();
+        entry.rule = rule;
+        entry.table._basis_size = localbasis.size();
+        last = &entry;
+        return entry;
+      }
+
+      // skeleton terms hold the tables of both sides at the same time
+      Table& scratchTable (const LocalBasisType& localbasis) const
+      {
+        Table& table = scratch[next];
+        next = 1 - next;
+        table.reset(localbasis.size());
+        return table;
+      }
+
+      template<typename FaceGeometry>
+      static bool sameEmbedding (const Entry& entry, const FaceGeometry& geometryInElement)
+      {
+        if (int(entry.corners.size()) != geometryInElement.corners())
+          return false;
+        for (std::size_t i = 0; i < entry.corners.size(); ++i)
+          {
+            const DomainType corner = geometryInElement.corner(i);
+            for (int j = 0; j < dim; ++j)
+              if (std::abs(corner[j] - entry.corners[i][j]) > 1e-8)
+                return false;
+          }
+        return true;
+      }
+
+      mutable EntryContainer entries;
+      mutable Entry* last;
+      bool enabled;
+      mutable Table scratch[2];
+      mutable int next;
+      mutable std::vector<RangeType> values;
+      mutable std::vector<JacobianType> jacobians;
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,352 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_PDELAB_COMMUNICATIONPLAN_HH
+#define DUNE_PDELAB_COMMUNICATIONPLAN_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/typetraits.hh>
+#include <dune/grid/common/datahandleif.hh>
+#include <dune/grid/common/gridenums.hh>
+
+#include <dune/pdelab/gridfunctionspace/genericdatahandle.hh>
+
+namespace Dune {
+  namespace PDELab {
+
+#ifndef DOXYGEN
+    namespace CommunicationPlanImp {
+
+#if HAVE_MPI
+      // the MPI communicator of a collective communication, if it has one
+      inline bool communicator (const CollectiveCommunication<MPI_Comm>& cc, MPI_Comm& comm)
+      {
+        comm = cc;
+        return true;
+      }
+
+      template<class CC>
+      bool communicator (const CC& cc, MPI_Comm& comm)
+      {
+        return false;
+      }
+#endif
+
+      // message buffer on a contiguous range of values
+      template<class T>
+      class ContiguousBuffer
+      {
+      public:
+        explicit ContiguousBuffer (T* data_) : data(data_), pos(0) {}
+
+        void write (const T& t)
+        {
+          data[pos++] = t;
+        }
+
+        void read (T& t)
+        {
+          t = data[pos++];
+        }
+
+      private:
+        T* data;
+        std::size_t pos;
+      };
+
+    } // end namespace CommunicationPlanImp
+#endif // DOXYGEN
+
+    //! \brief precomputed exchange of the dofs of a grid function space over an interface
+    /**
+     * Equivalent to calling gridView().communicate() with a
+     * GenericDataHandle for the given interface and direction, but the
+     * global indices of the dofs to send to and receive from each
+     * neighbour are determined only once.  Every exchange then packs and
+     * unpacks contiguous buffers and sends them with nonblocking MPI, the
+     * entities are not visited again.
+     *
+     * The plan is set up by two communications over the grid, sending the
+     * rank of the process in both directions.  The entities shared with a
+     * neighbour are sorted by their global id, so both sides agree on the
+     * order of the dofs.  It is rebuilt whenever the update count of the
+     * grid function space changes.  Without MPI or for grids without an
+     * MPI communicator every exchange falls back to
+     * gridView().communicate(), as do vectors whose entries are not of
+     * type E.  The message buffers are kept between
+     * the exchanges and only resized by update().
+     *
+     * \tparam GFS The grid function space.
+     * \tparam E   The type of the vector entries to exchange.
+     */
+    template<class GFS, class E = double>
+    class CommunicationPlan
+    {
+      typedef typename GFS::Traits::GridViewType GV;
+      typedef typename GFS::Traits::BackendType B;
+      typedef typename GFS::Traits::SizeType SizeType;
+      typedef typename GV::Grid::GlobalIdSet IdSet;
+      typedef typename IdSet::IdType IdType;
+
+      // an entity shared with another process
+      struct Item
+      {
+        int rank;
+        int codim;
+        IdType id;
+        std::size_t begin;
+        std::size_t end;
+
+        bool operator< (const Item& other) const
+        {
+          if (rank != other.rank) return rank < other.rank;
+          if (codim != other.codim) return codim < other.codim;
+          return id < other.id;
+        }
+      };
+
+      // sends the rank and records the dofs of the entities it was received for
+      class RankDataHandle
+        : public Dune::CommDataHandleIF<RankDataHandle,int>
+      {
+      public:
+        RankDataHandle (const GFS& gfs_, std::vector<Item>& items_, std::vector<SizeType>& indices_)
+          : gfs(gfs_), idset(gfs_.gridView().grid().globalIdSet()),
+            rank(gfs_.gridView().comm().rank()), items(items_), indices(indices_)
+        {}
+
+        bool contains (int dim, int codim) const
+        {
+          return gfs.dataHandleContains(dim,codim);
+        }
+
+        bool fixedsize (int dim, int codim) const
+        {
+          return true;
+        }
+
+        template<class EntityType>
+        size_t size (EntityType& e) const
+        {
+          return 1;
+        }
+
+        template<class MessageBuffer, class EntityType>
+        void gather (MessageBuffer& buff, const EntityType& e) const
+        {
+          buff.write(rank);
+        }
+
+        template<class MessageBuffer, class EntityType>
+        void scatter (MessageBuffer& buff, const EntityType& e, size_t n)
+        {
+          Item item;
+          buff.read(item.rank);
+          gfs.dataHandleGlobalIndices(e,global);
+          if (global.empty())
+            return;
+          item.codim = EntityType::codimension;
+          item.id = idset.id(e);
+          item.begin = indices.size();
+          indices.insert(indices.end(),global.begin(),global.end());
+          item.end = indices.size();
+          items.push_back(item);
+        }
+
+      private:
+        const GFS& gfs;
+        const IdSet& idset;
+        int rank;
+        std::vector<Item>& items;
+        std::vector<SizeType>& indices;
+        std::vector<SizeType> global;
+      };
+
+      // the dofs exchanged with one process
+      struct Neighbour
+      {
+        int rank;
+        std::vector<SizeType> send;
+        std::vector<SizeType> recv;
+      };
+
+    public:
+
+      //! \brief Construct a plan, it is set up on first use
+      /**
+       * \param gfs_    The grid function space.
+       * \param iftype_ The interface to communicate over.
+       * \param dir_    The direction of the communication.
+       */
+      CommunicationPlan (const GFS& gfs_, InterfaceType iftype_, CommunicationDirection dir_)
+        : gfs(gfs_), iftype(iftype_), dir(dir_), valid(false), updates(0)
+      {}
+
+      //! \brief exchange the dofs of v, applying the gather and scatter methods of t
+      /**
+       * T has the same gather and scatter methods as the functors used with
+       * GenericDataHandle, e.g. AddGatherScatter or CopyGatherScatter, and
+       * must read and write exactly one value per dof.  Vectors whose
+       * entries are not of type E are exchanged by
+       * gridView().communicate().
+       */
+      template<class V, class T>
+      void communicate (V& v, T t) const
+      {
+        if (gfs.gridView().comm().size() <= 1)
+          return;
+        communicate(v,t,integral_constant<bool,is_same<typename V::ElementType,E>::value>());
+      }
+
+      //! \brief set up the plan for the current state of the grid function space
+      void update () const
+      {
+        std::vector<Item> recvItems, sendItems;
+        std::vector<SizeType> recvIndices, sendIndices;
+
+        // the processes we receive from send us their rank
+        RankDataHandle recvHandle(gfs,recvItems,recvIndices);
+        gfs.gridView().communicate(recvHandle,iftype,dir);
+
+        // the processes we send to do so in the opposite direction
+        RankDataHandle sendHandle(gfs,sendItems,sendIndices);
+        gfs.gridView().communicate(sendHandle,iftype,
+                                   dir == ForwardCommunication ? BackwardCommunication : ForwardCommunication);
+
+        std::sort(recvItems.begin(),recvItems.end());
+        std::sort(sendItems.begin(),sendItems.end());
+
+        neighbours.clear();
+        typename std::vector<Item>::const_iterator rit = recvItems.begin();
+        typename std::vector<Item>::const_iterator sit = sendItems.begin();
+        while (rit != recvItems.end() || sit != sendItems.end())
+          {
+            Neighbour neighbour;
+            neighbour.rank = std::min(rit != recvItems.end() ? rit->rank : sit->rank,
+                                      sit != sendItems.end() ? sit->rank : rit->rank);
+            for (; rit != recvItems.end() && rit->rank == neighbour.rank; ++rit)
+              neighbour.recv.insert(neighbour.recv.end(),
+                                    recvIndices.begin()+rit->begin,recvIndices.begin()+rit->end);
+            for (; sit != sendItems.end() && sit->rank == neighbour.rank; ++sit)
+              neighbour.send.insert(neighbour.send.end(),
+                                    sendIndices.begin()+sit->begin,sendIndices.begin()+sit->end);
+            neighbours.push_back(neighbour);
+          }
+
+        sendBuffers.resize(neighbours.size());
+        recvBuffers.resize(neighbours.size());
+        for (std::size_t k = 0; k < neighbours.size(); ++k)
+          {
+            sendBuffers[k].resize(neighbours[k].send.size());
+            recvBuffers[k].resize(neighbours[k].recv.size());
+          }
+#if HAVE_MPI
+        requests.reserve(2*neighbours.size());
+#endif
+
+        valid = true;
+        updates = gfs.updateCount();
+      }
+
+    private:
+
+      // the entries of the vector match the buffers of the plan
+      template<class V, class T>
+      void communicate (V& v, T& t, integral_constant<bool,true>) const
+      {
+#if HAVE_MPI
+        MPI_Comm comm;
+        if (CommunicationPlanImp::communicator(gfs.gridView().comm(),comm))
+          {
+            if (!valid || updates != gfs.updateCount())
+              update();
+            exchange(v,t,comm);
+            return;
+          }
+#endif
+        communicate(v,t,integral_constant<bool,false>());
+      }
+
+      // any other vector is exchanged over the grid
+      template<class V, class T>
+      void communicate (V& v, T& t, integral_constant<bool,false>) const
+      {
+        GenericDataHandle<GFS,V,T> handle(gfs,v,t);
+        gfs.gridView().communicate(handle,iftype,dir);
+      }
+
+#if HAVE_MPI
+      template<class V, class T>
+      void exchange (V& v, T& t, MPI_Comm comm) const
+      {
+        typedef CommunicationPlanImp::ContiguousBuffer<E> Buffer;
+        const int tag = 7331;
+
+        requests.clear();
+
+        for (std::size_t k = 0; k < neighbours.size(); ++k)
+          {
+            const Neighbour& neighbour = neighbours[k];
+            if (neighbour.recv.empty())
+              continue;
+            requests.push_back(MPI_Request());
+            MPI_Irecv(&recvBuffers[k][0],int(recvBuffers[k].size()*sizeof(E)),MPI_BYTE,
+                      neighbour.rank,tag,comm,&requests.back());
+          }
+
+        // gather all values before any of them is changed by a scatter
+        for (std::size_t k = 0; k < neighbours.size(); ++k)
+          {
+            const Neighbour& neighbour = neighbours[k];
+            if (neighbour.send.empty())
+              continue;
+            Buffer buff(&sendBuffers[k][0]);
+            for (std::size_t i = 0; i < neighbour.send.size(); ++i)
+              t.gather(buff,B::access(v,neighbour.send[i]));
+          }
+        for (std::size_t k = 0; k < neighbours.size(); ++k)
+          {
+            const Neighbour& neighbour = neighbours[k];
+            if (neighbour.send.empty())
+              continue;
+            requests.push_back(MPI_Request());
+            MPI_Isend(&sendBuffers[k][0],int(sendBuffers[k].size()*sizeof(E)),MPI_BYTE,
+                      neighbour.rank,tag,comm,&requests.back());
+          }
+
+        if (!requests.empty())
+          MPI_Waitall(int(requests.size()),&requests[0],MPI_STATUSES_IGNORE);
+
+        for (std::size_t k = 0; k < neighbours.size(); ++k)
+          {
+            const Neighbour& neighbour = neighbours[k];
+            if (neighbour.recv.empty())
+              continue;
+            Buffer buff(&recvBuffers[k][0]);
+            for (std::size_t i = 0; i < neighbour.recv.size(); ++i)
+              t.scatter(buff,B::access(v,neighbour.recv[i]));
+          }
+      }
+#endif
+
+      const GFS& gfs;
+      InterfaceType iftype;
+      CommunicationDirection dir;
+      mutable std::vector<Neighbour> neighbours;
+      mutable std::vector<std::vector<E> > sendBuffers;
+      mutable std::vector<std::vector<E> > recvBuffers;
+#if HAVE_MPI
+      mutable std::vector<MPI_Request> requests;
+#endif
+      mutable bool valid;
+      mutable std::size_t updates;
+    };
+
+  } // end namespace PDELab
+} // end namespace Dune
+
+#endif // DUNE_PDELAB_COMMUNICATIONPLAN_HH
@@ -0,0 +1,247 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_PDELAB_ELEMENTINDEXCACHE_HH
+#define DUNE_PDELAB_ELEMENTINDEXCACHE_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/stdstreams.hh>
+
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/type.hh>
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/localfunctions/common/interfaceswitch.hh>
+#include <dune/localfunctions/common/localkey.hh>
+
+namespace Dune {
+  namespace PDELab {
+
+    //! \addtogroup GridFunctionSpace
+    //! \ingroup PDELab
+    //! \{
+
+    //! Precomputed table of the global DOF indices of all grid cells
+    /**
+     * The table is stored in compressed row format: the indices of a
+     * cell occupy a contiguous slice of one large array. Binding a
+     * LocalFunctionSpace then reduces to copying that slice instead of
+     * evaluating the reference element, the index set and the offset
+     * maps of the grid function space for every local key.
+     *
+     * Alongside the global indices, the data required to construct the
+     * MultiIndex of every DOF (GeometryType and index of the associated
+     * subentity as well as the index within that subentity) is stored,
+     * unless the space has DOFs attached to intersections.
+     *
+     * The cache is owned by a leaf GridFunctionSpace, it is disabled by
+     * default and has to be rebuilt by GridFunctionSpace::update()
+     * whenever the grid or the space changes.
+     *
+     * \tparam GV The grid view.
+     * \tparam SizeType The type of the global indices.
+     */
+    template<typename GV, typename SizeType>
+    class ElementIndexCache
+    {
+
+      typedef typename GV::IndexSet IndexSet;
+      typedef typename IndexSet::IndexType IndexType;
+      typedef typename GV::Traits::template Codim<0>::Entity Element;
+      typedef typename GV::Traits::template Codim<0>::Iterator ElementIterator;
+
+    public:
+
+      ElementIndexCache()
+        : _enabled(false)
+        , _valid(false)
+        , _has_multi_indices(false)
+        , _index_set(0)
+      {}
+
+      //! Returns whether the cache is enabled.
+      bool enabled() const
+      {
+        return _enabled;
+      }
+
+      //! Enables or disables the cache, the change takes effect on the next call to update().
+      void setEnabled(bool enabled)
+      {
+        _enabled = enabled;
+        if (!enabled)
+          clear();
+      }
+
+      //! Returns whether the cache has been built and may be used for lookups.
+      bool valid() const
+      {
+        return _valid;
+      }
+
+      //! Returns whether the cache contains the data for the MultiIndices.
+      bool hasMultiIndices() const
+      {
+        return _valid && _has_multi_indices;
+      }
+
+      //! Releases all memory held by the cache.
+      void clear()
+      {
+        _valid = false;
+        _has_multi_indices = false;
+        std::vector<std::size_t>().swap(_cell_offsets);
+        std::vector<std::size_t>().swap(_offsets);
+        std::vector<SizeType>().swap(_indices);
+        std::vector<GeometryType>().swap(_entity_types);
+        std::vector<IndexType>().swap(_entity_indices);
+        std::vector<unsigned int>().swap(_key_indices);
+      }
+
+      //! Rebuilds the table for the given leaf grid function space.
+      /**
+       * The global indices are obtained from gfs.globalIndices(), so this
+       * method must be called after the grid function space has finished
+       * its own update and while the cache is still marked invalid.
+       */
+      template<typename GFS>
+      void update(const GFS& gfs)
+      {
+        clear();
+        if (!_enabled)
+          return;
+
+        typedef typename GFS::Traits::FiniteElementType FiniteElement;
+        typedef FiniteElementInterfaceSwitch<FiniteElement> FESwitch;
+        const int dim = GV::dimension;
+
+        const GV& gv = gfs.gridView();
+        const IndexSet& is = gv.indexSet();
+        _index_set = &is;
+
+        // consecutive numbering of the cells across geometry types, the
+        // offsets are indexed by the index of the GeometryType
+        const std::vector<GeometryType>& gts = is.geomTypes(0);
+        _cell_offsets.assign(LocalGeometryTypeIndex::size(dim),0);
+        std::size_t cells = 0;
+        for (std::size_t i = 0; i < gts.size(); ++i)
+          {
+            _cell_offsets[LocalGeometryTypeIndex::index(gts[i])] = cells;
+            cells += is.size(gts[i]);
+          }
+
+        // count the DOFs of each cell
+        _offsets.assign(cells+1,0);
+        _has_multi_indices = true;
+        for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+          {
+            const typename FESwitch::Coefficients& coeffs =
+              FESwitch::coefficients(gfs.finiteElementMap().find(*it));
+            _offsets[cellIndex(*it)+1] = coeffs.size();
+            for (std::size_t i = 0; i < std::size_t(coeffs.size()); ++i)
+              if (coeffs.localKey(i).codim() == Dune::LocalKey::intersectionCodim)
+                _has_multi_indices = false;
+          }
+        for (std::size_t i = 0; i < cells; ++i)
+          _offsets[i+1] += _offsets[i];
+
+        // fill the table
+        _indices.resize(_offsets.back());
+        if (_has_multi_indices)
+          {
+            _entity_types.resize(_offsets.back());
+            _entity_indices.resize(_offsets.back());
+            _key_indices.resize(_offsets.back());
+          }
+        for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+          {
+            const FiniteElement& fe = gfs.finiteElementMap().find(*it);
+            const std::size_t begin = _offsets[cellIndex(*it)];
+            const std::size_t end = _offsets[cellIndex(*it)+1];
+            gfs.globalIndices(fe,*it,_indices.begin()+begin,_indices.begin()+end);
+
+            if (!_has_multi_indices)
+              continue;
+
+            const typename FESwitch::Coefficients& coeffs = FESwitch::coefficients(fe);
+            const GenericReferenceElement<double,dim>& refEl =
+              GenericReferenceElements<double,dim>::general(it->type());
+            for (std::size_t i = 0; i < end-begin; ++i)
+              {
+                const LocalKey& key = coeffs.localKey(i);
+                _entity_types[begin+i] = refEl.type(key.subEntity(),key.codim());
+                _entity_indices[begin+i] = is.subIndex(*it,key.subEntity(),key.codim());
+                _key_indices[begin+i] = key.index();
+              }
+          }
+
+        _valid = true;
+
+        Dune::dinfo << "ElementIndexCache: stored " << _indices.size()
+                    << " indices for " << cells << " cells ("
+                    << memory() << " bytes)" << std::endl;
+      }
+
+      //! Copies the global indices of the given cell to the range [it,endit).
+      template<typename StorageIterator>
+      void globalIndices(const Element& e, StorageIterator it, StorageIterator endit) const
+      {
+        assert(_valid);
+        const std::size_t c = cellIndex(e);
+        assert(std::size_t(endit - it) == _offsets[c+1] - _offsets[c]);
+        std::copy(_indices.begin() + _offsets[c], _indices.begin() + _offsets[c+1], it);
+      }
+
+      //! Sets the MultiIndices of the given cell in the range [it,endit).
+      template<typename MultiIndexIterator>
+      void multiIndices(const Element& e, MultiIndexIterator it, MultiIndexIterator endit) const
+      {
+        assert(hasMultiIndices());
+        const std::size_t c = cellIndex(e);
+        for (std::size_t i = _offsets[c]; i < _offsets[c+1]; ++i, ++it)
+          {
+            assert(it != endit);
+            it->set(_entity_types[i],_entity_indices[i],_key_indices[i]);
+          }
+      }
+
+      //! Returns the number of bytes allocated by the cache.
+      std::size_t memory() const
+      {
+        return _offsets.capacity() * sizeof(std::size_t)
+          + _indices.capacity() * sizeof(SizeType)
+          + _entity_types.capacity() * sizeof(GeometryType)
+          + _entity_indices.capacity() * sizeof(IndexType)
+          + _key_indices.capacity() * sizeof(unsigned int);
+      }
+
+    private:
+
+      std::size_t cellIndex(const Element& e) const
+      {
+        return _cell_offsets[LocalGeometryTypeIndex::index(e.type())] + _index_set->index(e);
+      }
+
+      bool _enabled;
+      bool _valid;
+      bool _has_multi_indices;
+      const IndexSet* _index_set;
+
+      std::vector<std::size_t> _cell_offsets;
+      std::vector<std::size_t> _offsets;
+      std::vector<SizeType> _indices;
+      std::vector<GeometryType> _entity_types;
+      std::vector<IndexType> _entity_indices;
+      std::vector<unsigned int> _key_indices;
+    };
+
+    //! \} group GridFunctionSpace
+
+  } // namespace PDELab
+} // namespace Dune
+
+#endif // DUNE_PDELAB_ELEMENTINDEXCACHE_HH
@@ -27,9 +27,11 @@
 #include <dune/pdelab/gridfunctionspace/blockwiseordering.hh>
 #include <dune/pdelab/gridfunctionspace/compositegridfunctionspace.hh>
 #include <dune/pdelab/gridfunctionspace/dynamicblockwiseordering.hh>
+#include <dune/pdelab/gridfunctionspace/elementindexcache.hh>
 #include <dune/pdelab/gridfunctionspace/gridfunctionspaceutilities.hh>
 #include <dune/pdelab/gridfunctionspace/leafordering.hh>
 #include <dune/pdelab/gridfunctionspace/lexicographicordering.hh>
+#include <dune/pdelab/gridfunctionspace/localindexmap.hh>
 #include <dune/pdelab/gridfunctionspace/localfunctionspace.hh>
 #include <dune/pdelab/gridfunctionspace/powergridfunctionspace.hh>
 
@@ -328,9 +330,15 @@ namespace Dune {
 
       typedef LeafOrdering<GridFunctionSpace> Ordering;
 
+      //! Type of the precomputed element index table
+      typedef ElementIndexCache<GV,typename Traits::SizeType> ElementIndexCacheType;
+
+      //! Type of the resolved local keys of a finite element, see localIndexMap()
+      typedef typename LocalIndexMap<typename Traits::SizeType>::Type LocalIndexMapType;
+
       //! constructor
       GridFunctionSpace (const GV& gridview, const FEM& fem, const CE& ce_)
-        : defaultce(ce_), gv(gridview), pfem(stackobject_to_shared_ptr(fem)), ce(ce_)
+        : defaultce(ce_), gv(gridview), pfem(stackobject_to_shared_ptr(fem)), ce(ce_), updates(0)
       {
         orderingp = make_shared<Ordering>(*this);
         update();
@@ -338,7 +346,7 @@ namespace Dune {
 
       //! constructor
       GridFunctionSpace (const GV& gridview, const FEM& fem)
-        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), ce(defaultce)
+        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), ce(defaultce), updates(0)
       {
         orderingp = make_shared<Ordering>(*this);
         update();
@@ -346,7 +354,7 @@ namespace Dune {
 
       //! constructor
       GridFunctionSpace (const GV& gridview, shared_ptr<const FEM> fem, const CE& ce_)
-        : defaultce(ce_), gv(gridview), pfem(fem), ce(ce_)
+        : defaultce(ce_), gv(gridview), pfem(fem), ce(ce_), updates(0)
       {
         orderingp = make_shared<Ordering>(*this);
         update();
@@ -354,7 +362,7 @@ namespace Dune {
 
       //! constructor
       GridFunctionSpace (const GV& gridview, shared_ptr<const FEM> fem)
-        : gv(gridview), pfem(fem), ce(defaultce)
+        : gv(gridview), pfem(fem), ce(defaultce), updates(0)
       {
         orderingp = make_shared<Ordering>(*this);
         update();
@@ -426,6 +434,13 @@ namespace Dune {
       void globalIndices (const typename Traits::FiniteElementType& fe,
                           const Element& e, StorageIterator it, StorageIterator endit) const
       {
+        // use the precomputed index table if available
+        if (index_cache.valid())
+          {
+            index_cache.globalIndices(e,it,endit);
+            return;
+          }
+
         typedef FiniteElementInterfaceSwitch<
           typename Traits::FiniteElementType
           > FESwitch;
@@ -454,6 +469,44 @@ namespace Dune {
           }
       }
 
+      //! resolve the local keys of a finite element against the tables of this space
+      void localIndexMap (const typename Traits::FiniteElementType& fe, LocalIndexMapType& map) const
+      {
+        typedef FiniteElementInterfaceSwitch<
+          typename Traits::FiniteElementType
+          > FESwitch;
+        const typename FESwitch::Coefficients &coeffs =
+          FESwitch::coefficients(fe);
+        const Dune::GenericReferenceElement<double,GV::Grid::dimension>& refEl =
+          Dune::GenericReferenceElements<double,GV::Grid::dimension>::general(fe.type());
+
+        map.resize(coeffs.size());
+        for (std::size_t i=0; i<std::size_t(coeffs.size()); ++i)
+          {
+            const Dune::LocalKey& key = coeffs.localKey(i);
+            map[i].gt = refEl.type(key.subEntity(),key.codim());
+            map[i].codim = key.codim();
+            map[i].subentity = key.subEntity();
+            map[i].index = key.index();
+            map[i].base = gtoffset.find(map[i].gt)->second;
+            map[i].stride = 0;
+          }
+      }
+
+      //! compute global indices and MultiIndices for one element from a map computed by localIndexMap()
+      template<typename StorageIterator, typename MultiIndexIterator>
+      void localIndices (const LocalIndexMapType& map, const Element& e,
+                         StorageIterator it, MultiIndexIterator mit) const
+      {
+        for (std::size_t i=0; i<map.size(); ++i, ++it, ++mit)
+          {
+            const typename GV::IndexSet::IndexType index =
+              gv.indexSet().subIndex(e,map[i].subentity,map[i].codim);
+            (*it) = offset[map[i].base+index] + map[i].index;
+            mit->set(map[i].gt,index,map[i].index);
+          }
+      }
+
       //! Return the offset in the global indices for the given entity
       template< class Entity >
       typename Traits::SizeType entityOffset(const Entity &e) const
@@ -671,6 +724,43 @@ namespace Dune {
 
         // update ordering
         orderingp->update();
+
+        // rebuild the element index table if requested
+        index_cache.update(*this);
+
+        ++updates;
+      }
+
+      //! Enables or disables the precomputed element index table
+      /**
+       * When enabled, update() stores the global indices of all cells in a
+       * flat table, and binding a LocalFunctionSpace only copies a slice of
+       * that table. This trades memory (roughly one index per local DOF of
+       * every cell, plus the data for the MultiIndices) for much cheaper
+       * binds, which pays off if the same grid is assembled many times.
+       */
+      void setElementIndexCaching (bool enable)
+      {
+        index_cache.setEnabled(enable);
+        index_cache.update(*this);
+      }
+
+      //! Returns whether the precomputed element index table is enabled
+      bool elementIndexCaching () const
+      {
+        return index_cache.enabled();
+      }
+
+      //! Direct access to the precomputed element index table
+      const ElementIndexCacheType& elementIndexCache () const
+      {
+        return index_cache;
+      }
+
+      //! Number of calls to update(), allows clients to detect a changed space
+      std::size_t updateCount () const
+      {
+        return updates;
       }
 
       bool fixedSize() const
@@ -693,6 +783,9 @@ namespace Dune {
       std::set<unsigned int> codimUsed;
 
       Dune::shared_ptr<Ordering> orderingp;
+
+      ElementIndexCacheType index_cache;
+      std::size_t updates;
     };
 
     /** \brief Tag indicating a fixed number of unkowns per entity (known at compile time).
@@ -732,9 +825,15 @@ namespace Dune {
 
       typedef LeafOrdering<GridFunctionSpace> Ordering;
 
+      //! Type of the precomputed element index table
+      typedef ElementIndexCache<GV,typename Traits::SizeType> ElementIndexCacheType;
+
+      //! Type of the resolved local keys of a finite element, see localIndexMap()
+      typedef typename LocalIndexMap<typename Traits::SizeType>::Type LocalIndexMapType;
+
       // constructor
       GridFunctionSpace (const GV& gridview, const FEM& fem, const CE& ce_)
-        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), defaultce(ce_), ce(ce_)
+        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), defaultce(ce_), ce(ce_), updates(0)
       {
         orderingp = make_shared<Ordering>(*this);
         update();
@@ -742,7 +841,7 @@ namespace Dune {
 
       // constructor
       GridFunctionSpace (const GV& gridview, const FEM& fem)
-        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), ce(defaultce)
+        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), ce(defaultce), updates(0)
       {
         orderingp = make_shared<Ordering>(*this);
         update();
@@ -813,6 +912,13 @@ namespace Dune {
       void globalIndices (const typename Traits::FiniteElementType& fe,
                           const Element& e, StorageIterator it, StorageIterator endit) const
       {
+        // use the precomputed index table if available
+        if (index_cache.valid())
+          {
+            index_cache.globalIndices(e,it,endit);
+            return;
+          }
+
         // get local coefficients for this entity
         typedef FiniteElementInterfaceSwitch<
           typename Traits::FiniteElementType
@@ -841,6 +947,44 @@ namespace Dune {
           }
       }
 
+      //! resolve the local keys of a finite element against the tables of this space
+      void localIndexMap (const typename Traits::FiniteElementType& fe, LocalIndexMapType& map) const
+      {
+        typedef FiniteElementInterfaceSwitch<
+          typename Traits::FiniteElementType
+          > FESwitch;
+        const typename FESwitch::Coefficients &coeffs =
+          FESwitch::coefficients(fe);
+        const Dune::GenericReferenceElement<double,GV::Grid::dimension>& refEl =
+          Dune::GenericReferenceElements<double,GV::Grid::dimension>::general(fe.type());
+
+        map.resize(coeffs.size());
+        for (std::size_t i=0; i<std::size_t(coeffs.size()); ++i)
+          {
+            const Dune::LocalKey& key = coeffs.localKey(i);
+            map[i].gt = refEl.type(key.subEntity(),key.codim());
+            map[i].codim = key.codim();
+            map[i].subentity = key.subEntity();
+            map[i].index = key.index();
+            map[i].base = offset.find(map[i].gt)->second;
+            map[i].stride = dofcountmap.find(map[i].gt)->second;
+          }
+      }
+
+      //! compute global indices and MultiIndices for one element from a map computed by localIndexMap()
+      template<typename StorageIterator, typename MultiIndexIterator>
+      void localIndices (const LocalIndexMapType& map, const Element& e,
+                         StorageIterator it, MultiIndexIterator mit) const
+      {
+        for (std::size_t i=0; i<map.size(); ++i, ++it, ++mit)
+          {
+            const typename GV::IndexSet::IndexType index =
+              gv.indexSet().subIndex(e,map[i].subentity,map[i].codim);
+            (*it) = map[i].base + index*map[i].stride + map[i].index;
+            mit->set(map[i].gt,index,map[i].index);
+          }
+      }
+
       //------------------------------
       // generic data handle interface
       //------------------------------
@@ -989,6 +1133,43 @@ namespace Dune {
 
         // update ordering
         orderingp->update();
+
+        // rebuild the element index table if requested
+        index_cache.update(*this);
+
+        ++updates;
+      }
+
+      //! Enables or disables the precomputed element index table
+      /**
+       * When enabled, update() stores the global indices of all cells in a
+       * flat table, and binding a LocalFunctionSpace only copies a slice of
+       * that table. This trades memory (roughly one index per local DOF of
+       * every cell, plus the data for the MultiIndices) for much cheaper
+       * binds, which pays off if the same grid is assembled many times.
+       */
+      void setElementIndexCaching (bool enable)
+      {
+        index_cache.setEnabled(enable);
+        index_cache.update(*this);
+      }
+
+      //! Returns whether the precomputed element index table is enabled
+      bool elementIndexCaching () const
+      {
+        return index_cache.enabled();
+      }
+
+      //! Direct access to the precomputed element index table
+      const ElementIndexCacheType& elementIndexCache () const
+      {
+        return index_cache;
+      }
+
+      //! Number of calls to update(), allows clients to detect a changed space
+      std::size_t updateCount () const
+      {
+        return updates;
       }
 
       bool fixedSize() const
@@ -1011,6 +1192,9 @@ namespace Dune {
       std::set<unsigned int> codimUsed;
 
       Dune::shared_ptr<Ordering> orderingp;
+
+      ElementIndexCacheType index_cache;
+      std::size_t updates;
     };
 
     //! \addtogroup GridFunctionSpace
@@ -1101,31 +1285,37 @@ namespace Dune {
 
       typedef LeafOrdering<GridFunctionSpace> Ordering;
 
+      //! Type of the precomputed element index table
+      typedef ElementIndexCache<GV,typename Traits::SizeType> ElementIndexCacheType;
+
+      //! Type of the resolved local keys of a finite element, see localIndexMap()
+      typedef typename LocalIndexMap<typename Traits::SizeType>::Type LocalIndexMapType;
+
       // constructors
       GridFunctionSpace (const GV& gridview, const FEM& fem, const IIS& iis_,
                          const CE& ce_)
-        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), iis(iis_), defaultce(ce_), ce(ce_)
+        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), iis(iis_), defaultce(ce_), ce(ce_), updates(0)
       {
         orderingp = make_shared<Ordering>(*this);
         update();
       }
 
       GridFunctionSpace (const GV& gridview, const FEM& fem, const IIS& iis_)
-        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), iis(iis_), ce(defaultce)
+        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), iis(iis_), ce(defaultce), updates(0)
       {
         orderingp = make_shared<Ordering>(*this);
         update();
       }
 
       GridFunctionSpace (const GV& gridview, const FEM& fem, const CE& ce_)
-        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), iis(dummyiis), defaultce(ce_), ce(ce_)
+        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), iis(dummyiis), defaultce(ce_), ce(ce_), updates(0)
       {
         orderingp = make_shared<Ordering>(*this);
         update();
       }
 
       GridFunctionSpace (const GV& gridview, const FEM& fem)
-        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), iis(dummyiis), ce(defaultce)
+        : gv(gridview), pfem(stackobject_to_shared_ptr(fem)), iis(dummyiis), ce(defaultce), updates(0)
       {
         orderingp = make_shared<Ordering>(*this);
         update();
@@ -1196,6 +1386,13 @@ namespace Dune {
       void globalIndices (const typename Traits::FiniteElementType& fe,
                           const Element& e, StorageIterator it, StorageIterator endit) const
       {
+        // use the precomputed index table if available
+        if (index_cache.valid())
+          {
+            index_cache.globalIndices(e,it,endit);
+            return;
+          }
+
         typedef FiniteElementInterfaceSwitch<
           typename Traits::FiniteElementType
           > FESwitch;
@@ -1224,6 +1421,51 @@ namespace Dune {
           }
       }
 
+      //! resolve the local keys of a finite element against the tables of this space
+      void localIndexMap (const typename Traits::FiniteElementType& fe, LocalIndexMapType& map) const
+      {
+        typedef FiniteElementInterfaceSwitch<
+          typename Traits::FiniteElementType
+          > FESwitch;
+        const typename FESwitch::Coefficients &coeffs =
+          FESwitch::coefficients(fe);
+        const Dune::GenericReferenceElement<double,GV::Grid::dimension>& refEl =
+          Dune::GenericReferenceElements<double,GV::Grid::dimension>::general(fe.type());
+
+        map.resize(coeffs.size());
+        for (std::size_t i=0; i<std::size_t(coeffs.size()); ++i)
+          {
+            const Dune::LocalKey& key = coeffs.localKey(i);
+            // intersections do not have a GeometryType
+            if (key.codim() == Dune::LocalKey::intersectionCodim)
+              map[i].gt.makeNone(GV::dimension-1);
+            else
+              map[i].gt = refEl.type(key.subEntity(),key.codim());
+            map[i].codim = key.codim();
+            map[i].subentity = key.subEntity();
+            map[i].index = key.index();
+            map[i].base = offset.find(key.codim())->second;
+            map[i].stride = dofpercodim.find(key.codim())->second;
+          }
+      }
+
+      //! compute global indices and MultiIndices for one element from a map computed by localIndexMap()
+      template<typename StorageIterator, typename MultiIndexIterator>
+      void localIndices (const LocalIndexMapType& map, const Element& e,
+                         StorageIterator it, MultiIndexIterator mit) const
+      {
+        for (std::size_t i=0; i<map.size(); ++i, ++it, ++mit)
+          {
+            typename GV::IndexSet::IndexType index;
+            if (map[i].codim == Dune::LocalKey::intersectionCodim)
+              index = iis.subIndex(e,map[i].subentity);
+            else
+              index = gv.indexSet().subIndex(e,map[i].subentity,map[i].codim);
+            (*it) = map[i].base + index*map[i].stride + map[i].index;
+            mit->set(map[i].gt,index,map[i].index);
+          }
+      }
+
       //------------------------------
       // generic data handle interface
       //------------------------------
@@ -1370,6 +1612,43 @@ namespace Dune {
 
         // update ordering
         orderingp->update();
+
+        // rebuild the element index table if requested
+        index_cache.update(*this);
+
+        ++updates;
+      }
+
+      //! Enables or disables the precomputed element index table
+      /**
+       * When enabled, update() stores the global indices of all cells in a
+       * flat table, and binding a LocalFunctionSpace only copies a slice of
+       * that table. This trades memory (roughly one index per local DOF of
+       * every cell, plus the data for the MultiIndices) for much cheaper
+       * binds, which pays off if the same grid is assembled many times.
+       */
+      void setElementIndexCaching (bool enable)
+      {
+        index_cache.setEnabled(enable);
+        index_cache.update(*this);
+      }
+
+      //! Returns whether the precomputed element index table is enabled
+      bool elementIndexCaching () const
+      {
+        return index_cache.enabled();
+      }
+
+      //! Direct access to the precomputed element index table
+      const ElementIndexCacheType& elementIndexCache () const
+      {
+        return index_cache;
+      }
+
+      //! Number of calls to update(), allows clients to detect a changed space
+      std::size_t updateCount () const
+      {
+        return updates;
       }
 
       bool fixedSize() const
@@ -1397,6 +1676,9 @@ namespace Dune {
       std::map<unsigned int,typename Traits::SizeType> offset;
 
       Dune::shared_ptr<Ordering> orderingp;
+
+      ElementIndexCacheType index_cache;
+      std::size_t updates;
     };
 
 
@@ -1476,6 +1758,12 @@ namespace Dune {
         return pgfs->globalSize();
       }
 
+      //! number of updates of the root space
+      std::size_t updateCount () const
+      {
+        return pgfs->updateCount();
+      }
+
       //! get dimension of this finite element space
       typename Traits::SizeType size () const
       {
@@ -1506,6 +1794,11 @@ namespace Dune {
         return pcgfs->subMap(i,j);
       }
 
+      bool fixedSize() const
+      {
+        return pcgfs->fixedSize();
+      }
+
     private:
       shared_ptr<GFS const> pgfs;
       shared_ptr<CGFS const> pcgfs;
@@ -1560,6 +1853,12 @@ namespace Dune {
         return pgfs->globalSize();
       }
 
+      //! number of updates of the root space
+      std::size_t updateCount () const
+      {
+        return pgfs->updateCount();
+      }
+
       //! get dimension of this finite element space
       typename Traits::SizeType size () const
       {
@@ -1663,6 +1962,12 @@ namespace Dune {
         return pgfs->globalSize();
       }
 
+      //! number of updates of the root space
+      std::size_t updateCount () const
+      {
+        return pgfs->updateCount();
+      }
+
       //! get dimension of this finite element space
       typename Traits::SizeType size () const
       {
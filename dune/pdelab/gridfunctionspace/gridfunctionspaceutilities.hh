@@ -10,6 +10,8 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/static_assert.hh>
 
+#include <dune/geometry/type.hh>
+
 #include <dune/localfunctions/common/interfaceswitch.hh>
 
 #include"../common/function.hh"
@@ -29,6 +31,56 @@ namespace Dune {
     // output: convert grid function space to discrete grid function
     //===============================================================
 
+    //! Remembers the cell a LocalFunctionSpace has been bound to last
+    /**
+     * Discrete grid functions are usually evaluated at several points of
+     * the same cell in a row, e.g. by the VTKWriter at all corners of a cell.
+     * bind() skips binding the local function space again as long as the cell
+     * and the grid function space stay the same.  A cell is identified by its
+     * GeometryType and its index in the grid view of the space, a changed
+     * space by its updateCount().
+     *
+     * \tparam GFS Type of GridFunctionSpace
+     */
+    template<typename GFS>
+    class LocalFunctionSpaceBinding
+    {
+      typedef typename GFS::Traits::GridViewType::IndexSet::IndexType Index;
+
+    public:
+      LocalFunctionSpaceBinding (const GFS& gfs)
+        : pgfs(&gfs), valid(false), index(0), updates(0)
+      {}
+
+      //! Bind lfs to e unless it is still bound to e, returns whether it was bound anew
+      template<typename LFS, typename E>
+      bool bind (LFS& lfs, const E& e)
+      {
+        const Index i = pgfs->gridView().indexSet().index(e);
+        if (valid && i == index && e.type() == type && pgfs->updateCount() == updates)
+          return false;
+        lfs.bind(e);
+        valid = true;
+        index = i;
+        type = e.type();
+        updates = pgfs->updateCount();
+        return true;
+      }
+
+      //! Forget the cell, the next call to bind() always binds
+      void invalidate ()
+      {
+        valid = false;
+      }
+
+    private:
+      const GFS* pgfs;
+      bool valid;
+      Index index;
+      GeometryType type;
+      std::size_t updates;
+    };
+
 
     /** \brief convert a grid function space and a coefficient vector into a
      *         grid function
@@ -103,7 +155,7 @@ namespace Dune {
       DiscreteGridFunction (const GFS& gfs, const X& x_)
         : pgfs(stackobject_to_shared_ptr(gfs)),
           pxg(stackobject_to_shared_ptr(x_)),
-          lfs(pgfs), xl(pgfs->maxLocalSize()), yb(pgfs->maxLocalSize())
+          lfs(pgfs), binding(*pgfs), xl(pgfs->maxLocalSize()), yb(pgfs->maxLocalSize())
       {
       }
 
@@ -115,7 +167,7 @@ namespace Dune {
       DiscreteGridFunction (shared_ptr<const GFS> gfs, shared_ptr<const X> x_)
         : pgfs(gfs),
           pxg(x_),
-          lfs(pgfs), xl(pgfs->maxLocalSize()), yb(pgfs->maxLocalSize())
+          lfs(pgfs), binding(*pgfs), xl(pgfs->maxLocalSize()), yb(pgfs->maxLocalSize())
       {
       }
 
@@ -124,15 +176,29 @@ namespace Dune {
                             const typename Traits::DomainType& x,
                             typename Traits::RangeType& y) const
       {
-        typedef FiniteElementInterfaceSwitch<
-          typename Dune::PDELab::LocalFunctionSpace<GFS>::Traits::FiniteElementType
-          > FESwitch;
-        lfs.bind(e);
+        binding.bind(lfs,e);
         lfs.vread(*pxg,xl);
-        FESwitch::basis(lfs.finiteElement()).evaluateFunction(x,yb);
-        y = 0;
-        for (unsigned int i=0; i<yb.size(); i++)
-          y.axpy(xl[i],yb[i]);
+        evaluateBound(x,y);
+      }
+
+      //! Evaluate at several points of the same cell
+      /**
+       * The local function space is bound and the coefficients are read
+       * only once for all points.
+       *
+       * \param e The cell.
+       * \param x The positions in the reference element of e.
+       * \param y The values at the positions, resized to the size of x.
+       */
+      void evaluateAll (const typename Traits::ElementType& e,
+                        const std::vector<typename Traits::DomainType>& x,
+                        std::vector<typename Traits::RangeType>& y) const
+      {
+        binding.bind(lfs,e);
+        lfs.vread(*pxg,xl);
+        y.resize(x.size());
+        for (std::size_t k=0; k<x.size(); k++)
+          evaluateBound(x[k],y[k]);
       }
 
       //! get a reference to the GridView
@@ -142,9 +208,23 @@ namespace Dune {
       }
 
     private:
+      // evaluate with lfs bound to the cell and its coefficients in xl
+      void evaluateBound (const typename Traits::DomainType& x,
+                          typename Traits::RangeType& y) const
+      {
+        typedef FiniteElementInterfaceSwitch<
+          typename Dune::PDELab::LocalFunctionSpace<GFS>::Traits::FiniteElementType
+          > FESwitch;
+        FESwitch::basis(lfs.finiteElement()).evaluateFunction(x,yb);
+        y = 0;
+        for (unsigned int i=0; i<yb.size(); i++)
+          y.axpy(xl[i],yb[i]);
+      }
+
       shared_ptr<const GFS> pgfs;
       shared_ptr<const X> pxg;
       mutable LocalFunctionSpace<GFS> lfs;
+      mutable LocalFunctionSpaceBinding<GFS> binding;
       mutable std::vector<typename Traits::RangeFieldType> xl;
       mutable std::vector<typename Traits::RangeType> yb;
     };
@@ -191,6 +271,25 @@ namespace Dune {
       shared_ptr<const GFS> pgfs;
       shared_ptr<const X> pxg;
       mutable LocalFunctionSpace<GFS> lfs;
+      mutable LocalFunctionSpaceBinding<GFS> binding;
+      mutable std::vector<typename Traits::RangeFieldType> xl;
+      mutable std::vector<Jacobian> jacobian;
+
+      // evaluate with lfs bound to the cell and its coefficients in xl
+      void evaluateBound (const typename Traits::DomainType& x,
+                          typename Traits::RangeType& y) const
+      {
+        static const J2C& j2C = J2C();
+
+        lfs.finiteElement().basis().evaluateJacobian(x,jacobian);
+
+        y = 0;
+        typename Traits::RangeType yb;
+        for (std::size_t i=0; i < lfs.size(); i++) {
+          j2C(jacobian[i], yb);
+          y.axpy(xl[i], yb);
+        }
+      }
 
     public:
       /** \brief Construct a DiscreteGridFunctionCurl
@@ -201,7 +300,7 @@ namespace Dune {
       DiscreteGridFunctionCurl(const GFS& gfs_, const X& xg_) :
         pgfs(stackobject_to_shared_ptr(gfs_)),
         pxg(stackobject_to_shared_ptr(xg_)),
-        lfs(pgfs)
+        lfs(pgfs), binding(*pgfs)
       { }
 
       // Evaluate
@@ -209,20 +308,26 @@ namespace Dune {
                      const typename Traits::DomainType& x,
                      typename Traits::RangeType& y) const
       {
-        static const J2C& j2C = J2C();
-
-        lfs.bind(e);
-        std::vector<typename Traits::RangeFieldType> xl(lfs.size());
+        binding.bind(lfs,e);
+        xl.resize(lfs.size());
         lfs.vread(*pxg,xl);
-        std::vector<Jacobian> jacobian(lfs.size());
-        lfs.finiteElement().basis().evaluateJacobian(x,jacobian);
+        evaluateBound(x,y);
+      }
 
-        y = 0;
-        typename Traits::RangeType yb;
-        for (std::size_t i=0; i < lfs.size(); i++) {
-          j2C(jacobian[i], yb);
-          y.axpy(xl[i], yb);
-        }
+      //! Evaluate at several points of the same cell
+      /**
+       * \copydetails DiscreteGridFunction::evaluateAll
+       */
+      void evaluateAll (const typename Traits::ElementType& e,
+                        const std::vector<typename Traits::DomainType>& x,
+                        std::vector<typename Traits::RangeType>& y) const
+      {
+        binding.bind(lfs,e);
+        xl.resize(lfs.size());
+        lfs.vread(*pxg,xl);
+        y.resize(x.size());
+        for (std::size_t k=0; k<x.size(); k++)
+          evaluateBound(x[k],y[k]);
       }
 
       //! get a reference to the GridView
@@ -351,7 +456,7 @@ namespace Dune {
       DiscreteGridFunctionGlobalCurl (const GFS& gfs, const X& x_)
         : pgfs(stackobject_to_shared_ptr(gfs)),
           pxg(stackobject_to_shared_ptr(x_)),
-          lfs(gfs), xl(pgfs->maxLocalSize()), J(pgfs->maxLocalSize())
+          lfs(gfs), binding(gfs), xl(pgfs->maxLocalSize()), J(pgfs->maxLocalSize())
       {
       }
 
@@ -360,8 +465,38 @@ namespace Dune {
                             const typename Traits::DomainType& x,
                             typename Traits::RangeType& y) const
       {
-        lfs.bind(e);
+        binding.bind(lfs,e);
         lfs.vread(*pxg,xl);
+        evaluateBound(e,x,y);
+      }
+
+      //! Evaluate at several points of the same cell
+      /**
+       * \copydetails DiscreteGridFunction::evaluateAll
+       */
+      void evaluateAll (const typename Traits::ElementType& e,
+                        const std::vector<typename Traits::DomainType>& x,
+                        std::vector<typename Traits::RangeType>& y) const
+      {
+        binding.bind(lfs,e);
+        lfs.vread(*pxg,xl);
+        y.resize(x.size());
+        for (std::size_t k=0; k<x.size(); k++)
+          evaluateBound(e,x[k],y[k]);
+      }
+
+      //! get a reference to the GridView
+      inline const typename Traits::GridViewType& getGridView () const
+      {
+        return pgfs->gridView();
+      }
+
+    private:
+      // evaluate with lfs bound to e and its coefficients in xl
+      void evaluateBound (const typename Traits::ElementType& e,
+                          const typename Traits::DomainType& x,
+                          typename Traits::RangeType& y) const
+      {
         lfs.finiteElement().localBasis().
           evaluateJacobianGlobal(x,J,e.geometry());
         y = 0;
@@ -388,16 +523,10 @@ namespace Dune {
           }
       }
 
-      //! get a reference to the GridView
-      inline const typename Traits::GridViewType& getGridView () const
-      {
-        return pgfs->gridView();
-      }
-
-    private:
       shared_ptr<const GFS> pgfs;
       shared_ptr<const X> pxg;
       mutable LocalFunctionSpace<GFS> lfs;
+      mutable LocalFunctionSpaceBinding<GFS> binding;
       mutable std::vector<typename Traits::RangeFieldType> xl;
       mutable std::vector<typename T::Traits::FiniteElementType::Traits::LocalBasisType::Traits::JacobianType> J;
     };
@@ -455,7 +584,7 @@ namespace Dune {
       DiscreteGridFunctionGradient (const GFS& gfs, const X& x_)
         : pgfs(stackobject_to_shared_ptr(gfs)),
           pxg(stackobject_to_shared_ptr(x_)),
-          lfs(pgfs)
+          lfs(pgfs), binding(*pgfs)
       { }
 
       // Evaluate
@@ -464,18 +593,48 @@ namespace Dune {
                             typename Traits::RangeType& y) const
       {
         // get and bind local functions space
-        lfs.bind(e);
+        binding.bind(lfs,e);
 
         // get local coefficients
-        std::vector<typename Traits::RangeFieldType> xl(lfs.size());
+        xl.resize(lfs.size());
         lfs.vread(*pxg,xl);
 
+        evaluateBound(e,x,y);
+      }
+
+      //! Evaluate at several points of the same cell
+      /**
+       * \copydetails DiscreteGridFunction::evaluateAll
+       */
+      void evaluateAll (const typename Traits::ElementType& e,
+                        const std::vector<typename Traits::DomainType>& x,
+                        std::vector<typename Traits::RangeType>& y) const
+      {
+        binding.bind(lfs,e);
+        xl.resize(lfs.size());
+        lfs.vread(*pxg,xl);
+        y.resize(x.size());
+        for (std::size_t k=0; k<x.size(); k++)
+          evaluateBound(e,x[k],y[k]);
+      }
+
+      //! get a reference to the GridView
+      inline const typename Traits::GridViewType& getGridView () const
+      {
+        return pgfs->gridView();
+      }
+
+    private:
+      // evaluate with lfs bound to e and its coefficients in xl
+      void evaluateBound (const typename Traits::ElementType& e,
+                          const typename Traits::DomainType& x,
+                          typename Traits::RangeType& y) const
+      {
         // get Jacobian of geometry
         const typename Traits::ElementType::Geometry::Jacobian&
           JgeoIT = e.geometry().jacobianInverseTransposed(x);
 
         // get local Jacobians/gradients of the shape functions
-        std::vector<typename LBTraits::JacobianType> J(lfs.size());
         lfs.finiteElement().localBasis().evaluateJacobian(x,J);
 
         typename Traits::RangeType gradphi;
@@ -490,16 +649,12 @@ namespace Dune {
         }
       }
 
-      //! get a reference to the GridView
-      inline const typename Traits::GridViewType& getGridView () const
-      {
-        return pgfs->gridView();
-      }
-
-    private:
       shared_ptr<const GFS> pgfs;
       shared_ptr<const X> pxg;
       mutable LocalFunctionSpace<GFS> lfs;
+      mutable LocalFunctionSpaceBinding<GFS> binding;
+      mutable std::vector<typename Traits::RangeFieldType> xl;
+      mutable std::vector<typename LBTraits::JacobianType> J;
     };
 
     /** \brief DiscreteGridFunction with Piola transformation
@@ -540,7 +695,7 @@ namespace Dune {
       DiscreteGridFunctionPiola (const GFS& gfs, const X& x_)
         : pgfs(stackobject_to_shared_ptr(gfs)),
           pxg(stackobject_to_shared_ptr(x_)),
-          lfs(pgfs), xl(pgfs->maxLocalSize()), yb(pgfs->maxLocalSize())
+          lfs(pgfs), binding(*pgfs), xl(pgfs->maxLocalSize()), yb(pgfs->maxLocalSize())
       {
       }
 
@@ -548,9 +703,39 @@ namespace Dune {
                             const typename Traits::DomainType& x,
                             typename Traits::RangeType& y) const
       {
-        // evaluate shape function on the reference element as before
-        lfs.bind(e);
+        binding.bind(lfs,e);
+        lfs.vread(*pxg,xl);
+        evaluateBound(e,x,y);
+      }
+
+      //! Evaluate at several points of the same cell
+      /**
+       * \copydetails DiscreteGridFunction::evaluateAll
+       */
+      void evaluateAll (const typename Traits::ElementType& e,
+                        const std::vector<typename Traits::DomainType>& x,
+                        std::vector<typename Traits::RangeType>& y) const
+      {
+        binding.bind(lfs,e);
         lfs.vread(*pxg,xl);
+        y.resize(x.size());
+        for (std::size_t k=0; k<x.size(); k++)
+          evaluateBound(e,x[k],y[k]);
+      }
+
+      //! get a reference to the GridView
+      inline const typename Traits::GridViewType& getGridView () const
+      {
+        return pgfs->gridView();
+      }
+
+    private:
+      // evaluate with lfs bound to e and its coefficients in xl
+      void evaluateBound (const typename Traits::ElementType& e,
+                          const typename Traits::DomainType& x,
+                          typename Traits::RangeType& y) const
+      {
+        // evaluate shape function on the reference element as before
         lfs.finiteElement().localBasis().evaluateFunction(x,yb);
         typename Traits::RangeType yhat;
         yhat = 0;
@@ -566,16 +751,10 @@ namespace Dune {
         y /= J.determinant();
       }
 
-      //! get a reference to the GridView
-      inline const typename Traits::GridViewType& getGridView () const
-      {
-        return pgfs->gridView();
-      }
-
-    private:
       shared_ptr<const GFS> pgfs;
       shared_ptr<const X> pxg;
       mutable LocalFunctionSpace<GFS> lfs;
+      mutable LocalFunctionSpaceBinding<GFS> binding;
       mutable std::vector<typename Traits::RangeFieldType> xl;
       mutable std::vector<typename Traits::RangeType> yb;
     };
@@ -643,7 +822,7 @@ namespace Dune {
                                  std::size_t start = 0)
         : pgfs(stackobject_to_shared_ptr(gfs)),
           pxg(stackobject_to_shared_ptr(x_)),
-          lfs(pgfs), xl(pgfs->maxLocalSize()), yb(pgfs->maxLocalSize())
+          lfs(pgfs), binding(*pgfs), xl(pgfs->maxLocalSize()), yb(pgfs->maxLocalSize())
       {
         for(std::size_t i = 0; i < dimR; ++i)
           remap[i] = i + start;
@@ -666,7 +845,7 @@ namespace Dune {
                                  const Remap &remap_)
         : pgfs(stackobject_to_shared_ptr(gfs)),
           pxg(stackobject_to_shared_ptr(x_)),
-          lfs(pgfs), xl(pgfs->maxLocalSize()), yb(pgfs->maxLocalSize())
+          lfs(pgfs), binding(*pgfs), xl(pgfs->maxLocalSize()), yb(pgfs->maxLocalSize())
       {
         for(std::size_t i = 0; i < dimR; ++i)
           remap[i] = remap_[i];
@@ -676,8 +855,37 @@ namespace Dune {
                             const typename Traits::DomainType& x,
                             typename Traits::RangeType& y) const
       {
-        lfs.bind(e);
+        binding.bind(lfs,e);
+        lfs.vread(*pxg,xl);
+        evaluateBound(x,y);
+      }
+
+      //! Evaluate at several points of the same cell
+      /**
+       * \copydetails DiscreteGridFunction::evaluateAll
+       */
+      void evaluateAll (const typename Traits::ElementType& e,
+                        const std::vector<typename Traits::DomainType>& x,
+                        std::vector<typename Traits::RangeType>& y) const
+      {
+        binding.bind(lfs,e);
         lfs.vread(*pxg,xl);
+        y.resize(x.size());
+        for (std::size_t k=0; k<x.size(); k++)
+          evaluateBound(x[k],y[k]);
+      }
+
+      //! get a reference to the GridView
+      inline const typename Traits::GridViewType& getGridView () const
+      {
+        return pgfs->gridView();
+      }
+
+    private:
+      // evaluate with lfs bound to the cell and its coefficients in xl
+      void evaluateBound (const typename Traits::DomainType& x,
+                          typename Traits::RangeType& y) const
+      {
         for (unsigned int k=0; k < dimR; k++)
           {
             lfs.child(remap[k]).finiteElement().localBasis().
@@ -688,17 +896,11 @@ namespace Dune {
           }
       }
 
-      //! get a reference to the GridView
-      inline const typename Traits::GridViewType& getGridView () const
-      {
-        return pgfs->gridView();
-      }
-
-    private:
       shared_ptr<const GFS> pgfs;
       shared_ptr<const X> pxg;
       std::size_t remap[dimR];
       mutable LocalFunctionSpace<GFS> lfs;
+      mutable LocalFunctionSpaceBinding<GFS> binding;
       mutable std::vector<RF> xl;
       mutable std::vector<RT> yb;
     };
@@ -3,17 +3,21 @@
 #ifndef DUNE_PDELAB_LOCALFUNCTIONSPACE_HH
 #define DUNE_PDELAB_LOCALFUNCTIONSPACE_HH
 
+#include<limits>
 #include<vector>
 
 #include <dune/common/stdstreams.hh>
 
 #include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/typeindex.hh>
 
 #include <dune/localfunctions/common/interfaceswitch.hh>
 #include <dune/localfunctions/common/localkey.hh>
 
 #include <dune/pdelab/common/typetree.hh>
 #include <dune/pdelab/common/multiindex.hh>
+#include <dune/pdelab/finiteelementmap/finiteelementmap.hh>
+#include <dune/pdelab/gridfunctionspace/localindexmap.hh>
 #include <dune/pdelab/gridfunctionspace/tags.hh>
 #include <dune/pdelab/gridfunctionspace/localvector.hh>
 
@@ -89,6 +93,7 @@ namespace Dune {
         {
           node.offset = offset;
           node.n = 0;
+          node.layout_valid.clear();
         }
 
         ClearSizeVisitor(std::size_t offset_)
@@ -171,6 +176,78 @@ namespace Dune {
         const Entity& e;
       };
 
+
+      // Records the sizes and offsets of a freshly bound tree for the
+      // GeometryType with the given index, together with the local index
+      // maps of the leaves.
+      template<typename = int>
+      struct StoreLayoutVisitor
+        : public TypeTree::TreeVisitor
+        , public TypeTree::DynamicTraversal
+      {
+
+        template<typename Node, typename TreePath>
+        void pre(Node& node, TreePath treePath)
+        {
+          if (node.layout_n.size() <= gti)
+            {
+              node.layout_n.resize(gti+1);
+              node.layout_offset.resize(gti+1);
+            }
+          node.layout_n[gti] = node.n;
+          node.layout_offset[gti] = node.offset;
+        }
+
+        template<typename Node, typename TreePath>
+        void leaf(Node& node, TreePath treePath)
+        {
+          pre(node,treePath);
+          node.storeLocalIndexMap(node.gridFunctionSpace(),gti);
+        }
+
+        StoreLayoutVisitor(std::size_t gti_)
+          : gti(gti_)
+        {}
+
+        const std::size_t gti;
+      };
+
+
+      // Binds a tree whose sizes and offsets have been recorded by the
+      // StoreLayoutVisitor for the GeometryType of the entity, i.e. only the
+      // finite elements and the indices have to be updated.
+      template<typename Entity>
+      struct FixedLayoutBindVisitor
+        : public FillIndicesVisitor<Entity>
+      {
+
+        template<typename Node, typename TreePath>
+        void pre(Node& node, TreePath treePath)
+        {
+          node.n = node.layout_n[gti];
+          node.offset = node.layout_offset[gti];
+        }
+
+        template<typename Node, typename TreePath>
+        void leaf(Node& node, TreePath treePath)
+        {
+          pre(node,treePath);
+          // leaves with a local index map only evaluate the index set
+          if (node.mappedIndices(node.gridFunctionSpace(),this->e,gti))
+            return;
+          Node::FESwitch::setStore(node.pfe, node.pgfs->finiteElementMap().find(this->e));
+          assert(Node::FESwitch::basis(*node.pfe).size() == node.n);
+          FillIndicesVisitor<Entity>::leaf(node,treePath);
+        }
+
+        FixedLayoutBindVisitor(const Entity& entity, std::size_t gti_)
+          : FillIndicesVisitor<Entity>(entity)
+          , gti(gti_)
+        {}
+
+        const std::size_t gti;
+      };
+
     } // end empty namespace
 
     //=======================================
@@ -224,6 +301,12 @@ namespace Dune {
       template<typename>
       friend struct FillIndicesVisitor;
 
+      template<typename>
+      friend struct FixedLayoutBindVisitor;
+
+      template<typename>
+      friend struct StoreLayoutVisitor;
+
     public:
       typedef LocalFunctionSpaceBaseTraits<GFS,MultiIndex> Traits;
 
@@ -235,6 +318,8 @@ namespace Dune {
         , _multi_index_storage(gfs->maxLocalSize())
         , _multi_indices(&_multi_index_storage)
         , n(0)
+        , layout_updates(std::numeric_limits<std::size_t>::max())
+        , layout_fixed(false)
       {}
 
       //! \brief get current size
@@ -340,6 +425,17 @@ namespace Dune {
          classes have to add a method bind, which forward to this
          method.
 
+         If the GridFunctionSpace reports fixedSize(), the sizes and
+         offsets within the tree only depend on the GeometryType of the
+         element. They are then recorded for every GeometryType on the
+         first bind to an element of that type and reused until the
+         updateCount() of the space changes, so that only the finite
+         elements and indices are updated. Leaves whose finite element map
+         returns the same finite element for all elements additionally keep
+         their finite element and the local keys resolved by
+         localIndexMap() of their space, which reduces filling their
+         indices to evaluating the index set of the grid.
+
          \param node reference to the derived node, the address must be the same as this
          \param e entity to bind to
        */
@@ -359,6 +455,14 @@ namespace Dune {
       typename Traits::MultiIndexContainer* _multi_indices;
       typename Traits::IndexContainer::size_type n;
       typename Traits::IndexContainer::size_type offset;
+
+      // state of the fixed size fast path in bind(), the recorded sizes and
+      // offsets are indexed by the LocalGeometryTypeIndex of the element
+      std::size_t layout_updates;
+      bool layout_fixed;
+      std::vector<bool> layout_valid;
+      std::vector<typename Traits::IndexContainer::size_type> layout_n;
+      std::vector<typename Traits::IndexContainer::size_type> layout_offset;
     };
 
 
@@ -370,15 +474,44 @@ namespace Dune {
       typedef typename LocalFunctionSpaceBaseNode<GFS,MultiIndex>::Traits::Element Element;
       assert(&node == this);
 
-      // compute sizes
-      ComputeSizeVisitor<Element> csv(e);
-      TypeTree::applyToTree(node,csv);
+      // the recorded layouts are only valid for the state of the space they were computed for
+      if (layout_updates != pgfs->updateCount())
+        {
+          layout_updates = pgfs->updateCount();
+          layout_fixed = pgfs->fixedSize();
+          layout_valid.clear();
+        }
+
+      const std::size_t gti = LocalGeometryTypeIndex::index(e.type());
+      if (gti < layout_valid.size() && layout_valid[gti])
+        {
+          // sizes and offsets are known, just fill indices
+          FixedLayoutBindVisitor<Element> flbv(e,gti);
+          TypeTree::applyToTree(node,flbv);
+
+          global_storage.resize(node.n);
+        }
+      else
+        {
+          // compute sizes
+          ComputeSizeVisitor<Element> csv(e);
+          TypeTree::applyToTree(node,csv);
 
-      global_storage.resize(node.n);
+          global_storage.resize(node.n);
 
-      // initialize iterators and fill indices
-      FillIndicesVisitor<Element> fiv(e);
-      TypeTree::applyToTree(node,fiv);
+          // initialize iterators and fill indices
+          FillIndicesVisitor<Element> fiv(e);
+          TypeTree::applyToTree(node,fiv);
+
+          if (layout_fixed)
+            {
+              StoreLayoutVisitor<> slv(gti);
+              TypeTree::applyToTree(node,slv);
+              if (layout_valid.size() <= gti)
+                layout_valid.resize(gti+1,false);
+              layout_valid[gti] = true;
+            }
+        }
 
       // apply upMap
       for (typename Traits::IndexContainer::size_type i=0; i<n; ++i)
@@ -421,6 +554,12 @@ namespace Dune {
       template<typename>
       friend struct FillIndicesVisitor;
 
+      template<typename>
+      friend struct FixedLayoutBindVisitor;
+
+      template<typename>
+      friend struct StoreLayoutVisitor;
+
     public:
       typedef PowerCompositeLocalFunctionSpaceTraits<GFS,MultiIndex,PowerLocalFunctionSpaceNode> Traits;
 
@@ -502,6 +641,12 @@ namespace Dune {
       template<typename>
       friend struct FillIndicesVisitor;
 
+      template<typename>
+      friend struct FixedLayoutBindVisitor;
+
+      template<typename>
+      friend struct StoreLayoutVisitor;
+
     public:
       typedef PowerCompositeLocalFunctionSpaceTraits<GFS,MultiIndex,CompositeLocalFunctionSpaceNode> Traits;
 
@@ -616,6 +761,65 @@ namespace Dune {
     {};
 
 
+    // SFINAE switch that decides whether the GFS provides a precomputed element
+    // index table based on the presence of the nested type ElementIndexCacheType.
+
+    template<typename GFS, typename = void>
+    struct gfs_has_element_index_cache
+      : public integral_constant<bool,false>
+    {};
+
+    template<typename GFS>
+    struct gfs_has_element_index_cache<
+      GFS,
+      typename enable_if<
+        Dune::AlwaysTrue<
+          typename GFS::ElementIndexCacheType
+          >::value
+        >::type
+      >
+      : public integral_constant<bool,true>
+    {};
+
+
+    // Decides whether the finite element map returns the same finite element
+    // for every entity, i.e. whether it is derived from SimpleLocalFiniteElementMap.
+
+    template<typename FEM>
+    struct fem_is_simple
+    {
+    private:
+      template<typename Imp>
+      static char test(const SimpleLocalFiniteElementMap<Imp>*);
+      static long test(...);
+    public:
+      static const bool value = sizeof(test(static_cast<const FEM*>(0))) == sizeof(char);
+    };
+
+
+    // SFINAE switch that decides whether a leaf LocalFunctionSpace keeps the
+    // local keys of its finite element resolved by localIndexMap() of the GFS.
+    // This requires that the GFS provides the nested type LocalIndexMapType
+    // and that its finite element does not change between entities.
+
+    template<typename GFS, typename = void>
+    struct gfs_has_local_index_map
+      : public integral_constant<bool,false>
+    {};
+
+    template<typename GFS>
+    struct gfs_has_local_index_map<
+      GFS,
+      typename enable_if<
+        Dune::AlwaysTrue<
+          typename GFS::LocalIndexMapType
+          >::value
+        >::type
+      >
+      : public integral_constant<bool,fem_is_simple<typename GFS::Traits::FiniteElementMapType>::value>
+    {};
+
+
     //! traits for single component local function space
     template<typename GFS, typename MultiIndex, typename N>
     struct LeafLocalFunctionSpaceTraits : public PowerCompositeLocalFunctionSpaceTraits<GFS,MultiIndex,N>
@@ -652,6 +856,12 @@ namespace Dune {
       template<typename>
       friend struct FillIndicesVisitor;
 
+      template<typename>
+      friend struct FixedLayoutBindVisitor;
+
+      template<typename>
+      friend struct StoreLayoutVisitor;
+
     public:
       typedef LeafLocalFunctionSpaceTraits<GFS,MultiIndex,LeafLocalFunctionSpaceNode> Traits;
 
@@ -716,10 +926,65 @@ namespace Dune {
         DUNE_THROW(Dune::Exception,"This GridFunctionSpace does not support DOFs on intersections.");
       }
 
+      template<typename GFS2, typename Entity, typename MultiIndexIterator>
+      typename enable_if<gfs_has_element_index_cache<GFS2>::value,bool>::type
+      cachedMultiIndices(const GFS2& gfs, const Entity& e, MultiIndexIterator it, MultiIndexIterator endit) const
+      {
+        if (!gfs.elementIndexCache().hasMultiIndices())
+          return false;
+        gfs.elementIndexCache().multiIndices(e,it,endit);
+        return true;
+      }
+
+      template<typename GFS2, typename Entity, typename MultiIndexIterator>
+      typename enable_if<!gfs_has_element_index_cache<GFS2>::value,bool>::type
+      cachedMultiIndices(const GFS2& gfs, const Entity& e, MultiIndexIterator it, MultiIndexIterator endit) const
+      {
+        return false;
+      }
+
+      template<typename GFS2>
+      typename enable_if<gfs_has_local_index_map<GFS2>::value>::type
+      storeLocalIndexMap(const GFS2& gfs, std::size_t gti)
+      {
+        if (local_index_maps.size() <= gti)
+          local_index_maps.resize(gti+1);
+        gfs.localIndexMap(*pfe,local_index_maps[gti]);
+      }
+
+      template<typename GFS2>
+      typename enable_if<!gfs_has_local_index_map<GFS2>::value>::type
+      storeLocalIndexMap(const GFS2& gfs, std::size_t gti)
+      {}
+
+      // fills the indices from the map recorded by storeLocalIndexMap(), the
+      // finite element is the same for all entities and thus kept
+      template<typename GFS2, typename Entity>
+      typename enable_if<gfs_has_local_index_map<GFS2>::value,bool>::type
+      mappedIndices(const GFS2& gfs, const Entity& e, std::size_t gti)
+      {
+        assert(local_index_maps[gti].size() == this->n);
+        gfs.localIndices(local_index_maps[gti],e,
+                         this->global->begin()+this->offset,
+                         this->_multi_indices->begin()+this->offset);
+        return true;
+      }
+
+      template<typename GFS2, typename Entity>
+      typename enable_if<!gfs_has_local_index_map<GFS2>::value,bool>::type
+      mappedIndices(const GFS2& gfs, const Entity& e, std::size_t gti)
+      {
+        return false;
+      }
+
       //! Calculates the multiindices associated with the given entity.
       template<typename Entity, typename MultiIndexIterator>
       void multiIndices(const Entity& e, MultiIndexIterator it, MultiIndexIterator endit)
       {
+        // use the precomputed index table of the grid function space if available
+        if (cachedMultiIndices(this->gridFunctionSpace(),e,it,endit))
+          return;
+
         // get layout of entity
         const typename FESwitch::Coefficients &coeffs =
           FESwitch::coefficients(*pfe);
@@ -796,6 +1061,7 @@ namespace Dune {
 
     private:
       typename FESwitch::Store pfe;
+      std::vector<typename LocalIndexMap<typename Traits::SizeType>::Type> local_index_maps;
     };
 
     // Register LeafGFS -> LocalFunctionSpace transformation
@@ -847,6 +1113,12 @@ namespace Dune {
       template<typename>
       friend struct FillIndicesVisitor;
 
+      template<typename>
+      friend struct FixedLayoutBindVisitor;
+
+      template<typename>
+      friend struct StoreLayoutVisitor;
+
     public:
       typedef typename BaseT::Traits Traits;
 
@@ -901,6 +1173,12 @@ namespace Dune {
       template<typename>
       friend struct FillIndicesVisitor;
 
+      template<typename>
+      friend struct FixedLayoutBindVisitor;
+
+      template<typename>
+      friend struct StoreLayoutVisitor;
+
       // store a copy of the share_ptr to avoid deallocation
       shared_ptr<const GFS> dummy_pgfs;
       
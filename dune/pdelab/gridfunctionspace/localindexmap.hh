@@ -0,0 +1,57 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_PDELAB_LOCALINDEXMAP_HH
+#define DUNE_PDELAB_LOCALINDEXMAP_HH
+
+#include <vector>
+
+#include <dune/geometry/type.hh>
+
+namespace Dune {
+  namespace PDELab {
+
+    //! \addtogroup GridFunctionSpace
+    //! \ingroup PDELab
+    //! \{
+
+    //! A local key of a finite element, resolved against the tables of a leaf GridFunctionSpace
+    /**
+     * Computing a global index from a LocalKey involves a lookup of the
+     * reference element and of the offset maps of the space. Both only
+     * depend on the finite element, so a LocalFunctionSpace that binds to
+     * many cells with the same finite element computes them once with
+     * localIndexMap() and afterwards only evaluates the index set of the
+     * grid in localIndices().
+     *
+     * \tparam SizeType The type of the global indices.
+     */
+    template<typename SizeType>
+    struct LocalIndexMapEntry
+    {
+      //! GeometryType of the subentity, none for DOFs attached to intersections
+      GeometryType gt;
+      //! codimension of the subentity
+      unsigned int codim;
+      //! number of the subentity within the cell
+      unsigned int subentity;
+      //! index of the DOF within the subentity
+      unsigned int index;
+      //! position of the subentities of this type in the offset tables of the space
+      SizeType base;
+      //! number of DOFs per subentity, if the space stores it
+      SizeType stride;
+    };
+
+    //! The resolved local keys of all DOFs of a finite element
+    template<typename SizeType>
+    struct LocalIndexMap
+    {
+      typedef std::vector<LocalIndexMapEntry<SizeType> > Type;
+    };
+
+    //! \} group GridFunctionSpace
+
+  } // namespace PDELab
+} // namespace Dune
+
+#endif // DUNE_PDELAB_LOCALINDEXMAP_HH
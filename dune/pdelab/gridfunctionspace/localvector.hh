@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <functional>
 #include <dune/common/deprecated.hh>
+#include <dune/pdelab/common/alignedallocator.hh>
 #include <dune/pdelab/gridfunctionspace/localfunctionspacetags.hh>
 
 /** \file
@@ -64,6 +65,37 @@ namespace Dune {
      * \{
      */
 
+    //! Kernels for accumulating contiguous ranges into the local containers.
+    /**
+     * The loops over blocks of a fixed width have a trip count that is known at
+     * compile time, which allows the compiler to map them to SIMD instructions.
+     *
+     * \tparam width  The number of entries processed per block.
+     */
+    template<std::size_t width>
+    struct BlockAccumulation
+    {
+      //! y[k] += w * x[k] for 0 <= k < width
+      template<typename T, typename W, typename X>
+      static void block(T* y, const W& w, const X* x)
+      {
+        for (std::size_t k = 0; k < width; ++k)
+          y[k] += w * x[k];
+      }
+
+      //! y[k] += w * x[k] for 0 <= k < n, in blocks of width entries
+      template<typename T, typename W, typename X>
+      static void range(T* y, const W& w, const X* x, std::size_t n)
+      {
+        const std::size_t blocks = n - n % width;
+        std::size_t k = 0;
+        for (; k < blocks; k += width)
+          block(y + k,w,x + k);
+        for (; k < n; ++k)
+          y[k] += w * x[k];
+      }
+    };
+
     //! An accumulate-only view on a local vector that automatically takes into account an accumulation weight.
     template<typename C>
     class WeightedVectorAccumulationView
@@ -99,6 +131,9 @@ namespace Dune {
       //! The size_type of the underlying container.
       typedef typename Container::size_type size_type;
 
+      //! The number of entries processed at once by accumulateRange().
+      static const size_type simd_width = Container::simd_width;
+
       //! Returns a reference proxy to an entry of the underlying container.
       /**
        * \returns A proxy that wraps the entry in the underlying container and
@@ -158,6 +193,27 @@ namespace Dune {
         _container(lfs,n) += v;
       }
 
+      //! Applies the current weight to v[0],...,v[n-1] and adds the results to the DOFs first,...,first+n-1 of the lfs.
+      /**
+       * The DOFs of a LocalFunctionSpace are stored contiguously, so this is a single loop
+       * over simd_width entries at a time that the compiler can vectorize.
+       */
+      template<typename LFS>
+      void accumulateRange(const LFS& lfs, size_type first, size_type n, const value_type* v)
+      {
+        _modified = true;
+        if (n > 0)
+          BlockAccumulation<simd_width>::range(&_container(lfs,first),_weight,v,n);
+      }
+
+      //! Applies the current weight to v[0],...,v[width-1] and adds the results to the DOFs first,...,first+width-1 of the lfs.
+      template<std::size_t width, typename LFS>
+      void accumulateBlock(const LFS& lfs, size_type first, const value_type* v)
+      {
+        _modified = true;
+        BlockAccumulation<width>::block(&_container(lfs,first),_weight,v);
+      }
+
       //! Constructor
       WeightedVectorAccumulationView(C& container, weight_type weight)
         : _container(container)
@@ -223,7 +279,8 @@ namespace Dune {
     //! A container for storing data associated with the degrees of freedom of a LocalFunctionSpace.
     /**
      * This container acts as a wrapper around a std::vector-like container and supports accessing
-     * its entries indexed by pairs of (LocalFunctionSpace,DOF of LocalFunctionSpace). If requested
+     * its entries indexed by pairs of (LocalFunctionSpace,DOF of LocalFunctionSpace). The storage
+     * is aligned to DUNE_PDELAB_SIMD_ALIGNMENT bytes. If requested
      * by specifying a non-default LFSFlavorTag, the container will also assert that a LocalFunctionSpace
      * of the matching kind (trial or test space) is used to access its content.
      *
@@ -237,7 +294,7 @@ namespace Dune {
     public:
 
       //! The type of the underlying storage container.
-      typedef std::vector<T> BaseContainer;
+      typedef std::vector<T,AlignedAllocator<T> > BaseContainer;
 
       //! The value type of this container.
       typedef typename BaseContainer::value_type  value_type;
@@ -258,6 +315,9 @@ namespace Dune {
        */
       typedef W weight_type;
 
+      //! The number of entries that fit into one SIMD register.
+      static const size_type simd_width = SIMDWidth<T>::value;
+
       //! An accumulate-only view of this container that automatically applies a weight to all contributions.
       typedef WeightedVectorAccumulationView<LocalVector> WeightedAccumulationView;
 
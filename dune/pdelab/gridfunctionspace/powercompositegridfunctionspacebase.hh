@@ -198,6 +198,10 @@ namespace Dune {
       //! export traits class
       typedef PowerCompositeGridFunctionSpaceTraits<GV,B,Mapper,k> Traits;
 
+      PowerCompositeGridFunctionSpaceBase ()
+        : updates(0)
+      {}
+
       //! extract type for storing constraints
       template<typename E>
       struct ConstraintsContainer
@@ -209,7 +213,11 @@ namespace Dune {
       };
 
       //! assumes all children are up to date.
-      void shallowUpdate() { gfs().ordering().update(); }
+      void shallowUpdate()
+      {
+        gfs().ordering().update();
+        ++updates;
+      }
 
       //! recalculate sizes
       void update ()
@@ -217,7 +225,17 @@ namespace Dune {
         TypeTree::applyToTree(gfs(),UpdateVisitor());
       }
 
-      
+      //! Number of updates of this space, allows clients to detect a changed space
+      std::size_t updateCount () const
+      {
+        return updates;
+      }
+
+      //! true if the number of DOFs per entity only depends on its GeometryType in all children
+      bool fixedSize () const
+      {
+        return gfs().ordering().fixedSize();
+      }
 
       //! get dimension of root finite element space
       typename Traits::SizeType globalSize () const
@@ -299,6 +317,9 @@ namespace Dune {
         TypeTree::applyToTree(gfs(),visitor);
       }
 
+    private:
+      std::size_t updates;
+
     };
 
   }
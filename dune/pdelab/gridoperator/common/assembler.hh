@@ -57,6 +57,8 @@ namespace Dune {
       bool requireVEnrichedCoupling() const;
       bool requireUVVolumePostSkeleton() const;
       bool requireVVolumePostSkeleton() const;
+      bool requireUVVolumeBatch() const;
+      std::size_t volumeBatchSize() const;
       //! @}
 
       /**
@@ -240,6 +242,30 @@ namespace Dune {
       void loadCoefficientsLFSUCoupling(const LFSU_Coupling & lfsu_coupling);
       /** @} */
 
+      /**
+         @name Batched volume assembly
+
+         Only called if requireUVVolumeBatch() returns true and
+         batching is enabled on the assembler. The cells in the lanes
+         of a batch have the same GeometryType and stay bound to their
+         local function spaces until their remaining terms have been
+         assembled. After assembleUVVolumeBatch(), the assembler calls
+         onSelectLFSUVBatchLane() for each lane in turn, which must set
+         up the local coefficients and the local results of the engine
+         as onBindLFSV(), onBindLFSUV(), loadCoefficientsLFSUInside() and
+         assembleUVVolume() would have done. The remaining terms of the
+         cell are then assembled and scattered as usual.
+
+         @{
+       */
+      bool acceptVolumeBatchLane(const LFSU & lfsu, const LFSV & lfsv) const;
+      template<typename EG>
+      void onBindLFSUVBatch(std::size_t lane, const EG & eg, const LFSU & lfsu, const LFSV & lfsv);
+      void assembleUVVolumeBatch(std::size_t lanes);
+      template<typename EG>
+      void onSelectLFSUVBatchLane(std::size_t lane, const EG & eg, const LFSU & lfsu, const LFSV & lfsv);
+      /** @} */
+
 
       /**
          @name Assign the assembler target objects
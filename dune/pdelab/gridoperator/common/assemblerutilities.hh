@@ -140,6 +140,25 @@ namespace Dune{
       template<typename X>
       void forwardtransform(X & x, const bool postrestrict = false)
       {
+        const CV & cv = *pconstraintsv;
+        if (cv.compressed())
+          {
+            for (std::size_t p=0; p<cv.constrainedIndices().size(); ++p)
+              {
+                const SizeType contributor = cv.constrainedIndices()[p];
+                for (std::size_t k=0; k<cv.rowSize(p); ++k)
+                  {
+                    typename X::block_type block(x[contributor]);
+                    block *= cv.rowWeights(p)[k];
+                    x[cv.rowIndices(p)[k]] += block;
+                  }
+              }
+            if(postrestrict)
+              for (std::size_t p=0; p<cv.constrainedIndices().size(); ++p)
+                x[cv.constrainedIndices()[p]]=0.;
+            return;
+          }
+
         typedef typename CV::const_iterator global_col_iterator;
         for (global_col_iterator cit=pconstraintsv->begin(); cit!=pconstraintsv->end(); ++cit){
           typedef typename global_col_iterator::value_type::first_type GlobalIndex;
@@ -172,6 +191,24 @@ namespace Dune{
       template<typename X>
       void backtransform(X & x, const bool prerestrict = false)
       {
+        const CV & cv = *pconstraintsv;
+        if (cv.compressed())
+          {
+            for (std::size_t p=0; p<cv.constrainedIndices().size(); ++p)
+              {
+                const SizeType contributor = cv.constrainedIndices()[p];
+                if(prerestrict)
+                  x[contributor] = 0.;
+                for (std::size_t k=0; k<cv.rowSize(p); ++k)
+                  {
+                    typename X::block_type block(x[cv.rowIndices(p)[k]]);
+                    block *= cv.rowWeights(p)[k];
+                    x[contributor] += block;
+                  }
+              }
+            return;
+          }
+
         typedef typename CV::const_iterator global_col_iterator;
         for (global_col_iterator cit=pconstraintsv->begin(); cit!=pconstraintsv->end(); ++cit){
           typedef typename global_col_iterator::value_type::first_type GlobalIndex;
@@ -223,10 +260,22 @@ namespace Dune{
       template<typename LFSV, typename LFSU, typename T, typename GC>
       void eadd (const LFSV& lfsv, const LFSU& lfsu, const LocalMatrix<T>& localcontainer, GC& globalcontainer) const
       {
-        typename B::template Accessor<LFSV,LFSU,T> accessor(globalcontainer,lfsv,lfsu);
+        typename B::template AccessorScratch<T> scratch;
+        eadd(lfsv,lfsu,localcontainer,globalcontainer,scratch);
+      }
+
+      /** \brief write local stiffness matrix for entity, keeping the
+          storage of the matrix accessor in scratch */
+      template<typename LFSV, typename LFSU, typename T, typename GC, typename S>
+      void eadd (const LFSV& lfsv, const LFSU& lfsu, const LocalMatrix<T>& localcontainer, GC& globalcontainer,
+                 S& scratch) const
+      {
+        if (lfsu.size() == 0)
+          return;
+        typename B::template Accessor<LFSV,LFSU,T> accessor(globalcontainer,lfsv,lfsu,scratch);
+        // the rows of the local matrix are contiguous
         for (size_t i=0; i<lfsv.size(); i++)
-          for (size_t j=0; j<lfsu.size(); j++)
-            accessor.add(i,j,localcontainer(i,j));
+          accessor.addRow(i,&localcontainer.getEntry(i,0));
       }
 
 
@@ -242,6 +291,9 @@ namespace Dune{
 
         for (size_t j = 0; j < lfsu.size(); ++j)
           {
+            if (!cu.isConstrained(lfsu.globalIndex(j)))
+              continue;
+
             global_ucol_iterator cuit = cu.find(lfsu.globalIndex(j));
 
             // If this column is not constrained or the constraint is not of
@@ -270,6 +322,93 @@ namespace Dune{
           \boldsymbol{\tilde U}} \f$*/
       template<typename LFSV, typename LFSU, typename T, typename GC>
       void etadd (const LFSV& lfsv, const LFSU& lfsu, const LocalMatrix<T>& localcontainer, GC& globalcontainer) const
+      {
+        typename B::template AccessorScratch<T> scratch;
+        etadd(lfsv,lfsu,localcontainer,globalcontainer,scratch);
+      }
+
+      /** \brief Same as etadd() above, but the storage of the matrix
+          accessor is kept in scratch. The local assembler engines own
+          one scratch each and reuse it for all elements. */
+      template<typename LFSV, typename LFSU, typename T, typename GC, typename S>
+      void etadd (const LFSV& lfsv, const LFSU& lfsu, const LocalMatrix<T>& localcontainer, GC& globalcontainer,
+                  S& scratch) const
+      {
+        const CV & cv = *pconstraintsv;
+        const CU & cu = *pconstraintsu;
+        if (!cv.compressed() || !cu.compressed())
+          {
+            etadd_uncompressed(lfsv,lfsu,localcontainer,globalcontainer);
+            return;
+          }
+
+        if (lfsu.size() == 0)
+          return;
+
+        typename B::template Accessor<LFSV,LFSU,T> accessor(globalcontainer,lfsv,lfsu,scratch);
+
+        // the positions of the constraint rows are table lookups, npos
+        // for unconstrained dofs
+        bool constrained = false;
+        for (size_t i=0; i<lfsv.size() && !constrained; i++)
+          constrained = (cv.position(lfsv.globalIndex(i)) != CV::npos);
+        for (size_t j=0; j<lfsu.size() && !constrained; j++)
+          constrained = (cu.position(lfsu.globalIndex(j)) != CU::npos);
+
+        if (!constrained)
+          {
+            // scatter whole rows, which are contiguous in the local
+            // matrix; addRow() skips zero entries
+            for (size_t i=0; i<lfsv.size(); i++)
+              accessor.addRow(i,&localcontainer(lfsv,i,lfsu,0));
+            return;
+          }
+
+        for (size_t i=0; i<lfsv.size(); i++) {
+          const std::size_t pv = cv.position(lfsv.globalIndex(i));
+          // an unconstrained row is its own contribution, a Dirichlet row has none
+          const std::size_t nv = (pv == CV::npos) ? 1 : cv.rowSize(pv);
+
+          for (std::size_t k=0; k<nv; k++){
+            SizeType gi = lfsv.globalIndex(i);
+            T vf = 1;
+            if (pv != CV::npos){
+              gi = cv.rowIndices(pv)[k];
+              vf = cv.rowWeights(pv)[k];
+            }
+
+            for (size_t j=0; j<lfsu.size(); j++){
+              const std::size_t pu = cu.position(lfsu.globalIndex(j));
+
+              // unconstrained and Dirichlet columns keep their entry
+              if (pu == CU::npos || cu.rowSize(pu) == 0){
+                T t = localcontainer(lfsv,i,lfsu,j) * vf;
+                if (t != 0.0)                 // entry might not be present in the matrix
+                  {
+                    if (pv != CV::npos)
+                      accessor.addGlobal(gi,lfsu.globalIndex(j),t);
+                    else
+                      accessor.add(i,j,t);
+                  }
+                continue;
+              }
+
+              for (std::size_t l=0; l<cu.rowSize(pu); l++){
+                T t = localcontainer(lfsv,i,lfsu,j) * T(cu.rowWeights(pu)[l]) * vf;
+                if (t != 0.0)                 // entry might not be present in the matrix
+                  accessor.addGlobal(gi,SizeType(cu.rowIndices(pu)[l]),t);
+              }
+            }
+          }
+        }
+      }
+
+      /** \brief Add local matrix \f$m\f$ to global Jacobian \f$J\f$
+          and apply constraints transformation, looking up the constraints
+          in the maps. Used by etadd() if one of the constraints containers
+          is not compressed. */
+      template<typename LFSV, typename LFSU, typename T, typename GC>
+      void etadd_uncompressed (const LFSV& lfsv, const LFSU& lfsu, const LocalMatrix<T>& localcontainer, GC& globalcontainer) const
       {
 
         typename B::template Accessor<LFSV,LFSU,T> accessor(globalcontainer,lfsv,lfsu);
@@ -417,6 +556,11 @@ namespace Dune{
         typedef typename global_ucol_iterator::value_type::second_type global_urow_type;
         typedef typename global_urow_type::const_iterator global_urow_iterator;
 
+        if (!cv.isConstrained(gi) && !cu.isConstrained(gj)){
+          globalpattern.add_link(gi,gj);
+          return;
+        }
+
         global_vcol_iterator gvcit = cv.find(gi);
         global_ucol_iterator gucit = cu.find(gj);
 
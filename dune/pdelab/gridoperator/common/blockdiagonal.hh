@@ -0,0 +1,254 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef DUNE_PDELAB_BLOCKDIAGONAL_HH
+#define DUNE_PDELAB_BLOCKDIAGONAL_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/pdelab/gridfunctionspace/localfunctionspace.hh>
+
+namespace Dune{
+  namespace PDELab{
+
+    //! Dense diagonal blocks of an operator, one block per grid cell
+    /**
+     * Every degree of freedom is assigned to the first cell in which it
+     * occurs, and the DOFs assigned to a cell form its block. For DG
+     * spaces, these are exactly the element blocks; for continuous spaces
+     * the blocks form a non-overlapping partition of the DOFs.
+     *
+     * The entries of the blocks are filled through add(), which silently
+     * drops entries coupling two different blocks. After factorize(), the
+     * blocks are replaced by their LU decompositions and solve() applies
+     * the inverse of the block diagonal, i.e. one block Jacobi step.
+     *
+     * \tparam E The field type of the entries.
+     */
+    template<typename E>
+    class ElementBlockDiagonal
+    {
+    public:
+
+      typedef E ElementType;
+      typedef std::size_t size_type;
+
+      ElementBlockDiagonal()
+        : _updates(invalid()), _factorized(false)
+      {}
+
+      //! Assigns the DOFs of gfs to the blocks of the cells of its grid view.
+      template<typename GFS>
+      void update(const GFS& gfs)
+      {
+        typedef typename GFS::Traits::GridViewType GV;
+        typedef typename GV::Traits::template Codim<0>::Iterator ElementIterator;
+        typedef LocalFunctionSpace<GFS> LFS;
+
+        const size_type n = gfs.globalSize();
+        _block.assign(n,invalid());
+        _position.assign(n,0);
+        _offsets.assign(1,0);
+        _value_offsets.assign(1,0);
+        _indices.clear();
+
+        LFS lfs(gfs);
+        const GV& gv = gfs.gridView();
+        for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+          {
+            lfs.bind(*it);
+            const size_type b = _offsets.size() - 1;
+            size_type block_size = 0;
+            for (size_type i = 0; i < lfs.size(); ++i)
+              {
+                const size_type gi = lfs.globalIndex(i);
+                if (_block[gi] != invalid())
+                  continue;
+                _block[gi] = b;
+                _position[gi] = block_size++;
+                _indices.push_back(gi);
+              }
+            if (block_size == 0)
+              continue;
+            _offsets.push_back(_indices.size());
+            _value_offsets.push_back(_value_offsets.back() + block_size * block_size);
+          }
+
+        size_type max_block_size = 0;
+        for (size_type b = 0; b < blocks(); ++b)
+          max_block_size = std::max(max_block_size,_offsets[b+1] - _offsets[b]);
+
+        _values.assign(_value_offsets.back(),E(0));
+        _pivots.assign(_indices.size(),0);
+        _scratch.assign(max_block_size,E(0));
+        _updates = gfs.updateCount();
+        _factorized = false;
+      }
+
+      //! The update count of the space at the last call of update(), allows to detect outdated blocks.
+      size_type updateCount() const
+      {
+        return _updates;
+      }
+
+      //! Number of blocks.
+      size_type blocks() const
+      {
+        return _offsets.size() - 1;
+      }
+
+      //! Number of degrees of freedom covered by the blocks.
+      size_type size() const
+      {
+        return _block.size();
+      }
+
+      //! Number of bytes allocated for the block entries.
+      size_type memory() const
+      {
+        return _values.capacity() * sizeof(E);
+      }
+
+      //! Resets all entries to zero.
+      void clear()
+      {
+        std::fill(_values.begin(),_values.end(),E(0));
+        _factorized = false;
+      }
+
+      //! Adds v to the entry (gi,gj) if both DOFs belong to the same block.
+      void add(size_type gi, size_type gj, const E& v)
+      {
+        const size_type b = _block[gi];
+        if (b != _block[gj] || b == invalid())
+          return;
+        entry(b,_position[gi],_position[gj]) += v;
+      }
+
+      //! Replaces row gi by the corresponding row of the identity.
+      void setIdentityRow(size_type gi)
+      {
+        const size_type b = _block[gi];
+        if (b == invalid())
+          return;
+        const size_type n = _offsets[b+1] - _offsets[b];
+        for (size_type j = 0; j < n; ++j)
+          entry(b,_position[gi],j) = E(0);
+        entry(b,_position[gi],_position[gi]) = E(1);
+      }
+
+      //! Replaces every block by its LU decomposition with partial pivoting.
+      void factorize()
+      {
+        for (size_type b = 0; b < blocks(); ++b)
+          {
+            const size_type n = _offsets[b+1] - _offsets[b];
+            size_type* pivots = &_pivots[_offsets[b]];
+            for (size_type k = 0; k < n; ++k)
+              {
+                size_type p = k;
+                for (size_type i = k+1; i < n; ++i)
+                  if (std::abs(entry(b,i,k)) > std::abs(entry(b,p,k)))
+                    p = i;
+                pivots[k] = p;
+                if (entry(b,p,k) == E(0))
+                  DUNE_THROW(Dune::Exception,"ElementBlockDiagonal: singular block " << b);
+                if (p != k)
+                  for (size_type j = 0; j < n; ++j)
+                    std::swap(entry(b,k,j),entry(b,p,j));
+                for (size_type i = k+1; i < n; ++i)
+                  {
+                    const E l = (entry(b,i,k) /= entry(b,k,k));
+                    for (size_type j = k+1; j < n; ++j)
+                      entry(b,i,j) -= l * entry(b,k,j);
+                  }
+              }
+          }
+        _factorized = true;
+      }
+
+      //! Returns whether factorize() has been called since the last change of the entries.
+      bool factorized() const
+      {
+        return _factorized;
+      }
+
+      //! Computes v = D^{-1} d, with v and d accessed through the backend of the vector type.
+      template<typename X, typename Y>
+      void solve(X& v, const Y& d) const
+      {
+        typedef typename X::Backend BX;
+        typedef typename Y::Backend BY;
+        assert(_factorized);
+        if (_scratch.empty())
+          return;
+        E* z = &_scratch[0];
+        for (size_type b = 0; b < blocks(); ++b)
+          {
+            const size_type n = _offsets[b+1] - _offsets[b];
+            const size_type* indices = &_indices[_offsets[b]];
+            const size_type* pivots = &_pivots[_offsets[b]];
+            for (size_type i = 0; i < n; ++i)
+              z[i] = BY::access(d,indices[i]);
+            // apply the row permutation, then forward substitution
+            for (size_type k = 0; k < n; ++k)
+              std::swap(z[k],z[pivots[k]]);
+            for (size_type k = 0; k < n; ++k)
+              for (size_type i = k+1; i < n; ++i)
+                z[i] -= entry(b,i,k) * z[k];
+            // backward substitution
+            for (size_type k = n; k-- > 0; )
+              {
+                for (size_type j = k+1; j < n; ++j)
+                  z[k] -= entry(b,k,j) * z[j];
+                z[k] /= entry(b,k,k);
+              }
+            for (size_type i = 0; i < n; ++i)
+              BX::access(v,indices[i]) = z[i];
+          }
+      }
+
+    private:
+
+      static size_type invalid()
+      {
+        return std::numeric_limits<size_type>::max();
+      }
+
+      E& entry(size_type b, size_type i, size_type j)
+      {
+        return _values[_value_offsets[b] + i * (_offsets[b+1] - _offsets[b]) + j];
+      }
+
+      const E& entry(size_type b, size_type i, size_type j) const
+      {
+        return _values[_value_offsets[b] + i * (_offsets[b+1] - _offsets[b]) + j];
+      }
+
+      //! block of each DOF
+      std::vector<size_type> _block;
+      //! position of each DOF within its block
+      std::vector<size_type> _position;
+      //! global DOF indices of the blocks, in compressed row format
+      std::vector<size_type> _offsets;
+      std::vector<size_type> _indices;
+      //! dense row-major block entries
+      std::vector<size_type> _value_offsets;
+      std::vector<E> _values;
+      std::vector<size_type> _pivots;
+      //! one block of the right hand side in solve()
+      mutable std::vector<E> _scratch;
+      size_type _updates;
+      bool _factorized;
+    };
+
+  } // namespace PDELab
+} // namespace Dune
+
+#endif // DUNE_PDELAB_BLOCKDIAGONAL_HH
@@ -80,6 +80,19 @@ namespace Dune{
 
     };
 
+    //! Whether a grid operator can assemble residual and jacobian in one traversal
+    /**
+     * Grid operators which provide a method
+     * residual_and_jacobian(x,r,a) specialize this template with
+     * value true. Solvers use it to pick the fused assembly when it
+     * is available.
+     */
+    template<typename GO>
+    struct ProvidesResidualAndJacobian
+    {
+      static const bool value = false;
+    };
+
   } // namespace PDELab
 } // namespace Dune
 
@@ -4,6 +4,8 @@
 #ifndef DUNE_PDELAB_GRIDOPERATOR_COMMON_LOCALASSEMBLERENGINEBASE_HH
 #define DUNE_PDELAB_GRIDOPERATOR_COMMON_LOCALASSEMBLERENGINEBASE_HH
 
+#include <cstddef>
+
 namespace Dune {
   namespace PDELab {
 
@@ -96,6 +98,18 @@ namespace Dune {
           return false;
         }
 
+        //! Whether the engine assembles the volume terms of several cells at once
+        bool requireUVVolumeBatch() const
+        {
+          return false;
+        }
+
+        //! Maximum number of cells per volume batch
+        std::size_t volumeBatchSize() const
+        {
+          return 1;
+        }
+
         //! @}
 
         //! @name Callbacks for LocalFunctionSpace binding and unbinding events
@@ -257,6 +271,39 @@ namespace Dune {
 
         //! @}
 
+        //! @name Callbacks for batched volume assembly
+        //! @{
+
+        //! Whether the cell bound to lfsu and lfsv fits into the current batch
+        template<typename LFSU, typename LFSV>
+        bool acceptVolumeBatchLane(const LFSU& lfsu, const LFSV& lfsv) const
+        {
+          return true;
+        }
+
+        //! Put the cell into the given lane of the current batch
+        template<typename EG,
+                 typename LFSU, typename LFSV>
+        void onBindLFSUVBatch(std::size_t lane, const EG& eg,
+                              const LFSU& lfsu, const LFSV& lfsv)
+        {
+        }
+
+        //! Assemble the volume terms of the first lanes cells of the current batch
+        void assembleUVVolumeBatch(std::size_t lanes)
+        {
+        }
+
+        //! Make the cell in the given lane the current cell after the batch has been assembled
+        template<typename EG,
+                 typename LFSU, typename LFSV>
+        void onSelectLFSUVBatchLane(std::size_t lane, const EG& eg,
+                                    const LFSU& lfsu, const LFSV& lfsv)
+        {
+        }
+
+        //! @}
+
         //! @name Assembly methods
         //! @{
 
@@ -0,0 +1,217 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef DUNE_PDELAB_PATTERNCACHE_HH
+#define DUNE_PDELAB_PATTERNCACHE_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include <dune/common/shared_ptr.hh>
+
+namespace Dune{
+  namespace PDELab{
+
+    //! Bit mask describing which couplings a local operator adds to the sparsity pattern.
+    template<typename LOP>
+    struct PatternCouplingFlags
+    {
+      enum { value =
+             (LOP::doPatternVolume ? 1 : 0) |
+             (LOP::doPatternVolumePostSkeleton ? 2 : 0) |
+             (LOP::doPatternSkeleton ? 4 : 0) |
+             (LOP::doPatternBoundary ? 8 : 0) |
+             (LOP::doSkeletonTwoSided ? 16 : 0) };
+    };
+
+    //! Cache for the sparsity patterns of grid operators.
+    /**
+     * Grid operators which share the same trial and test spaces, the same
+     * constraints and whose local operators request the same couplings
+     * (see PatternCouplingFlags) produce the same sparsity pattern. If
+     * such operators are attached to a common cache via
+     * GridOperator::setPatternCache(), only the first matrix that is set
+     * up traverses the grid; later matrices are set up from the stored
+     * structure.
+     *
+     * The cache does not keep a copy of the pattern. It stores the
+     * sorted column indices of all rows in one array with an offset per
+     * row, i.e. the structure of the assembled matrix without duplicate
+     * links and without the overhead of one container per row.
+     *
+     * The key contains the update counts of the grid function spaces, so
+     * a pattern is not reused after the spaces have been updated, e.g.
+     * after grid adaptation. Inserting the new pattern drops the patterns
+     * stored for earlier states of the same spaces. The constraints are
+     * only identified by their address, so clear() has to be called
+     * whenever they have been recomputed.
+     *
+     * \note The key only contains the coupling flags of the local
+     * operators, so operators whose pattern methods deviate from the
+     * default implementations in pattern.hh should not share a cache.
+     *
+     * \tparam P The sparsity pattern type of the matrix backend, a
+     *           random access container of rows which can be constructed
+     *           from a range of column indices.
+     */
+    template<typename P>
+    class SparsityPatternCache
+    {
+    public:
+
+      typedef P Pattern;
+
+      //! Identifies the sparsity pattern of a grid operator.
+      struct Key
+      {
+        Key(const void* gfsu_, const void* gfsv_, const void* cu_, const void* cv_,
+            unsigned int flags_, std::size_t updates_u_, std::size_t updates_v_,
+            std::size_t size_u_, std::size_t size_v_)
+          : gfsu(gfsu_), gfsv(gfsv_), cu(cu_), cv(cv_), flags(flags_)
+          , updates_u(updates_u_), updates_v(updates_v_)
+          , size_u(size_u_), size_v(size_v_)
+        {}
+
+        //! Whether both keys belong to the same operator setup, regardless of the state of the spaces
+        bool sameSetup(const Key& other) const
+        {
+          return gfsu == other.gfsu && gfsv == other.gfsv
+            && cu == other.cu && cv == other.cv && flags == other.flags;
+        }
+
+        bool operator<(const Key& other) const
+        {
+          if (gfsu != other.gfsu) return gfsu < other.gfsu;
+          if (gfsv != other.gfsv) return gfsv < other.gfsv;
+          if (cu != other.cu) return cu < other.cu;
+          if (cv != other.cv) return cv < other.cv;
+          if (flags != other.flags) return flags < other.flags;
+          if (updates_u != other.updates_u) return updates_u < other.updates_u;
+          if (updates_v != other.updates_v) return updates_v < other.updates_v;
+          if (size_u != other.size_u) return size_u < other.size_u;
+          return size_v < other.size_v;
+        }
+
+        const void* gfsu;
+        const void* gfsv;
+        //! the constraints, null for empty constraints
+        const void* cu;
+        const void* cv;
+        unsigned int flags;
+        //! the update counts of the grid function spaces
+        std::size_t updates_u;
+        std::size_t updates_v;
+        std::size_t size_u;
+        std::size_t size_v;
+      };
+
+      SparsityPatternCache()
+        : _hits(0), _misses(0)
+      {}
+
+      //! Fills the rows of p with the structure stored for key, returns false if there is none.
+      bool lookup(const Key& key, Pattern& p) const
+      {
+        typename PatternMap::const_iterator it = _patterns.find(key);
+        if (it == _patterns.end())
+          {
+            ++_misses;
+            return false;
+          }
+        ++_hits;
+        const Structure& structure = *(it->second);
+        for (std::size_t i = 0; i < p.size(); ++i)
+          p[i] = Row(structure.columns.begin() + structure.offsets[i],
+                     structure.columns.begin() + structure.offsets[i+1]);
+        return true;
+      }
+
+      //! Stores the structure of the pattern p under key, dropping outdated patterns of the same setup.
+      void insert(const Key& key, const Pattern& p)
+      {
+        for (typename PatternMap::iterator it = _patterns.begin(); it != _patterns.end();)
+          if (it->first.sameSetup(key))
+            _patterns.erase(it++);
+          else
+            ++it;
+
+        shared_ptr<Structure> structure(new Structure);
+        std::size_t links = 0;
+        for (std::size_t i = 0; i < p.size(); ++i)
+          links += p[i].size();
+        structure->columns.reserve(links);
+        structure->offsets.reserve(p.size()+1);
+        structure->offsets.push_back(0);
+        for (std::size_t i = 0; i < p.size(); ++i)
+          {
+            // the rows may still hold their links in the order of insertion
+            std::vector<Index>& columns = structure->columns;
+            columns.insert(columns.end(),p[i].begin(),p[i].end());
+            const typename std::vector<Index>::iterator begin = columns.begin() + structure->offsets.back();
+            std::sort(begin,columns.end());
+            columns.erase(std::unique(begin,columns.end()),columns.end());
+            structure->offsets.push_back(columns.size());
+          }
+        std::vector<Index>(structure->columns).swap(structure->columns);
+        _patterns[key] = structure;
+      }
+
+      //! Removes all stored patterns.
+      void clear()
+      {
+        _patterns.clear();
+      }
+
+      //! Number of stored patterns.
+      std::size_t size() const
+      {
+        return _patterns.size();
+      }
+
+      //! Number of bytes held by the stored structures.
+      std::size_t memory() const
+      {
+        std::size_t bytes = 0;
+        for (typename PatternMap::const_iterator it = _patterns.begin(); it != _patterns.end(); ++it)
+          bytes += it->second->offsets.capacity() * sizeof(std::size_t)
+            + it->second->columns.capacity() * sizeof(Index);
+        return bytes;
+      }
+
+      //! Number of successful lookups.
+      std::size_t hits() const
+      {
+        return _hits;
+      }
+
+      //! Number of lookups that did not find a pattern.
+      std::size_t misses() const
+      {
+        return _misses;
+      }
+
+    private:
+
+      typedef typename Pattern::value_type Row;
+      typedef typename Row::value_type Index;
+
+      //! the sorted column indices of all rows, row i holds [offsets[i],offsets[i+1])
+      struct Structure
+      {
+        std::vector<std::size_t> offsets;
+        std::vector<Index> columns;
+      };
+
+      typedef std::map<Key,shared_ptr<Structure> > PatternMap;
+
+      PatternMap _patterns;
+      mutable std::size_t _hits;
+      mutable std::size_t _misses;
+    };
+
+  } // namespace PDELab
+} // namespace Dune
+
+#endif // DUNE_PDELAB_PATTERNCACHE_HH
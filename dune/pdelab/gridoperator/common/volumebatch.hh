@@ -0,0 +1,380 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef DUNE_PDELAB_VOLUMEBATCH_HH
+#define DUNE_PDELAB_VOLUMEBATCH_HH
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/pdelab/common/alignedallocator.hh>
+#include <dune/pdelab/common/geometrywrapper.hh>
+
+namespace Dune{
+  namespace PDELab{
+
+    /** \addtogroup GridOperator
+     *  \{
+     */
+
+    //! One value per local DOF for each cell of a VolumeBatch.
+    /**
+     * The N values of a DOF, one per lane, are contiguous, so loops over the
+     * lanes have a fixed trip count and map to SIMD instructions.
+     *
+     * \tparam T The type of the entries.
+     * \tparam N The number of lanes.
+     */
+    template<typename T, std::size_t N>
+    class BatchVector
+    {
+    public:
+      typedef T value_type;
+      typedef std::size_t size_type;
+
+      //! The number of lanes.
+      static const size_type lanes = N;
+
+      BatchVector()
+        : _size(0)
+      {}
+
+      //! Resize to n DOFs and assign t to all entries.
+      void assign(size_type n, const T& t)
+      {
+        _size = n;
+        _data.assign(n*N,t);
+      }
+
+      //! The number of DOFs.
+      size_type size() const
+      {
+        return _size;
+      }
+
+      //! The values of DOF i, indexed by lane.
+      T* operator[](size_type i)
+      {
+        return &_data[i*N];
+      }
+
+      //! The values of DOF i, indexed by lane (const version).
+      const T* operator[](size_type i) const
+      {
+        return &_data[i*N];
+      }
+
+    private:
+      std::vector<T,AlignedAllocator<T> > _data;
+      size_type _size;
+    };
+
+    //! One value per pair of local DOFs for each cell of a VolumeBatch.
+    /**
+     * \tparam T The type of the entries.
+     * \tparam N The number of lanes.
+     */
+    template<typename T, std::size_t N>
+    class BatchMatrix
+    {
+    public:
+      typedef T value_type;
+      typedef std::size_t size_type;
+
+      //! The number of lanes.
+      static const size_type lanes = N;
+
+      BatchMatrix()
+        : _rows(0)
+        , _cols(0)
+      {}
+
+      //! Resize to r rows and c columns and assign t to all entries.
+      void assign(size_type r, size_type c, const T& t)
+      {
+        _rows = r;
+        _cols = c;
+        _data.assign(r*c*N,t);
+      }
+
+      size_type nrows() const
+      {
+        return _rows;
+      }
+
+      size_type ncols() const
+      {
+        return _cols;
+      }
+
+      //! The values of the entry (i,j), indexed by lane.
+      T* operator()(size_type i, size_type j)
+      {
+        return &_data[(i*_cols + j)*N];
+      }
+
+      //! The values of the entry (i,j), indexed by lane (const version).
+      const T* operator()(size_type i, size_type j) const
+      {
+        return &_data[(i*_cols + j)*N];
+      }
+
+    private:
+      std::vector<T,AlignedAllocator<T> > _data;
+      size_type _rows;
+      size_type _cols;
+    };
+
+    //! The cells handed to the batched volume methods of a local operator.
+    /**
+     * DefaultAssembler groups up to N cells of the same GeometryType whose
+     * local function spaces have the same sizes. The local operator's
+     * alpha_volume_batch() and jacobian_volume_batch() then evaluate all of
+     * them at once with one SIMD lane per cell, reading the coefficients
+     * from a BatchVector and writing into a BatchVector or BatchMatrix.
+     * Both are indexed by the local indices of the cell's spaces, i.e. the
+     * coefficient of basis function i of lane k is x[lfsu(k).localIndex(i)][k].
+     * The local operator adds its unweighted contributions, the engine
+     * applies the weight of the local assembler when scattering.
+     *
+     * Batches with fewer than N cells are padded by repeating the first
+     * cell, so local operators can always process all N lanes. The engine
+     * discards the results of the padding lanes.
+     *
+     * The finite elements of the cells are not required to be the same
+     * object, e.g. for finite element maps which depend on the orientation
+     * of the cell. Local operators which share basis evaluations between
+     * the lanes have to check sameFiniteElement().
+     *
+     * \tparam E    The codim 0 entity type.
+     * \tparam LFSU The trial LocalFunctionSpace.
+     * \tparam LFSV The test LocalFunctionSpace.
+     * \tparam N    The number of lanes.
+     */
+    template<typename E, typename LFSU_, typename LFSV_, std::size_t N>
+    class VolumeBatch
+    {
+    public:
+      typedef E Element;
+      typedef ElementGeometry<E> EG;
+      typedef LFSU_ LFSU;
+      typedef LFSV_ LFSV;
+      typedef typename E::Geometry Geometry;
+      typedef typename Geometry::ctype ctype;
+      typedef typename LFSU::Traits::FiniteElementType::
+        Traits::LocalBasisType::Traits BasisTraits;
+
+      enum { mydimension = Geometry::mydimension };
+      enum { coorddimension = Geometry::coorddimension };
+
+      typedef FieldVector<ctype,mydimension> LocalCoordinate;
+
+      //! The number of lanes.
+      static const std::size_t lanes = N;
+
+      VolumeBatch()
+        : _size(0)
+      {
+        for (std::size_t k = 0; k < N; ++k)
+          {
+            _elements[k] = 0;
+            _lfsu[k] = 0;
+            _lfsv[k] = 0;
+            _cached[k] = false;
+          }
+      }
+
+      //! Put a cell into a lane. Called by the assembler engines.
+      void set(std::size_t lane, const E& e, const LFSU& lfsu, const LFSV& lfsv)
+      {
+        assert(lane < N);
+        _elements[lane] = &e;
+        _lfsu[lane] = &lfsu;
+        _lfsv[lane] = &lfsv;
+        _cached[lane] = false;
+      }
+
+      //! Fix the number of occupied lanes and pad the rest. Called by the assembler engines.
+      /**
+       * Also reserves the scratch space for the basis evaluations of the
+       * lanes, so evaluating them at the quadrature points does not
+       * allocate.
+       */
+      void setSize(std::size_t size)
+      {
+        assert(size > 0 && size <= N);
+        _size = size;
+        for (std::size_t k = size; k < N; ++k)
+          set(k,*_elements[0],*_lfsu[0],*_lfsv[0]);
+        _values.reserve(_lfsu[0]->size());
+        _jacobians.reserve(_lfsu[0]->size());
+      }
+
+      //! The number of occupied lanes, lanes from size() to N-1 are padding.
+      std::size_t size() const
+      {
+        return _size;
+      }
+
+      //! The cell in lane k.
+      const E& entity(std::size_t k) const
+      {
+        return *_elements[k];
+      }
+
+      //! The cell in lane k wrapped as it is handed to alpha_volume().
+      EG elementGeometry(std::size_t k) const
+      {
+        return EG(*_elements[k]);
+      }
+
+      //! The trial space bound to the cell in lane k.
+      const LFSU& lfsu(std::size_t k) const
+      {
+        return *_lfsu[k];
+      }
+
+      //! The test space bound to the cell in lane k.
+      const LFSV& lfsv(std::size_t k) const
+      {
+        return *_lfsv[k];
+      }
+
+      //! Whether the trial spaces of lanes 0 and k use the same finite element object.
+      bool sameFiniteElement(std::size_t k) const
+      {
+        return &_lfsu[k]->finiteElement() == &_lfsu[0]->finiteElement();
+      }
+
+      //! Evaluate the geometries of all lanes at the local coordinate x.
+      /**
+       * \param x                  Position in the reference element.
+       * \param jit                Entry [r][c][k] is entry (r,c) of the jacobian inverse
+       *                           transposed of the cell in lane k.
+       * \param integrationElement Entry [k] is the integration element of the cell in lane k.
+       *
+       * Like ElementGeometry, the values of affine cells are only computed once.
+       */
+      template<typename RF>
+      void jacobianInverseTransposed(const LocalCoordinate& x,
+                                     RF (&jit)[coorddimension][mydimension][N],
+                                     RF (&integrationElement)[N]) const
+      {
+        for (std::size_t k = 0; k < N; ++k)
+          {
+            if (!_cached[k])
+              {
+                const Geometry geo = _elements[k]->geometry();
+                _jit[k] = geo.jacobianInverseTransposed(x);
+                _integrationElement[k] = geo.integrationElement(x);
+                _cached[k] = geo.affine();
+              }
+            for (int r = 0; r < coorddimension; ++r)
+              for (int c = 0; c < mydimension; ++c)
+                jit[r][c][k] = _jit[k][r][c];
+            integrationElement[k] = _integrationElement[k];
+          }
+      }
+
+      //! Values of the trial basis of all lanes at the local coordinate x.
+      /**
+       * \param x         Position in the reference element.
+       * \param reference The basis evaluated at x for lane 0.
+       * \param phi       Entry [i*N+k] is basis function i of the cell in lane k.
+       *
+       * The reference values are reused for all lanes with the same finite
+       * element, the basis of the other lanes is evaluated separately.
+       * phi is resized to n*N, callers which keep it over the quadrature
+       * points of a batch allocate it only once.
+       */
+      template<typename Range, typename RF>
+      void basisValues(const LocalCoordinate& x,
+                       const std::vector<Range>& reference,
+                       std::vector<RF>& phi) const
+      {
+        const std::size_t n = reference.size();
+        phi.resize(n*N);
+        for (std::size_t i = 0; i < n; ++i)
+          for (std::size_t k = 0; k < N; ++k)
+            phi[i*N+k] = reference[i][0];
+
+        for (std::size_t k = 1; k < N; ++k)
+          if (!sameFiniteElement(k))
+            {
+              _lfsu[k]->finiteElement().localBasis().evaluateFunction(x,_values);
+              for (std::size_t i = 0; i < n; ++i)
+                phi[i*N+k] = _values[i][0];
+            }
+      }
+
+      //! Gradients of the trial basis of all lanes at the local coordinate x.
+      /**
+       * \param x                  Position in the reference element.
+       * \param reference          The jacobians of the basis evaluated at x for lane 0.
+       * \param gradphi            Entry [(i*coorddimension+d)*N+k] is component d of the
+       *                           gradient of basis function i on the cell in lane k.
+       * \param integrationElement Entry [k] is the integration element of the cell in lane k.
+       *
+       * Only scalar bases are supported. The transformation to the cells is
+       * done for all lanes at once. Like phi in basisValues(), gradphi is
+       * only allocated if it is too small.
+       */
+      template<typename Jacobian, typename RF>
+      void basisGradients(const LocalCoordinate& x,
+                          const std::vector<Jacobian>& reference,
+                          std::vector<RF>& gradphi,
+                          RF (&integrationElement)[N]) const
+      {
+        RF jit[coorddimension][mydimension][N];
+        jacobianInverseTransposed(x,jit,integrationElement);
+
+        const std::size_t n = reference.size();
+        gradphi.assign(n*coorddimension*N,0.0);
+        for (std::size_t i = 0; i < n; ++i)
+          for (int d = 0; d < coorddimension; ++d)
+            {
+              RF* g = &gradphi[(i*coorddimension+d)*N];
+              for (int c = 0; c < mydimension; ++c)
+                {
+                  const RF r = reference[i][0][c];
+                  for (std::size_t k = 0; k < N; ++k)
+                    g[k] += jit[d][c][k] * r;
+                }
+            }
+
+        for (std::size_t k = 1; k < N; ++k)
+          if (!sameFiniteElement(k))
+            {
+              _lfsu[k]->finiteElement().localBasis().evaluateJacobian(x,_jacobians);
+              for (std::size_t i = 0; i < n; ++i)
+                for (int d = 0; d < coorddimension; ++d)
+                  {
+                    RF g = 0.0;
+                    for (int c = 0; c < mydimension; ++c)
+                      g += jit[d][c][k] * _jacobians[i][0][c];
+                    gradphi[(i*coorddimension+d)*N+k] = g;
+                  }
+            }
+      }
+
+    private:
+      std::size_t _size;
+      const E* _elements[N];
+      const LFSU* _lfsu[N];
+      const LFSV* _lfsv[N];
+      mutable bool _cached[N];
+      mutable typename Geometry::JacobianInverseTransposed _jit[N];
+      mutable ctype _integrationElement[N];
+      mutable std::vector<typename BasisTraits::RangeType> _values;
+      mutable std::vector<typename BasisTraits::JacobianType> _jacobians;
+    };
+
+    //! \} group GridOperator
+
+  } // namespace PDELab
+} // namespace Dune
+
+#endif // DUNE_PDELAB_VOLUMEBATCH_HH
@@ -1,7 +1,11 @@
 #ifndef DUNE_PDELAB_DEFAULT_ASSEMBLER_HH
 #define DUNE_PDELAB_DEFAULT_ASSEMBLER_HH
 
+#include <vector>
+
+#include <dune/common/shared_ptr.hh>
 #include <dune/common/typetraits.hh>
+#include <dune/pdelab/common/instrumentation.hh>
 #include <dune/pdelab/gridoperator/common/assemblerutilities.hh>
 #include <dune/pdelab/gridoperatorspace/gridoperatorspaceutilities.hh>
 #include <dune/pdelab/gridfunctionspace/localfunctionspace.hh>
@@ -26,6 +30,7 @@ namespace Dune{
       typedef typename GFSU::Traits::GridViewType GV;
       typedef typename GV::Traits::template Codim<0>::Iterator ElementIterator;
       typedef typename GV::Traits::template Codim<0>::Entity Element;
+      typedef typename GV::Traits::template Codim<0>::EntityPointer ElementPointer;
       typedef typename GV::IntersectionIterator IntersectionIterator;
       typedef typename IntersectionIterator::Intersection Intersection;
       //! @}
@@ -44,7 +49,7 @@ namespace Dune{
 
       DefaultAssembler (const GFSU& gfsu_, const GFSV& gfsv_)
         : gfsu(gfsu_), gfsv(gfsv_), lfsu(gfsu_), lfsv(gfsv_),
-          lfsun(gfsu_), lfsvn(gfsv_)
+          lfsun(gfsu_), lfsvn(gfsv_), volume_batching(false)
       { }
 
       //! Get the trial grid function space
@@ -59,16 +64,30 @@ namespace Dune{
         return gfsv;
       }
 
-      // Assembler (const GFSU& gfsu_, const GFSV& gfsv_)
-      //   : gfsu(gfsu_), gfsv(gfsv_), lfsu(gfsu_), lfsv(gfsv_),
-      //     lfsun(gfsu_), lfsvn(gfsv_),
-      //     sub_triangulation(ST(gfsu_.gridview(),Dune::PDELab::NoSubTriangulationImp()))
-      // { }
+      //! Enable or disable batched volume assembly
+      /**
+       * If enabled, engines which support it assemble the volume terms of
+       * consecutive cells of the same GeometryType in batches by calling
+       * the local operator's alpha_volume_batch() or
+       * jacobian_volume_batch(). All other terms are still assembled cell
+       * by cell. Batching is disabled by default.
+       */
+      void setVolumeBatching(bool enable)
+      {
+        volume_batching = enable;
+      }
+
+      //! Whether batched volume assembly is enabled
+      bool volumeBatching() const
+      {
+        return volume_batching;
+      }
 
       template<class LocalAssemblerEngine>
       void assemble(LocalAssemblerEngine & assembler_engine) const
       {
-        typedef typename GV::Traits::template Codim<0>::Entity Element;
+        AssemblyProfile & profile = assemblyProfile();
+        AssemblyPhaseTimer total_timer(profile,AssemblyPhase::total);
 
         // Notify assembler engine about oncoming assembly
         assembler_engine.preAssembly();
@@ -76,6 +95,106 @@ namespace Dune{
         // Map each cell to unique id
         Dune::PDELab::MultiGeomUniqueIDMapper<GV> cell_mapper(gfsu.gridView());
 
+        if (volume_batching && assembler_engine.requireUVVolumeBatch())
+          assembleBatched(assembler_engine,cell_mapper,profile);
+        else
+          // Traverse grid view
+          for (ElementIterator it = gfsu.gridView().template begin<0>();
+               it!=gfsu.gridView().template end<0>(); ++it)
+            assembleElement(assembler_engine,*it,cell_mapper,lfsu,lfsv,lfsun,lfsvn,profile);
+
+        // Notify assembler engine that assembly is finished
+        AssemblyPhaseTimer constraints_timer(profile,AssemblyPhase::constraints);
+        assembler_engine.postAssembly();
+
+      }
+
+    protected:
+
+      /* local function spaces */
+      typedef Dune::PDELab::LocalFunctionSpace<GFSU, Dune::PDELab::TrialSpaceTag> LFSU;
+      typedef Dune::PDELab::LocalFunctionSpace<GFSV, Dune::PDELab::TestSpaceTag> LFSV;
+
+      //! Assemble all contributions of a single grid cell
+      /**
+       * This is the body of the grid traversal in assemble(). It is
+       * exposed to derived assemblers which traverse the grid in a
+       * different order, and takes the local function spaces and the
+       * profile to record into as arguments so that those assemblers
+       * can hand in their own (e.g. thread-local) instances.
+       */
+      template<class LocalAssemblerEngine, class CellMapper>
+      void assembleElement(LocalAssemblerEngine & assembler_engine,
+                           const Element & e,
+                           CellMapper & cell_mapper,
+                           LFSU & lfsu, LFSV & lfsv,
+                           LFSU & lfsun, LFSV & lfsvn,
+                           AssemblyProfile & profile) const
+      {
+        ElementGeometry<Element> eg(e);
+
+        if(assembler_engine.assembleCell(eg))
+          return;
+
+        {
+          AssemblyPhaseTimer timer(profile,AssemblyPhase::bind);
+
+          // Bind local test function space to element
+          lfsv.bind( e );
+
+          // Notify assembler engine about bind
+          assembler_engine.onBindLFSV(eg,lfsv);
+        }
+
+        {
+          AssemblyPhaseTimer timer(profile,AssemblyPhase::volume);
+
+          // Volume integration
+          assembler_engine.assembleVVolume(eg,lfsv);
+        }
+
+        {
+          AssemblyPhaseTimer timer(profile,AssemblyPhase::bind);
+
+          // Bind local trial function space to element
+          lfsu.bind( e );
+
+          // Notify assembler engine about bind
+          assembler_engine.onBindLFSUV(eg,lfsu,lfsv);
+        }
+
+        {
+          AssemblyPhaseTimer timer(profile,AssemblyPhase::loadCoefficients);
+
+          // Load coefficients of local functions
+          assembler_engine.loadCoefficientsLFSUInside(lfsu);
+        }
+
+        {
+          AssemblyPhaseTimer timer(profile,AssemblyPhase::volume);
+
+          // Volume integration
+          assembler_engine.assembleUVVolume(eg,lfsu,lfsv);
+        }
+
+        assembleAfterVolume(assembler_engine,eg,cell_mapper,lfsu,lfsv,lfsun,lfsvn,profile);
+      }
+
+      //! Assemble the terms of a cell which follow its volume terms and scatter the results
+      /**
+       * Traverses the intersections of the cell, assembles the volume
+       * terms after the skeleton and notifies the engine about the
+       * unbinds. Expects lfsu and lfsv to be bound to the cell and the
+       * coefficients of lfsu to be loaded.
+       */
+      template<class LocalAssemblerEngine, class CellMapper>
+      void assembleAfterVolume(LocalAssemblerEngine & assembler_engine,
+                               const ElementGeometry<Element> & eg,
+                               CellMapper & cell_mapper,
+                               LFSU & lfsu, LFSV & lfsv,
+                               LFSU & lfsun, LFSV & lfsvn,
+                               AssemblyProfile & profile) const
+      {
         // Extract integration requirements from the local assembler
         const bool require_uv_skeleton = assembler_engine.requireUVSkeleton();
         const bool require_v_skeleton = assembler_engine.requireVSkeleton();
@@ -87,178 +206,293 @@ namespace Dune{
         const bool require_v_post_skeleton = assembler_engine.requireVVolumePostSkeleton();
         const bool require_skeleton_two_sided = assembler_engine.requireSkeletonTwoSided();
 
-        // Traverse grid view
-        for (ElementIterator it = gfsu.gridView().template begin<0>();
-             it!=gfsu.gridView().template end<0>(); ++it)
-          {
-            // Compute unique id
-            const typename GV::IndexSet::IndexType ids = cell_mapper.map(*it);
+        const Element & e = eg.entity();
 
-            ElementGeometry<Element> eg(*it);
+        // Compute unique id
+        const typename GV::IndexSet::IndexType ids = cell_mapper.map(e);
 
-            if(assembler_engine.assembleCell(eg))
-              continue;
+        // Skip if no intersection iterator is needed
+        if (require_uv_skeleton || require_v_skeleton ||
+            require_uv_boundary || require_v_boundary ||
+            require_uv_processor || require_v_processor)
+          {
+            // Traverse intersections
+            unsigned int intersection_index = 0;
+            IntersectionIterator endit = gfsu.gridView().iend(e);
+            IntersectionIterator iit = gfsu.gridView().ibegin(e);
+            for(; iit!=endit; ++iit, ++intersection_index)
+              {
 
-            // Bind local test function space to element
-            lfsv.bind( *it );
+                IntersectionGeometry<Intersection> ig(*iit,intersection_index);
 
-            // Notify assembler engine about bind
-            assembler_engine.onBindLFSV(eg,lfsv);
+                switch (IntersectionType::get(*iit))
+                  {
+                  case IntersectionType::skeleton:
+                    // the specific ordering of the if-statements in the old code caused periodic
+                    // boundary intersection to be handled the same as skeleton intersections
+                  case IntersectionType::periodic:
+                    if (require_uv_skeleton || require_v_skeleton)
+                      {
+                        // compute unique id for neighbor
 
-            // Volume integration
-            assembler_engine.assembleVVolume(eg,lfsv);
+                        const typename GV::IndexSet::IndexType idn = cell_mapper.map(*(iit->outside()));
 
-            // Bind local trial function space to element
-            lfsu.bind( *it );
+                        // Visit face if id is bigger
+                        bool visit_face = ids > idn || require_skeleton_two_sided;
 
-            // Notify assembler engine about bind
-            assembler_engine.onBindLFSUV(eg,lfsu,lfsv);
+                        // unique vist of intersection
+                        if (visit_face)
+                          {
+                            {
+                              AssemblyPhaseTimer timer(profile,AssemblyPhase::bind);
 
-            // Load coefficients of local functions
-            assembler_engine.loadCoefficientsLFSUInside(lfsu);
+                              // Bind local test space to neighbor element
+                              lfsvn.bind(*(iit->outside()));
 
-            // Volume integration
-            assembler_engine.assembleUVVolume(eg,lfsu,lfsv);
+                              // Notify assembler engine about binds
+                              assembler_engine.onBindLFSVOutside(ig,lfsv,lfsvn);
+                            }
 
-            // Skip if no intersection iterator is needed
-            if (require_uv_skeleton || require_v_skeleton ||
-                require_uv_boundary || require_v_boundary ||
-                require_uv_processor || require_v_processor)
-              {
-                // Traverse intersections
-                unsigned int intersection_index = 0;
-                IntersectionIterator endit = gfsu.gridView().iend(*it);
-                IntersectionIterator iit = gfsu.gridView().ibegin(*it);
-                for(; iit!=endit; ++iit, ++intersection_index)
-                  {
+                            {
+                              AssemblyPhaseTimer timer(profile,AssemblyPhase::skeleton);
+
+                              // Skeleton integration
+                              assembler_engine.assembleVSkeleton(ig,lfsv,lfsvn);
+                            }
 
-                    IntersectionGeometry<Intersection> ig(*iit,intersection_index);
+                            if(require_uv_skeleton){
 
-                    switch (IntersectionType::get(*iit))
-                      {
-                      case IntersectionType::skeleton:
-                        // the specific ordering of the if-statements in the old code caused periodic
-                        // boundary intersection to be handled the same as skeleton intersections
-                      case IntersectionType::periodic:
-                        if (require_uv_skeleton || require_v_skeleton)
-                          {
-                            // compute unique id for neighbor
+                              {
+                                AssemblyPhaseTimer timer(profile,AssemblyPhase::bind);
 
-                            const typename GV::IndexSet::IndexType idn = cell_mapper.map(*(iit->outside()));
+                                // Bind local trial space to neighbor element
+                                lfsun.bind(*(iit->outside()));
 
-                            // Visit face if id is bigger
-                            bool visit_face = ids > idn || require_skeleton_two_sided;
+                                // Notify assembler engine about binds
+                                assembler_engine.onBindLFSUVOutside(ig,
+                                                                    lfsu,lfsv,
+                                                                    lfsun,lfsvn);
+                              }
 
-                            // unique vist of intersection
-                            if (visit_face)
                               {
-                                // Bind local test space to neighbor element
-                                lfsvn.bind(*(iit->outside()));
+                                AssemblyPhaseTimer timer(profile,AssemblyPhase::loadCoefficients);
 
-                                // Notify assembler engine about binds
-                                assembler_engine.onBindLFSVOutside(ig,lfsv,lfsvn);
+                                // Load coefficients of local functions
+                                assembler_engine.loadCoefficientsLFSUOutside(lfsun);
+                              }
+
+                              {
+                                AssemblyPhaseTimer timer(profile,AssemblyPhase::skeleton);
 
                                 // Skeleton integration
-                                assembler_engine.assembleVSkeleton(ig,lfsv,lfsvn);
+                                assembler_engine.assembleUVSkeleton(ig,lfsu,lfsv,lfsun,lfsvn);
+                              }
+
+                              AssemblyPhaseTimer timer(profile,AssemblyPhase::scatter);
 
-                                if(require_uv_skeleton){
+                              // Notify assembler engine about unbinds
+                              assembler_engine.onUnbindLFSUVOutside(ig,
+                                                                    lfsu,lfsv,
+                                                                    lfsun,lfsvn);
+                            }
 
-                                  // Bind local trial space to neighbor element
-                                  lfsun.bind(*(iit->outside()));
+                            AssemblyPhaseTimer timer(profile,AssemblyPhase::scatter);
 
-                                  // Notify assembler engine about binds
-                                  assembler_engine.onBindLFSUVOutside(ig,
-                                                                      lfsu,lfsv,
-                                                                      lfsun,lfsvn);
+                            // Notify assembler engine about unbinds
+                            assembler_engine.onUnbindLFSVOutside(ig,lfsv,lfsvn);
+                          }
+                      }
+                    break;
 
-                                  // Load coefficients of local functions
-                                  assembler_engine.loadCoefficientsLFSUOutside(lfsun);
+                  case IntersectionType::boundary:
+                    if(require_uv_boundary || require_v_boundary )
+                      {
+                        AssemblyPhaseTimer timer(profile,AssemblyPhase::boundary);
 
-                                  // Skeleton integration
-                                  assembler_engine.assembleUVSkeleton(ig,lfsu,lfsv,lfsun,lfsvn);
+                        // Boundary integration
+                        assembler_engine.assembleVBoundary(ig,lfsv);
 
-                                  // Notify assembler engine about unbinds
-                                  assembler_engine.onUnbindLFSUVOutside(ig,
-                                                                        lfsu,lfsv,
-                                                                        lfsun,lfsvn);
-                                }
+                        if(require_uv_boundary){
+                          // Boundary integration
+                          assembler_engine.assembleUVBoundary(ig,lfsu,lfsv);
+                        }
+                      }
+                    break;
 
-                                // Notify assembler engine about unbinds
-                                assembler_engine.onUnbindLFSVOutside(ig,lfsv,lfsvn);
-                              }
-                          }
-                        break;
+                  case IntersectionType::processor:
+                    if(require_uv_processor || require_v_processor )
+                      {
+                        AssemblyPhaseTimer timer(profile,AssemblyPhase::boundary);
 
-                      case IntersectionType::boundary:
-                        if(require_uv_boundary || require_v_boundary )
-                          {
+                        // Processor integration
+                        assembler_engine.assembleVProcessor(ig,lfsv);
 
-                            // Boundary integration
-                            assembler_engine.assembleVBoundary(ig,lfsv);
+                        if(require_uv_processor){
+                          // Processor integration
+                          assembler_engine.assembleUVProcessor(ig,lfsu,lfsv);
+                        }
+                      }
+                    break;
+                  } // switch
 
-                            if(require_uv_boundary){
-                              // Boundary integration
-                              assembler_engine.assembleUVBoundary(ig,lfsu,lfsv);
-                            }
-                          }
-                        break;
+              } // iit
+          } // do skeleton
 
-                      case IntersectionType::processor:
-                        if(require_uv_processor || require_v_processor )
-                          {
+        if(require_uv_post_skeleton || require_v_post_skeleton){
+          AssemblyPhaseTimer timer(profile,AssemblyPhase::volume);
 
-                            // Processor integration
-                            assembler_engine.assembleVProcessor(ig,lfsv);
+          // Volume integration
+          assembler_engine.assembleVVolumePostSkeleton(eg,lfsv);
 
-                            if(require_uv_processor){
-                              // Processor integration
-                              assembler_engine.assembleUVProcessor(ig,lfsu,lfsv);
-                            }
-                          }
-                        break;
-                      } // switch
+          if(require_uv_post_skeleton){
+            // Volume integration
+            assembler_engine.assembleUVVolumePostSkeleton(eg,lfsu,lfsv);
+          }
+        }
 
-                  } // iit
-              } // do skeleton
+        AssemblyPhaseTimer timer(profile,AssemblyPhase::scatter);
 
-            if(require_uv_post_skeleton || require_v_post_skeleton){
-              // Volume integration
-              assembler_engine.assembleVVolumePostSkeleton(eg,lfsv);
+        // Notify assembler engine about unbinds
+        assembler_engine.onUnbindLFSUV(eg,lfsu,lfsv);
 
-              if(require_uv_post_skeleton){
-                // Volume integration
-                assembler_engine.assembleUVVolumePostSkeleton(eg,lfsu,lfsv);
-              }
+        // Notify assembler engine about unbinds
+        assembler_engine.onUnbindLFSV(eg,lfsv);
+      }
+
+      /* global function spaces */
+      const GFSU& gfsu;
+      const GFSV& gfsv;
+
+    private:
+
+      //! Grid traversal which collects the cells into volume batches
+      /**
+       * Consecutive cells of the same GeometryType are collected until the
+       * batch is full, the GeometryType changes or the engine rejects a
+       * cell, e.g. because its local function space has a different size.
+       * Each cell of a batch is bound to its own pair of local function
+       * spaces, which stay bound until the batch has been scattered.
+       */
+      template<class LocalAssemblerEngine, class CellMapper>
+      void assembleBatched(LocalAssemblerEngine & assembler_engine,
+                           CellMapper & cell_mapper,
+                           AssemblyProfile & profile) const
+      {
+        const std::size_t batch_size = assembler_engine.volumeBatchSize();
+        while (batch_lfsu.size() < batch_size)
+          {
+            batch_lfsu.push_back(Dune::shared_ptr<LFSU>(new LFSU(gfsu)));
+            batch_lfsv.push_back(Dune::shared_ptr<LFSV>(new LFSV(gfsv)));
+          }
+
+        // the entity pointers keep the cells of the batch alive, the
+        // reserved capacity makes sure they are never moved
+        std::vector<ElementPointer> elements;
+        elements.reserve(batch_size);
+
+        for (ElementIterator it = gfsu.gridView().template begin<0>();
+             it!=gfsu.gridView().template end<0>(); ++it)
+          {
+            if(assembler_engine.assembleCell(ElementGeometry<Element>(*it)))
+              continue;
+
+            if (!elements.empty() && it->type() != elements.front()->type())
+              flushBatch(assembler_engine,elements,cell_mapper,profile);
+
+            std::size_t lane = elements.size();
+
+            {
+              AssemblyPhaseTimer timer(profile,AssemblyPhase::bind);
+
+              // Bind local function spaces of the next free lane to element
+              batch_lfsv[lane]->bind( *it );
+              batch_lfsu[lane]->bind( *it );
             }
 
-            // Notify assembler engine about unbinds
-            assembler_engine.onUnbindLFSUV(eg,lfsu,lfsv);
+            if (lane > 0 && !assembler_engine.acceptVolumeBatchLane(*batch_lfsu[lane],*batch_lfsv[lane]))
+              {
+                flushBatch(assembler_engine,elements,cell_mapper,profile);
+                batch_lfsu[lane].swap(batch_lfsu[0]);
+                batch_lfsv[lane].swap(batch_lfsv[0]);
+                lane = 0;
+              }
 
-            // Notify assembler engine about unbinds
-            assembler_engine.onUnbindLFSV(eg,lfsv);
+            elements.push_back(ElementPointer(it));
 
-          } // it
+            {
+              AssemblyPhaseTimer timer(profile,AssemblyPhase::loadCoefficients);
 
-        // Notify assembler engine that assembly is finished
-        assembler_engine.postAssembly();
+              // Notify assembler engine about bind
+              assembler_engine.onBindLFSUVBatch(lane,ElementGeometry<Element>(*elements[lane]),
+                                                *batch_lfsu[lane],*batch_lfsv[lane]);
+            }
 
+            if (elements.size() == batch_size)
+              flushBatch(assembler_engine,elements,cell_mapper,profile);
+          }
+
+        if (!elements.empty())
+          flushBatch(assembler_engine,elements,cell_mapper,profile);
       }
 
-    private:
+      //! Assemble the current volume batch, then the remaining terms of its cells
+      /**
+       * The remaining terms of a cell are assembled on the local function
+       * spaces of its lane, which are still bound. The engine takes the
+       * coefficients and the volume contributions of the cell from the
+       * batch, so the local results of a cell are scattered only once.
+       */
+      template<class LocalAssemblerEngine, class CellMapper>
+      void flushBatch(LocalAssemblerEngine & assembler_engine,
+                      std::vector<ElementPointer> & elements,
+                      CellMapper & cell_mapper,
+                      AssemblyProfile & profile) const
+      {
+        const std::size_t lanes = elements.size();
 
-      /* global function spaces */
-      const GFSU& gfsu;
-      const GFSV& gfsv;
+        {
+          AssemblyPhaseTimer timer(profile,AssemblyPhase::volume);
+
+          // Volume integration
+          assembler_engine.assembleUVVolumeBatch(lanes);
+        }
+
+        for (std::size_t k = 0; k < lanes; ++k)
+          {
+            ElementGeometry<Element> eg(*elements[k]);
+
+            {
+              AssemblyPhaseTimer timer(profile,AssemblyPhase::loadCoefficients);
+
+              // Make the cell of the lane the current one of the engine
+              assembler_engine.onSelectLFSUVBatchLane(k,eg,*batch_lfsu[k],*batch_lfsv[k]);
+            }
+
+            {
+              AssemblyPhaseTimer timer(profile,AssemblyPhase::volume);
+
+              // Volume integration
+              assembler_engine.assembleVVolume(eg,*batch_lfsv[k]);
+            }
+
+            assembleAfterVolume(assembler_engine,eg,cell_mapper,
+                                *batch_lfsu[k],*batch_lfsv[k],lfsun,lfsvn,profile);
+          }
+
+        elements.clear();
+      }
 
-      /* local function spaces */
-      typedef Dune::PDELab::LocalFunctionSpace<GFSU, Dune::PDELab::TrialSpaceTag> LFSU;
-      typedef Dune::PDELab::LocalFunctionSpace<GFSV, Dune::PDELab::TestSpaceTag> LFSV;
       // local function spaces in local cell
       mutable LFSU lfsu;
       mutable LFSV lfsv;
       // local function spaces in neighbor
       mutable LFSU lfsun;
       mutable LFSV lfsvn;
+      // local function spaces of the cells in a volume batch
+      mutable std::vector<Dune::shared_ptr<LFSU> > batch_lfsu;
+      mutable std::vector<Dune::shared_ptr<LFSV> > batch_lfsv;
+
+      bool volume_batching;
     };
 
   }
@@ -0,0 +1,294 @@
+#ifndef DUNE_PDELAB_DEFAULT_BLOCKDIAGONALENGINE_HH
+#define DUNE_PDELAB_DEFAULT_BLOCKDIAGONALENGINE_HH
+
+#include <dune/common/nullptr.hh>
+#include <dune/pdelab/gridoperator/common/localassemblerenginebase.hh>
+#include <dune/pdelab/gridoperator/common/blockdiagonal.hh>
+#include <dune/pdelab/gridoperatorspace/gridoperatorspaceutilities.hh>
+
+namespace Dune{
+  namespace PDELab{
+
+    /**
+       \brief The local assembler engine for DUNE grids which
+       assembles the element diagonal blocks of the jacobian matrix
+
+       The local jacobians are computed as for the full matrix, but
+       only the entries coupling DOFs of the same block of the
+       ElementBlockDiagonal are kept. Constrained rows are replaced by
+       rows of the identity, as done for the assembled matrix.
+
+       \tparam LA The local assembler
+
+    */
+    template<typename LA>
+    class DefaultLocalBlockDiagonalAssemblerEngine
+      : public LocalAssemblerEngineBase
+    {
+    public:
+      //! The type of the wrapping local assembler
+      typedef LA LocalAssembler;
+
+      //! The type of the local operator
+      typedef typename LA::LocalOperator LOP;
+
+      //! The local function spaces
+      typedef typename LA::LFSU LFSU;
+      typedef typename LA::LFSV LFSV;
+
+      //! The type of the jacobian matrix entries
+      typedef typename LA::Traits::Jacobian::ElementType JacobianElement;
+
+      //! The type of the block diagonal
+      typedef ElementBlockDiagonal<JacobianElement> BlockDiagonal;
+
+      //! The type of the solution vector
+      typedef typename LA::Traits::Solution Solution;
+      typedef typename Solution::ElementType SolutionElement;
+
+      /**
+         \brief Constructor
+
+         \param [in] local_assembler_ The local assembler object which
+         creates this engine
+      */
+      DefaultLocalBlockDiagonalAssemblerEngine(const LocalAssembler & local_assembler_)
+        : local_assembler(local_assembler_), lop(local_assembler_.lop),
+          diagonal(nullptr),
+          solution(nullptr),
+          al_view(al,1.0),
+          al_sn_view(al_sn,1.0),
+          al_ns_view(al_ns,1.0),
+          al_nn_view(al_nn,1.0)
+      {}
+
+      /**
+         \brief Copy constructor
+
+         The copy writes into the same block diagonal as the original,
+         but owns its local scratch containers.
+      */
+      DefaultLocalBlockDiagonalAssemblerEngine(const DefaultLocalBlockDiagonalAssemblerEngine & other)
+        : LocalAssemblerEngineBase(other),
+          local_assembler(other.local_assembler), lop(other.lop),
+          diagonal(other.diagonal),
+          solution(other.solution),
+          al_view(al,1.0),
+          al_sn_view(al_sn,1.0),
+          al_ns_view(al_ns,1.0),
+          al_nn_view(al_nn,1.0)
+      {}
+
+      //! Query methods for the global grid assembler
+      //! @{
+      bool requireSkeleton() const
+      { return local_assembler.doAlphaSkeleton(); }
+      bool requireSkeletonTwoSided() const
+      { return local_assembler.doSkeletonTwoSided(); }
+      bool requireUVVolume() const
+      { return local_assembler.doAlphaVolume(); }
+      bool requireUVSkeleton() const
+      { return local_assembler.doAlphaSkeleton(); }
+      bool requireUVBoundary() const
+      { return local_assembler.doAlphaBoundary(); }
+      bool requireUVVolumePostSkeleton() const
+      { return local_assembler.doAlphaVolumePostSkeleton(); }
+      //! @}
+
+      //! Public access to the wrapping local assembler
+      const LocalAssembler & localAssembler() const { return local_assembler; }
+
+      //! Set current block diagonal. Should be called prior to
+      //! assembling.
+      void setBlockDiagonal(BlockDiagonal & diagonal_){
+        diagonal = &diagonal_;
+      }
+
+      //! Set current solution vector. Should be called prior to
+      //! assembling.
+      void setSolution(const Solution & solution_){
+        solution = &solution_;
+      }
+
+      //! Called immediately after binding of local function space in
+      //! global assembler.
+      //! @{
+      template<typename EG>
+      void onBindLFSUV(const EG & eg, const LFSU & lfsu, const LFSV & lfsv){
+        xl.resize(lfsu.size());
+        al.assign(lfsv.size() ,lfsu.size(),0.0);
+      }
+
+      template<typename IG>
+      void onBindLFSUVOutside(const IG & ig,
+                              const LFSU & lfsu_s, const LFSV & lfsv_s,
+                              const LFSU & lfsu_n, const LFSV & lfsv_n)
+      {
+        xn.resize(lfsu_n.size());
+        al_sn.assign(lfsv_s.size(),lfsu_n.size(),0.0);
+        al_ns.assign(lfsv_n.size(),lfsu_s.size(),0.0);
+        al_nn.assign(lfsv_n.size(),lfsu_n.size(),0.0);
+      }
+
+      //! @}
+
+      //! Called when the local function space is about to be rebound or
+      //! discarded
+      //! @{
+      template<typename EG>
+      void onUnbindLFSUV(const EG & eg, const LFSU & lfsu, const LFSV & lfsv){
+        scatter(lfsv,lfsu,al);
+      }
+
+      template<typename IG>
+      void onUnbindLFSUVOutside(const IG & ig,
+                                const LFSU & lfsu_s, const LFSV & lfsv_s,
+                                const LFSU & lfsu_n, const LFSV & lfsv_n)
+      {
+        // the off-diagonal blocks matter for DOFs shared by both cells
+        scatter(lfsv_s,lfsu_n,al_sn);
+        scatter(lfsv_n,lfsu_s,al_ns);
+        scatter(lfsv_n,lfsu_n,al_nn);
+      }
+
+      //! @}
+
+      //! Methods for loading of the local function's coefficients
+      //! @{
+      void loadCoefficientsLFSUInside(const LFSU & lfsu){
+        lfsu.vread(*solution,xl);
+      }
+      void loadCoefficientsLFSUOutside(const LFSU & lfsun){
+        lfsun.vread(*solution,xn);
+      }
+      void loadCoefficientsLFSUCoupling(const LFSU & lfsu_c)
+      {DUNE_THROW(Dune::NotImplemented,"No coupling lfsu available for ");}
+      //! @}
+
+      //! Notifier functions, called immediately before and after assembling
+      //! @{
+      void preAssembly(){
+        diagonal->clear();
+      }
+
+      void postAssembly(){
+        if(local_assembler.doConstraintsPostProcessing){
+          typedef typename LocalAssembler::CV::const_iterator global_row_iterator;
+          const typename LocalAssembler::CV & cv = local_assembler.testConstraints();
+          for (global_row_iterator cit=cv.begin(); cit!=cv.end(); ++cit)
+            diagonal->setIdentityRow(cit->first);
+        }
+      }
+      //! @}
+
+      //! Assembling methods
+      //! @{
+
+      /** Assemble on a given cell without function spaces.
+
+          \return If true, the assembling for this cell is assumed to
+          be complete and the assembler continues with the next grid
+          cell.
+       */
+      template<typename EG>
+      bool assembleCell(const EG & eg)
+      {
+        return LocalAssembler::isNonOverlapping && eg.entity().partitionType() != Dune::InteriorEntity;
+      }
+
+      template<typename EG>
+      void assembleUVVolume(const EG & eg, const LFSU & lfsu, const LFSV & lfsv)
+      {
+        al_view.setWeight(local_assembler.weight);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaVolume>::
+          jacobian_volume(lop,eg,lfsu,xl,lfsv,al_view);
+      }
+
+      template<typename IG>
+      void assembleUVSkeleton(const IG & ig, const LFSU & lfsu_s, const LFSV & lfsv_s,
+                              const LFSU & lfsu_n, const LFSV & lfsv_n)
+      {
+        al_view.setWeight(local_assembler.weight);
+        al_sn_view.setWeight(local_assembler.weight);
+        al_ns_view.setWeight(local_assembler.weight);
+        al_nn_view.setWeight(local_assembler.weight);
+
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaSkeleton>::
+          jacobian_skeleton(lop,ig,lfsu_s,xl,lfsv_s,lfsu_n,xn,lfsv_n,al_view,al_sn_view,al_ns_view,al_nn_view);
+      }
+
+      template<typename IG>
+      void assembleUVBoundary(const IG & ig, const LFSU & lfsu_s, const LFSV & lfsv_s)
+      {
+        al_view.setWeight(local_assembler.weight);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaBoundary>::
+          jacobian_boundary(lop,ig,lfsu_s,xl,lfsv_s,al_view);
+      }
+
+      template<typename IG>
+      static void assembleUVEnrichedCoupling(const IG & ig,
+                                             const LFSU & lfsu_s, const LFSV & lfsv_s,
+                                             const LFSU & lfsu_n, const LFSV & lfsv_n,
+                                             const LFSU & lfsu_coupling, const LFSV & lfsv_coupling)
+      {DUNE_THROW(Dune::NotImplemented,"Assembling of coupling spaces is not implemented for ");}
+
+      template<typename EG>
+      void assembleUVVolumePostSkeleton(const EG & eg, const LFSU & lfsu, const LFSV & lfsv)
+      {
+        al_view.setWeight(local_assembler.weight);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaVolumePostSkeleton>::
+          jacobian_volume_post_skeleton(lop,eg,lfsu,xl,lfsv,al_view);
+      }
+
+      //! @}
+
+    private:
+
+      template<typename LFSV_, typename LFSU_, typename M>
+      void scatter(const LFSV_ & lfsv, const LFSU_ & lfsu, const M & localcontainer)
+      {
+        for (std::size_t i=0; i<lfsv.size(); ++i)
+          for (std::size_t j=0; j<lfsu.size(); ++j)
+            diagonal->add(lfsv.globalIndex(i),lfsu.globalIndex(j),localcontainer(i,j));
+      }
+
+      //! Reference to the wrapping local assembler object which
+      //! constructed this engine
+      const LocalAssembler & local_assembler;
+
+      //! Reference to the local operator
+      const LOP & lop;
+
+      //! Pointer to the current block diagonal in which to assemble
+      BlockDiagonal * diagonal;
+
+      //! Pointer to the current solution vector
+      const Solution * solution;
+
+      //! The local vectors and matrices as required for assembling
+      //! @{
+      typedef Dune::PDELab::TrialSpaceTag LocalTrialSpaceTag;
+
+      typedef Dune::PDELab::LocalVector<SolutionElement, LocalTrialSpaceTag> SolutionVector;
+      typedef Dune::PDELab::LocalMatrix<JacobianElement> JacobianMatrix;
+
+      SolutionVector xl;
+      SolutionVector xn;
+
+      JacobianMatrix al;
+      JacobianMatrix al_sn;
+      JacobianMatrix al_ns;
+      JacobianMatrix al_nn;
+
+      typename JacobianMatrix::WeightedAccumulationView al_view;
+      typename JacobianMatrix::WeightedAccumulationView al_sn_view;
+      typename JacobianMatrix::WeightedAccumulationView al_ns_view;
+      typename JacobianMatrix::WeightedAccumulationView al_nn_view;
+
+      //! @}
+
+    }; // End of class DefaultLocalBlockDiagonalAssemblerEngine
+
+  }
+}
+#endif
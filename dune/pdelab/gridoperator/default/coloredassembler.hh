@@ -0,0 +1,326 @@
+#ifndef DUNE_PDELAB_DEFAULT_COLOREDASSEMBLER_HH
+#define DUNE_PDELAB_DEFAULT_COLOREDASSEMBLER_HH
+
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/stdstreams.hh>
+#include <dune/pdelab/gridoperator/default/assembler.hh>
+
+namespace Dune{
+  namespace PDELab{
+
+    /**
+       \brief Thread parallel assembler for standard DUNE grids
+
+       The cells of the grid view are partitioned into colors such
+       that no two cells of the same color write to the same degree of
+       freedom. The colors are then processed one after another, and
+       the cells of one color are distributed across OpenMP threads.
+       Every thread owns its local function spaces and a copy of the
+       local assembler engine (and thereby its local scratch vectors
+       and matrices), all of which write directly into the global
+       containers.
+
+       Two cells conflict if they share a vertex. If the local
+       operator requires skeleton integrals, the footprint of a cell is
+       extended by its face neighbors, as skeleton terms also write
+       into the rows of the neighbor.
+
+       \note The local operator is shared by all threads and thus has
+       to be safe for concurrent calls of its const methods (in
+       particular, it must not use mutable caches like
+       LocalBasisCache). Constraints which couple degrees of freedom
+       outside the closure of a cell and its neighbors (e.g. hanging
+       node constraints) are not taken into account by the coloring.
+
+       The colors store entity seeds, the cells are recolored
+       automatically by the next assembly once the update count of the
+       trial space has changed, i.e. after the grid has been adapted and
+       the space updated.
+
+       An exception thrown while assembling a cell stops the remaining
+       cells from being assembled and is rethrown after the parallel
+       region. Dune::Exceptions keep their message but are rethrown as
+       Dune::Exception.
+
+       \note Without OpenMP support the colors are processed
+       sequentially, which yields the same result as DefaultAssembler.
+
+       * \tparam GFSU GridFunctionSpace for ansatz functions
+       * \tparam GFSV GridFunctionSpace for test functions
+       * \tparam nonoverlapping_mode Indicates whether assembling is done for overlap cells
+       */
+    template<typename GFSU, typename GFSV, bool nonoverlapping_mode=false>
+    class ColoredAssembler
+      : public DefaultAssembler<GFSU,GFSV,nonoverlapping_mode>
+    {
+      typedef DefaultAssembler<GFSU,GFSV,nonoverlapping_mode> Base;
+
+    public:
+
+      typedef typename Base::GV GV;
+      typedef typename Base::ElementIterator ElementIterator;
+      typedef typename Base::Element Element;
+      typedef typename Base::IntersectionIterator IntersectionIterator;
+      typedef typename GV::Traits::template Codim<0>::EntityPointer ElementPointer;
+      typedef typename Element::EntitySeed ElementSeed;
+      typedef typename Base::SizeType SizeType;
+
+      /**
+         \brief Constructor
+
+         \param gfsu_ The trial grid function space
+         \param gfsv_ The test grid function space
+         \param threads_ Number of threads to use, 0 selects the OpenMP default
+      */
+      ColoredAssembler (const GFSU& gfsu_, const GFSV& gfsv_, int threads_ = 0)
+        : Base(gfsu_,gfsv_), threads(threads_), cell_mapper(gfsu_.gridView()), updates(0)
+      {
+        update();
+      }
+
+      //! Recompute the coloring
+      /**
+         This is done by the next assembly anyway if the trial space
+         has been updated since the last coloring.
+       */
+      void update ()
+      {
+        recolor();
+      }
+
+      //! Number of colors used for the given kind of assembly
+      std::size_t colors (bool skeleton) const
+      {
+        if (updates != this->gfsu.updateCount())
+          recolor();
+        return skeleton ? skeleton_colors.size() : volume_colors.size();
+      }
+
+      //! Number of threads used for assembling
+      int threadCount () const
+      {
+#ifdef _OPENMP
+        return threads > 0 ? threads : omp_get_max_threads();
+#else
+        return 1;
+#endif
+      }
+
+      template<class LocalAssemblerEngine>
+      void assemble(LocalAssemblerEngine & assembler_engine) const
+      {
+        AssemblyPhaseTimer total_timer(assemblyProfile(),AssemblyPhase::total);
+
+        if (updates != this->gfsu.updateCount())
+          recolor();
+
+        // Notify assembler engine about oncoming assembly
+        assembler_engine.preAssembly();
+
+        const typename GV::Grid& grid = this->gfsu.gridView().grid();
+        bool failed = false;
+        Dune::Exception failure;
+
+        const bool skeleton = assembler_engine.requireUVSkeleton() || assembler_engine.requireVSkeleton();
+        const ColorContainer & cells = skeleton ? skeleton_colors : volume_colors;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threadCount())
+#endif
+        {
+          // Thread local state
+          typename Base::LFSU lfsu(this->gfsu);
+          typename Base::LFSV lfsv(this->gfsv);
+          typename Base::LFSU lfsun(this->gfsu);
+          typename Base::LFSV lfsvn(this->gfsv);
+          LocalAssemblerEngine engine(assembler_engine);
+          Dune::PDELab::MultiGeomUniqueIDMapper<GV> mapper(cell_mapper);
+          AssemblyProfile profile;
+
+          for (std::size_t c = 0; c < cells.size(); ++c)
+            {
+              const long n = cells[c].size();
+              // the implicit barrier at the end of the loop separates the colors
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,16)
+#endif
+              for (long i = 0; i < n; ++i)
+                {
+                  // an exception must not leave the parallel region, the
+                  // remaining cells are skipped once one has been caught
+#ifdef _OPENMP
+#pragma omp flush(failed)
+#endif
+                  if (failed)
+                    continue;
+                  std::string message;
+                  try
+                    {
+                      const ElementPointer ep(grid.entityPointer(cells[c][i]));
+                      this->assembleElement(engine,*ep,mapper,lfsu,lfsv,lfsun,lfsvn,profile);
+                      continue;
+                    }
+                  catch (Dune::Exception & e)
+                    {
+#ifdef _OPENMP
+#pragma omp critical(coloredassembler_failure)
+#endif
+                      if (!failed)
+                        {
+                          failure = e;
+                          failed = true;
+                        }
+                    }
+                  catch (std::exception & e)
+                    {
+                      message = e.what();
+                    }
+                  catch (...)
+                    {
+                      message = "unknown exception";
+                    }
+                  if (!message.empty())
+                    {
+#ifdef _OPENMP
+#pragma omp critical(coloredassembler_failure)
+#endif
+                      if (!failed)
+                        {
+                          failure.message("ColoredAssembler: " + message);
+                          failed = true;
+                        }
+                    }
+#ifdef _OPENMP
+#pragma omp flush(failed)
+#endif
+                }
+            }
+
+          if (AssemblyPhaseTimer::enabled)
+            {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+              assemblyProfile().merge(profile);
+            }
+        }
+
+        if (failed)
+          throw failure;
+
+        // Notify assembler engine that assembly is finished
+        AssemblyPhaseTimer constraints_timer(assemblyProfile(),AssemblyPhase::constraints);
+        assembler_engine.postAssembly();
+      }
+
+    private:
+
+      typedef std::vector<std::vector<ElementSeed> > ColorContainer;
+
+      //! Color the cells of the current grid view of the trial space
+      void recolor () const
+      {
+        const GV& gv = this->gfsu.gridView();
+
+        // Assign the unique cell ids in traversal order, so that all
+        // thread local copies of the mapper agree on them
+        for (ElementIterator it = gv.template begin<0>();
+             it!=gv.template end<0>(); ++it)
+          cell_mapper.map(*it);
+
+        computeColoring(false,volume_colors);
+        computeColoring(true,skeleton_colors);
+
+        Dune::dinfo << "ColoredAssembler: " << volume_colors.size()
+                    << " colors without and " << skeleton_colors.size()
+                    << " colors with skeleton terms" << std::endl;
+        updates = this->gfsu.updateCount();
+      }
+
+      //! Greedy coloring of the cells by their vertex footprint
+      void computeColoring (bool skeleton, ColorContainer & cells) const
+      {
+        const GV& gv = this->gfsu.gridView();
+        const typename GV::IndexSet& is = gv.indexSet();
+
+        // colors of all cells whose footprint contains a given vertex
+        std::vector<std::vector<std::size_t> > vertex_colors(is.size(GV::dimension));
+        // last cell that marked a color as forbidden
+        std::vector<std::size_t> forbidden;
+        std::vector<std::size_t> footprint;
+
+        cells.clear();
+        std::size_t stamp = 0;
+        for (ElementIterator it = gv.template begin<0>();
+             it!=gv.template end<0>(); ++it)
+          {
+            ++stamp;
+
+            // collect the vertices of the cell and, if required, of its face neighbors
+            footprint.clear();
+            addVertices(is,*it,footprint);
+            if (skeleton)
+              {
+                IntersectionIterator endit = gv.iend(*it);
+                for (IntersectionIterator iit = gv.ibegin(*it); iit!=endit; ++iit)
+                  if (iit->neighbor())
+                    addVertices(is,*(iit->outside()),footprint);
+              }
+
+            // mark the colors of all conflicting cells
+            for (std::size_t k = 0; k < footprint.size(); ++k)
+              {
+                const std::vector<std::size_t> & vc = vertex_colors[footprint[k]];
+                for (std::size_t l = 0; l < vc.size(); ++l)
+                  forbidden[vc[l]] = stamp;
+              }
+
+            // pick the first admissible color
+            std::size_t color = 0;
+            while (color < cells.size() && forbidden[color] == stamp)
+              ++color;
+            if (color == cells.size())
+              {
+                cells.push_back(std::vector<ElementPointer>());
+                forbidden.push_back(0);
+              }
+            cells[color].push_back(it->seed());
+
+            for (std::size_t k = 0; k < footprint.size(); ++k)
+              {
+                std::vector<std::size_t> & vc = vertex_colors[footprint[k]];
+                if (vc.empty() || vc.back() != color)
+                  vc.push_back(color);
+              }
+          }
+      }
+
+      static void addVertices (const typename GV::IndexSet& is, const Element& e,
+                               std::vector<std::size_t> & footprint)
+      {
+        const int dim = GV::dimension;
+        const int n = e.template count<dim>();
+        for (int i = 0; i < n; ++i)
+          footprint.push_back(is.subIndex(e,i,dim));
+      }
+
+      const int threads;
+      mutable Dune::PDELab::MultiGeomUniqueIDMapper<GV> cell_mapper;
+      mutable ColorContainer volume_colors;
+      mutable ColorContainer skeleton_colors;
+      //! update count of the trial space the coloring belongs to
+      mutable std::size_t updates;
+    };
+
+  }
+}
+#endif
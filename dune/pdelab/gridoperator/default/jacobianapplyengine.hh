@@ -53,6 +53,22 @@ namespace Dune{
           rn_view(rn,1.0)
       {}
 
+      /**
+         \brief Copy constructor
+
+         The copy writes into the same global containers as the
+         original, but owns its local scratch containers. This allows
+         several engines to run concurrently on disjoint sets of cells.
+      */
+      DefaultLocalJacobianApplyAssemblerEngine(const DefaultLocalJacobianApplyAssemblerEngine & other)
+        : LocalAssemblerEngineBase(other),
+          local_assembler(other.local_assembler), lop(other.lop),
+          residual(other.residual),
+          solution(other.solution),
+          rl_view(rl,1.0),
+          rn_view(rn,1.0)
+      {}
+
       //! Query methods for the global grid assembler
       //! @{
       bool requireSkeleton() const
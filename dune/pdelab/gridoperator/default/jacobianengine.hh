@@ -2,6 +2,7 @@
 #define DUNE_PDELAB_DEFAULT_JACOBIANENGINE_HH
 
 #include <dune/pdelab/gridoperator/common/localassemblerenginebase.hh>
+#include <dune/pdelab/gridoperator/common/volumebatch.hh>
 #include <dune/pdelab/gridoperatorspace/gridoperatorspaceutilities.hh>
 
 namespace Dune{
@@ -37,6 +38,10 @@ namespace Dune{
       typedef typename LA::Traits::Solution Solution;
       typedef typename Solution::ElementType SolutionElement;
 
+      //! The batch of cells handed to jacobian_volume_batch()
+      typedef VolumeBatch<typename LA::GridView::template Codim<0>::Entity,
+                          LFSU,LFSV,LOP::volumeBatchSize> Batch;
+
       /**
          \brief Constructor
 
@@ -55,6 +60,26 @@ namespace Dune{
           al_nn_view(al_nn,1.0)
       {}
 
+      /**
+         \brief Copy constructor
+
+         The copy writes into the same global containers as the
+         original, but owns its local scratch containers. This allows
+         several engines to run concurrently on disjoint sets of cells.
+      */
+      DefaultLocalJacobianAssemblerEngine(const DefaultLocalJacobianAssemblerEngine & other)
+        : LocalAssemblerEngineBase(other),
+          local_assembler(other.local_assembler), lop(other.lop),
+          invalid_jacobian(static_cast<Jacobian*>(0)),
+          invalid_solution(static_cast<Solution*>(0)),
+          jacobian(other.jacobian),
+          solution(other.solution),
+          al_view(al,1.0),
+          al_sn_view(al_sn,1.0),
+          al_ns_view(al_ns,1.0),
+          al_nn_view(al_nn,1.0)
+      {}
+
       //! Query methods for the global grid assembler
       //! @{
       bool requireSkeleton() const
@@ -69,6 +94,10 @@ namespace Dune{
       { return local_assembler.doAlphaBoundary(); }
       bool requireUVVolumePostSkeleton() const
       { return local_assembler.doAlphaVolumePostSkeleton(); }
+      bool requireUVVolumeBatch() const
+      { return local_assembler.doAlphaVolumeBatch() && local_assembler.doAlphaVolume(); }
+      std::size_t volumeBatchSize() const
+      { return Batch::lanes; }
       //! @}
 
       //! Public access to the wrapping local assembler
@@ -113,7 +142,7 @@ namespace Dune{
       //! @{
       template<typename EG>
       void onUnbindLFSUV(const EG & eg, const LFSU & lfsu, const LFSV & lfsv){
-        local_assembler.etadd(lfsv,lfsu,al,*jacobian);
+        local_assembler.etadd(lfsv,lfsu,al,*jacobian,accessor_scratch);
       }
 
       template<typename IG>
@@ -121,9 +150,58 @@ namespace Dune{
                                 const LFSU & lfsu_s, const LFSV & lfsv_s,
                                 const LFSU & lfsu_n, const LFSV & lfsv_n)
       {
-        local_assembler.etadd(lfsv_s,lfsu_n,al_sn,*jacobian);
-        local_assembler.etadd(lfsv_n,lfsu_s,al_ns,*jacobian);
-        local_assembler.etadd(lfsv_n,lfsu_n,al_nn,*jacobian);
+        local_assembler.etadd(lfsv_s,lfsu_n,al_sn,*jacobian,accessor_scratch);
+        local_assembler.etadd(lfsv_n,lfsu_s,al_ns,*jacobian,accessor_scratch);
+        local_assembler.etadd(lfsv_n,lfsu_n,al_nn,*jacobian,accessor_scratch);
+      }
+
+      //! @}
+
+      //! Callbacks for batched volume assembly
+      //! @{
+
+      //! All cells of a batch need spaces of the same size
+      bool acceptVolumeBatchLane(const LFSU & lfsu, const LFSV & lfsv) const
+      {
+        return xb.size() == lfsu.size() && ab.nrows() == lfsv.size();
+      }
+
+      template<typename EG>
+      void onBindLFSUVBatch(std::size_t lane, const EG & eg, const LFSU & lfsu, const LFSV & lfsv)
+      {
+        if (lane == 0)
+          {
+            xb.assign(lfsu.size(),0.0);
+            ab.assign(lfsv.size(),lfsu.size(),0.0);
+          }
+        batch.set(lane,eg.entity(),lfsu,lfsv);
+        xl.resize(lfsu.size());
+        lfsu.vread(*solution,xl);
+        for (std::size_t i = 0; i < xl.size(); ++i)
+          xb[i][lane] = xl.base()[i];
+      }
+
+      void assembleUVVolumeBatch(std::size_t lanes)
+      {
+        batch.setSize(lanes);
+        for (std::size_t i = 0; i < xb.size(); ++i)
+          for (std::size_t k = lanes; k < Batch::lanes; ++k)
+            xb[i][k] = xb[i][0];
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaVolumeBatch>::
+          jacobian_volume_batch(lop,batch,xb,ab);
+      }
+
+      //! Load the coefficients and the weighted volume jacobian of the lane into xl and al
+      template<typename EG>
+      void onSelectLFSUVBatchLane(std::size_t lane, const EG & eg, const LFSU & lfsu, const LFSV & lfsv)
+      {
+        xl.resize(lfsu.size());
+        for (std::size_t i = 0; i < xl.size(); ++i)
+          xl.base()[i] = xb[i][lane];
+        al.assign(lfsv.size(),lfsu.size(),0.0);
+        for (std::size_t i = 0; i < ab.nrows(); ++i)
+          for (std::size_t j = 0; j < ab.ncols(); ++j)
+            al.getEntry(i,j) = local_assembler.weight * ab(i,j)[lane];
       }
 
       //! @}
@@ -258,6 +336,18 @@ namespace Dune{
       typename JacobianMatrix::WeightedAccumulationView al_ns_view;
       typename JacobianMatrix::WeightedAccumulationView al_nn_view;
 
+      //! Storage of the matrix accessors, reused for all elements
+      typename LA::Traits::MatrixBackend::template AccessorScratch<JacobianElement> accessor_scratch;
+
+      //! @}
+
+      //! The containers for batched volume assembly
+      //! @{
+      Batch batch;
+      //! Coefficients of all lanes
+      BatchVector<SolutionElement,Batch::lanes> xb;
+      //! Jacobians of all lanes
+      BatchMatrix<JacobianElement,Batch::lanes> ab;
       //! @}
 
     }; // End of class DefaultLocalJacobianAssemblerEngine
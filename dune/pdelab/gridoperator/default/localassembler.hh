@@ -5,6 +5,8 @@
 #include <dune/pdelab/gridoperator/default/patternengine.hh>
 #include <dune/pdelab/gridoperator/default/jacobianengine.hh>
 #include <dune/pdelab/gridoperator/default/jacobianapplyengine.hh>
+#include <dune/pdelab/gridoperator/default/blockdiagonalengine.hh>
+#include <dune/pdelab/gridoperator/default/residualjacobianengine.hh>
 #include <dune/pdelab/gridoperator/common/assemblerutilities.hh>
 #include <dune/pdelab/common/typetree.hh>
 
@@ -71,24 +73,30 @@ namespace Dune{
       typedef DefaultLocalResidualAssemblerEngine<DefaultLocalAssembler> LocalResidualAssemblerEngine;
       typedef DefaultLocalJacobianAssemblerEngine<DefaultLocalAssembler> LocalJacobianAssemblerEngine;
       typedef DefaultLocalJacobianApplyAssemblerEngine<DefaultLocalAssembler> LocalJacobianApplyAssemblerEngine;
+      typedef DefaultLocalBlockDiagonalAssemblerEngine<DefaultLocalAssembler> LocalBlockDiagonalAssemblerEngine;
+      typedef DefaultLocalResidualJacobianAssemblerEngine<DefaultLocalAssembler> LocalResidualJacobianAssemblerEngine;
 
       friend class DefaultLocalPatternAssemblerEngine<DefaultLocalAssembler>;
       friend class DefaultLocalResidualAssemblerEngine<DefaultLocalAssembler>;
       friend class DefaultLocalJacobianAssemblerEngine<DefaultLocalAssembler>;
       friend class DefaultLocalJacobianApplyAssemblerEngine<DefaultLocalAssembler>;
+      friend class DefaultLocalBlockDiagonalAssemblerEngine<DefaultLocalAssembler>;
+      friend class DefaultLocalResidualJacobianAssemblerEngine<DefaultLocalAssembler>;
       //! @}
 
       //! Constructor with empty constraints
       DefaultLocalAssembler (LOP & lop_)
         : lop(lop_),  weight(1.0), doConstraintsPostProcessing(true),
-          pattern_engine(*this), residual_engine(*this), jacobian_engine(*this), jacobian_apply_engine(*this)
+          pattern_engine(*this), residual_engine(*this), jacobian_engine(*this), jacobian_apply_engine(*this),
+          block_diagonal_engine(*this), residual_jacobian_engine(*this)
       {}
 
       //! Constructor for non trivial constraints
       DefaultLocalAssembler (LOP & lop_, const CU& cu_, const CV& cv_)
         : Base(cu_, cv_),
           lop(lop_),  weight(1.0), doConstraintsPostProcessing(true),
-          pattern_engine(*this), residual_engine(*this), jacobian_engine(*this), jacobian_apply_engine(*this)
+          pattern_engine(*this), residual_engine(*this), jacobian_engine(*this), jacobian_apply_engine(*this),
+          block_diagonal_engine(*this), residual_jacobian_engine(*this)
       {}
 
       //! Notifies the local assembler about the current time of
@@ -154,6 +162,27 @@ namespace Dune{
         return jacobian_apply_engine;
       }
 
+      //! Returns a reference to the requested engine. This engine is
+      //! completely configured and ready to use.
+      LocalBlockDiagonalAssemblerEngine & localBlockDiagonalAssemblerEngine
+      (typename LocalBlockDiagonalAssemblerEngine::BlockDiagonal & d, const typename Traits::Solution & x)
+      {
+        block_diagonal_engine.setBlockDiagonal(d);
+        block_diagonal_engine.setSolution(x);
+        return block_diagonal_engine;
+      }
+
+      //! Returns a reference to the requested engine. This engine is
+      //! completely configured and ready to use.
+      LocalResidualJacobianAssemblerEngine & localResidualJacobianAssemblerEngine
+      (typename Traits::Residual & r, typename Traits::Jacobian & a, const typename Traits::Solution & x)
+      {
+        residual_jacobian_engine.setResidual(r);
+        residual_jacobian_engine.setJacobian(a);
+        residual_jacobian_engine.setSolution(x);
+        return residual_jacobian_engine;
+      }
+
       //! @}
 
       //! \brief Query methods for the assembler engines. Theses methods
@@ -161,6 +190,7 @@ namespace Dune{
       //! implementations of query methods in the engines;
       //! @{
       static bool doAlphaVolume() { return LOP::doAlphaVolume; }
+      static bool doAlphaVolumeBatch() { return LOP::doAlphaVolumeBatch; }
       static bool doLambdaVolume() { return LOP::doLambdaVolume; }
       static bool doAlphaSkeleton() { return LOP::doAlphaSkeleton; }
       static bool doLambdaSkeleton() { return LOP::doLambdaSkeleton; }
@@ -201,6 +231,8 @@ namespace Dune{
       LocalResidualAssemblerEngine residual_engine;
       LocalJacobianAssemblerEngine jacobian_engine;
       LocalJacobianApplyAssemblerEngine jacobian_apply_engine;
+      LocalBlockDiagonalAssemblerEngine block_diagonal_engine;
+      LocalResidualJacobianAssemblerEngine residual_jacobian_engine;
       //! @}
 
     };
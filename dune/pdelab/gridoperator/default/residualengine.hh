@@ -2,6 +2,7 @@
 #define DUNE_PDELAB_DEFAULT_RESIDUALENGINE_HH
 
 #include <dune/pdelab/gridoperator/common/localassemblerenginebase.hh>
+#include <dune/pdelab/gridoperator/common/volumebatch.hh>
 #include <dune/pdelab/gridoperatorspace/gridoperatorspaceutilities.hh>
 #include <dune/pdelab/constraints/constraints.hh>
 
@@ -38,6 +39,10 @@ namespace Dune{
       typedef typename LA::LFSU LFSU;
       typedef typename LA::LFSV LFSV;
 
+      //! The batch of cells handed to alpha_volume_batch()
+      typedef VolumeBatch<typename LA::GridView::template Codim<0>::Entity,
+                          LFSU,LFSV,LOP::volumeBatchSize> Batch;
+
       /**
          \brief Constructor
 
@@ -53,6 +58,23 @@ namespace Dune{
           rn_view(rn,1.0)
       {}
 
+      /**
+         \brief Copy constructor
+
+         The copy writes into the same global containers as the
+         original, but owns its local scratch containers. This allows
+         several engines to run concurrently on disjoint sets of cells.
+      */
+      DefaultLocalResidualAssemblerEngine(const DefaultLocalResidualAssemblerEngine & other)
+        : LocalAssemblerEngineBase(other),
+          local_assembler(other.local_assembler), lop(other.lop),
+          invalid_residual(static_cast<Residual*>(0)), invalid_solution(static_cast<Solution*>(0)),
+          residual(other.residual),
+          solution(other.solution),
+          rl_view(rl,1.0),
+          rn_view(rn,1.0)
+      {}
+
       //! Query methods for the global grid assembler
       //! @{
       bool requireSkeleton() const
@@ -75,6 +97,10 @@ namespace Dune{
       { return local_assembler.doAlphaVolumePostSkeleton(); }
       bool requireVVolumePostSkeleton() const
       { return local_assembler.doLambdaVolumePostSkeleton(); }
+      bool requireUVVolumeBatch() const
+      { return local_assembler.doAlphaVolumeBatch() && local_assembler.doAlphaVolume(); }
+      std::size_t volumeBatchSize() const
+      { return Batch::lanes; }
       //! @}
 
       //! Public access to the wrapping local assembler
@@ -155,6 +181,54 @@ namespace Dune{
       }
       //! @}
 
+      //! Callbacks for batched volume assembly
+      //! @{
+
+      //! All cells of a batch need spaces of the same size
+      bool acceptVolumeBatchLane(const LFSU & lfsu, const LFSV & lfsv) const
+      {
+        return xb.size() == lfsu.size() && rb.size() == lfsv.size();
+      }
+
+      template<typename EG>
+      void onBindLFSUVBatch(std::size_t lane, const EG & eg, const LFSU & lfsu, const LFSV & lfsv)
+      {
+        if (lane == 0)
+          {
+            xb.assign(lfsu.size(),0.0);
+            rb.assign(lfsv.size(),0.0);
+          }
+        batch.set(lane,eg.entity(),lfsu,lfsv);
+        xl.resize(lfsu.size());
+        lfsu.vread(*solution,xl);
+        for (std::size_t i = 0; i < xl.size(); ++i)
+          xb[i][lane] = xl.base()[i];
+      }
+
+      void assembleUVVolumeBatch(std::size_t lanes)
+      {
+        batch.setSize(lanes);
+        for (std::size_t i = 0; i < xb.size(); ++i)
+          for (std::size_t k = lanes; k < Batch::lanes; ++k)
+            xb[i][k] = xb[i][0];
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaVolumeBatch>::
+          alpha_volume_batch(lop,batch,xb,rb);
+      }
+
+      //! Load the coefficients and the weighted volume residual of the lane into xl and rl
+      template<typename EG>
+      void onSelectLFSUVBatchLane(std::size_t lane, const EG & eg, const LFSU & lfsu, const LFSV & lfsv)
+      {
+        xl.resize(lfsu.size());
+        for (std::size_t i = 0; i < xl.size(); ++i)
+          xl.base()[i] = xb[i][lane];
+        rl.resize(lfsv.size());
+        for (std::size_t i = 0; i < rl.size(); ++i)
+          rl.base()[i] = local_assembler.weight * rb[i][lane];
+      }
+
+      //! @}
+
       //! Methods for loading of the local function's coefficients
       //! @{
       void loadCoefficientsLFSUInside(const LFSU & lfsu_s){
@@ -321,6 +395,15 @@ namespace Dune{
       typename ResidualVector::WeightedAccumulationView rn_view;
       //! @}
 
+      //! The containers for batched volume assembly
+      //! @{
+      Batch batch;
+      //! Coefficients of all lanes
+      BatchVector<SolutionElement,Batch::lanes> xb;
+      //! Residuals of all lanes
+      BatchVector<ResidualElement,Batch::lanes> rb;
+      //! @}
+
     }; // End of class DefaultLocalResidualAssemblerEngine
 
   }
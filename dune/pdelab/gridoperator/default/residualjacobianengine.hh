@@ -0,0 +1,415 @@
+#ifndef DUNE_PDELAB_DEFAULT_RESIDUALJACOBIANENGINE_HH
+#define DUNE_PDELAB_DEFAULT_RESIDUALJACOBIANENGINE_HH
+
+#include <dune/pdelab/gridoperator/common/localassemblerenginebase.hh>
+#include <dune/pdelab/gridoperatorspace/gridoperatorspaceutilities.hh>
+#include <dune/pdelab/constraints/constraints.hh>
+
+namespace Dune{
+  namespace PDELab{
+
+    /**
+       \brief The local assembler engine for DUNE grids which
+       assembles the residual vector and the jacobian matrix in a
+       single grid traversal
+
+       The local function spaces are bound and the local coefficients
+       are loaded only once per cell and intersection; the local
+       operator is then asked for both its residual and its jacobian
+       contributions.
+
+       \tparam LA The local assembler
+
+    */
+    template<typename LA>
+    class DefaultLocalResidualJacobianAssemblerEngine
+      : public LocalAssemblerEngineBase
+    {
+    public:
+      //! The type of the wrapping local assembler
+      typedef LA LocalAssembler;
+
+      //! The type of the local operator
+      typedef typename LA::LocalOperator LOP;
+
+      //! The local function spaces
+      typedef typename LA::LFSU LFSU;
+      typedef typename LA::LFSV LFSV;
+
+      //! The type of the residual vector
+      typedef typename LA::Traits::Residual Residual;
+      typedef typename Residual::ElementType ResidualElement;
+
+      //! The type of the jacobian matrix
+      typedef typename LA::Traits::Jacobian Jacobian;
+      typedef typename Jacobian::ElementType JacobianElement;
+
+      //! The type of the solution vector
+      typedef typename LA::Traits::Solution Solution;
+      typedef typename Solution::ElementType SolutionElement;
+
+      /**
+         \brief Constructor
+
+         \param [in] local_assembler_ The local assembler object which
+         creates this engine
+      */
+      DefaultLocalResidualJacobianAssemblerEngine(const LocalAssembler & local_assembler_)
+        : local_assembler(local_assembler_), lop(local_assembler_.lop),
+          residual(static_cast<Residual*>(0)),
+          jacobian(static_cast<Jacobian*>(0)),
+          solution(static_cast<Solution*>(0)),
+          rl_view(rl,1.0),
+          rn_view(rn,1.0),
+          al_view(al,1.0),
+          al_sn_view(al_sn,1.0),
+          al_ns_view(al_ns,1.0),
+          al_nn_view(al_nn,1.0)
+      {}
+
+      /**
+         \brief Copy constructor
+
+         The copy writes into the same global containers as the
+         original, but owns its local scratch containers. This allows
+         several engines to run concurrently on disjoint sets of cells.
+      */
+      DefaultLocalResidualJacobianAssemblerEngine(const DefaultLocalResidualJacobianAssemblerEngine & other)
+        : LocalAssemblerEngineBase(other),
+          local_assembler(other.local_assembler), lop(other.lop),
+          residual(other.residual),
+          jacobian(other.jacobian),
+          solution(other.solution),
+          rl_view(rl,1.0),
+          rn_view(rn,1.0),
+          al_view(al,1.0),
+          al_sn_view(al_sn,1.0),
+          al_ns_view(al_ns,1.0),
+          al_nn_view(al_nn,1.0)
+      {}
+
+      //! Query methods for the global grid assembler
+      //! @{
+      bool requireSkeleton() const
+      { return ( local_assembler.doAlphaSkeleton() || local_assembler.doLambdaSkeleton() ); }
+      bool requireSkeletonTwoSided() const
+      { return local_assembler.doSkeletonTwoSided(); }
+      bool requireUVVolume() const
+      { return local_assembler.doAlphaVolume(); }
+      bool requireVVolume() const
+      { return local_assembler.doLambdaVolume(); }
+      bool requireUVSkeleton() const
+      { return local_assembler.doAlphaSkeleton(); }
+      bool requireVSkeleton() const
+      { return local_assembler.doLambdaSkeleton(); }
+      bool requireUVBoundary() const
+      { return local_assembler.doAlphaBoundary(); }
+      bool requireVBoundary() const
+      { return local_assembler.doLambdaBoundary(); }
+      bool requireUVVolumePostSkeleton() const
+      { return local_assembler.doAlphaVolumePostSkeleton(); }
+      bool requireVVolumePostSkeleton() const
+      { return local_assembler.doLambdaVolumePostSkeleton(); }
+      //! @}
+
+      //! Public access to the wrapping local assembler
+      const LocalAssembler & localAssembler() const { return local_assembler; }
+
+      //! Set current residual vector. Should be called prior to
+      //! assembling.
+      void setResidual(Residual & residual_){
+        residual = &residual_;
+      }
+
+      //! Set current jacobian matrix. Should be called prior to
+      //! assembling.
+      void setJacobian(Jacobian & jacobian_){
+        jacobian = &jacobian_;
+      }
+
+      //! Set current solution vector. Should be called prior to
+      //! assembling.
+      void setSolution(const Solution & solution_){
+        solution = &solution_;
+      }
+
+      //! Called immediately after binding of local function space in
+      //! global assembler.
+      //! @{
+      template<typename EG>
+      void onBindLFSUV(const EG & eg, const LFSU & lfsu, const LFSV & lfsv){
+        xl.resize(lfsu.size());
+        al.assign(lfsv.size(),lfsu.size(),0.0);
+      }
+
+      template<typename EG>
+      void onBindLFSV(const EG & eg, const LFSV & lfsv){
+        rl.assign(lfsv.size(),0.0);
+      }
+
+      template<typename IG>
+      void onBindLFSUVInside(const IG & ig, const LFSU & lfsu, const LFSV & lfsv){
+        xl.resize(lfsu.size());
+      }
+
+      template<typename IG>
+      void onBindLFSUVOutside(const IG & ig,
+                              const LFSU & lfsu_s, const LFSV & lfsv_s,
+                              const LFSU & lfsu_n, const LFSV & lfsv_n)
+      {
+        xn.resize(lfsu_n.size());
+        al_sn.assign(lfsv_s.size(),lfsu_n.size(),0.0);
+        al_ns.assign(lfsv_n.size(),lfsu_s.size(),0.0);
+        al_nn.assign(lfsv_n.size(),lfsu_n.size(),0.0);
+      }
+
+      template<typename IG>
+      void onBindLFSVInside(const IG & ig, const LFSV & lfsv){
+        rl.assign(lfsv.size(),0.0);
+      }
+
+      template<typename IG>
+      void onBindLFSVOutside(const IG & ig,
+                             const LFSV & lfsv_s,
+                             const LFSV & lfsv_n)
+      {
+        rn.assign(lfsv_n.size(),0.0);
+      }
+
+      //! @}
+
+      //! Called when the local function space is about to be rebound or
+      //! discarded
+      //! @{
+      template<typename EG>
+      void onUnbindLFSUV(const EG & eg, const LFSU & lfsu, const LFSV & lfsv){
+        local_assembler.etadd(lfsv,lfsu,al,*jacobian,accessor_scratch);
+      }
+
+      template<typename EG>
+      void onUnbindLFSV(const EG & eg, const LFSV & lfsv){
+        lfsv.vadd(rl,*residual);
+      }
+
+      template<typename IG>
+      void onUnbindLFSUVOutside(const IG & ig,
+                                const LFSU & lfsu_s, const LFSV & lfsv_s,
+                                const LFSU & lfsu_n, const LFSV & lfsv_n)
+      {
+        local_assembler.etadd(lfsv_s,lfsu_n,al_sn,*jacobian,accessor_scratch);
+        local_assembler.etadd(lfsv_n,lfsu_s,al_ns,*jacobian,accessor_scratch);
+        local_assembler.etadd(lfsv_n,lfsu_n,al_nn,*jacobian,accessor_scratch);
+      }
+
+      template<typename IG>
+      void onUnbindLFSVInside(const IG & ig, const LFSV & lfsv){
+        lfsv.vadd(rl,*residual);
+      }
+
+      template<typename IG>
+      void onUnbindLFSVOutside(const IG & ig,
+                               const LFSV & lfsv_s,
+                               const LFSV & lfsv_n)
+      {
+        lfsv_n.vadd(rn,*residual);
+      }
+      //! @}
+
+      //! Methods for loading of the local function's coefficients
+      //! @{
+      void loadCoefficientsLFSUInside(const LFSU & lfsu_s){
+        lfsu_s.vread(*solution,xl);
+      }
+      void loadCoefficientsLFSUOutside(const LFSU & lfsu_n){
+        lfsu_n.vread(*solution,xn);
+      }
+      void loadCoefficientsLFSUCoupling(const LFSU & lfsu_c)
+      {DUNE_THROW(Dune::NotImplemented,"No coupling lfsu available for ");}
+      //! @}
+
+      //! Notifier functions, called immediately before and after assembling
+      //! @{
+
+      void postAssembly(){
+        if(local_assembler.doConstraintsPostProcessing){
+          Dune::PDELab::constrain_residual(*(local_assembler.pconstraintsv),*residual);
+          local_assembler.handle_dirichlet_constraints(*jacobian);
+        }
+      }
+
+      //! @}
+
+      //! Assembling methods
+      //! @{
+
+      /** Assemble on a given cell without function spaces.
+
+          \return If true, the assembling for this cell is assumed to
+          be complete and the assembler continues with the next grid
+          cell.
+       */
+      template<typename EG>
+      bool assembleCell(const EG & eg)
+      {
+        return LocalAssembler::isNonOverlapping && eg.entity().partitionType() != Dune::InteriorEntity;
+      }
+
+      template<typename EG>
+      void assembleUVVolume(const EG & eg, const LFSU & lfsu, const LFSV & lfsv)
+      {
+        rl_view.setWeight(local_assembler.weight);
+        al_view.setWeight(local_assembler.weight);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaVolume>::
+          alpha_volume(lop,eg,lfsu,xl,lfsv,rl_view);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaVolume>::
+          jacobian_volume(lop,eg,lfsu,xl,lfsv,al_view);
+      }
+
+      template<typename EG>
+      void assembleVVolume(const EG & eg, const LFSV & lfsv)
+      {
+        rl_view.setWeight(local_assembler.weight);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doLambdaVolume>::
+          lambda_volume(lop,eg,lfsv,rl_view);
+      }
+
+      template<typename IG>
+      void assembleUVSkeleton(const IG & ig, const LFSU & lfsu_s, const LFSV & lfsv_s,
+                              const LFSU & lfsu_n, const LFSV & lfsv_n)
+      {
+        rl_view.setWeight(local_assembler.weight);
+        rn_view.setWeight(local_assembler.weight);
+        al_view.setWeight(local_assembler.weight);
+        al_sn_view.setWeight(local_assembler.weight);
+        al_ns_view.setWeight(local_assembler.weight);
+        al_nn_view.setWeight(local_assembler.weight);
+
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaSkeleton>::
+          alpha_skeleton(lop,ig,
+                         lfsu_s,xl,lfsv_s,
+                         lfsu_n,xn,lfsv_n,
+                         rl_view,rn_view);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaSkeleton>::
+          jacobian_skeleton(lop,ig,lfsu_s,xl,lfsv_s,lfsu_n,xn,lfsv_n,al_view,al_sn_view,al_ns_view,al_nn_view);
+      }
+
+      template<typename IG>
+      void assembleVSkeleton(const IG & ig, const LFSV & lfsv_s, const LFSV & lfsv_n)
+      {
+        rl_view.setWeight(local_assembler.weight);
+        rn_view.setWeight(local_assembler.weight);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doLambdaSkeleton>::
+          lambda_skeleton(lop, ig, lfsv_s, lfsv_n, rl_view, rn_view);
+      }
+
+      template<typename IG>
+      void assembleUVBoundary(const IG & ig, const LFSU & lfsu_s, const LFSV & lfsv_s)
+      {
+        rl_view.setWeight(local_assembler.weight);
+        al_view.setWeight(local_assembler.weight);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaBoundary>::
+          alpha_boundary(lop,ig,lfsu_s,xl,lfsv_s,rl_view);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaBoundary>::
+          jacobian_boundary(lop,ig,lfsu_s,xl,lfsv_s,al_view);
+      }
+
+      template<typename IG>
+      void assembleVBoundary(const IG & ig, const LFSV & lfsv_s)
+      {
+        rl_view.setWeight(local_assembler.weight);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doLambdaBoundary>::
+          lambda_boundary(lop,ig,lfsv_s,rl_view);
+      }
+
+      template<typename IG>
+      static void assembleUVEnrichedCoupling(const IG & ig,
+                                             const LFSU & lfsu_s, const LFSV & lfsv_s,
+                                             const LFSU & lfsu_n, const LFSV & lfsv_n,
+                                             const LFSU & lfsu_coupling, const LFSV & lfsv_coupling)
+      {DUNE_THROW(Dune::NotImplemented,"Assembling of coupling spaces is not implemented for ");}
+
+      template<typename IG>
+      static void assembleVEnrichedCoupling(const IG & ig,
+                                            const LFSV & lfsv_s,
+                                            const LFSV & lfsv_n,
+                                            const LFSV & lfsv_coupling)
+      {DUNE_THROW(Dune::NotImplemented,"Assembling of coupling spaces is not implemented for ");}
+
+      template<typename EG>
+      void assembleUVVolumePostSkeleton(const EG & eg, const LFSU & lfsu, const LFSV & lfsv)
+      {
+        rl_view.setWeight(local_assembler.weight);
+        al_view.setWeight(local_assembler.weight);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaVolumePostSkeleton>::
+          alpha_volume_post_skeleton(lop,eg,lfsu,xl,lfsv,rl_view);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doAlphaVolumePostSkeleton>::
+          jacobian_volume_post_skeleton(lop,eg,lfsu,xl,lfsv,al_view);
+      }
+
+      template<typename EG>
+      void assembleVVolumePostSkeleton(const EG & eg, const LFSV & lfsv)
+      {
+        rl_view.setWeight(local_assembler.weight);
+        Dune::PDELab::LocalAssemblerCallSwitch<LOP,LOP::doLambdaVolumePostSkeleton>::
+          lambda_volume_post_skeleton(lop,eg,lfsv,rl_view);
+      }
+
+      //! @}
+
+    private:
+      //! Reference to the wrapping local assembler object which
+      //! constructed this engine
+      const LocalAssembler & local_assembler;
+
+      //! Reference to the local operator
+      const LOP & lop;
+
+      //! Pointer to the current residual vector in which to assemble
+      Residual * residual;
+
+      //! Pointer to the current jacobian matrix in which to assemble
+      Jacobian * jacobian;
+
+      //! Pointer to the current solution vector
+      const Solution * solution;
+
+      //! The local vectors and matrices as required for assembling
+      //! @{
+      typedef Dune::PDELab::TrialSpaceTag LocalTrialSpaceTag;
+      typedef Dune::PDELab::TestSpaceTag LocalTestSpaceTag;
+
+      typedef Dune::PDELab::LocalVector<SolutionElement, LocalTrialSpaceTag> SolutionVector;
+      typedef Dune::PDELab::LocalVector<ResidualElement, LocalTestSpaceTag> ResidualVector;
+      typedef Dune::PDELab::LocalMatrix<JacobianElement> JacobianMatrix;
+
+      //! Inside local coefficients
+      SolutionVector xl;
+      //! Outside local coefficients
+      SolutionVector xn;
+      //! Inside local residual
+      ResidualVector rl;
+      //! Outside local residual
+      ResidualVector rn;
+
+      JacobianMatrix al;
+      JacobianMatrix al_sn;
+      JacobianMatrix al_ns;
+      JacobianMatrix al_nn;
+
+      typename ResidualVector::WeightedAccumulationView rl_view;
+      typename ResidualVector::WeightedAccumulationView rn_view;
+      typename JacobianMatrix::WeightedAccumulationView al_view;
+      typename JacobianMatrix::WeightedAccumulationView al_sn_view;
+      typename JacobianMatrix::WeightedAccumulationView al_ns_view;
+      typename JacobianMatrix::WeightedAccumulationView al_nn_view;
+
+      //! Storage of the matrix accessors, reused for all elements
+      typename LA::Traits::MatrixBackend::template AccessorScratch<JacobianElement> accessor_scratch;
+
+      //! @}
+
+    }; // End of class DefaultLocalResidualJacobianAssemblerEngine
+
+  }
+}
+#endif
@@ -2,8 +2,10 @@
 #define DUNE_PDELAB_GRIDOPERATOR_HH
 
 #include <dune/pdelab/gridoperator/common/gridoperatorutilities.hh>
+#include <dune/pdelab/gridoperator/common/patterncache.hh>
 #include <dune/pdelab/gridoperator/default/localassembler.hh>
 #include <dune/pdelab/gridoperator/default/assembler.hh>
+#include <dune/pdelab/gridoperator/default/coloredassembler.hh>
 #include <dune/pdelab/gridfunctionspace/interpolate.hh>
 #include <dune/common/tupleutility.hh>
 
@@ -22,19 +24,21 @@ namespace Dune{
        \tparam CU   Constraints maps for the individual dofs (trial space)
        \tparam CV   Constraints maps for the individual dofs (test space)
        \tparam nonoverlapping_mode Switch for nonoverlapping grids
+       \tparam GA   The global assembler, e.g. DefaultAssembler or ColoredAssembler
 
     */
     template<typename GFSU, typename GFSV, typename LOP,
              typename MB, typename DF, typename RF, typename JF,
              typename CU=Dune::PDELab::EmptyTransformation,
              typename CV=Dune::PDELab::EmptyTransformation,
-             bool nonoverlapping_mode = false>
+             bool nonoverlapping_mode = false,
+             typename GA = DefaultAssembler<GFSU,GFSV,nonoverlapping_mode> >
     class GridOperator
     {
     public:
 
       //! The global assembler type
-      typedef DefaultAssembler<GFSU,GFSV,nonoverlapping_mode> Assembler;
+      typedef GA Assembler;
 
       //! The type of the domain (solution).
       typedef typename Dune::PDELab::BackendVectorSelector<GFSU,DF>::Type Domain;
@@ -46,6 +50,12 @@ namespace Dune{
       //! The sparsity pattern container for the jacobian matrix
       typedef typename MB::Pattern Pattern;
 
+      //! The container for the element diagonal blocks of the jacobian
+      typedef ElementBlockDiagonal<JF> BlockDiagonal;
+
+      //! The cache type for sparsity patterns shared between grid operators
+      typedef SparsityPatternCache<Pattern> PatternCache;
+
       //! The local assembler type
       typedef DefaultLocalAssembler<GridOperator,LOP,nonoverlapping_mode>
       LocalAssembler;
@@ -61,12 +71,12 @@ namespace Dune{
 
       //! Constructor for non trivial constraints
       GridOperator(const GFSU & gfsu_, const CU & cu_, const GFSV & gfsv_, const CV & cv_, LOP & lop_ )
-        : global_assembler(gfsu_,gfsv_), local_assembler(lop_, cu_, cv_)
+        : global_assembler(gfsu_,gfsv_), local_assembler(lop_, cu_, cv_), pattern_cache(0)
       {}
 
       //! Constructor for empty constraints
       GridOperator(const GFSU & gfsu_, const GFSV & gfsv_, LOP & lop_)
-        : global_assembler(gfsu_,gfsv_), local_assembler(lop_)
+        : global_assembler(gfsu_,gfsv_), local_assembler(lop_), pattern_cache(0)
       {}
 
       //! Get the trial grid function space
@@ -139,11 +149,44 @@ namespace Dune{
         Dune::PDELab::copy_nonconstrained_dofs(local_assembler.trialConstraints(),xold,x);
       }
 
+      //! Share sparsity patterns with other grid operators through the given cache
+      /**
+       * Pass a null pointer to detach the grid operator from its cache.
+       * The cache must outlive the grid operator.
+       */
+      void setPatternCache(PatternCache * cache)
+      {
+        pattern_cache = cache;
+      }
+
+      //! The sparsity pattern cache, null if none has been set
+      PatternCache * patternCache() const
+      {
+        return pattern_cache;
+      }
+
+      //! The key which identifies the sparsity pattern of this operator
+      typename PatternCache::Key patternCacheKey(unsigned int flags = PatternCouplingFlags<LOP>::value) const
+      {
+        const CU & cu = local_assembler.trialConstraints();
+        const CV & cv = local_assembler.testConstraints();
+        return typename PatternCache::Key(&trialGridFunctionSpace(), &testGridFunctionSpace(),
+                                          cu.empty() ? 0 : &cu, cv.empty() ? 0 : &cv,
+                                          flags | (nonoverlapping_mode ? 1u<<31 : 0),
+                                          trialGridFunctionSpace().updateCount(),
+                                          testGridFunctionSpace().updateCount(),
+                                          globalSizeU(), globalSizeV());
+      }
+
       //! Fill pattern of jacobian matrix
       void fill_pattern(Pattern & p) const {
+        if (pattern_cache && pattern_cache->lookup(patternCacheKey(),p))
+          return;
         typedef typename LocalAssembler::LocalPatternAssemblerEngine PatternEngine;
         PatternEngine & pattern_engine = local_assembler.localPatternAssemblerEngine(p);
         global_assembler.assemble(pattern_engine);
+        if (pattern_cache)
+          pattern_cache->insert(patternCacheKey(),p);
       }
 
       //! Assemble residual
@@ -160,6 +203,18 @@ namespace Dune{
         global_assembler.assemble(jacobian_engine);
       }
 
+      //! Assemble residual and jacobian in a single grid traversal
+      /**
+       * Gives the same result as residual(x,r) followed by
+       * jacobian(x,a), but binds the local function spaces and reads
+       * the local coefficients only once per cell.
+       */
+      void residual_and_jacobian(const Domain & x, Range & r, Jacobian & a) const {
+        typedef typename LocalAssembler::LocalResidualJacobianAssemblerEngine ResidualJacobianEngine;
+        ResidualJacobianEngine & residual_jacobian_engine = local_assembler.localResidualJacobianAssemblerEngine(r,a,x);
+        global_assembler.assemble(residual_jacobian_engine);
+      }
+
       //! Apply jacobian matrix without explicitly assembling it
       void jacobian_apply(const Domain & x, Range & r) const {
         typedef typename LocalAssembler::LocalJacobianApplyAssemblerEngine JacobianApplyEngine;
@@ -167,9 +222,28 @@ namespace Dune{
         global_assembler.assemble(jacobian_apply_engine);
       }
 
+      //! Assemble the element diagonal blocks of the jacobian matrix
+      /**
+       * The block structure has to be set up by d.update(gfsu) before.
+       */
+      void jacobian_block_diagonal(const Domain & x, BlockDiagonal & d) const {
+        typedef typename LocalAssembler::LocalBlockDiagonalAssemblerEngine BlockDiagonalEngine;
+        BlockDiagonalEngine & block_diagonal_engine = local_assembler.localBlockDiagonalAssemblerEngine(d,x);
+        global_assembler.assemble(block_diagonal_engine);
+      }
+
     private:
       Assembler global_assembler;
       mutable LocalAssembler local_assembler;
+      PatternCache * pattern_cache;
+    };
+
+    template<typename GFSU, typename GFSV, typename LOP,
+             typename MB, typename DF, typename RF, typename JF,
+             typename CU, typename CV, bool nonoverlapping_mode, typename GA>
+    struct ProvidesResidualAndJacobian<GridOperator<GFSU,GFSV,LOP,MB,DF,RF,JF,CU,CV,nonoverlapping_mode,GA> >
+    {
+      static const bool value = true;
     };
 
   }
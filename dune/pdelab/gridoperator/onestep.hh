@@ -16,6 +16,9 @@ namespace Dune{
       //! The sparsity pattern container for the jacobian matrix
       typedef typename GO0::Traits::MatrixBackend::Pattern Pattern;
 
+      //! The cache type for sparsity patterns shared between grid operators
+      typedef typename GO0::PatternCache PatternCache;
+
       //! The global UDG assembler type
       typedef typename GO0::Traits::Assembler Assembler;
 
@@ -65,7 +68,8 @@ namespace Dune{
           go0(go0_), go1(go1_),
           la0(go0_.localAssembler()), la1(go1_.localAssembler()),
           const_residual( go0_.testGridFunctionSpace() ),
-          local_assembler(la0,la1, const_residual)
+          local_assembler(la0,la1, const_residual),
+          pattern_cache(0)
       {
         GO0::setupGridOperators(Dune::tie(go0_,go1_));
         if(!implicit)
@@ -116,17 +120,30 @@ namespace Dune{
 
       LocalAssembler & localAssembler() const { return local_assembler; }
 
+      //! Share sparsity patterns with other grid operators through the given cache
+      void setPatternCache(PatternCache * cache)
+      {
+        pattern_cache = cache;
+      }
+
+      //! The sparsity pattern cache, null if none has been set
+      PatternCache * patternCache() const
+      {
+        return pattern_cache;
+      }
+
       //! Fill pattern of jacobian matrix
       void fill_pattern(Pattern & p) const {
-        if(implicit){
-          typedef typename LocalAssembler::LocalPatternAssemblerEngine PatternEngine;
-          PatternEngine & pattern_engine = local_assembler.localPatternAssemblerEngine(p);
-          global_assembler.assemble(pattern_engine);
-        } else {
-          typedef typename LocalAssembler::LocalExplicitPatternAssemblerEngine PatternEngine;
-          PatternEngine & pattern_engine = local_assembler.localExplicitPatternAssemblerEngine(p);
-          global_assembler.assemble(pattern_engine);
-        }
+        // the pattern depends on the couplings of both operators and the time stepping mode
+        const unsigned int flags =
+          PatternCouplingFlags<typename LocalAssemblerDT0::LocalOperator>::value
+          | (PatternCouplingFlags<typename LocalAssemblerDT1::LocalOperator>::value << 8)
+          | (implicit ? 0 : 1u<<16);
+        if (pattern_cache && pattern_cache->lookup(go0.patternCacheKey(flags),p))
+          return;
+        fill_pattern_uncached(p);
+        if (pattern_cache)
+          pattern_cache->insert(go0.patternCacheKey(flags),p);
       }
 
       //! Assemble constant part of residual
@@ -230,6 +247,19 @@ namespace Dune{
       }
 
     private:
+
+      void fill_pattern_uncached(Pattern & p) const {
+        if(implicit){
+          typedef typename LocalAssembler::LocalPatternAssemblerEngine PatternEngine;
+          PatternEngine & pattern_engine = local_assembler.localPatternAssemblerEngine(p);
+          global_assembler.assemble(pattern_engine);
+        } else {
+          typedef typename LocalAssembler::LocalExplicitPatternAssemblerEngine PatternEngine;
+          PatternEngine & pattern_engine = local_assembler.localExplicitPatternAssemblerEngine(p);
+          global_assembler.assemble(pattern_engine);
+        }
+      }
+
       Assembler & global_assembler;
       GO0 & go0;
       GO1 & go1;
@@ -237,6 +267,7 @@ namespace Dune{
       LocalAssemblerDT1 & la1;
       Range const_residual;
       mutable LocalAssembler local_assembler;
+      PatternCache * pattern_cache;
     };
 
   }
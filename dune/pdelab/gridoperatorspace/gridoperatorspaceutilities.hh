@@ -402,6 +402,10 @@ namespace Dune {
       static void alpha_volume (const LA& la, const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, R& r)
       {
       }
+      template<typename B, typename X, typename R>
+      static void alpha_volume_batch (const LA& la, const B& batch, const X& x, R& r)
+      {
+      }
       template<typename EG, typename LFSU, typename X, typename LFSV, typename R>
       static void alpha_volume_post_skeleton (const LA& la, const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, R& r)
       {
@@ -464,6 +468,10 @@ namespace Dune {
       static void jacobian_volume (const LA& la, const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, M & mat)
       {
       }
+      template<typename B, typename X, typename M>
+      static void jacobian_volume_batch (const LA& la, const B& batch, const X& x, M& mat)
+      {
+      }
       template<typename EG, typename LFSU, typename X, typename LFSV, typename M>
       static void jacobian_volume_post_skeleton (const LA& la, const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, M& mat)
       {
@@ -521,6 +529,11 @@ namespace Dune {
       {
         la.alpha_volume(eg,lfsu,x,lfsv,r);
       }
+      template<typename B, typename X, typename R>
+      static void alpha_volume_batch (const LA& la, const B& batch, const X& x, R& r)
+      {
+        la.alpha_volume_batch(batch,x,r);
+      }
       template<typename EG, typename LFSU, typename X, typename LFSV, typename R>
       static void alpha_volume_post_skeleton (const LA& la, const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, R& r)
       {
@@ -596,6 +609,11 @@ namespace Dune {
       {
         la.jacobian_volume(eg,lfsu,x,lfsv,mat);
       }
+      template<typename B, typename X, typename M>
+      static void jacobian_volume_batch (const LA& la, const B& batch, const X& x, M& mat)
+      {
+        la.jacobian_volume_batch(batch,x,mat);
+      }
       template<typename EG, typename LFSU, typename X, typename LFSV, typename M>
       static void jacobian_volume_post_skeleton (const LA& la, const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, M & mat)
       {
@@ -50,6 +50,9 @@ namespace Dune {
       //! The size_type of the underlying container.
       typedef typename C::size_type size_type;
 
+      //! The number of entries processed at once by accumulateRow().
+      static const size_type simd_width = C::simd_width;
+
       //! A special wrapper type to enable backwards compatibility with current containers when directly accessing entries.
       typedef WeightedContainerEntryProxy<value_type,weight_type> reference;
 
@@ -98,6 +101,31 @@ namespace Dune {
         _container(lfsv,i,lfsu,j) += v;
       }
 
+      //! Applies the current weight to v[0],...,v[n-1] and adds the results to the entries of the i-th row of lfsv in the columns first,...,first+n-1 of lfsu.
+      /**
+       * The rows of LocalMatrix are stored contiguously, so this is a single loop
+       * over simd_width entries at a time that the compiler can vectorize.
+       */
+      template<typename LFSU, typename LFSV>
+      void accumulateRow(const LFSV& lfsv, size_type i,
+                         const LFSU& lfsu, size_type first, size_type n,
+                         const value_type* v)
+      {
+        _modified = true;
+        if (n > 0)
+          BlockAccumulation<simd_width>::range(&_container(lfsv,i,lfsu,first),_weight,v,n);
+      }
+
+      //! Applies the current weight to v[0],...,v[width-1] and adds the results to the entries of the i-th row of lfsv in the columns first,...,first+width-1 of lfsu.
+      template<std::size_t width, typename LFSU, typename LFSV>
+      void accumulateRowBlock(const LFSV& lfsv, size_type i,
+                              const LFSU& lfsu, size_type first,
+                              const value_type* v)
+      {
+        _modified = true;
+        BlockAccumulation<width>::block(&_container(lfsv,i,lfsu,first),_weight,v);
+      }
+
       //! Returns a reference proxy to an entry of the underlying container.
       /**
        * \returns A proxy that wraps the entry in the underlying container and
@@ -197,6 +225,9 @@ namespace Dune {
      * contain tags indicating whether they are trial or test spaces, the access methods will also assert that the
      * first space is a test space and the second space is a trial space.
      *
+     * The entries are stored row by row. The storage is aligned to DUNE_PDELAB_SIMD_ALIGNMENT bytes and each row is
+     * padded to a multiple of simd_width entries, so that all rows start at an aligned address.
+     *
      * \tparam T            The type of values to store in the matrix.
      * \tparam W            The type of weight applied in a WeightedAccumulationView.
      */	template<typename T, typename W = T>
@@ -207,8 +238,9 @@ namespace Dune {
       //! The type of the underlying storage container.
       /**
        * \warning This is not a matrix-like container anymore, but a std::vector-like one!
+       *          It also contains the padding at the end of each row, see rowStride().
        */
-      typedef std::vector<T> BaseContainer;
+      typedef std::vector<T,AlignedAllocator<T> > BaseContainer;
 
       //! The value type of this container.
       typedef typename BaseContainer::value_type  value_type;
@@ -229,30 +261,40 @@ namespace Dune {
        */
       typedef W weight_type;
 
+      //! The number of entries that fit into one SIMD register.
+      static const size_type simd_width = SIMDWidth<T>::value;
+
       //! An accumulate-only view of this container that automatically applies a weight to all contributions.
       typedef WeightedMatrixAccumulationView<LocalMatrix> WeightedAccumulationView;
 
       //! Default constructor
-	  LocalMatrix () {}
+	  LocalMatrix ()
+        : _rows(0)
+        , _cols(0)
+        , _stride(0)
+      {}
 
       //! Construct a LocalMatrix with r rows and c columns.
 	  LocalMatrix (size_type r, size_type c)
-		: _container(r*c)
+		: _container(r*simdPadded<T>(c))
         , _rows(r)
         , _cols(c)
+        , _stride(simdPadded<T>(c))
 	  {}
 
       //! Construct a LocalMatrix with r rows and c columns and initialize its entries with t.
 	  LocalMatrix (size_type r, size_type c, const T& t)
-		: _container(r*c,t)
+		: _container(r*simdPadded<T>(c),t)
         , _rows(r)
         , _cols(c)
+        , _stride(simdPadded<T>(c))
 	  {}
 
       //! Resize the matrix.
 	  void resize (size_type r, size_type c)
 	  {
-		_container.resize(r*c);
+		_stride = simdPadded<T>(c);
+		_container.resize(r*_stride);
 		_rows = r;
 		_cols = c;
 	  }
@@ -267,7 +309,8 @@ namespace Dune {
       //! Resize the matrix and assign t to all entries.
 	  void assign (size_type r, size_type c, const T& t)
 	  {
-		_container.assign(r*c,t);
+		_stride = simdPadded<T>(c);
+		_container.assign(r*_stride,t);
 		_rows = r;
 		_cols = c;
 	  }
@@ -329,14 +372,23 @@ namespace Dune {
 		return _cols;
 	  }
 
+      //! Returns the distance between the first entries of two consecutive rows in the storage container.
+      size_type rowStride () const
+      {
+        return _stride;
+      }
+
       //! y = A x
       template<class X, class R>
       void umv (const X& x, R& y) const
       {
         for (size_type i=0; i<_rows; ++i)
         {
+          const T* row = &_container[i*_stride];
+          T sum(0.0);
           for (size_type j=0; j<_cols; j++)
-            accessBaseContainer(y)[i] += getEntry(i,j) * accessBaseContainer(x)[j];
+            sum += row[j] * accessBaseContainer(x)[j];
+          accessBaseContainer(y)[i] += sum;
         }
       }
 
@@ -346,8 +398,11 @@ namespace Dune {
       {
         for (size_type i=0; i<_rows; ++i)
         {
+          const T* row = &_container[i*_stride];
+          T sum(0.0);
           for (size_type j=0; j<_cols; j++)
-            accessBaseContainer(y)[i] += alpha * getEntry(i,j) * accessBaseContainer(x)[j];
+            sum += row[j] * accessBaseContainer(x)[j];
+          accessBaseContainer(y)[i] += alpha * sum;
         }
       }
 
@@ -413,7 +468,7 @@ namespace Dune {
        */
       value_type& getEntry(size_type i, size_type j)
       {
-        return _container[j*_rows + i];
+        return _container[i*_stride + j];
       }
 
       //! Direct (unmapped) access to the (i,j)-th entry of the matrix (const version).
@@ -427,13 +482,13 @@ namespace Dune {
        */
       const value_type& getEntry(size_type i, size_type j) const
       {
-        return _container[j*_rows + i];
+        return _container[i*_stride + j];
       }
 
 	private:
 
-	  std::vector<T> _container;
-	  size_type _rows, _cols;
+	  BaseContainer _container;
+	  size_type _rows, _cols, _stride;
 	};
 
     template<class Stream, class T, class W>
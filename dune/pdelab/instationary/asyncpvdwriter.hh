@@ -0,0 +1,568 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=8 sw=2 sts=2:
+#ifndef DUNE_PDELAB_ASYNCPVDWRITER_HH
+#define DUNE_PDELAB_ASYNCPVDWRITER_HH
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/shared_ptr.hh>
+
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/grid/common/gridenums.hh>
+#include <dune/grid/io/file/vtk/common.hh>
+#include <dune/grid/io/file/vtk/function.hh>
+
+#include "onestep.hh"
+#include "pvdwriter.hh"
+
+namespace Dune
+{
+    namespace PDELab
+    {
+
+        //! The data of one piece of a VTK unstructured grid, copied out of the grid
+        /**
+         * Holds everything needed to write the piece and, on rank 0, the
+         * parallel header and the entry of the collection file, so it can
+         * be written while the grid and the coefficients change.
+         */
+        struct VTKPieceSnapshot
+        {
+            //! a named point or cell data array
+            struct Field
+            {
+                std::string name;
+                int ncomps;
+                std::vector<float> values;
+            };
+
+            //! 3 coordinates per point
+            std::vector<float> points;
+            std::vector<int> connectivity;
+            std::vector<int> offsets;
+            std::vector<unsigned char> types;
+            std::vector<Field> pointData;
+            std::vector<Field> cellData;
+
+            //! file name of the piece
+            std::string pieceName;
+            //! file name of the parallel header, empty if this rank does not write it
+            std::string headerName;
+            //! file names of all pieces relative to the header
+            std::vector<std::string> pieceSources;
+            //! time step for the collection file
+            double time;
+            //! file name of the header as referenced from the collection file
+            std::string collectionEntry;
+        };
+
+#ifndef DOXYGEN
+
+        namespace AsyncPVDWriterImp
+        {
+
+            inline const char * byteOrder()
+            {
+                const unsigned short one = 1;
+                return *reinterpret_cast<const unsigned char *>(&one) ? "LittleEndian" : "BigEndian";
+            }
+
+            // writes the arrays of a piece as raw binary blocks into the appended section
+            class AppendedData
+            {
+                std::vector<std::pair<const char *, unsigned int> > blocks;
+                unsigned int size;
+
+            public:
+
+                AppendedData() : size(0) {}
+
+                // register an array and return its offset in the appended section
+                template<typename T>
+                unsigned int add(const std::vector<T> & v)
+                {
+                    const unsigned int offset = size;
+                    const unsigned int bytes = v.size() * sizeof(T);
+                    blocks.push_back(std::make_pair(v.empty() ? static_cast<const char *>(0)
+                                                    : reinterpret_cast<const char *>(&v[0]), bytes));
+                    size += sizeof(unsigned int) + bytes;
+                    return offset;
+                }
+
+                void write(std::ostream & s) const
+                {
+                    s << "<AppendedData encoding=\"raw\">\n_";
+                    for (std::size_t i=0; i<blocks.size(); i++)
+                        {
+                            s.write(reinterpret_cast<const char *>(&blocks[i].second), sizeof(unsigned int));
+                            if (blocks[i].second > 0)
+                                s.write(blocks[i].first, blocks[i].second);
+                        }
+                    s << "\n</AppendedData>\n";
+                }
+            };
+
+            inline void writeFieldHeaders(std::ostream & s, const std::vector<VTKPieceSnapshot::Field> & fields,
+                                          const char * element, AppendedData * data)
+            {
+                for (std::size_t i=0; i<fields.size(); i++)
+                    {
+                        s << "<" << element << " type=\"Float32\" Name=\"" << fields[i].name
+                          << "\" NumberOfComponents=\"" << fields[i].ncomps << "\"";
+                        if (data)
+                            s << " format=\"appended\" offset=\"" << data->add(fields[i].values) << "\"";
+                        s << "/>\n";
+                    }
+            }
+
+            inline void writePiece(const VTKPieceSnapshot & piece)
+            {
+                std::ofstream s(piece.pieceName.c_str(), std::ios::binary);
+                if (!s.is_open())
+                    DUNE_THROW(IOError, "could not open " << piece.pieceName);
+                AppendedData data;
+                s << "<?xml version=\"1.0\"?>\n"
+                  << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"" << byteOrder() << "\">\n"
+                  << "<UnstructuredGrid>\n"
+                  << "<Piece NumberOfPoints=\"" << piece.points.size() / 3
+                  << "\" NumberOfCells=\"" << piece.types.size() << "\">\n";
+                s << "<PointData>\n";
+                writeFieldHeaders(s, piece.pointData, "DataArray", &data);
+                s << "</PointData>\n"
+                  << "<CellData>\n";
+                writeFieldHeaders(s, piece.cellData, "DataArray", &data);
+                // one statement per array, the offsets depend on the order of the calls to add()
+                s << "</CellData>\n"
+                  << "<Points>\n";
+                s << "<DataArray type=\"Float32\" Name=\"Coordinates\" NumberOfComponents=\"3\" format=\"appended\" offset=\""
+                  << data.add(piece.points) << "\"/>\n";
+                s << "</Points>\n"
+                  << "<Cells>\n";
+                s << "<DataArray type=\"Int32\" Name=\"connectivity\" NumberOfComponents=\"1\" format=\"appended\" offset=\""
+                  << data.add(piece.connectivity) << "\"/>\n";
+                s << "<DataArray type=\"Int32\" Name=\"offsets\" NumberOfComponents=\"1\" format=\"appended\" offset=\""
+                  << data.add(piece.offsets) << "\"/>\n";
+                s << "<DataArray type=\"UInt8\" Name=\"types\" NumberOfComponents=\"1\" format=\"appended\" offset=\""
+                  << data.add(piece.types) << "\"/>\n";
+                s << "</Cells>\n"
+                  << "</Piece>\n"
+                  << "</UnstructuredGrid>\n";
+                data.write(s);
+                s << "</VTKFile>\n";
+                s.close();
+                if (!s)
+                    DUNE_THROW(IOError, "could not write " << piece.pieceName);
+            }
+
+            inline void writeHeader(const VTKPieceSnapshot & piece)
+            {
+                std::ofstream s(piece.headerName.c_str());
+                if (!s.is_open())
+                    DUNE_THROW(IOError, "could not open " << piece.headerName);
+                s << "<?xml version=\"1.0\"?>\n"
+                  << "<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\" byte_order=\"" << byteOrder() << "\">\n"
+                  << "<PUnstructuredGrid GhostLevel=\"0\">\n"
+                  << "<PPointData>\n";
+                writeFieldHeaders(s, piece.pointData, "PDataArray", 0);
+                s << "</PPointData>\n"
+                  << "<PCellData>\n";
+                writeFieldHeaders(s, piece.cellData, "PDataArray", 0);
+                s << "</PCellData>\n"
+                  << "<PPoints>\n"
+                  << "<PDataArray type=\"Float32\" Name=\"Coordinates\" NumberOfComponents=\"3\"/>\n"
+                  << "</PPoints>\n";
+                for (std::size_t i=0; i<piece.pieceSources.size(); i++)
+                    s << "<Piece Source=\"" << piece.pieceSources[i] << "\"/>\n";
+                s << "</PUnstructuredGrid>\n"
+                  << "</VTKFile>\n";
+                s.close();
+                if (!s)
+                    DUNE_THROW(IOError, "could not write " << piece.headerName);
+            }
+
+            // same names as VTKWriter::pwrite()
+            inline std::string parallelName(const std::string & name, const std::string & path,
+                                            int rank, int size, bool header)
+            {
+                std::ostringstream s;
+                if (path.size() > 0)
+                    s << path << '/';
+                s << 's' << std::setw(4) << std::setfill('0') << size << '-';
+                if (!header)
+                    s << 'p' << std::setw(4) << std::setfill('0') << rank << '-';
+                s << name << (header ? ".pvtu" : ".vtu");
+                return s.str();
+            }
+
+        } // end namespace AsyncPVDWriterImp
+
+#endif // DOXYGEN
+
+        //! Writes a time series of binary VTK files from a background thread
+        /**
+         * write() evaluates the registered VTKFunctions on the interior cells
+         * of this rank and copies the result into a VTKPieceSnapshot.  The
+         * snapshot is written by a background thread as a .vtu piece with
+         * raw appended binary data; rank 0 also writes the .pvtu header and
+         * appends the time step to the .pvd collection.  The simulation only
+         * waits for the output if more than maxPending snapshots are queued.
+         *
+         * The functions are evaluated in write(), so the grid and the
+         * coefficients may change as soon as write() returns.  The files of a
+         * time step are complete once flush() returns, the destructor waits
+         * for all pending output.  Errors of the background thread are thrown
+         * as IOError by the next call to write() or flush().
+         *
+         * Without POSIX threads (HAVE_PTHREAD), or if constructed with
+         * asynchronous=false, the files are written within write().
+         *
+         * The file names are the same as those of PVDWriter, the target
+         * directory has to exist.
+         *
+         * \tparam GV Type of the GridView
+         */
+        template<typename GV>
+        class AsyncPVDWriter
+        {
+            typedef typename GV::ctype DF;
+            enum { dim = GV::dimension };
+            typedef typename GV::template Codim<0>::Entity Element;
+            typedef typename GV::template Codim<0>::
+                template Partition<Interior_Partition>::Iterator Iterator;
+            typedef typename GV::IndexSet::IndexType Index;
+
+        public:
+
+            typedef Dune::VTKFunction<GV> VTKFunction;
+            typedef shared_ptr<const VTKFunction> VTKFunctionPtr;
+
+            /**
+             * \param gv_           The GridView to write.
+             * \param basename_     Base name of the files.
+             * \param path_         Directory of the .vtu and .pvtu files.
+             * \param datamode_     Conforming or nonconforming point data.
+             * \param offset_       Number of the first time step.
+             * \param asynchronous_ Write from a background thread if available.
+             * \param maxPending_   Maximum number of snapshots waiting to be written.
+             */
+            AsyncPVDWriter(const GV & gv_, const std::string & basename_,
+                           const std::string & path_ = "vtk",
+                           Dune::VTK::DataMode datamode_ = Dune::VTK::conforming,
+                           unsigned int offset_ = 0,
+                           bool asynchronous_ = true,
+                           std::size_t maxPending_ = 2) :
+                gv(gv_), fn(basename_,offset_), path(path_), datamode(datamode_),
+                pvd(basename_ + ".pvd"),
+                async(asynchronous_), maxPending(maxPending_ > 0 ? maxPending_ : 1)
+#if HAVE_PTHREAD
+              , running(false), busy(false), stop(false)
+#endif
+            {
+#if HAVE_PTHREAD
+                pthread_mutex_init(&mutex, 0);
+                pthread_cond_init(&changed, 0);
+#endif
+            }
+
+            ~AsyncPVDWriter()
+            {
+#if HAVE_PTHREAD
+                if (running)
+                    {
+                        pthread_mutex_lock(&mutex);
+                        stop = true;
+                        pthread_cond_broadcast(&changed);
+                        pthread_mutex_unlock(&mutex);
+                        pthread_join(thread, 0);
+                    }
+                pthread_cond_destroy(&changed);
+                pthread_mutex_destroy(&mutex);
+#endif
+            }
+
+            //! add point data, the writer takes ownership of p
+            void addVertexData(VTKFunction * p)
+            {
+                vertexdata.push_back(VTKFunctionPtr(p));
+            }
+
+            //! add point data
+            void addVertexData(const VTKFunctionPtr & p)
+            {
+                vertexdata.push_back(p);
+            }
+
+            //! add cell data, the writer takes ownership of p
+            void addCellData(VTKFunction * p)
+            {
+                celldata.push_back(VTKFunctionPtr(p));
+            }
+
+            //! add cell data
+            void addCellData(const VTKFunctionPtr & p)
+            {
+                celldata.push_back(p);
+            }
+
+            //! remove all point and cell data
+            void clear()
+            {
+                vertexdata.clear();
+                celldata.clear();
+            }
+
+            //! whether the files are written by a background thread
+            bool asynchronous() const
+            {
+#if HAVE_PTHREAD
+                return async;
+#else
+                return false;
+#endif
+            }
+
+            //! evaluate all data and queue the time step for writing
+            void write(double time)
+            {
+                shared_ptr<VTKPieceSnapshot> piece(new VTKPieceSnapshot);
+                snapshot(*piece);
+                piece->time = time;
+
+                const std::string name(fn.getName());
+                const int rank = gv.comm().rank();
+                const int size = gv.comm().size();
+                piece->pieceName = AsyncPVDWriterImp::parallelName(name, path, rank, size, false);
+                if (rank == 0)
+                    {
+                        piece->headerName = AsyncPVDWriterImp::parallelName(name, path, rank, size, true);
+                        piece->collectionEntry = piece->headerName;
+                        for (int i=0; i<size; i++)
+                            piece->pieceSources.push_back(AsyncPVDWriterImp::parallelName(name, "", i, size, false));
+                    }
+                fn.increment();
+
+#if HAVE_PTHREAD
+                if (async)
+                    {
+                        pthread_mutex_lock(&mutex);
+                        if (!running)
+                            {
+                                if (pthread_create(&thread, 0, &AsyncPVDWriter::run, this) != 0)
+                                    {
+                                        pthread_mutex_unlock(&mutex);
+                                        DUNE_THROW(Exception, "could not start the VTK writer thread");
+                                    }
+                                running = true;
+                            }
+                        while (queue.size() >= maxPending && error.empty())
+                            pthread_cond_wait(&changed, &mutex);
+                        const std::string e(error);
+                        error.clear();
+                        if (e.empty())
+                            {
+                                queue.push_back(piece);
+                                pthread_cond_broadcast(&changed);
+                            }
+                        pthread_mutex_unlock(&mutex);
+                        if (!e.empty())
+                            DUNE_THROW(IOError, e);
+                        return;
+                    }
+#endif
+                writeSnapshot(*piece);
+            }
+
+            //! wait until all queued time steps have been written
+            void flush()
+            {
+#if HAVE_PTHREAD
+                pthread_mutex_lock(&mutex);
+                while ((!queue.empty() || busy) && error.empty())
+                    pthread_cond_wait(&changed, &mutex);
+                const std::string e(error);
+                error.clear();
+                pthread_mutex_unlock(&mutex);
+                if (!e.empty())
+                    DUNE_THROW(IOError, e);
+#endif
+            }
+
+        private:
+
+            AsyncPVDWriter(const AsyncPVDWriter &);
+            AsyncPVDWriter & operator=(const AsyncPVDWriter &);
+
+            // evaluate the data of the interior cells
+            void snapshot(VTKPieceSnapshot & piece) const
+            {
+                piece.pointData.resize(vertexdata.size());
+                for (std::size_t k=0; k<vertexdata.size(); k++)
+                    {
+                        piece.pointData[k].name = vertexdata[k]->name();
+                        piece.pointData[k].ncomps = paddedComponents(*vertexdata[k]);
+                    }
+                piece.cellData.resize(celldata.size());
+                for (std::size_t k=0; k<celldata.size(); k++)
+                    {
+                        piece.cellData[k].name = celldata[k]->name();
+                        piece.cellData[k].ncomps = paddedComponents(*celldata[k]);
+                    }
+
+                std::vector<int> number;
+                if (datamode == Dune::VTK::conforming)
+                    number.assign(gv.size(dim), -1);
+                int points = 0;
+
+                const Iterator end = gv.template end<0,Interior_Partition>();
+                for (Iterator it = gv.template begin<0,Interior_Partition>(); it != end; ++it)
+                    {
+                        const Element & e = *it;
+                        const GeometryType gt = e.type();
+                        const typename Element::Geometry geo = e.geometry();
+                        const GenericReferenceElement<DF,dim> & ref = GenericReferenceElements<DF,dim>::general(gt);
+
+                        for (int i=0; i<ref.size(dim); i++)
+                            {
+                                const int corner = Dune::VTK::renumber(gt,i);
+                                int n = points;
+                                if (datamode == Dune::VTK::conforming)
+                                    {
+                                        const Index v = gv.indexSet().subIndex(e,corner,dim);
+                                        if (number[v] < 0)
+                                            number[v] = points;
+                                        n = number[v];
+                                    }
+                                if (n == points)
+                                    {
+                                        ++points;
+                                        const typename Element::Geometry::GlobalCoordinate x = geo.corner(corner);
+                                        for (int d=0; d<3; d++)
+                                            piece.points.push_back(d < int(Element::Geometry::coorddimension) ? x[d] : 0.0);
+                                        const FieldVector<DF,dim> & xi = ref.position(corner,dim);
+                                        for (std::size_t k=0; k<vertexdata.size(); k++)
+                                            append(*vertexdata[k], e, xi, piece.pointData[k]);
+                                    }
+                                piece.connectivity.push_back(n);
+                            }
+                        piece.offsets.push_back(piece.connectivity.size());
+                        piece.types.push_back(Dune::VTK::geometryType(gt));
+
+                        for (std::size_t k=0; k<celldata.size(); k++)
+                            append(*celldata[k], e, ref.position(0,0), piece.cellData[k]);
+                    }
+            }
+
+            // like VTKWriter, pad 2D vectors to 3 components
+            static int paddedComponents(const VTKFunction & f)
+            {
+                return f.ncomps() == 2 ? 3 : f.ncomps();
+            }
+
+            static void append(const VTKFunction & f, const Element & e, const FieldVector<DF,dim> & xi,
+                               VTKPieceSnapshot::Field & field)
+            {
+                for (int c=0; c<f.ncomps(); c++)
+                    field.values.push_back(f.evaluate(c,e,xi));
+                for (int c=f.ncomps(); c<field.ncomps; c++)
+                    field.values.push_back(0.0);
+            }
+
+            void writeSnapshot(const VTKPieceSnapshot & piece)
+            {
+                AsyncPVDWriterImp::writePiece(piece);
+                if (!piece.headerName.empty())
+                    {
+                        AsyncPVDWriterImp::writeHeader(piece);
+                        pvd.append(piece.time, piece.collectionEntry);
+                    }
+            }
+
+#if HAVE_PTHREAD
+            static void * run(void * self)
+            {
+                static_cast<AsyncPVDWriter *>(self)->work();
+                return 0;
+            }
+
+            // the background thread, writes queued snapshots until stopped
+            void work()
+            {
+                pthread_mutex_lock(&mutex);
+                while (true)
+                    {
+                        while (queue.empty() && !stop)
+                            pthread_cond_wait(&changed, &mutex);
+                        if (queue.empty())
+                            break;
+                        shared_ptr<VTKPieceSnapshot> piece = queue.front();
+                        queue.pop_front();
+                        busy = true;
+                        pthread_cond_broadcast(&changed);
+                        pthread_mutex_unlock(&mutex);
+
+                        std::string e;
+                        try
+                            {
+                                writeSnapshot(*piece);
+                            }
+                        catch (Dune::Exception & ex)
+                            {
+                                e = ex.what();
+                            }
+                        catch (std::exception & ex)
+                            {
+                                e = ex.what();
+                            }
+                        piece.reset();
+
+                        pthread_mutex_lock(&mutex);
+                        busy = false;
+                        if (!e.empty() && error.empty())
+                            error = e;
+                        pthread_cond_broadcast(&changed);
+                    }
+                pthread_mutex_unlock(&mutex);
+            }
+#endif
+
+            const GV & gv;
+            FilenameHelper fn;
+            std::string path;
+            Dune::VTK::DataMode datamode;
+            PVDCollection pvd;
+            std::vector<VTKFunctionPtr> vertexdata;
+            std::vector<VTKFunctionPtr> celldata;
+            bool async;
+            std::size_t maxPending;
+
+#if HAVE_PTHREAD
+            pthread_t thread;
+            pthread_mutex_t mutex;
+            pthread_cond_t changed;
+            std::deque<shared_ptr<VTKPieceSnapshot> > queue;
+            bool running;
+            bool busy;
+            bool stop;
+            std::string error;
+#endif
+        };
+
+    } // end namespace PDELab
+} // end namespace Dune
+
+#endif // DUNE_PDELAB_ASYNCPVDWRITER_HH
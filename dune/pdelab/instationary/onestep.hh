@@ -15,6 +15,7 @@
 #include <dune/common/fmatrix.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/ios_state.hh>
+#include <dune/common/shared_ptr.hh>
 
 #include <dune/pdelab/common/logtag.hh>
 #include <dune/pdelab/gridoperatorspace/instationarygridoperatorspace.hh>
@@ -749,6 +750,58 @@ namespace Dune {
     };
 
 
+    //! Vectors which are kept alive from one time step to the next
+    /**
+     * The one step methods take their stage and residual vectors from
+     * this pool. A vector is only reallocated after the grid function
+     * space has been updated, e.g. on an adapted grid, or if its size
+     * does not match the space.
+     *
+     * \tparam V vector type
+     */
+    template<class V>
+    class VectorPool
+    {
+    public:
+      //! the i-th vector of the pool, allocated for gfs if necessary
+      template<class GFS>
+      V& get (std::size_t i, const GFS& gfs)
+      {
+        if (vectors.size() <= i)
+          {
+            vectors.resize(i+1);
+            updates.resize(i+1,0);
+          }
+        if (!vectors[i] || updates[i] != gfs.updateCount()
+            || vectors[i]->flatsize() != gfs.globalSize())
+          {
+            // release the old vector first to limit the peak memory
+            vectors[i].reset();
+            vectors[i] = shared_ptr<V>(new V(gfs));
+            updates[i] = gfs.updateCount();
+          }
+        return *vectors[i];
+      }
+
+      //! number of vectors held by the pool
+      std::size_t size () const
+      {
+        return vectors.size();
+      }
+
+      //! release all vectors
+      void clear ()
+      {
+        vectors.clear();
+        updates.clear();
+      }
+
+    private:
+      std::vector<shared_ptr<V> > vectors;
+      //! update count of the space each vector was allocated for
+      std::vector<std::size_t> updates;
+    };
+
     //! Do one step of a time-stepping scheme
     /**
      * \tparam T          type to represent time values
@@ -880,7 +933,7 @@ namespace Dune {
 	    else
 	      {
 		// intermediate step
-		x.push_back(new TrlV(igos.trialGridFunctionSpace()));
+		x.push_back(&stages.get(r-1,igos.trialGridFunctionSpace()));
 		if (r>1)
 		  *(x[r]) = *(x[r-1]); // use result of last stage as initial guess
 		else
@@ -894,9 +947,6 @@ namespace Dune {
             igos.postStage();
 	  }
 
-	// delete intermediate steps
-        for (unsigned i=1; i<method->s(); ++i) delete x[i];
-
         // step cleanup
         igos.postStep();
 
@@ -969,7 +1019,7 @@ namespace Dune {
 	    else
 	      {
 		// intermediate step
-		x.push_back(new TrlV(igos.trialGridFunctionSpace()));
+		x.push_back(&stages.get(r-1,igos.trialGridFunctionSpace()));
 	      }
 
             // set boundary conditions and initial value 
@@ -982,9 +1032,6 @@ namespace Dune {
             igos.postStage();
 	  }
 
-	// delete intermediate steps
-        for (unsigned i=1; i<method->s(); ++i) delete x[i];
-
         // step cleanup
         igos.postStep();
 
@@ -998,6 +1045,7 @@ namespace Dune {
       PDESOLVER& pdesolver;
       int verbosityLevel;
       int step;
+      VectorPool<TrlV> stages;
     };
 
     //! Do one step of an explicit time-stepping scheme
@@ -1029,8 +1077,8 @@ namespace Dune {
        * Use SimpleTimeController that does not control the time step.
        */
       ExplicitOneStepMethod(const TimeSteppingParameterInterface<T>& method_, IGOS& igos_, LS& ls_)
-	: method(&method_), igos(igos_), ls(ls_), verbosityLevel(1), step(1), D(igos), 
-          tc(new SimpleTimeController<T>()), allocated(true)
+	: method(&method_), igos(igos_), ls(ls_), verbosityLevel(1), step(1),
+          tc(new SimpleTimeController<T>()), allocated(true), trial_updates(0), test_updates(0)
       {
         if (method->implicit())
           DUNE_THROW(Exception,"explicit one step method called with implicit scheme");
@@ -1051,8 +1099,8 @@ namespace Dune {
        * there).
        */
       ExplicitOneStepMethod(const TimeSteppingParameterInterface<T>& method_, IGOS& igos_, LS& ls_, TC& tc_)
-	: method(&method_), igos(igos_), ls(ls_), verbosityLevel(1), step(1), D(igos), 
-          tc(&tc_), allocated(false)
+	: method(&method_), igos(igos_), ls(ls_), verbosityLevel(1), step(1),
+          tc(&tc_), allocated(false), trial_updates(0), test_updates(0)
       {
         if (method->implicit())
           DUNE_THROW(Exception,"explicit one step method called with implicit scheme");
@@ -1109,7 +1157,8 @@ namespace Dune {
         if(verbosityLevel>=4)
           std::cout << mytag << "Creating residual vectors alpha and beta..."
                     << std::endl;
-        TstV alpha(igos.testGridFunctionSpace()), beta(igos.testGridFunctionSpace()); // split residual vectors
+        TstV& alpha = residuals.get(0,igos.testGridFunctionSpace()); // split residual vectors
+        TstV& beta = residuals.get(1,igos.testGridFunctionSpace());
         if(verbosityLevel>=4)
           std::cout << mytag
                     << "Creating residual vectors alpha and beta... done."
@@ -1168,7 +1217,7 @@ namespace Dune {
 	    else
 	      {
 		// intermediate step
-		x.push_back(new TrlV(igos.trialGridFunctionSpace()));
+		x.push_back(&stages.get(r-1,igos.trialGridFunctionSpace()));
 		if (r>1)
 		  *(x[r]) = *(x[r-1]); // use result of last stage as initial guess
 		else
@@ -1177,6 +1226,7 @@ namespace Dune {
 
 	    // compute residuals and jacobian
 	    if (verbosityLevel>=4) std::cout << "assembling D, alpha, beta ..." << std::endl;
+            M& D = matrix();
             D = 0.0;
             alpha = 0.0;
             beta = 0.0;
@@ -1249,9 +1299,6 @@ namespace Dune {
               std::cout << stagetag << "Finished." << std::endl;
 	  }
 
-	// delete intermediate steps
-        for(unsigned i=1; i<method->s(); ++i) delete x[i];
-
         // step cleanup
         if (verbosityLevel>=4)
           std::cout << mytag << "Cleanup..." << std::endl;
@@ -1264,14 +1311,34 @@ namespace Dune {
       }
 
     private:
+      //! the matrix of the stages, set up again after the spaces have been updated
+      M& matrix ()
+      {
+        const std::size_t trial = igos.trialGridFunctionSpace().updateCount();
+        const std::size_t test = igos.testGridFunctionSpace().updateCount();
+        if (!D || trial != trial_updates || test != test_updates)
+          {
+            // release the old matrix first to limit the peak memory
+            D.reset();
+            D = shared_ptr<M>(new M(igos));
+            trial_updates = trial;
+            test_updates = test;
+          }
+        return *D;
+      }
+
       const TimeSteppingParameterInterface<T> *method;
       IGOS& igos;
       LS ls;
       int verbosityLevel;
       int step;
-      M D;
+      shared_ptr<M> D;
       TimeControllerInterface<T> *tc;
       bool allocated;
+      std::size_t trial_updates;
+      std::size_t test_updates;
+      VectorPool<TrlV> stages;
+      VectorPool<TstV> residuals;
     };
 
     class FilenameHelper 
@@ -5,6 +5,7 @@
 
 #include <vector>
 #include <fstream>
+#include <dune/common/exceptions.hh>
 #include <dune/grid/io/file/vtk/vtkwriter.hh>
 #include "onestep.hh"
 
@@ -12,6 +13,58 @@
 
 namespace Dune
 {
+    namespace PDELab
+    {
+
+        //! A .pvd collection file which is extended by appending
+        /**
+         * Every call to append() overwrites the closing tags at the end of
+         * the file with the new data set and the closing tags, so the cost
+         * of an update does not grow with the number of time steps already
+         * written.  The file is created anew by the first call to append().
+         */
+        class PVDCollection
+        {
+            std::string name;
+            std::streampos tail;
+            bool started;
+
+        public:
+
+            //! \param name_ file name of the collection including the extension
+            explicit PVDCollection(const std::string & name_) :
+                name(name_), tail(0), started(false) {}
+
+            //! add the data set in file to the collection
+            void append(double time, const std::string & file)
+            {
+                std::fstream pvd;
+                if (started)
+                    pvd.open(name.c_str(), std::ios::in | std::ios::out);
+                else
+                    pvd.open(name.c_str(), std::ios::out | std::ios::trunc);
+                if (!pvd.is_open())
+                    DUNE_THROW(IOError, "could not open " << name);
+                pvd << std::fixed;
+                if (started)
+                    pvd.seekp(tail);
+                else
+                    pvd << "<?xml version=\"1.0\"?>\n"
+                        << "<VTKFile type=\"Collection\" version=\"0.1\">\n"
+                        << "<Collection>\n";
+                pvd << "  <DataSet timestep=\"" << time
+                    << "\" file=\"" << file << "\"/>\n";
+                tail = pvd.tellp();
+                pvd << "</Collection>\n"
+                    << "</VTKFile>\n";
+                pvd.close();
+                if (!pvd)
+                    DUNE_THROW(IOError, "could not write " << name);
+                started = true;
+            }
+        };
+
+    } // end namespace PDELab
 
     template< class GridView, class VTK = VTKWriter<GridView> >
     class PVDWriter : public VTK
@@ -20,9 +73,8 @@ namespace Dune
         std::string basename;
         PDELab::FilenameHelper fn;
         std::string path;
-        std::vector<double> timesteps;
         Dune::VTK::OutputType outputtype;
-        unsigned int offset;
+        PDELab::PVDCollection pvd;
 
     public:
 
@@ -33,36 +85,17 @@ namespace Dune
             VTK(gv_,datamode_), gv(gv_),
             basename(basename_), fn(basename_,offset_),
             path(path_), outputtype(outputtype_),
-            offset(offset_){}
+            pvd(basename_ + ".pvd") {}
 
         void write(double time)
         {
-            /* remember current time step */
-            timesteps.push_back(time);
             /* make sure the directory exists */
             // mkdir("vtk", 777);
             /* write VTK file */
             VTK::pwrite(fn.getName(),path,"",outputtype);
-            /* write pvd file */
-            std::string pvdname = basename + ".pvd";
-            std::ofstream pvd(pvdname.c_str());
-            //std::cout << "WRITE PVD FILE " << pvdname << std::endl;
-            assert(pvd.is_open());
-            pvd << std::fixed;
-            pvd << "<?xml version=\"1.0\"?>\n"
-                << "<VTKFile type=\"Collection\" version=\"0.1\">\n"
-                << "<Collection>\n";
-            PDELab::FilenameHelper fnloop(basename,offset);
-            for (unsigned int i=0; i<timesteps.size(); i++)
-                {
-                    std::string fname = this->getParallelHeaderName(fnloop.getName(), path, gv.comm().size());
-                    pvd << "  <DataSet timestep=\"" << timesteps[i]
-                        << "\" file=\"" << fname << "\"/>\n";
-                    fnloop.increment();
-                }
-            pvd << "</Collection>\n"
-                << "</VTKFile>\n";
-            pvd.close();
+            /* append the time step to the pvd file */
+            if (gv.comm().rank() == 0)
+                pvd.append(time, this->getParallelHeaderName(fn.getName(), path, gv.comm().size()));
 
             /* increment counter */
             fn.increment();
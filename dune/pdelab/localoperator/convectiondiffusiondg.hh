@@ -15,6 +15,7 @@
 #include<dune/pdelab/localoperator/idefault.hh>
 #include<dune/pdelab/localoperator/defaultimp.hh>
 #include<dune/pdelab/finiteelement/localbasiscache.hh>
+#include<dune/pdelab/finiteelement/qksumfactorization.hh>
 
 #include"convectiondiffusionparameter.hh"
 
@@ -163,7 +164,7 @@ namespace Dune {
 #endif
 
             // transform gradients of shape functions to real element
-            jac = eg.geometry().jacobianInverseTransposed(it->position());
+            jac = eg.jacobianInverseTransposed(it->position());
             std::vector<Dune::FieldVector<RF,dim> > gradphi(lfsu.size());
             for (size_type i=0; i<lfsu.size(); i++)
               jac.mv(js[i][0],gradphi[i]);
@@ -188,7 +189,7 @@ namespace Dune {
             typename T::Traits::RangeFieldType c = param.c(eg.entity(),it->position());
 
             // integrate (K grad u - bu)*grad phi_i + a*u*phi_i
-            RF factor = it->weight() * eg.geometry().integrationElement(it->position());
+            RF factor = it->weight() * eg.integrationElement(it->position());
             for (size_type i=0; i<lfsv.size(); i++)
               r.accumulate(lfsv,i,( Agradu*gradpsi[i] - u*(b*gradpsi[i]) + c*u*psi[i] )*factor);
           }
@@ -248,7 +249,7 @@ namespace Dune {
 #endif
 
             // transform gradients of shape functions to real element
-            jac = eg.geometry().jacobianInverseTransposed(it->position());
+            jac = eg.jacobianInverseTransposed(it->position());
             std::vector<Dune::FieldVector<RF,dim> > gradphi(lfsu.size());
             std::vector<Dune::FieldVector<RF,dim> > Agradphi(lfsu.size());
             for (size_type i=0; i<lfsu.size(); i++)
@@ -264,7 +265,7 @@ namespace Dune {
             typename T::Traits::RangeFieldType c = param.c(eg.entity(),it->position());
 
             // integrate (K grad u - bu)*grad phi_i + a*u*phi_i
-            RF factor = it->weight() * eg.geometry().integrationElement(it->position());
+            RF factor = it->weight() * eg.integrationElement(it->position());
             for (size_type j=0; j<lfsu.size(); j++)
               for (size_type i=0; i<lfsu.size(); i++)
                 mat.accumulate(lfsu,i,lfsu,j,( Agradphi[j]*gradphi[i] - phi[j]*(b*gradphi[i]) + c*phi[j]*phi[i] )*factor);
@@ -407,12 +408,12 @@ namespace Dune {
 #endif
 
             // transform gradients of shape functions to real element
-            jac = ig.inside()->geometry().jacobianInverseTransposed(iplocal_s);
+            jac = ig.insideJacobianInverseTransposed(iplocal_s);
             std::vector<Dune::FieldVector<RF,dim> > tgradphi_s(lfsu_s.size());
             for (size_type i=0; i<lfsu_s.size(); i++) jac.mv(gradphi_s[i][0],tgradphi_s[i]);
             std::vector<Dune::FieldVector<RF,dim> > tgradpsi_s(lfsv_s.size());
             for (size_type i=0; i<lfsv_s.size(); i++) jac.mv(gradpsi_s[i][0],tgradpsi_s[i]);
-            jac = ig.outside()->geometry().jacobianInverseTransposed(iplocal_n);
+            jac = ig.outsideJacobianInverseTransposed(iplocal_n);
             std::vector<Dune::FieldVector<RF,dim> > tgradphi_n(lfsu_n.size());
             for (size_type i=0; i<lfsu_n.size(); i++) jac.mv(gradphi_n[i][0],tgradphi_n[i]);
             std::vector<Dune::FieldVector<RF,dim> > tgradpsi_n(lfsv_n.size());
@@ -442,7 +443,7 @@ namespace Dune {
               }
 
             // integration factor
-            RF factor = it->weight() * ig.geometry().integrationElement(it->position());
+            RF factor = it->weight() * ig.integrationElement(it->position());
 
             // convection term
             RF term1 = (omegaup_s*u_s + omegaup_n*u_n) * normalflux *factor;
@@ -592,10 +593,10 @@ namespace Dune {
 #endif
 
             // transform gradients of shape functions to real element
-            jac = ig.inside()->geometry().jacobianInverseTransposed(iplocal_s);
+            jac = ig.insideJacobianInverseTransposed(iplocal_s);
             std::vector<Dune::FieldVector<RF,dim> > tgradphi_s(lfsu_s.size());
             for (size_type i=0; i<lfsu_s.size(); i++) jac.mv(gradphi_s[i][0],tgradphi_s[i]);
-            jac = ig.outside()->geometry().jacobianInverseTransposed(iplocal_n);
+            jac = ig.outsideJacobianInverseTransposed(iplocal_n);
             std::vector<Dune::FieldVector<RF,dim> > tgradphi_n(lfsu_n.size());
             for (size_type i=0; i<lfsu_n.size(); i++) jac.mv(gradphi_n[i][0],tgradphi_n[i]);
 
@@ -615,7 +616,7 @@ namespace Dune {
               }
 
             // integration factor
-            RF factor = it->weight() * ig.geometry().integrationElement(it->position());
+            RF factor = it->weight() * ig.integrationElement(it->position());
             RF ipfactor = penalty_factor * factor;
 
             // do all terms in the order: I convection, II diffusion, III consistency, IV ip
@@ -746,7 +747,7 @@ namespace Dune {
 #endif
 
             // integration factor
-            RF factor = it->weight() * ig.geometry().integrationElement(it->position());
+            RF factor = it->weight() * ig.integrationElement(it->position());
 
             if (bctype == ConvectionDiffusionBoundaryConditions::Neumann)
               {
@@ -804,7 +805,7 @@ namespace Dune {
 #endif
 
             // transform gradients of shape functions to real element
-            jac = ig.inside()->geometry().jacobianInverseTransposed(iplocal_s);
+            jac = ig.insideJacobianInverseTransposed(iplocal_s);
             std::vector<Dune::FieldVector<RF,dim> > tgradphi_s(lfsu_s.size());
             for (size_type i=0; i<lfsu_s.size(); i++) jac.mv(gradphi_s[i][0],tgradphi_s[i]);
             std::vector<Dune::FieldVector<RF,dim> > tgradpsi_s(lfsv_s.size());
@@ -940,7 +941,7 @@ namespace Dune {
 #endif
 
             // integration factor
-            RF factor = it->weight() * ig.geometry().integrationElement(it->position());
+            RF factor = it->weight() * ig.integrationElement(it->position());
 
             // evaluate velocity field and upwinding, assume H(div) velocity field => choose any side
             typename T::Traits::RangeType b = param.b(*(ig.inside()),iplocal_s);
@@ -971,7 +972,7 @@ namespace Dune {
 #endif
 
             // transform gradients of shape functions to real element
-            jac = ig.inside()->geometry().jacobianInverseTransposed(iplocal_s);
+            jac = ig.insideJacobianInverseTransposed(iplocal_s);
             std::vector<Dune::FieldVector<RF,dim> > tgradphi_s(lfsu_s.size());
             for (size_type i=0; i<lfsu_s.size(); i++) jac.mv(gradphi_s[i][0],tgradphi_s[i]);
 
@@ -1048,7 +1049,7 @@ namespace Dune {
             f = param.f(eg.entity(),it->position());
 
             // integrate f
-            RF factor = it->weight() * eg.geometry().integrationElement(it->position());
+            RF factor = it->weight() * eg.integrationElement(it->position());
             for (size_type i=0; i<lfsv.size(); i++)
               r.accumulate(lfsv,i,-f*phi[i]*factor);
           }
@@ -1060,7 +1061,7 @@ namespace Dune {
         param.setTime(t);
       }
 
-    private:
+    protected:
       T& param;  // two phase parameter class
       ConvectionDiffusionDGMethod::Type method;
       ConvectionDiffusionDGWeights::Type weights;
@@ -1111,6 +1112,274 @@ namespace Dune {
           }
       }
     };
+
+    /** ConvectionDiffusionDG with sum-factorized volume and face terms for Q_k elements
+     *
+     * On affine cubes, alpha_volume() and alpha_skeleton() evaluate the
+     * solution at all quadrature points and integrate against all test
+     * functions with QkSumFactorization, which reduces the cost per
+     * element from O(k^(2d)) to O(k^(d+1)). Other elements, faces whose
+     * embeddings differ from the reference cube (nonconforming or
+     * rotated neighbors) and the boundary terms are left to
+     * ConvectionDiffusionDG.
+     *
+     * The volume and skeleton terms are linear in u, so
+     * jacobian_apply_volume() and jacobian_apply_skeleton() apply the
+     * fast residual to the direction instead of differencing it.
+     *
+     * \note The kernel and the operator keep scratch buffers which are
+     * reused for all elements and faces, so no memory is allocated after
+     * the first element. The operator is therefore not thread-safe and
+     * must not be used with ColoredAssembler, which calls one operator
+     * from several threads.
+     *
+     * \tparam T model of ConvectionDiffusionParameterInterface
+     * \tparam FiniteElementMap map to QkDGLocalFiniteElement
+     */
+    template<typename T, typename FiniteElementMap>
+    class SumFactorizedConvectionDiffusionDG
+      : public ConvectionDiffusionDG<T,FiniteElementMap>
+    {
+      typedef ConvectionDiffusionDG<T,FiniteElementMap> Base;
+      typedef typename FiniteElementMap::Traits::FiniteElementType::Traits::LocalBasisType LocalBasisType;
+      typedef typename QkSumFactorizationSelector<LocalBasisType>::Type Kernel;
+      typedef typename Kernel::GradientType GradientType;
+      typedef typename LocalBasisType::Traits::RangeFieldType RangeFieldType;
+
+      enum { dim = T::Traits::GridViewType::dimension };
+
+      typedef typename T::Traits::RangeFieldType Real;
+
+    public:
+      //! constructor: pass parameter object
+      SumFactorizedConvectionDiffusionDG (T& param_,
+                                          ConvectionDiffusionDGMethod::Type method_=ConvectionDiffusionDGMethod::NIPG,
+                                          ConvectionDiffusionDGWeights::Type weights_=ConvectionDiffusionDGWeights::weightsOff,
+                                          Real alpha_=0.0,
+                                          int intorderadd_=0
+                                          )
+        : Base(param_,method_,weights_,alpha_,intorderadd_),
+          kernel(intorderadd_ + 2 * Kernel::degree)
+      {}
+
+      // volume integral depending on test and ansatz functions
+      template<typename EG, typename LFSU, typename X, typename LFSV, typename R>
+      void alpha_volume (const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, R& r) const
+      {
+        if (!applicable(eg.geometry(),lfsu,lfsv))
+          {
+            Base::alpha_volume(eg,lfsu,x,lfsv,r);
+            return;
+          }
+
+        // domain and range field type
+        typedef typename LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::DomainFieldType DF;
+        typedef typename LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::RangeFieldType RF;
+        typedef typename LFSU::Traits::SizeType size_type;
+
+        // diffusion tensor and transformation are constant on affine elements
+        Dune::GeometryType gt = eg.geometry().type();
+        Dune::FieldVector<DF,dim> localcenter = Dune::ReferenceElements<DF,dim>::general(gt).position(0,0);
+        typename T::Traits::PermTensorType A = this->param.A(eg.entity(),localcenter);
+        const typename EG::Geometry::JacobianInverseTransposed
+          jac = eg.jacobianInverseTransposed(localcenter);
+        const RF integrationelement = eg.geometry().integrationElement(localcenter);
+
+        // evaluate u and its reference gradient at all quadrature points
+        std::vector<RF>& xl = scratch_xl[0];
+        xl.resize(lfsu.size());
+        for (size_type i=0; i<lfsu.size(); i++)
+          xl[i] = x(lfsu,i);
+        std::vector<RF>& u = scratch_u[0];
+        std::vector<GradientType>& gradu = scratch_gradu[0];
+        kernel.evaluate(xl,u,gradu);
+
+        // replace them by the coefficients of the test functions and their gradients
+        Dune::FieldVector<RF,dim> tgradu, flux;
+        for (std::size_t q=0; q<kernel.points(); q++)
+          {
+            jac.mv(gradu[q],tgradu);
+            typename T::Traits::RangeType b = this->param.b(eg.entity(),kernel.position(q));
+            typename T::Traits::RangeFieldType c = this->param.c(eg.entity(),kernel.position(q));
+            RF factor = kernel.weight(q) * integrationelement;
+
+            // (A grad u - bu)*grad phi_i + c*u*phi_i
+            A.mv(tgradu,flux);
+            flux.axpy(-u[q],b);
+            flux *= factor;
+            jac.mtv(flux,gradu[q]);
+            u[q] *= c*factor;
+          }
+        kernel.integrate(u,gradu,xl);
+        for (size_type i=0; i<lfsv.size(); i++)
+          r.accumulate(lfsv,i,xl[i]);
+      }
+
+      // apply jacobian of volume term
+      template<typename EG, typename LFSU, typename X, typename LFSV, typename Y>
+      void jacobian_apply_volume (const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, Y& y) const
+      {
+        alpha_volume(eg,lfsu,x,lfsv,y);
+      }
+
+      // skeleton integral depending on test and ansatz functions
+      // each face is only visited ONCE!
+      template<typename IG, typename LFSU, typename X, typename LFSV, typename R>
+      void alpha_skeleton (const IG& ig,
+                           const LFSU& lfsu_s, const X& x_s, const LFSV& lfsv_s,
+                           const LFSU& lfsu_n, const X& x_n, const LFSV& lfsv_n,
+                           R& r_s, R& r_n) const
+      {
+        const int face_s = ig.indexInInside();
+        const int face_n = ig.indexInOutside();
+        if (!applicable(ig.inside()->geometry(),lfsu_s,lfsv_s) ||
+            !applicable(ig.outside()->geometry(),lfsu_n,lfsv_n) ||
+            !Kernel::canonicalFace(face_s,ig.geometryInInside()) ||
+            !Kernel::canonicalFace(face_n,ig.geometryInOutside()))
+          {
+            Base::alpha_skeleton(ig,lfsu_s,x_s,lfsv_s,lfsu_n,x_n,lfsv_n,r_s,r_n);
+            return;
+          }
+
+        // domain and range field type
+        typedef typename LFSV::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::DomainFieldType DF;
+        typedef typename LFSV::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::RangeFieldType RF;
+        typedef typename LFSV::Traits::SizeType size_type;
+
+        // evaluate permeability tensors
+        const Dune::FieldVector<DF,dim>&
+          inside_local = Dune::ReferenceElements<DF,dim>::general(ig.inside()->type()).position(0,0);
+        const Dune::FieldVector<DF,dim>&
+          outside_local = Dune::ReferenceElements<DF,dim>::general(ig.outside()->type()).position(0,0);
+        typename T::Traits::PermTensorType A_s, A_n;
+        A_s = this->param.A(*(ig.inside()),inside_local);
+        A_n = this->param.A(*(ig.outside()),outside_local);
+
+        // face diameter, as in ConvectionDiffusionDG
+        RF h_F = std::min(ig.inside()->geometry().volume(),ig.outside()->geometry().volume())/ig.geometry().volume(); // Houston!
+
+        // tensor times normal, the normal is constant on affine faces
+        const Dune::FieldVector<DF,dim> n_F = ig.centerUnitOuterNormal();
+        Dune::FieldVector<RF,dim> An_F_s;
+        A_s.mv(n_F,An_F_s);
+        Dune::FieldVector<RF,dim> An_F_n;
+        A_n.mv(n_F,An_F_n);
+
+        // compute weights
+        RF omega_s;
+        RF omega_n;
+        RF harmonic_average(0.0);
+        if (this->weights==ConvectionDiffusionDGWeights::weightsOn)
+          {
+            RF delta_s = (An_F_s*n_F);
+            RF delta_n = (An_F_n*n_F);
+            omega_s = delta_n/(delta_s+delta_n+1e-20);
+            omega_n = delta_s/(delta_s+delta_n+1e-20);
+            harmonic_average = 2.0*delta_s*delta_n/(delta_s+delta_n+1e-20);
+          }
+        else
+          {
+            omega_s = omega_n = 0.5;
+            harmonic_average = 1.0;
+          }
+
+        // penalty factor
+        const int degree = Kernel::degree;
+        RF penalty_factor = (this->alpha/h_F) * harmonic_average * degree*(degree+dim-1);
+
+        // transformations and face integration element
+        const typename IG::Entity::Geometry::JacobianInverseTransposed
+          jac_s = ig.insideJacobianInverseTransposed(inside_local);
+        const typename IG::Entity::Geometry::JacobianInverseTransposed
+          jac_n = ig.outsideJacobianInverseTransposed(outside_local);
+        const Dune::FieldVector<DF,dim-1>& face_local =
+          Dune::ReferenceElements<DF,dim-1>::general(ig.geometry().type()).position(0,0);
+        const RF integrationelement = ig.geometry().integrationElement(face_local);
+
+        // evaluate u and its reference gradient on both sides of the face
+        std::vector<RF>& xl_s = scratch_xl[0];
+        std::vector<RF>& xl_n = scratch_xl[1];
+        xl_s.resize(lfsu_s.size());
+        xl_n.resize(lfsu_n.size());
+        for (size_type i=0; i<lfsu_s.size(); i++)
+          xl_s[i] = x_s(lfsu_s,i);
+        for (size_type i=0; i<lfsu_n.size(); i++)
+          xl_n[i] = x_n(lfsu_n,i);
+        std::vector<RF>& u_s = scratch_u[0];
+        std::vector<RF>& u_n = scratch_u[1];
+        std::vector<GradientType>& gradu_s = scratch_gradu[0];
+        std::vector<GradientType>& gradu_n = scratch_gradu[1];
+        kernel.evaluateFace(face_s,xl_s,u_s,gradu_s);
+        kernel.evaluateFace(face_n,xl_n,u_n,gradu_n);
+
+        Dune::FieldVector<RF,dim> tgradu_s, tgradu_n, flux;
+        for (std::size_t q=0; q<kernel.facePoints(); q++)
+          {
+            jac_s.mv(gradu_s[q],tgradu_s);
+            jac_n.mv(gradu_n[q],tgradu_n);
+
+            // evaluate velocity field and upwinding, assume H(div) velocity field => may choose any side
+            typename T::Traits::RangeType b = this->param.b(*(ig.inside()),kernel.facePosition(face_s,q));
+            RF normalflux = b*n_F;
+            RF omegaup_s = (normalflux>=0.0) ? 1.0 : 0.0;
+            RF omegaup_n = 1.0 - omegaup_s;
+
+            // integration factor
+            RF factor = kernel.faceWeight(q) * integrationelement;
+
+            // convection, diffusion and standard IP terms are tested with psi
+            RF term1 = (omegaup_s*u_s[q] + omegaup_n*u_n[q]) * normalflux *factor;
+            RF term2 = -(omega_s*(An_F_s*tgradu_s) + omega_n*(An_F_n*tgradu_n)) * factor;
+            RF term3 = (u_s[q]-u_n[q]) * factor;
+            RF term4 = penalty_factor * term3;
+
+            // (non-)symmetric IP term is tested with grad psi
+            flux = An_F_s;
+            flux *= term3 * this->theta * omega_s;
+            jac_s.mtv(flux,gradu_s[q]);
+            flux = An_F_n;
+            flux *= term3 * this->theta * omega_n;
+            jac_n.mtv(flux,gradu_n[q]);
+
+            u_s[q] = term1 + term2 + term4;
+            u_n[q] = -u_s[q];
+          }
+        kernel.integrateFace(face_s,u_s,gradu_s,xl_s);
+        kernel.integrateFace(face_n,u_n,gradu_n,xl_n);
+        for (size_type i=0; i<lfsv_s.size(); i++)
+          r_s.accumulate(lfsv_s,i,xl_s[i]);
+        for (size_type i=0; i<lfsv_n.size(); i++)
+          r_n.accumulate(lfsv_n,i,xl_n[i]);
+      }
+
+      // apply jacobian of skeleton term
+      template<typename IG, typename LFSU, typename X, typename LFSV, typename Y>
+      void jacobian_apply_skeleton (const IG& ig,
+                                    const LFSU& lfsu_s, const X& x_s, const LFSV& lfsv_s,
+                                    const LFSU& lfsu_n, const X& x_n, const LFSV& lfsv_n,
+                                    Y& y_s, Y& y_n) const
+      {
+        alpha_skeleton(ig,lfsu_s,x_s,lfsv_s,lfsu_n,x_n,lfsv_n,y_s,y_n);
+      }
+
+    private:
+      template<typename Geometry, typename LFSU, typename LFSV>
+      bool applicable (const Geometry& geo, const LFSU& lfsu, const LFSV& lfsv) const
+      {
+        return geo.type().isCube() && geo.affine()
+          && lfsu.size() == kernel.size() && lfsv.size() == kernel.size();
+      }
+
+      Kernel kernel;
+      //! coefficients, values and gradients of the inside and outside element
+      mutable std::vector<RangeFieldType> scratch_xl[2];
+      mutable std::vector<RangeFieldType> scratch_u[2];
+      mutable std::vector<GradientType> scratch_gradu[2];
+    };
   }
 }
 #endif
@@ -57,6 +57,9 @@ namespace Dune {
       enum { doAlphaVolume = true };
       enum { doAlphaBoundary = true };
 
+      // batched assembly flags
+      enum { doAlphaVolumeBatch = true };
+
       ConvectionDiffusionFEM (T& param_, int intorderadd_=0) 
         : param(param_), intorderadd(intorderadd_)
       {
@@ -111,7 +114,7 @@ namespace Dune {
 
             // transform gradients of shape functions to real element
             const typename EG::Geometry::JacobianInverseTransposed jac =
-              eg.geometry().jacobianInverseTransposed(it->position());
+              eg.jacobianInverseTransposed(it->position());
             std::vector<Dune::FieldVector<RF,dim> > gradphi(lfsu.size());
             for (size_type i=0; i<lfsu.size(); i++)
               jac.mv(js[i][0],gradphi[i]);
@@ -131,7 +134,7 @@ namespace Dune {
             typename T::Traits::RangeFieldType f = param.f(eg.entity(),it->position());
 
             // integrate (A grad u)*grad phi_i - u b*grad phi_i + c*u*phi_i
-            RF factor = it->weight() * eg.geometry().integrationElement(it->position());
+            RF factor = it->weight() * eg.integrationElement(it->position());
             for (size_type i=0; i<lfsu.size(); i++)
               r.accumulate(lfsu,i,( Agradu*gradphi[i] - u*(b*gradphi[i]) + (c*u-f)*phi[i] )*factor);
           }
@@ -176,7 +179,7 @@ namespace Dune {
 
             // transform gradient to real element
             const typename EG::Geometry::JacobianInverseTransposed jac
-              = eg.geometry().jacobianInverseTransposed(it->position());
+              = eg.jacobianInverseTransposed(it->position());
             std::vector<Dune::FieldVector<RF,dim> > gradphi(lfsu.size());
             std::vector<Dune::FieldVector<RF,dim> > Agradphi(lfsu.size());
             for (size_type i=0; i<lfsu.size(); i++)
@@ -195,13 +198,205 @@ namespace Dune {
             typename T::Traits::RangeFieldType c = param.c(eg.entity(),it->position());
 
             // integrate (A grad phi_j)*grad phi_i - phi_j b*grad phi_i + c*phi_j*phi_i
-            RF factor = it->weight() * eg.geometry().integrationElement(it->position());
+            RF factor = it->weight() * eg.integrationElement(it->position());
             for (size_type j=0; j<lfsu.size(); j++)
               for (size_type i=0; i<lfsu.size(); i++)
                 mat.accumulate(lfsu,i,lfsu,j,( Agradphi[j]*gradphi[i]-phi[j]*(b*gradphi[i])+c*phi[j]*phi[i] )*factor);
           }
       }
 
+      // volume integral of alpha_volume() on a batch of cells, one cell per lane
+      template<typename BT, typename X, typename R>
+      void alpha_volume_batch (const BT& batch, const X& x, R& r) const
+      {
+        // domain and range field type
+        typedef typename BT::LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::DomainFieldType DF;
+        typedef typename BT::LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::RangeFieldType RF;
+        typedef typename BT::LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::JacobianType JacobianType;
+        typedef typename BT::LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::RangeType RangeType;
+        typedef typename BT::LFSU::Traits::SizeType size_type;
+
+        // dimensions and lanes
+        const int dim = BT::coorddimension;
+        static const std::size_t N = BT::lanes;
+
+        // all lanes share the layout of lane 0 (we assume Galerkin method lfsu=lfsv)
+        const typename BT::LFSU& lfsu = batch.lfsu(0);
+
+        // select quadrature rule
+        Dune::GeometryType gt = batch.entity(0).type();
+        const int intorder = intorderadd+2*lfsu.finiteElement().localBasis().order();
+        const Dune::QuadratureRule<DF,dim>& rule = Dune::QuadratureRules<DF,dim>::rule(gt,intorder);
+
+        // evaluate diffusion tensors at cell centers, assume they are constant over elements
+        RF A[dim][dim][N];
+        Dune::FieldVector<DF,dim> localcenter = Dune::GenericReferenceElements<DF,dim>::general(gt).position(0,0);
+        for (std::size_t k=0; k<N; k++)
+          {
+            typename T::Traits::PermTensorType tensor = param.A(batch.entity(k),localcenter);
+            for (int d=0; d<dim; d++)
+              for (int e=0; e<dim; e++)
+                A[d][e][k] = tensor[d][e];
+          }
+
+        // sized once per batch, the quadrature points only overwrite them
+        std::vector<RF> phi(lfsu.size()*N), gradphi(lfsu.size()*dim*N);
+
+        // loop over quadrature points
+        for (typename Dune::QuadratureRule<DF,dim>::const_iterator it=rule.begin(); it!=rule.end(); ++it)
+          {
+            // evaluate basis functions and their gradients on all cells
+            const std::vector<RangeType>& phi0 = cache.evaluateFunction(it->position(),lfsu.finiteElement().localBasis());
+            const std::vector<JacobianType>& js = cache.evaluateJacobian(it->position(),lfsu.finiteElement().localBasis());
+            RF factor[N];
+            batch.basisValues(it->position(),phi0,phi);
+            batch.basisGradients(it->position(),js,gradphi,factor);
+
+            // evaluate u and its gradient
+            RF u[N], gradu[dim][N];
+            for (std::size_t k=0; k<N; k++)
+              {
+                u[k] = 0.0;
+                for (int d=0; d<dim; d++)
+                  gradu[d][k] = 0.0;
+              }
+            for (size_type i=0; i<lfsu.size(); i++)
+              {
+                const typename X::value_type* xi = x[lfsu.localIndex(i)];
+                for (std::size_t k=0; k<N; k++)
+                  u[k] += xi[k]*phi[i*N+k];
+                for (int d=0; d<dim; d++)
+                  for (std::size_t k=0; k<N; k++)
+                    gradu[d][k] += xi[k]*gradphi[(i*dim+d)*N+k];
+              }
+
+            // compute A * gradient of u
+            RF Agradu[dim][N];
+            for (int d=0; d<dim; d++)
+              for (std::size_t k=0; k<N; k++)
+                {
+                  Agradu[d][k] = 0.0;
+                  for (int e=0; e<dim; e++)
+                    Agradu[d][k] += A[d][e][k]*gradu[e][k];
+                }
+
+            // evaluate velocity field, sink term and source term
+            RF b[dim][N], c[N], f[N];
+            for (std::size_t k=0; k<N; k++)
+              {
+                typename T::Traits::RangeType bk = param.b(batch.entity(k),it->position());
+                for (int d=0; d<dim; d++)
+                  b[d][k] = bk[d];
+                c[k] = param.c(batch.entity(k),it->position());
+                f[k] = param.f(batch.entity(k),it->position());
+                factor[k] *= it->weight();
+              }
+
+            // integrate (A grad u)*grad phi_i - u b*grad phi_i + c*u*phi_i
+            for (size_type i=0; i<lfsu.size(); i++)
+              {
+                typename R::value_type* ri = r[lfsu.localIndex(i)];
+                for (std::size_t k=0; k<N; k++)
+                  {
+                    RF flux = (c[k]*u[k]-f[k])*phi[i*N+k];
+                    for (int d=0; d<dim; d++)
+                      flux += (Agradu[d][k] - u[k]*b[d][k])*gradphi[(i*dim+d)*N+k];
+                    ri[k] += flux*factor[k];
+                  }
+              }
+          }
+      }
+
+      // jacobian of alpha_volume_batch()
+      template<typename BT, typename X, typename M>
+      void jacobian_volume_batch (const BT& batch, const X& x, M& mat) const
+      {
+        // domain and range field type
+        typedef typename BT::LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::DomainFieldType DF;
+        typedef typename BT::LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::RangeFieldType RF;
+        typedef typename BT::LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::JacobianType JacobianType;
+        typedef typename BT::LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::RangeType RangeType;
+        typedef typename BT::LFSU::Traits::SizeType size_type;
+
+        // dimensions and lanes
+        const int dim = BT::coorddimension;
+        static const std::size_t N = BT::lanes;
+
+        // all lanes share the layout of lane 0 (we assume Galerkin method lfsu=lfsv)
+        const typename BT::LFSU& lfsu = batch.lfsu(0);
+
+        // select quadrature rule
+        Dune::GeometryType gt = batch.entity(0).type();
+        const int intorder = intorderadd+2*lfsu.finiteElement().localBasis().order();
+        const Dune::QuadratureRule<DF,dim>& rule = Dune::QuadratureRules<DF,dim>::rule(gt,intorder);
+
+        // evaluate diffusion tensors at cell centers, assume they are constant over elements
+        RF A[dim][dim][N];
+        Dune::FieldVector<DF,dim> localcenter = Dune::GenericReferenceElements<DF,dim>::general(gt).position(0,0);
+        for (std::size_t k=0; k<N; k++)
+          {
+            typename T::Traits::PermTensorType tensor = param.A(batch.entity(k),localcenter);
+            for (int d=0; d<dim; d++)
+              for (int e=0; e<dim; e++)
+                A[d][e][k] = tensor[d][e];
+          }
+
+        // sized once per batch, the quadrature points only overwrite them
+        std::vector<RF> phi(lfsu.size()*N), gradphi(lfsu.size()*dim*N), Agradphi(lfsu.size()*dim*N);
+
+        // loop over quadrature points
+        for (typename Dune::QuadratureRule<DF,dim>::const_iterator it=rule.begin(); it!=rule.end(); ++it)
+          {
+            // evaluate basis functions and their gradients on all cells
+            const std::vector<RangeType>& phi0 = cache.evaluateFunction(it->position(),lfsu.finiteElement().localBasis());
+            const std::vector<JacobianType>& js = cache.evaluateJacobian(it->position(),lfsu.finiteElement().localBasis());
+            RF factor[N];
+            batch.basisValues(it->position(),phi0,phi);
+            batch.basisGradients(it->position(),js,gradphi,factor);
+
+            // apply the tensors to the gradients
+            Agradphi.assign(gradphi.size(),0.0);
+            for (size_type i=0; i<lfsu.size(); i++)
+              for (int d=0; d<dim; d++)
+                for (int e=0; e<dim; e++)
+                  for (std::size_t k=0; k<N; k++)
+                    Agradphi[(i*dim+d)*N+k] += A[d][e][k]*gradphi[(i*dim+e)*N+k];
+
+            // evaluate velocity field and sink term
+            RF b[dim][N], c[N];
+            for (std::size_t k=0; k<N; k++)
+              {
+                typename T::Traits::RangeType bk = param.b(batch.entity(k),it->position());
+                for (int d=0; d<dim; d++)
+                  b[d][k] = bk[d];
+                c[k] = param.c(batch.entity(k),it->position());
+                factor[k] *= it->weight();
+              }
+
+            // integrate (A grad phi_j)*grad phi_i - phi_j b*grad phi_i + c*phi_j*phi_i
+            for (size_type j=0; j<lfsu.size(); j++)
+              for (size_type i=0; i<lfsu.size(); i++)
+                {
+                  typename M::value_type* a = mat(lfsu.localIndex(i),lfsu.localIndex(j));
+                  for (std::size_t k=0; k<N; k++)
+                    {
+                      RF v = c[k]*phi[j*N+k]*phi[i*N+k];
+                      for (int d=0; d<dim; d++)
+                        v += (Agradphi[(j*dim+d)*N+k] - phi[j*N+k]*b[d][k])*gradphi[(i*dim+d)*N+k];
+                      a[k] += v*factor[k];
+                    }
+                }
+          }
+      }
+
       // boundary integral
       template<typename IG, typename LFSU, typename X, typename LFSV, typename R>
       void alpha_boundary (const IG& ig, 
@@ -251,7 +446,7 @@ namespace Dune {
                 typename T::Traits::RangeFieldType j = param.j(ig.intersection(),it->position());
             
                 // integrate j
-                RF factor = it->weight()*ig.geometry().integrationElement(it->position());
+                RF factor = it->weight()*ig.integrationElement(it->position());
                 for (size_type i=0; i<lfsu_s.size(); i++)
                   r_s.accumulate(lfsu_s,i,j*phi[i]*factor);
               }
@@ -271,7 +466,7 @@ namespace Dune {
                 typename T::Traits::RangeFieldType o = param.o(ig.intersection(),it->position());
             
                 // integrate o
-                RF factor = it->weight()*ig.geometry().integrationElement(it->position());
+                RF factor = it->weight()*ig.integrationElement(it->position());
                 for (size_type i=0; i<lfsu_s.size(); i++)
                   r_s.accumulate(lfsu_s,i,( (b*n)*u + o)*phi[i]*factor);
               }
@@ -327,7 +522,7 @@ namespace Dune {
             const Dune::FieldVector<DF,dim> n = ig.unitOuterNormal(it->position());
         
             // integrate 
-            RF factor = it->weight()*ig.geometry().integrationElement(it->position());
+            RF factor = it->weight()*ig.integrationElement(it->position());
             for (size_type j=0; j<lfsu_s.size(); j++)
               for (size_type i=0; i<lfsu_s.size(); i++)
                 mat_s.accumulate(lfsu_s,i,lfsu_s,j,(b*n)*phi[j]*phi[i]*factor);
@@ -430,7 +625,7 @@ namespace Dune {
             typename T::Traits::RangeFieldType f = param.f(eg.entity(),it->position());
 
             // integrate f^2
-            RF factor = it->weight() * eg.geometry().integrationElement(it->position());
+            RF factor = it->weight() * eg.integrationElement(it->position());
             sum += (f*f-c*c*u*u)*factor;
           }
 
@@ -501,10 +696,10 @@ namespace Dune {
             lfsu_n.finiteElement().localBasis().evaluateJacobian(iplocal_n,gradphi_n);
 
             // transform gradients of shape functions to real element
-            jac = ig.inside()->geometry().jacobianInverseTransposed(iplocal_s);
+            jac = ig.insideJacobianInverseTransposed(iplocal_s);
             std::vector<Dune::FieldVector<RF,dim> > tgradphi_s(lfsu_s.size());
             for (size_type i=0; i<lfsu_s.size(); i++) jac.mv(gradphi_s[i][0],tgradphi_s[i]);
-            jac = ig.outside()->geometry().jacobianInverseTransposed(iplocal_n);
+            jac = ig.outsideJacobianInverseTransposed(iplocal_n);
             std::vector<Dune::FieldVector<RF,dim> > tgradphi_n(lfsu_n.size());
             for (size_type i=0; i<lfsu_n.size(); i++) jac.mv(gradphi_n[i][0],tgradphi_n[i]);
 
@@ -517,7 +712,7 @@ namespace Dune {
               gradu_n.axpy(x_n(lfsu_n,i),tgradphi_n[i]);
 
             // integrate
-            RF factor = it->weight() * ig.geometry().integrationElement(it->position());
+            RF factor = it->weight() * ig.integrationElement(it->position());
             RF jump = (An_F_s*gradu_s)-(An_F_n*gradu_n);
             sum += 0.25*jump*jump*factor;
           }
@@ -587,7 +782,7 @@ namespace Dune {
             lfsu_s.finiteElement().localBasis().evaluateJacobian(iplocal_s,gradphi_s);
 
             // transform gradients of shape functions to real element
-            jac = ig.inside()->geometry().jacobianInverseTransposed(iplocal_s);
+            jac = ig.insideJacobianInverseTransposed(iplocal_s);
             std::vector<Dune::FieldVector<RF,dim> > tgradphi_s(lfsu_s.size());
             for (size_type i=0; i<lfsu_s.size(); i++) jac.mv(gradphi_s[i][0],tgradphi_s[i]);
 
@@ -600,7 +795,7 @@ namespace Dune {
             RF j = param.j(ig.intersection(),it->position());
                 
             // integrate
-            RF factor = it->weight() * ig.geometry().integrationElement(it->position());
+            RF factor = it->weight() * ig.integrationElement(it->position());
             RF jump = j+(An_F_s*gradu_s);
             sum += jump*jump*factor;
           }
@@ -713,7 +908,7 @@ namespace Dune {
               u += x(lfsu,i)*phi[i];
 
             // integrate f^2
-            RF factor = it->weight() * eg.geometry().integrationElement(it->position());
+            RF factor = it->weight() * eg.integrationElement(it->position());
             sum += u*u*factor;
 
             // evaluate right hand side parameter function
@@ -884,7 +1079,7 @@ namespace Dune {
               u += x(lfsu,i)*phi[i];
 
             // integrate jump
-            RF factor = it->weight() * eg.geometry().integrationElement(it->position());
+            RF factor = it->weight() * eg.integrationElement(it->position());
             sum += u*u*factor;
 
             // evaluate gradient of shape functions (we assume Galerkin method lfsu=lfsv)
@@ -893,7 +1088,7 @@ namespace Dune {
 
             // transform gradients of shape functions to real element
             const typename EG::Geometry::JacobianInverseTransposed jac =
-              eg.geometry().jacobianInverseTransposed(it->position());
+              eg.jacobianInverseTransposed(it->position());
             std::vector<Dune::FieldVector<RF,dim> > gradphi(lfsu.size());
             for (size_type i=0; i<lfsu.size(); i++)
               jac.mv(js[i][0],gradphi[i]);
@@ -979,7 +1174,7 @@ namespace Dune {
             RF j_up = param.j(ig.intersection(),it->position());
 
             // integrate
-            RF factor = it->weight() * ig.geometry().integrationElement(it->position());
+            RF factor = it->weight() * ig.integrationElement(it->position());
             sum_down += (j_down-j_mid)*(j_down-j_mid)*factor;
             sum_up += (j_up-j_mid)*(j_up-j_mid)*factor;
           }
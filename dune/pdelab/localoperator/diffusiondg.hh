@@ -8,6 +8,7 @@
 #include <dune/geometry/quadraturerules.hh>
 #include <dune/geometry/referenceelements.hh>
 
+#include <dune/pdelab/finiteelement/qksumfactorization.hh>
 #include <dune/pdelab/localoperator/defaultimp.hh>
 
 #include "../common/geometrywrapper.hh"
@@ -902,7 +903,7 @@ namespace Dune {
       }
 #endif
 
-    private:
+    protected:
       const K& k;
       const F& f;
       const B& bctype;
@@ -915,6 +916,208 @@ namespace Dune {
       int superintegration_order; // Quadrature order
     };
 
+    // DiffusionDG with sum-factorized volume and face terms for Q_k elements
+    //
+    // On affine cubes, alpha_volume and alpha_skeleton evaluate the
+    // solution at all quadrature points and integrate against all test
+    // functions with QkSumFactorization, at O(k^(d+1)) instead of
+    // O(k^(2d)) operations per element. Other elements, faces whose
+    // embeddings differ from the reference cube and the boundary terms
+    // are left to DiffusionDG. The kernel and the operator keep scratch
+    // buffers which are reused for all elements and faces, so the operator
+    // is not thread-safe and must not be used with ColoredAssembler.
+    //
+    // @tparam FiniteElementMap map to QkDGLocalFiniteElement
+    template<typename K, typename F, typename B, typename G, typename J, typename FiniteElementMap>
+    class SumFactorizedDiffusionDG : public DiffusionDG<K, F, B, G, J>
+    {
+      typedef DiffusionDG<K, F, B, G, J> Base;
+      typedef typename FiniteElementMap::Traits::FiniteElementType::Traits::LocalBasisType LocalBasisType;
+      typedef typename QkSumFactorizationSelector<LocalBasisType>::Type Kernel;
+      typedef typename Kernel::GradientType GradientType;
+      typedef typename LocalBasisType::Traits::RangeFieldType RangeFieldType;
+
+    public:
+      SumFactorizedDiffusionDG (const K& k_, const F& f_, const B& bctype_, const G& g_, const J& j_, int dg_method, int _superintegration_order = 0) :
+        Base(k_, f_, bctype_, g_, j_, dg_method, _superintegration_order),
+        kernel(std::max(2 * (Kernel::degree - 1), 0) + _superintegration_order)
+      {}
+
+      // volume integral depending on test and ansatz functions
+      template<typename EG, typename LFSU, typename X, typename LFSV, typename R>
+      void alpha_volume (const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, R& r) const
+      {
+        if (!applicable(eg.geometry(),lfsu,lfsv))
+          {
+            Base::alpha_volume(eg,lfsu,x,lfsv,r);
+            return;
+          }
+
+        // domain and range field type
+        typedef typename LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::DomainFieldType DF;
+        typedef typename LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::RangeFieldType RF;
+
+        // dimensions
+        const int dim = EG::Geometry::dimension;
+
+        // diffusion tensor and transformation are constant on affine elements
+        Dune::GeometryType gt = eg.geometry().type();
+        typename K::Traits::RangeType tensor(0.0);
+        Dune::FieldVector<DF,dim> localcenter = Dune::ReferenceElements<DF,dim>::general(gt).position(0,0);
+        this->k.evaluate(eg.entity(),localcenter,tensor);
+        const typename EG::Geometry::JacobianInverseTransposed
+          jac = eg.geometry().jacobianInverseTransposed(localcenter);
+        const RF integrationelement = eg.geometry().integrationElement(localcenter);
+
+        // evaluate gradient of u at all quadrature points
+        std::vector<RF>& xl = scratch_xl[0];
+        xl.resize(lfsu.size());
+        for (size_t i=0; i<lfsu.size(); i++)
+          xl[i] = x(lfsu,i);
+        std::vector<RF>& u = scratch_u[0];
+        std::vector<GradientType>& gradu = scratch_gradu[0];
+        kernel.evaluate(xl,u,gradu);
+
+        // integrate (K grad u)*grad phi_i
+        Dune::FieldVector<RF,dim> tgradu, Kgradu;
+        for (size_t q=0; q<kernel.points(); q++)
+          {
+            jac.mv(gradu[q],tgradu);
+            tensor.mv(tgradu,Kgradu);
+            Kgradu *= kernel.weight(q) * integrationelement;
+            jac.mtv(Kgradu,gradu[q]);
+            u[q] = 0.0;
+          }
+        kernel.integrate(u,gradu,xl);
+        for (size_t i=0; i<lfsv.size(); i++)
+          r.accumulate( lfsv, i, xl[i] );
+      }
+
+      // skeleton integral depending on test and ansatz functions
+      // each face is only visited ONCE!
+      template<typename IG, typename LFSU, typename X, typename LFSV, typename R>
+      void alpha_skeleton (const IG& ig,
+                           const LFSU& lfsu_s, const X& x_s, const LFSV& lfsv_s,
+                           const LFSU& lfsu_n, const X& x_n, const LFSV& lfsv_n,
+                           R& r_s, R& r_n) const
+      {
+        const int face_s = ig.indexInInside();
+        const int face_n = ig.indexInOutside();
+        if (!applicable(ig.inside()->geometry(),lfsu_s,lfsv_s) ||
+            !applicable(ig.outside()->geometry(),lfsu_n,lfsv_n) ||
+            !Kernel::canonicalFace(face_s,ig.geometryInInside()) ||
+            !Kernel::canonicalFace(face_n,ig.geometryInOutside()))
+          {
+            Base::alpha_skeleton(ig,lfsu_s,x_s,lfsv_s,lfsu_n,x_n,lfsv_n,r_s,r_n);
+            return;
+          }
+
+        // domain and range field type
+        typedef typename LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::DomainFieldType DF;
+        typedef typename LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits::RangeFieldType RF;
+
+        // dimensions
+        const int dim = IG::dimension;
+        const int dimw = IG::dimensionworld;
+
+        // normal of center in face's reference element
+        const Dune::FieldVector<DF,IG::dimension-1>& face_center =
+          Dune::ReferenceElements<DF,IG::dimension-1>::
+          general(ig.geometry().type()).position(0,0);
+        const Dune::FieldVector<DF,dimw> normal = ig.unitOuterNormal(face_center);
+
+        // evaluate diffusion tensor at elements' centers, assume they are constant over elements
+        const Dune::FieldVector<DF,IG::dimension>&
+          inside_local = Dune::ReferenceElements<DF,IG::dimension>::general(ig.inside()->type()).position(0,0);
+        const Dune::FieldVector<DF,IG::dimension>&
+          outside_local = Dune::ReferenceElements<DF,IG::dimension>::general(ig.outside()->type()).position(0,0);
+        typename K::Traits::RangeType permeability_s(0.0);
+        typename K::Traits::RangeType permeability_n(0.0);
+        this->k.evaluate(*(ig.inside()),inside_local,permeability_s);
+        this->k.evaluate(*(ig.outside()),outside_local,permeability_n);
+
+        // (K grad v)*normal = grad v * (K^T normal)
+        Dune::FieldVector<RF,dim> ktnormal_s, ktnormal_n;
+        permeability_s.mtv(normal,ktnormal_s);
+        permeability_n.mtv(normal,ktnormal_n);
+
+        // penalty weight for NIPG / SIPG
+        RF penalty_weight = this->sigma / pow(ig.geometry().volume(), this->beta);
+
+        // transformations and face integration element are constant on affine elements
+        const typename IG::Entity::Geometry::JacobianInverseTransposed
+          jac_s = ig.inside()->geometry().jacobianInverseTransposed(inside_local);
+        const typename IG::Entity::Geometry::JacobianInverseTransposed
+          jac_n = ig.outside()->geometry().jacobianInverseTransposed(outside_local);
+        const RF integrationelement = ig.geometry().integrationElement(face_center);
+
+        // evaluate u and its reference gradient on both sides of the face
+        std::vector<RF>& xl_s = scratch_xl[0];
+        std::vector<RF>& xl_n = scratch_xl[1];
+        xl_s.resize(lfsu_s.size());
+        xl_n.resize(lfsu_n.size());
+        for (size_t i=0; i<lfsu_s.size(); i++)
+          xl_s[i] = x_s(lfsu_s,i);
+        for (size_t i=0; i<lfsu_n.size(); i++)
+          xl_n[i] = x_n(lfsu_n,i);
+        std::vector<RF>& u_s = scratch_u[0];
+        std::vector<RF>& u_n = scratch_u[1];
+        std::vector<GradientType>& gradu_s = scratch_gradu[0];
+        std::vector<GradientType>& gradu_n = scratch_gradu[1];
+        kernel.evaluateFace(face_s,xl_s,u_s,gradu_s);
+        kernel.evaluateFace(face_n,xl_n,u_n,gradu_n);
+
+        Dune::FieldVector<RF,dim> tgradu_s, tgradu_n, flux;
+        for (size_t q=0; q<kernel.facePoints(); q++)
+          {
+            jac_s.mv(gradu_s[q],tgradu_s);
+            jac_n.mv(gradu_n[q],tgradu_n);
+
+            // jump of u and average of K * grad u * normal
+            RF u_jump = u_s[q] - u_n[q];
+            RF kgradunormal_average = (ktnormal_s*tgradu_s + ktnormal_n*tgradu_n) * 0.5;
+
+            RF factor = kernel.faceWeight(q) * integrationelement;
+
+            // epsilon * <Kgradv*my>[u]
+            flux = ktnormal_s;
+            flux *= this->epsilon * 0.5 * u_jump * factor;
+            jac_s.mtv(flux,gradu_s[q]);
+            flux = ktnormal_n;
+            flux *= this->epsilon * 0.5 * u_jump * factor;
+            jac_n.mtv(flux,gradu_n[q]);
+
+            // NIPG / SIPG penalty term and - <Kgradu*my>[v]
+            u_s[q] = (penalty_weight * u_jump - kgradunormal_average) * factor;
+            u_n[q] = -u_s[q];
+          }
+        kernel.integrateFace(face_s,u_s,gradu_s,xl_s);
+        kernel.integrateFace(face_n,u_n,gradu_n,xl_n);
+        for (size_t i=0; i<lfsv_s.size(); i++)
+          r_s.accumulate( lfsv_s, i, xl_s[i] );
+        for (size_t i=0; i<lfsv_n.size(); i++)
+          r_n.accumulate( lfsv_n, i, xl_n[i] );
+      }
+
+    private:
+      template<typename Geometry, typename LFSU, typename LFSV>
+      bool applicable (const Geometry& geo, const LFSU& lfsu, const LFSV& lfsv) const
+      {
+        return geo.type().isCube() && geo.affine()
+          && lfsu.size() == kernel.size() && lfsv.size() == kernel.size();
+      }
+
+      Kernel kernel;
+      //! coefficients, values and gradients of the inside and outside element
+      mutable std::vector<RangeFieldType> scratch_xl[2];
+      mutable std::vector<RangeFieldType> scratch_u[2];
+      mutable std::vector<GradientType> scratch_gradu[2];
+    };
+
     //! \} group GridFunctionSpace
   } // namespace PDELab
 } // namespace Dune
@@ -74,6 +74,26 @@ namespace Dune
 
             //! \} Flags for the constant part of the residual
 
+            //! \name Flags for batched assembly
+            //! \{
+
+            //! \brief Whether the local operator implements
+            //!        alpha_volume_batch() and jacobian_volume_batch(),
+            //!        which evaluate volumeBatchSize cells of the same
+            //!        GeometryType at once, one cell per SIMD lane.
+            /**
+             * The batched methods are only called if batching has been
+             * enabled on the assembler; otherwise, and for the cells the
+             * assembler cannot batch, alpha_volume() and jacobian_volume()
+             * are used.  Both have to compute the same contributions.
+             */
+            enum { /*! \hideinitializer */ doAlphaVolumeBatch = false };
+            //! \brief Number of cells evaluated by one call of
+            //!        alpha_volume_batch() or jacobian_volume_batch().
+            enum { /*! \hideinitializer */ volumeBatchSize = 8 };
+
+            //! \} Flags for batched assembly
+
             //! \name Special flags
             //! \{
 
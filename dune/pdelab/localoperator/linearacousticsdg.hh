@@ -16,7 +16,7 @@
 #include<dune/pdelab/localoperator/flags.hh>
 #include<dune/pdelab/localoperator/idefault.hh>
 #include<dune/pdelab/localoperator/defaultimp.hh>
-#include<dune/pdelab/finiteelement/localbasiscache.hh>
+#include<dune/pdelab/finiteelement/quadraturebasiscache.hh>
 
 #include"linearacousticsparameter.hh"
 
@@ -191,6 +191,18 @@ namespace Dune {
       {
       }
 
+      //! \brief switch the tabulation of the basis at the quadrature points on or off
+      /**
+       * Without tabulation the basis is evaluated at every quadrature
+       * point of every element, which gives the reference values for the
+       * cached assembly.
+       */
+      void setBasisCaching (bool enabled)
+      {
+        for (std::size_t i=0; i<cache.size(); ++i)
+          cache[i].setEnabled(enabled);
+      }
+
       // volume integral depending on test and ansatz functions
       template<typename EG, typename LFSU, typename X, typename LFSV, typename R>
       void alpha_volume (const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, R& r) const
@@ -231,11 +243,14 @@ namespace Dune {
 
         // std::cout << "alpha_volume center=" << eg.geometry().center() << std::endl;
 
+        // tabulate basis functions at the quadrature points
+        const typename Cache::Table& table = cache[order].tabulate(rule,dgspace.finiteElement().localBasis());
+
         // loop over quadrature points
         for (typename Dune::QuadratureRule<DF,dim>::const_iterator it=rule.begin(); it!=rule.end(); ++it)
           {
             // evaluate basis functions
-            const std::vector<RangeType>& phi = cache[order].evaluateFunction(it->position(),dgspace.finiteElement().localBasis());
+            const RangeType* phi = table.function(it-rule.begin());
 
             // evaluate u
             Dune::FieldVector<RF,dim+1> u(0.0);
@@ -245,7 +260,7 @@ namespace Dune {
             // std::cout << "  u at " << it->position() << " : " << u << std::endl;
 
             // evaluate gradient of basis functions (we assume Galerkin method lfsu=lfsv)
-            const std::vector<JacobianType>& js = cache[order].evaluateJacobian(it->position(),dgspace.finiteElement().localBasis());
+            const JacobianType* js = table.jacobian(it-rule.begin());
 
             // compute global gradients
             jac = eg.geometry().jacobianInverseTransposed(it->position());
@@ -337,6 +352,10 @@ namespace Dune {
 
         // std::cout << "alpha_skeleton center=" << ig.geometry().center() << std::endl;
 
+        // tabulate basis functions at the quadrature points
+        const typename Cache::Table& table_s = cache[order_s].tabulate(rule,ig.geometryInInside(),dgspace_s.finiteElement().localBasis());
+        const typename Cache::Table& table_n = cache[order_n].tabulate(rule,ig.geometryInOutside(),dgspace_n.finiteElement().localBasis());
+
         // loop over quadrature points
         for (typename Dune::QuadratureRule<DF,dim-1>::const_iterator it=rule.begin(); it!=rule.end(); ++it)
           {
@@ -345,8 +364,8 @@ namespace Dune {
             Dune::FieldVector<DF,dim> iplocal_n = ig.geometryInOutside().global(it->position());
 
             // evaluate basis functions
-            const std::vector<RangeType>& phi_s = cache[order_s].evaluateFunction(iplocal_s,dgspace_s.finiteElement().localBasis());
-            const std::vector<RangeType>& phi_n = cache[order_n].evaluateFunction(iplocal_n,dgspace_n.finiteElement().localBasis());
+            const RangeType* phi_s = table_s.function(it-rule.begin());
+            const RangeType* phi_n = table_n.function(it-rule.begin());
 
             // evaluate u from inside and outside
             Dune::FieldVector<RF,dim+1> u_s(0.0);
@@ -444,6 +463,9 @@ namespace Dune {
 
         // std::cout << "alpha_boundary center=" << ig.geometry().center() << std::endl;
 
+        // tabulate basis functions at the quadrature points
+        const typename Cache::Table& table_s = cache[order_s].tabulate(rule,ig.geometryInInside(),dgspace_s.finiteElement().localBasis());
+
         // loop over quadrature points
         for (typename Dune::QuadratureRule<DF,dim-1>::const_iterator it=rule.begin(); it!=rule.end(); ++it)
           {
@@ -451,7 +473,7 @@ namespace Dune {
             Dune::FieldVector<DF,dim> iplocal_s = ig.geometryInInside().global(it->position());
 
             // evaluate basis functions
-            const std::vector<RangeType>& phi_s = cache[order_s].evaluateFunction(iplocal_s,dgspace_s.finiteElement().localBasis());
+            const RangeType* phi_s = table_s.function(it-rule.begin());
 
             // evaluate u from inside and outside
             Dune::FieldVector<RF,dim+1> u_s(0.0);
@@ -506,6 +528,9 @@ namespace Dune {
         Dune::GeometryType gt = eg.geometry().type();
         const Dune::QuadratureRule<DF,dim>& rule = Dune::QuadratureRules<DF,dim>::rule(gt,intorder);
 
+        // tabulate basis functions at the quadrature points
+        const typename Cache::Table& table = cache[order_s].tabulate(rule,dgspace.finiteElement().localBasis());
+
         // loop over quadrature points
         for (typename Dune::QuadratureRule<DF,dim>::const_iterator it=rule.begin(); it!=rule.end(); ++it)
           {
@@ -513,7 +538,7 @@ namespace Dune {
             Dune::FieldVector<RF,dim+1> q(param.q(eg.entity(),it->position()));
 
             // evaluate basis functions
-            const std::vector<RangeType>& phi = cache[order_s].evaluateFunction(it->position(),dgspace.finiteElement().localBasis());
+            const RangeType* phi = table.function(it-rule.begin());
 
             // integrate
             RF factor = it->weight() * eg.geometry().integrationElement(it->position());
@@ -554,7 +579,7 @@ namespace Dune {
       T& param;
       int overintegration;
       typedef typename FEM::Traits::FiniteElementType::Traits::LocalBasisType LocalBasisType;
-      typedef Dune::PDELab::LocalBasisCache<LocalBasisType> Cache;
+      typedef Dune::PDELab::QuadratureBasisCache<LocalBasisType> Cache;
       std::vector<Cache> cache;
     };
 
@@ -584,6 +609,18 @@ namespace Dune {
         : param(param_), overintegration(overintegration_), cache(20)
       {}
 
+      //! \brief switch the tabulation of the basis at the quadrature points on or off
+      /**
+       * Without tabulation the basis is evaluated at every quadrature
+       * point of every element, which gives the reference values for the
+       * cached assembly.
+       */
+      void setBasisCaching (bool enabled)
+      {
+        for (std::size_t i=0; i<cache.size(); ++i)
+          cache[i].setEnabled(enabled);
+      }
+
       // define sparsity pattern of operator representation
       template<typename LFSU, typename LFSV>
       void pattern_volume (const LFSU& lfsu, const LFSV& lfsv,
@@ -627,11 +664,14 @@ namespace Dune {
         Dune::GeometryType gt = eg.geometry().type();
         const Dune::QuadratureRule<DF,dim>& rule = Dune::QuadratureRules<DF,dim>::rule(gt,intorder);
 
+        // tabulate basis functions at the quadrature points
+        const typename Cache::Table& table = cache[order].tabulate(rule,dgspace.finiteElement().localBasis());
+
         // loop over quadrature points
         for (typename Dune::QuadratureRule<DF,dim>::const_iterator it=rule.begin(); it!=rule.end(); ++it)
           {
             // evaluate basis functions
-            const std::vector<RangeType>& phi = cache[order].evaluateFunction(it->position(),dgspace.finiteElement().localBasis());
+            const RangeType* phi = table.function(it-rule.begin());
 
             // evaluate u
             Dune::FieldVector<RF,dim+1> u(0.0);
@@ -671,11 +711,14 @@ namespace Dune {
         Dune::GeometryType gt = eg.geometry().type();
         const Dune::QuadratureRule<DF,dim>& rule = Dune::QuadratureRules<DF,dim>::rule(gt,intorder);
 
+        // tabulate basis functions at the quadrature points
+        const typename Cache::Table& table = cache[order].tabulate(rule,dgspace.finiteElement().localBasis());
+
         // loop over quadrature points
         for (typename Dune::QuadratureRule<DF,dim>::const_iterator it=rule.begin(); it!=rule.end(); ++it)
           {
             // evaluate basis functions
-            const std::vector<RangeType>& phi = cache[order].evaluateFunction(it->position(),dgspace.finiteElement().localBasis());
+            const RangeType* phi = table.function(it-rule.begin());
 
             // integrate
             RF factor = it->weight() * eg.geometry().integrationElement(it->position());
@@ -690,7 +733,7 @@ namespace Dune {
       T& param;
       int overintegration;
       typedef typename FEM::Traits::FiniteElementType::Traits::LocalBasisType LocalBasisType;
-      typedef Dune::PDELab::LocalBasisCache<LocalBasisType> Cache;
+      typedef Dune::PDELab::QuadratureBasisCache<LocalBasisType> Cache;
       std::vector<Cache> cache;
     };
 
@@ -55,6 +55,9 @@ namespace Dune {
       enum { doLambdaVolume = true };
       enum { doLambdaBoundary = true };
 
+      // batched assembly flags
+      enum { doAlphaVolumeBatch = true };
+
       Poisson (const F& f_, const B& bctype_, const J& j_)
         : f(f_), bctype(bctype_), j(j_)
       {}
@@ -109,6 +112,133 @@ namespace Dune {
           }
 	  }
 
+	  // volume integral of alpha_volume() on a batch of cells, one cell per lane
+	  // (requires a scalar local basis)
+	  template<typename BT, typename X, typename R>
+	  void alpha_volume_batch (const BT& batch, const X& x, R& r) const
+	  {
+		// domain and range field type
+        typedef typename BT::LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits LocalBasisTraits;
+        typedef typename LocalBasisTraits::DomainFieldType DF;
+        typedef typename LocalBasisTraits::RangeFieldType RF;
+        typedef typename LocalBasisTraits::JacobianType JacobianType;
+
+        // dimensions and lanes
+        static const int dimLocal = BT::mydimension;
+        static const int dimGlobal = BT::coorddimension;
+        static const std::size_t N = BT::lanes;
+
+        // all lanes share the layout of lane 0 (we assume Galerkin method lfsu=lfsv)
+        const typename BT::LFSU& lfsu = batch.lfsu(0);
+        const typename BT::LFSV& lfsv = batch.lfsv(0);
+
+        // select quadrature rule
+        Dune::GeometryType gt = batch.entity(0).type();
+        const Dune::QuadratureRule<DF,dimLocal>& rule =
+          Dune::QuadratureRules<DF,dimLocal>::rule(gt,qorder);
+
+        std::vector<JacobianType> js(lfsu.size());
+        // sized once per batch, the quadrature points only overwrite it
+        std::vector<RF> gradphi(lfsu.size()*dimGlobal*N);
+
+        // loop over quadrature points
+        for(typename Dune::QuadratureRule<DF,dimLocal>::const_iterator it =
+              rule.begin(); it!=rule.end(); ++it)
+          {
+            // evaluate gradient of shape functions on all cells
+            lfsu.finiteElement().localBasis().evaluateJacobian(it->position(),js);
+            RF factor[N];
+            batch.basisGradients(it->position(),js,gradphi,factor);
+            for (std::size_t k=0; k<N; k++)
+              factor[k] *= it->weight();
+
+            // compute gradient of u
+            RF gradu[dimGlobal][N];
+            for (int d=0; d<dimGlobal; d++)
+              for (std::size_t k=0; k<N; k++)
+                gradu[d][k] = 0.0;
+            for (size_t i=0; i<lfsu.size(); i++)
+              {
+                const typename X::value_type* xi = x[lfsu.localIndex(i)];
+                for (int d=0; d<dimGlobal; d++)
+                  {
+                    const RF* g = &gradphi[(i*dimGlobal+d)*N];
+                    for (std::size_t k=0; k<N; k++)
+                      gradu[d][k] += xi[k]*g[k];
+                  }
+              }
+
+            // integrate grad u * grad phi_i
+            for (size_t i=0; i<lfsv.size(); i++)
+              {
+                typename R::value_type* ri = r[lfsv.localIndex(i)];
+                for (int d=0; d<dimGlobal; d++)
+                  {
+                    const RF* g = &gradphi[(i*dimGlobal+d)*N];
+                    for (std::size_t k=0; k<N; k++)
+                      ri[k] += gradu[d][k]*g[k]*factor[k];
+                  }
+              }
+          }
+	  }
+
+	  // jacobian of alpha_volume_batch()
+	  template<typename BT, typename X, typename M>
+	  void jacobian_volume_batch (const BT& batch, const X& x, M& mat) const
+	  {
+		// domain and range field type
+        typedef typename BT::LFSU::Traits::FiniteElementType::
+          Traits::LocalBasisType::Traits LocalBasisTraits;
+        typedef typename LocalBasisTraits::DomainFieldType DF;
+        typedef typename LocalBasisTraits::RangeFieldType RF;
+        typedef typename LocalBasisTraits::JacobianType JacobianType;
+
+        // dimensions and lanes
+        static const int dimLocal = BT::mydimension;
+        static const int dimGlobal = BT::coorddimension;
+        static const std::size_t N = BT::lanes;
+
+        // all lanes share the layout of lane 0 (we assume Galerkin method lfsu=lfsv)
+        const typename BT::LFSU& lfsu = batch.lfsu(0);
+        const typename BT::LFSV& lfsv = batch.lfsv(0);
+
+        // select quadrature rule
+        Dune::GeometryType gt = batch.entity(0).type();
+        const Dune::QuadratureRule<DF,dimLocal>& rule =
+          Dune::QuadratureRules<DF,dimLocal>::rule(gt,qorder);
+
+        std::vector<JacobianType> js(lfsu.size());
+        // sized once per batch, the quadrature points only overwrite it
+        std::vector<RF> gradphi(lfsu.size()*dimGlobal*N);
+
+        // loop over quadrature points
+        for(typename Dune::QuadratureRule<DF,dimLocal>::const_iterator it =
+              rule.begin(); it!=rule.end(); ++it)
+          {
+            // evaluate gradient of shape functions on all cells
+            lfsu.finiteElement().localBasis().evaluateJacobian(it->position(),js);
+            RF factor[N];
+            batch.basisGradients(it->position(),js,gradphi,factor);
+            for (std::size_t k=0; k<N; k++)
+              factor[k] *= it->weight();
+
+            // integrate grad phi_j * grad phi_i
+            for (size_t j=0; j<lfsu.size(); j++)
+              for (size_t i=0; i<lfsv.size(); i++)
+                {
+                  typename M::value_type* a = mat(lfsv.localIndex(i),lfsu.localIndex(j));
+                  for (int d=0; d<dimGlobal; d++)
+                    {
+                      const RF* gi = &gradphi[(i*dimGlobal+d)*N];
+                      const RF* gj = &gradphi[(j*dimGlobal+d)*N];
+                      for (std::size_t k=0; k<N; k++)
+                        a[k] += gj[k]*gi[k]*factor[k];
+                    }
+                }
+          }
+	  }
+
  	  // volume integral depending only on test functions
 	  template<typename EG, typename LFSV, typename R>
       void lambda_volume (const EG& eg, const LFSV& lfsv, R& r) const
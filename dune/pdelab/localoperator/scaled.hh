@@ -148,6 +148,16 @@ namespace Dune {
       //! \brief Whether to visit the skeleton methods from both sides
       enum { doSkeletonTwoSided = Backend::doSkeletonTwoSided };
 
+      //! \brief Whether to call the local operator's alpha_volume_batch()
+      //!        and jacobian_volume_batch().
+      /**
+       * Batched assembly is not forwarded to the backend, the scaled
+       * operator is always assembled cell by cell.
+       */
+      enum { doAlphaVolumeBatch = false };
+      //! \brief Number of cells per call of alpha_volume_batch().
+      enum { volumeBatchSize = 1 };
+
       //! \} Control flags
 
       //////////////////////////////////////////////////////////////////////
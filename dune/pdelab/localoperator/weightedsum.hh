@@ -225,6 +225,16 @@ namespace Dune {
       //! \brief Whether to visit the skeleton methods from both sides
       enum { doSkeletonTwoSided          =
              AccFlag<TwoSidedSkeletonRequiredValue>::value  };
+
+      //! \brief Whether to call the local operator's alpha_volume_batch()
+      //!        and jacobian_volume_batch().
+      /**
+       * Batched assembly is not forwarded to the summands, the sum is always
+       * assembled cell by cell.
+       */
+      enum { doAlphaVolumeBatch          = false                  };
+      //! \brief Number of cells per call of alpha_volume_batch().
+      enum { volumeBatchSize             = 1                      };
       dune_static_assert(!(AccFlag<OneSidedSkeletonRequiredValue>::value &&
                            AccFlag<TwoSidedSkeletonRequiredValue>::value),
                          "Some summands require a one-sided skelton, others a "
@@ -3,6 +3,7 @@
 #ifndef DUNE_PDELAB_NEWTON_HH
 #define DUNE_PDELAB_NEWTON_HH
 
+#include <cstddef>
 #include <iostream>
 #include <iomanip>
 #include <cmath>
@@ -11,9 +12,11 @@
 
 #include <dune/common/exceptions.hh>
 #include <dune/common/ios_state.hh>
+#include <dune/common/shared_ptr.hh>
 #include <dune/common/timer.hh>
 
 #include "../backend/solver.hh"
+#include "../gridoperator/common/gridoperatorutilities.hh"
 
 namespace Dune
 {
@@ -39,6 +42,29 @@ namespace Dune
                 first_defect(0.0), defect(0.0), assembler_time(0.0), linear_solver_time(0.0) {}
         };
 
+        // Assembles residual and jacobian in one traversal if the grid
+        // operator supports it, and one after the other otherwise
+        template<class GOS, bool fused = ProvidesResidualAndJacobian<GOS>::value>
+        struct NewtonResidualAndJacobian
+        {
+            template<class X, class R, class A>
+            static void assemble(const GOS& go, const X& x, R& r, A& a)
+            {
+                go.residual(x, r);
+                go.jacobian(x, a);
+            }
+        };
+
+        template<class GOS>
+        struct NewtonResidualAndJacobian<GOS,true>
+        {
+            template<class X, class R, class A>
+            static void assemble(const GOS& go, const X& x, R& r, A& a)
+            {
+                go.residual_and_jacobian(x, r, a);
+            }
+        };
+
         template<class GOS, class TrlV, class TstV>
         class NewtonBase
         {
@@ -70,11 +96,21 @@ namespace Dune
             bool reassembled;
             RFType reduction;
             RFType abs_limit;
+            RFType reassemble_threshold;
+            bool fused_assembly;
+            // the next defect evaluation also assembles the jacobian
+            bool jacobian_with_defect;
+            // the matrix holds the jacobian at the current iterate
+            bool jacobian_current;
 
             NewtonBase(GridOperator& go, TrialVector& u_)
                 : gridoperator(go)
                 , u(&u_)
                 , verbosity_level(1)
+                , reassemble_threshold(0.0)
+                , fused_assembly(false)
+                , jacobian_with_defect(false)
+                , jacobian_current(false)
             {
                 if (gridoperator.trialGridFunctionSpace().gridView().comm().rank()>0)
                     verbosity_level = 0;
@@ -84,6 +120,10 @@ namespace Dune
                 : gridoperator(go)
                 , u(0)
                 , verbosity_level(1)
+                , reassemble_threshold(0.0)
+                , fused_assembly(false)
+                , jacobian_with_defect(false)
+                , jacobian_current(false)
             {
                 if (gridoperator.trialGridFunctionSpace().gridView().comm().rank()>0)
                     verbosity_level = 0;
@@ -115,18 +155,33 @@ namespace Dune
                 : NewtonBase<GOS,TrlV,TstV>(go,u_)
                 , solver(solver_)
                 , result_valid(false)
+                , trial_updates(0)
+                , test_updates(0)
             {}
 
             NewtonSolver(GridOperator& go, Solver& solver_)
                 : NewtonBase<GOS,TrlV,TstV>(go)
                 , solver(solver_)
                 , result_valid(false)
+                , trial_updates(0)
+                , test_updates(0)
             {}
 
             void apply();
 
             void apply(TrialVector& u_);
 
+            /* The jacobian matrix and the work vectors are kept from one
+               call of apply() to the next. They are set up again after
+               update() has been called on one of the grid function
+               spaces, or after discardLinearSystem(). */
+            void discardLinearSystem()
+            {
+                jacobian.reset();
+                correction.reset();
+                residual.reset();
+            }
+
             const Result& result() const
             {
                 if (!result_valid)
@@ -139,7 +194,17 @@ namespace Dune
             virtual void defect(TestVector& r)
             {
                 r = 0.0;                                        // TODO: vector interface
-                this->gridoperator.residual(*this->u, r);
+                this->jacobian_current = false;
+                if (this->jacobian_with_defect)
+                {
+                    // the jacobian at the new iterate comes with the defect
+                    Matrix& A = *jacobian;
+                    A = 0.0;                                    // TODO: Matrix interface
+                    NewtonResidualAndJacobian<GOS>::assemble(this->gridoperator, *this->u, r, A);
+                    this->jacobian_current = true;
+                }
+                else
+                    this->gridoperator.residual(*this->u, r);
                 this->res.defect = this->solver.norm(r);                    // TODO: solver interface
                 if (!std::isfinite(this->res.defect))
                     DUNE_THROW(NewtonDefectError,
@@ -148,6 +213,24 @@ namespace Dune
 
 
         private:
+            // set up the matrix and the work vectors if the spaces have changed
+            void setupLinearSystem()
+            {
+                const std::size_t trial = this->gridoperator.trialGridFunctionSpace().updateCount();
+                const std::size_t test = this->gridoperator.testGridFunctionSpace().updateCount();
+                if (jacobian && trial == trial_updates && test == test_updates)
+                    return;
+                if (this->verbosity_level >= 3)
+                    std::cout << "  Setting up matrix and work vectors" << std::endl;
+                // release the old objects first to limit the peak memory
+                discardLinearSystem();
+                jacobian = shared_ptr<Matrix>(new Matrix(this->gridoperator));
+                correction = shared_ptr<TrialVector>(new TrialVector(this->gridoperator.trialGridFunctionSpace()));
+                residual = shared_ptr<TestVector>(new TestVector(this->gridoperator.testGridFunctionSpace()));
+                trial_updates = trial;
+                test_updates = test;
+            }
+
             void linearSolve(Matrix& A, TrialVector& z, TestVector& r) const
             {
                 if (this->verbosity_level >= 4)
@@ -171,6 +254,12 @@ namespace Dune
 
             Solver& solver;
             bool result_valid;
+
+            shared_ptr<Matrix> jacobian;
+            shared_ptr<TrialVector> correction;
+            shared_ptr<TestVector> residual;
+            std::size_t trial_updates;
+            std::size_t test_updates;
         };
 
         template<class GOS, class S, class TrlV, class TstV>
@@ -191,12 +280,18 @@ namespace Dune
             this->res.assembler_time = 0.0;
             this->res.linear_solver_time = 0.0;
             result_valid = true;
+            this->jacobian_current = false;
             Timer timer;
 
             try
             {
-                TestVector r(this->gridoperator.testGridFunctionSpace());
+                setupLinearSystem();
+                TestVector& r = *residual;
+                // the first step compares the defect with itself, so it
+                // reassembles unless the threshold is at least one
+                this->jacobian_with_defect = this->fused_assembly && this->reassemble_threshold < 1.0;
                 this->defect(r);
+                this->jacobian_with_defect = false;
                 this->res.first_defect = this->res.defect;
                 this->prev_defect = this->res.defect;
 
@@ -209,8 +304,8 @@ namespace Dune
                               << this->res.defect << std::endl;
                 }
 
-                Matrix A(this->gridoperator);
-                TrialVector z(this->gridoperator.trialGridFunctionSpace());
+                Matrix& A = *jacobian;
+                TrialVector& z = *correction;
 
                 while (!this->terminate())
                 {
@@ -390,14 +485,12 @@ namespace Dune
                 : NewtonBase<GOS,TrlV,TstV>(go,u_)
                 , min_linear_reduction(1e-3)
                 , fixed_linear_reduction(0.0)
-                , reassemble_threshold(0.0)
             {}
 
             NewtonPrepareStep(GridOperator& go)
                 : NewtonBase<GOS,TrlV,TstV>(go)
                 , min_linear_reduction(1e-3)
                 , fixed_linear_reduction(0.0)
-                , reassemble_threshold(0.0)
             {}
 
             /* with min_linear_reduction > 0, the linear reduction will be
@@ -418,13 +511,32 @@ namespace Dune
 
             void setReassembleThreshold(RFType reassemble_threshold_)
             {
-                reassemble_threshold = reassemble_threshold_;
+                this->reassemble_threshold = reassemble_threshold_;
+            }
+
+            /* with fused_assembly == true, a defect evaluation after
+               which the next step reassembles the matrix in any case
+               also assembles the jacobian in the same grid traversal,
+               and prepare_step() uses that matrix instead of assembling
+               it again. These are the initial defect, if
+               reassemble_threshold < 1, and the defect of an undamped
+               update without line search, if reassemble_threshold <= 0.
+               Line search trials only evaluate the residual. The
+               jacobian of the final defect is assembled in vain. It has
+               no effect if the grid operator cannot assemble both at
+               once, so it is opt-in. */
+            void setFusedAssembly(bool fused_assembly_)
+            {
+                this->fused_assembly = fused_assembly_ && ProvidesResidualAndJacobian<GOS>::value;
             }
 
             virtual void prepare_step(Matrix& A, TstV& )
             {
                 this->reassembled = false;
-                if (this->res.defect/this->prev_defect > reassemble_threshold)
+                if (this->jacobian_current)
+                    // assembled together with the current defect
+                    this->reassembled = true;
+                else if (this->res.defect/this->prev_defect > this->reassemble_threshold)
                 {
                     if (this->verbosity_level >= 3)
                         std::cout << "      Reassembling matrix..." << std::endl;
@@ -432,6 +544,7 @@ namespace Dune
                     this->gridoperator.jacobian(*this->u, A);
                     this->reassembled = true;
                 }
+                this->jacobian_current = false;
 
                 if (fixed_linear_reduction == true)
                     this->linear_reduction = min_linear_reduction;
@@ -471,7 +584,6 @@ namespace Dune
         private:
             RFType min_linear_reduction;
             bool fixed_linear_reduction;
-            RFType reassemble_threshold;
         };
 
         template<class GOS, class TrlV, class TstV>
@@ -522,7 +634,17 @@ namespace Dune
                 if (strategy == noLineSearch)
                 {
                     this->u->axpy(-1.0, z);                     // TODO: vector interface
-                    this->defect(r);
+                    // the defect of the new iterate is positive, so the
+                    // next step reassembles for a threshold <= 0
+                    this->jacobian_with_defect = this->fused_assembly && this->reassemble_threshold <= 0.0;
+                    try {
+                        this->defect(r);
+                    }
+                    catch (...) {
+                        this->jacobian_with_defect = false;
+                        throw;
+                    }
+                    this->jacobian_with_defect = false;
                     return;
                 }
 
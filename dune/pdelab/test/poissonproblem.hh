@@ -0,0 +1,178 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_PDELAB_TEST_POISSONPROBLEM_HH
+#define DUNE_PDELAB_TEST_POISSONPROBLEM_HH
+
+#include<dune/common/fvector.hh>
+
+#include<dune/pdelab/finiteelementmap/q1fem.hh>
+#include<dune/pdelab/finiteelementmap/qkdg.hh>
+#include<dune/pdelab/finiteelementmap/conformingconstraints.hh>
+#include<dune/pdelab/gridfunctionspace/gridfunctionspace.hh>
+#include<dune/pdelab/constraints/constraints.hh>
+#include<dune/pdelab/common/function.hh>
+#include<dune/pdelab/gridoperator/gridoperator.hh>
+#include<dune/pdelab/backend/istlvectorbackend.hh>
+#include<dune/pdelab/backend/istlmatrixbackend.hh>
+#include<dune/pdelab/localoperator/poisson.hh>
+#include<dune/pdelab/localoperator/convectiondiffusion.hh>
+#include<dune/pdelab/localoperator/convectiondiffusiondg.hh>
+
+// Model problems shared by the tests of the assemblers and solvers
+
+// source term
+template<typename GV, typename RF>
+class F
+  : public Dune::PDELab::AnalyticGridFunctionBase<Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1>,
+                                                  F<GV,RF> >
+{
+public:
+  typedef Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1> Traits;
+  typedef Dune::PDELab::AnalyticGridFunctionBase<Traits,F<GV,RF> > BaseT;
+
+  F (const GV& gv) : BaseT(gv) {}
+  inline void evaluateGlobal (const typename Traits::DomainType& x,
+                              typename Traits::RangeType& y) const
+  {
+    y = x.two_norm2();
+  }
+};
+
+// Dirichlet (default) or Neumann boundary everywhere
+class ConstraintsParameters
+  : public Dune::PDELab::DirichletConstraintsParameters
+{
+public:
+  explicit ConstraintsParameters (bool dirichlet_ = true) : dirichlet(dirichlet_) {}
+
+  template<typename I>
+  bool isDirichlet(const I & ig, const Dune::FieldVector<typename I::ctype, I::dimension-1> & x) const
+  {
+    return dirichlet;
+  }
+
+private:
+  bool dirichlet;
+};
+
+// Poisson problem with conforming Q1 elements
+template<typename GV, typename CON = Dune::PDELab::ConformingDirichletConstraints>
+struct Q1PoissonProblem
+{
+  typedef Dune::PDELab::Q1LocalFiniteElementMap<typename GV::Grid::ctype,double,GV::dimension> FEM;
+  typedef Dune::PDELab::GridFunctionSpace<GV,FEM,CON,Dune::PDELab::ISTLVectorBackend<1> > GFS;
+  typedef typename GFS::template ConstraintsContainer<double>::Type C;
+  typedef F<GV,double> FType;
+  typedef Dune::PDELab::Poisson<FType,ConstraintsParameters,FType,2> LOP;
+  typedef Dune::PDELab::ISTLBCRSMatrixBackend<1,1> MB;
+  typedef Dune::PDELab::GridOperator<GFS,GFS,LOP,MB,double,double,double,C,C> GO;
+
+  explicit Q1PoissonProblem (const GV& gv, bool dirichlet = true)
+    : gfs(gv,fem), constraintsparameters(dirichlet), f(gv), lop(f,constraintsparameters,f)
+  {
+    Dune::PDELab::constraints(constraintsparameters,gfs,cg);
+  }
+
+  FEM fem;
+  GFS gfs;
+  C cg;
+  ConstraintsParameters constraintsparameters;
+  FType f;
+  LOP lop;
+};
+
+// Poisson problem with Dirichlet boundary and an SIPG discretization
+// with discontinuous Qk elements, which requires skeleton terms
+template<typename GV, int k>
+struct QkDGPoissonProblem
+{
+  typedef Dune::PDELab::QkDGLocalFiniteElementMap<typename GV::Grid::ctype,double,k,GV::dimension> FEM;
+  typedef Dune::PDELab::GridFunctionSpace<GV,FEM,Dune::PDELab::NoConstraints,
+    Dune::PDELab::ISTLVectorBackend<1> > GFS;
+  typedef typename GFS::template ConstraintsContainer<double>::Type C;
+  typedef Dune::PDELab::ConvectionDiffusionModelProblem<GV,double> Param;
+  typedef Dune::PDELab::ConvectionDiffusionDG<Param,FEM> LOP;
+  typedef Dune::PDELab::ISTLBCRSMatrixBackend<1,1> MB;
+  typedef Dune::PDELab::GridOperator<GFS,GFS,LOP,MB,double,double,double,C,C> GO;
+
+  explicit QkDGPoissonProblem (const GV& gv)
+    : gfs(gv,fem),
+      lop(param,Dune::PDELab::ConvectionDiffusionDGMethod::SIPG,
+          Dune::PDELab::ConvectionDiffusionDGWeights::weightsOn,2.0)
+  {}
+
+  FEM fem;
+  GFS gfs;
+  C cg;
+  Param param;
+  LOP lop;
+};
+
+// nonlinear reaction diffusion problem -div((1+u^2) grad u) + u^3 = 10
+template<typename GV, typename RF>
+class ReactionParameters
+  : public Dune::PDELab::ConvectionDiffusionParameterInterface<
+  Dune::PDELab::ConvectionDiffusionParameterTraits<GV,RF>,ReactionParameters<GV,RF> >
+{
+public:
+  typedef Dune::PDELab::ConvectionDiffusionParameterTraits<GV,RF> Traits;
+
+  typename Traits::RangeFieldType
+  f (const typename Traits::ElementType& e, const typename Traits::DomainType& x,
+     typename Traits::RangeFieldType u) const
+  {
+    return 10.0 - u*u*u;
+  }
+
+  typename Traits::RangeFieldType
+  w (const typename Traits::ElementType& e, const typename Traits::DomainType& x,
+     typename Traits::RangeFieldType u) const
+  {
+    return u;
+  }
+
+  typename Traits::RangeFieldType
+  v (const typename Traits::ElementType& e, const typename Traits::DomainType& x,
+     typename Traits::RangeFieldType u) const
+  {
+    return 1.0 + u*u;
+  }
+
+  typename Traits::PermTensorType
+  D (const typename Traits::ElementType& e, const typename Traits::DomainType& x) const
+  {
+    typename Traits::PermTensorType I(0.0);
+    for (int i=0; i<Traits::dimDomain; i++)
+      I[i][i] = 1.0;
+    return I;
+  }
+
+  typename Traits::RangeType
+  q (const typename Traits::ElementType& e, const typename Traits::DomainType& x,
+     typename Traits::RangeFieldType u) const
+  {
+    return typename Traits::RangeType(0.0);
+  }
+
+  template<typename I>
+  bool isDirichlet (const I& intersection,
+                    const Dune::FieldVector<typename I::ctype, I::dimension-1>& coord) const
+  {
+    return true;
+  }
+
+  typename Traits::RangeFieldType
+  g (const typename Traits::ElementType& e, const typename Traits::DomainType& x) const
+  {
+    return 0.0;
+  }
+
+  typename Traits::RangeFieldType
+  j (const typename Traits::ElementType& e, const typename Traits::DomainType& x,
+     typename Traits::RangeFieldType u) const
+  {
+    return 0.0;
+  }
+};
+
+#endif // DUNE_PDELAB_TEST_POISSONPROBLEM_HH
@@ -0,0 +1,120 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<iostream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../backend/seqistlsolverbackend.hh"
+#include"poissonproblem.hh"
+
+// solve A z = r from zero and check how the hierarchy was obtained
+template<typename LS, typename M, typename V>
+bool solve (LS& ls, M& A, const V& r, Dune::PDELab::ISTLAMGStatistics::HierarchySetup setup,
+            const std::string& name)
+{
+  V z(r);
+  V rhs(r);
+  z = 0.0;
+  ls.apply(A,z,rhs,1e-10);
+
+  const Dune::PDELab::ISTLAMGStatistics& stats = ls.statistics();
+  std::cout << name << ": setup " << stats.setup << ", " << stats.iterations
+            << " iterations, " << stats.setupIterations << " after the last full setup, "
+            << "setup time " << stats.tsetup << std::endl;
+
+  bool passed = ls.result().converged && stats.setup == setup;
+  if (setup == Dune::PDELab::ISTLAMGStatistics::keptHierarchy)
+    passed &= stats.tsetup == 0.0;
+  if (!passed)
+    std::cerr << "failed: " << name << std::endl;
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    Dune::FieldVector<double,2> L(1.0);
+    Dune::FieldVector<int,2> N(32);
+    Dune::FieldVector<bool,2> B(false);
+    Dune::YaspGrid<2> grid(L,N,B,0);
+    typedef Dune::YaspGrid<2>::LeafGridView GV;
+    const GV& gv=grid.leafView();
+
+    typedef Q1PoissonProblem<GV> Problem;
+    Problem problem(gv);
+    Problem::GO go(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+
+    typedef Problem::GO::Traits::Domain V;
+    typedef Problem::GO::Traits::Jacobian M;
+    V x(problem.gfs,0.0);
+    V r(problem.gfs,0.0);
+    go.residual(x,r);
+    M A(go);
+    A = 0.0;
+    go.jacobian(x,A);
+
+    typedef Dune::PDELab::ISTLAMGStatistics Stats;
+    typedef Dune::PDELab::ISTLBackend_SEQ_BCGS_AMG_SSOR<Problem::GO> LS;
+    LS ls(5000,0,false,false);
+    ls.setAdaptiveReuse(1.5,3.0);
+
+    bool passed = true;
+
+    // the first solve sets up the hierarchy
+    passed &= solve(ls,A,r,Stats::fullSetup,"first solve");
+
+    // the same number of iterations again keeps it
+    passed &= solve(ls,A,r,Stats::keptHierarchy,"unchanged iterations");
+
+    // the decisions only depend on the growth of the iteration count,
+    // which is one for the same system, so move the thresholds below it;
+    // a SuperLU coarse solver is not updated by the Galerkin products
+    ls.setAdaptiveReuse(0.5,1.5);
+    const Stats::HierarchySetup update
+      = ls.statistics().directCoarseLevelSolver ? Stats::fullSetup : Stats::galerkinUpdate;
+    passed &= solve(ls,A,r,update,"moderate growth");
+
+    ls.setAdaptiveReuse(0.25,0.5);
+    passed &= solve(ls,A,r,Stats::fullSetup,"large growth");
+
+    // a different matrix is always set up from scratch
+    ls.setAdaptiveReuse(1.5,3.0);
+    passed &= solve(ls,A,r,Stats::keptHierarchy,"unchanged iterations after a full setup");
+    M A2(go);
+    A2 = 0.0;
+    go.jacobian(x,A2);
+    passed &= solve(ls,A2,r,Stats::fullSetup,"different matrix");
+    passed &= solve(ls,A2,r,Stats::keptHierarchy,"unchanged iterations with the new matrix");
+
+    // ILU smoothers keep the factorization of the old matrix, so there
+    // is no Galerkin update
+    typedef Dune::PDELab::ISTLBackend_SEQ_AMG<Problem::GO,Dune::SeqILU0,Dune::BiCGSTABSolver> ILULS;
+    ILULS ilu(5000,0,false,false);
+    ilu.setAdaptiveReuse(1.5,3.0);
+    passed &= solve(ilu,A,r,Stats::fullSetup,"ILU first solve");
+    passed &= solve(ilu,A,r,Stats::keptHierarchy,"ILU unchanged iterations");
+    ilu.setAdaptiveReuse(0.5,1.5);
+    passed &= solve(ilu,A,r,Stats::fullSetup,"ILU moderate growth");
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,132 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<fstream>
+#include<iostream>
+#include<iterator>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/pdelab/backend/backendselector.hh>
+
+#include"../finiteelementmap/q12dfem.hh"
+#include"../gridfunctionspace/gridfunctionspace.hh"
+#include"../gridfunctionspace/gridfunctionspaceutilities.hh"
+#include"../gridfunctionspace/interpolate.hh"
+#include"../common/function.hh"
+#include"../common/vtkexport.hh"
+#include"../instationary/asyncpvdwriter.hh"
+
+template<typename GV, typename RF>
+class U
+  : public Dune::PDELab::AnalyticGridFunctionBase<Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1>,
+                                                  U<GV,RF> >
+{
+public:
+  typedef Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1> Traits;
+  typedef Dune::PDELab::AnalyticGridFunctionBase<Traits,U<GV,RF> > BaseT;
+
+  U (const GV& gv) : BaseT(gv) {}
+  inline void evaluateGlobal (const typename Traits::DomainType& x,
+                              typename Traits::RangeType& y) const
+  {
+    y = x[0]*x[1];
+  }
+};
+
+std::string contents (const std::string& name)
+{
+  std::ifstream s(name.c_str(), std::ios::binary);
+  if (!s.is_open())
+    DUNE_THROW(Dune::IOError, "could not open " << name);
+  return std::string(std::istreambuf_iterator<char>(s), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    Dune::FieldVector<double,2> L(1.0);
+    Dune::FieldVector<int,2> N(4);
+    Dune::FieldVector<bool,2> B(false);
+    Dune::YaspGrid<2> grid(L,N,B,0);
+    typedef Dune::YaspGrid<2>::LeafGridView GV;
+    const GV& gv=grid.leafView();
+
+    typedef Dune::PDELab::Q12DLocalFiniteElementMap<GV::Grid::ctype,double> FEM;
+    FEM fem;
+    typedef Dune::PDELab::GridFunctionSpace<GV,FEM> GFS;
+    GFS gfs(gv,fem);
+    typedef Dune::PDELab::BackendVectorSelector<GFS,double>::Type V;
+    V x(gfs);
+    U<GV,double> u(gv);
+    Dune::PDELab::interpolate(u,gfs,x);
+
+    typedef Dune::PDELab::DiscreteGridFunction<GFS,V> DGF;
+    DGF dgf(gfs,x);
+
+    // the same time steps written from the background thread and synchronously
+    Dune::PDELab::AsyncPVDWriter<GV> async(gv,"asyncpvd","",Dune::VTK::conforming,0,true);
+    async.addVertexData(new Dune::PDELab::VTKGridFunctionAdapter<DGF>(dgf,"u"));
+    async.addCellData(new Dune::PDELab::VTKGridFunctionAdapter<DGF>(dgf,"ucell"));
+    Dune::PDELab::AsyncPVDWriter<GV> sync(gv,"syncpvd","",Dune::VTK::conforming,0,false);
+    sync.addVertexData(new Dune::PDELab::VTKGridFunctionAdapter<DGF>(dgf,"u"));
+    sync.addCellData(new Dune::PDELab::VTKGridFunctionAdapter<DGF>(dgf,"ucell"));
+
+    const int steps = 4;
+    for (int i=0; i<steps; i++)
+      {
+        async.write(0.5*i);
+        sync.write(0.5*i);
+        // the coefficients change while the time step may still be written
+        x *= 2.0;
+      }
+    async.flush();
+
+    bool passed = true;
+    Dune::PDELab::FilenameHelper fa("asyncpvd"), fs("syncpvd");
+    for (int i=0; i<steps; i++)
+      {
+        const std::string a = Dune::PDELab::AsyncPVDWriterImp::parallelName(fa.getName(i),"",0,1,false);
+        const std::string s = Dune::PDELab::AsyncPVDWriterImp::parallelName(fs.getName(i),"",0,1,false);
+        if (contents(a) != contents(s))
+          {
+            std::cerr << a << " differs from " << s << std::endl;
+            passed = false;
+          }
+        if (contents(a).find("NumberOfPoints=\"25\" NumberOfCells=\"16\"") == std::string::npos)
+          {
+            std::cerr << a << " has a wrong number of points or cells" << std::endl;
+            passed = false;
+          }
+      }
+
+    // the collection lists all time steps and is closed properly
+    const std::string pvd = contents("asyncpvd.pvd");
+    std::size_t datasets = 0;
+    for (std::size_t pos = pvd.find("<DataSet"); pos != std::string::npos; pos = pvd.find("<DataSet",pos+1))
+      ++datasets;
+    if (datasets != std::size_t(steps) || pvd.find("</Collection>\n</VTKFile>\n") != pvd.size() - 25)
+      {
+        std::cerr << "asyncpvd.pvd is broken:\n" << pvd << std::endl;
+        passed = false;
+      }
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
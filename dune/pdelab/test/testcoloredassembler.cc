@@ -0,0 +1,317 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<algorithm>
+#include<iostream>
+#include<sstream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../backend/seqistlsolverbackend.hh"
+#include"../newton/newton.hh"
+#include"poissonproblem.hh"
+
+// compare residual and jacobian computed by two grid operators
+template<typename GO1, typename GO2>
+bool compare (const GO1& go1, const GO2& go2, const std::string& name)
+{
+  typedef typename GO1::Traits::Domain DV;
+  typedef typename GO1::Traits::Range RV;
+  typedef typename GO1::Traits::Jacobian M;
+
+  DV x(go1.trialGridFunctionSpace());
+  for (std::size_t i=0; i<x.flatsize(); ++i)
+    x.base()[i] = 1.0 + 0.1 * i;
+
+  RV r1(go1.testGridFunctionSpace(),0.0);
+  RV r2(go1.testGridFunctionSpace(),0.0);
+  go1.residual(x,r1);
+  go2.residual(x,r2);
+  r2 -= r1;
+
+  M m1(go1);
+  M m2(go2);
+  m1 = 0.0;
+  m2 = 0.0;
+  go1.jacobian(x,m1);
+  go2.jacobian(x,m2);
+  m2.base() -= m1.base();
+
+  // fused assembly of residual and jacobian by both assemblers
+  RV r3(go1.testGridFunctionSpace(),0.0);
+  M m3(go2);
+  m3 = 0.0;
+  go2.residual_and_jacobian(x,r3,m3);
+  r3 -= r1;
+  m3.base() -= m1.base();
+
+  RV r4(go1.testGridFunctionSpace(),0.0);
+  M m4(go1);
+  m4 = 0.0;
+  go1.residual_and_jacobian(x,r4,m4);
+  r4 -= r1;
+  m4.base() -= m1.base();
+
+  std::cout << name << ": " << go2.assembler().colors(false) << "/"
+            << go2.assembler().colors(true) << " colors, "
+            << go2.assembler().threadCount() << " threads, residual difference "
+            << r2.infinity_norm() << ", jacobian difference "
+            << m2.base().infinity_norm() << ", fused difference "
+            << std::max(std::max(r3.infinity_norm(),m3.base().infinity_norm()),
+                        std::max(r4.infinity_norm(),m4.base().infinity_norm())) << std::endl;
+
+  return r2.infinity_norm() < 1e-10 && m2.base().infinity_norm() < 1e-10
+    && r3.infinity_norm() < 1e-10 && m3.base().infinity_norm() < 1e-10
+    && r4.infinity_norm() < 1e-10 && m4.base().infinity_norm() < 1e-10;
+}
+
+template<typename GV>
+bool testQ1 (const GV& gv)
+{
+  typedef Q1PoissonProblem<GV> Problem;
+  Problem problem(gv);
+
+  typedef typename Problem::GO GO;
+  typedef Dune::PDELab::GridOperator<typename Problem::GFS,typename Problem::GFS,
+    typename Problem::LOP,typename Problem::MB,double,double,double,
+    typename Problem::C,typename Problem::C,false,
+    Dune::PDELab::ColoredAssembler<typename Problem::GFS,typename Problem::GFS> > ColoredGO;
+  GO go(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+  ColoredGO cgo(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+
+  return compare(go,cgo,"Q1");
+}
+
+// the coloring follows an update of the space after grid refinement
+bool testRefined ()
+{
+  Dune::FieldVector<double,2> L(1.0);
+  Dune::FieldVector<int,2> N(8);
+  Dune::FieldVector<bool,2> B(false);
+  Dune::YaspGrid<2> grid(L,N,B,0);
+  typedef Dune::YaspGrid<2>::LeafGridView GV;
+  const GV& gv=grid.leafView();
+
+  typedef Q1PoissonProblem<GV> Problem;
+  Problem problem(gv);
+
+  typedef Problem::GO GO;
+  typedef Dune::PDELab::GridOperator<Problem::GFS,Problem::GFS,Problem::LOP,Problem::MB,
+    double,double,double,Problem::C,Problem::C,false,
+    Dune::PDELab::ColoredAssembler<Problem::GFS,Problem::GFS> > ColoredGO;
+  GO go(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+  ColoredGO cgo(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+  bool passed = compare(go,cgo,"Q1 before refinement");
+
+  grid.globalRefine(1);
+  problem.gfs.update();
+  Dune::PDELab::constraints(problem.constraintsparameters,problem.gfs,problem.cg);
+  passed &= compare(go,cgo,"Q1 after refinement");
+  return passed;
+}
+
+// Poisson operator failing on the cells right of x=0.5
+template<typename F, typename B, typename J>
+class FailingPoisson
+  : public Dune::PDELab::Poisson<F,B,J,2>
+{
+public:
+  FailingPoisson (const F& f, const B& b, const J& j)
+    : Dune::PDELab::Poisson<F,B,J,2>(f,b,j)
+  {}
+
+  template<typename EG, typename LFSU, typename X, typename LFSV, typename R>
+  void alpha_volume (const EG& eg, const LFSU& lfsu, const X& x, const LFSV& lfsv, R& r) const
+  {
+    if (eg.geometry().center()[0] > 0.5)
+      DUNE_THROW(Dune::RangeError,"cell right of x=0.5");
+    Dune::PDELab::Poisson<F,B,J,2>::alpha_volume(eg,lfsu,x,lfsv,r);
+  }
+};
+
+// an exception thrown by a thread reaches the caller
+template<typename GV>
+bool testException (const GV& gv)
+{
+  typedef Q1PoissonProblem<GV> Problem;
+  Problem problem(gv);
+
+  typedef FailingPoisson<typename Problem::FType,ConstraintsParameters,typename Problem::FType> LOP;
+  LOP lop(problem.f,problem.constraintsparameters,problem.f);
+  typedef Dune::PDELab::GridOperator<typename Problem::GFS,typename Problem::GFS,
+    LOP,typename Problem::MB,double,double,double,
+    typename Problem::C,typename Problem::C,false,
+    Dune::PDELab::ColoredAssembler<typename Problem::GFS,typename Problem::GFS> > ColoredGO;
+  ColoredGO cgo(problem.gfs,problem.cg,problem.gfs,problem.cg,lop);
+
+  typename ColoredGO::Traits::Domain x(problem.gfs,1.0);
+  typename ColoredGO::Traits::Range r(problem.gfs,0.0);
+  bool caught = false;
+  try {
+    cgo.residual(x,r);
+  }
+  catch (Dune::Exception& e) {
+    std::cout << "exception of a thread: " << e << std::endl;
+    caught = true;
+  }
+  if (!caught)
+    std::cerr << "failed: the exception of the local operator was lost" << std::endl;
+  return caught;
+}
+
+// the skeleton terms write into the rows of both cells of a face
+template<int k, typename GV>
+bool testQkDG (const GV& gv)
+{
+  typedef QkDGPoissonProblem<GV,k> Problem;
+  Problem problem(gv);
+
+  typedef typename Problem::GO GO;
+  typedef Dune::PDELab::GridOperator<typename Problem::GFS,typename Problem::GFS,
+    typename Problem::LOP,typename Problem::MB,double,double,double,
+    typename Problem::C,typename Problem::C,false,
+    Dune::PDELab::ColoredAssembler<typename Problem::GFS,typename Problem::GFS> > ColoredGO;
+  GO go(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+  ColoredGO cgo(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+
+  std::stringstream name;
+  name << "Q" << k << " SIPG";
+  return compare(go,cgo,name.str());
+}
+
+// run at most maxit Newton steps from zero, with or without fused assembly
+template<typename GO, typename V>
+std::size_t solve (const GO& go, V& u, unsigned int maxit, bool fused,
+                   double threshold, bool linesearch)
+{
+  typedef Dune::PDELab::ISTLBackend_SEQ_BCGS_SSOR LS;
+  LS ls(5000,0);
+  typedef Dune::PDELab::Newton<GO,LS,V> Newton;
+  Newton newton(go,u,ls);
+  newton.setReassembleThreshold(threshold);
+  if (!linesearch)
+    newton.setLineSearchStrategy(Newton::noLineSearch);
+  newton.setVerbosityLevel(0);
+  newton.setReduction(1e-10);
+  newton.setMinLinearReduction(1e-12);
+  newton.setMaxIterations(maxit);
+  newton.setFusedAssembly(fused);
+  u = 0.0;
+  try {
+    newton.apply();
+  }
+  catch (Dune::PDELab::NewtonNotConverged&) {}
+  return newton.result().iterations;
+}
+
+// the Newton iterates do not depend on how residual and jacobian are
+// assembled, also if the matrix is not reassembled in every step
+template<typename GO>
+bool testNewton (const GO& go, const std::string& name, double threshold, bool linesearch)
+{
+  typedef typename GO::Traits::Domain V;
+
+  bool passed = true;
+  V u1(go.trialGridFunctionSpace());
+  V u2(go.trialGridFunctionSpace());
+  for (unsigned int maxit=1; maxit<=20; ++maxit)
+    {
+      const std::size_t it1 = solve(go,u1,maxit,false,threshold,linesearch);
+      const std::size_t it2 = solve(go,u2,maxit,true,threshold,linesearch);
+      const double norm = u1.infinity_norm();
+      u2 -= u1;
+      std::cout << name << " Newton after " << it1 << "/" << it2
+                << " iterations: difference " << u2.infinity_norm()
+                << " of " << norm << std::endl;
+      passed &= it1 == it2 && norm > 0.0 && u2.infinity_norm() <= 1e-8 * norm;
+      if (it1 < maxit)
+        break;
+    }
+  return passed;
+}
+
+template<typename GV>
+bool testNonlinear (const GV& gv)
+{
+  typedef ReactionParameters<GV,double> Param;
+  Param param;
+  typedef Dune::PDELab::BCTypeParam_CD<Param> BCType;
+  BCType bctype(gv,param);
+
+  typedef Q1PoissonProblem<GV> Problem;
+  Problem problem(gv);
+  typename Problem::C cg;
+  Dune::PDELab::constraints(bctype,problem.gfs,cg);
+
+  typedef Dune::PDELab::ConvectionDiffusion<Param> LOP;
+  LOP lop(param);
+
+  typedef Dune::PDELab::GridOperator<typename Problem::GFS,typename Problem::GFS,
+    LOP,typename Problem::MB,double,double,double,typename Problem::C,typename Problem::C> GO;
+  typedef Dune::PDELab::GridOperator<typename Problem::GFS,typename Problem::GFS,
+    LOP,typename Problem::MB,double,double,double,
+    typename Problem::C,typename Problem::C,false,
+    Dune::PDELab::ColoredAssembler<typename Problem::GFS,typename Problem::GFS> > ColoredGO;
+  GO go(problem.gfs,cg,problem.gfs,cg,lop);
+  ColoredGO cgo(problem.gfs,cg,problem.gfs,cg,lop);
+
+  bool passed = compare(go,cgo,"nonlinear Q1");
+  passed &= testNewton(go,"default",0.0,true);
+  passed &= testNewton(cgo,"colored",0.0,true);
+  passed &= testNewton(cgo,"colored without line search",0.0,false);
+  passed &= testNewton(cgo,"colored with threshold",0.5,false);
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    bool passed = true;
+
+    {
+      Dune::FieldVector<double,2> L(1.0);
+      Dune::FieldVector<int,2> N(16);
+      Dune::FieldVector<bool,2> B(false);
+      Dune::YaspGrid<2> grid(L,N,B,0);
+      typedef Dune::YaspGrid<2>::LeafGridView GV;
+      const GV& gv=grid.leafView();
+      passed &= testQ1(gv);
+      passed &= testQkDG<2>(gv);
+      passed &= testNonlinear(gv);
+      passed &= testException(gv);
+    }
+
+    passed &= testRefined();
+
+    {
+      Dune::FieldVector<double,3> L(1.0);
+      Dune::FieldVector<int,3> N(6);
+      Dune::FieldVector<bool,3> B(false);
+      Dune::YaspGrid<3> grid(L,N,B,0);
+      typedef Dune::YaspGrid<3>::LeafGridView GV;
+      const GV& gv=grid.leafView();
+      passed &= testQ1(gv);
+      passed &= testQkDG<1>(gv);
+    }
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
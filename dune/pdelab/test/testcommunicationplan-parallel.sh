@@ -0,0 +1,15 @@
+#!/bin/sh
+# Runs testcommunicationplan on several processes, the communication plan
+# only exchanges messages if there is more than one. Set MPIRUN to use a
+# launcher other than mpirun.
+
+MPIRUN=${MPIRUN:-mpirun}
+
+if ! command -v "$MPIRUN" > /dev/null 2>&1; then
+  echo "$MPIRUN not found, skipping the parallel run of testcommunicationplan"
+  exit 77
+fi
+
+for procs in 2 4; do
+  "$MPIRUN" -np $procs ./testcommunicationplan || exit 1
+done
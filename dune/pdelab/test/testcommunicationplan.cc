@@ -0,0 +1,107 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<iostream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/common/gridenums.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../gridfunctionspace/communicationplan.hh"
+#include"../gridfunctionspace/genericdatahandle.hh"
+#include"poissonproblem.hh"
+
+// compare the exchange of a plan with the one of GenericDataHandle; the
+// values are integers, so the sums do not depend on the order of the messages.
+// Vectors with other entries than the plan's are exchanged over the grid.
+template<typename E, typename GFS>
+bool compare (const GFS& gfs, Dune::InterfaceType iftype, const std::string& name)
+{
+  typedef typename Dune::PDELab::BackendVectorSelector<GFS,E>::Type V;
+  typedef Dune::PDELab::CommunicationPlan<GFS> Plan;
+  typedef Dune::PDELab::AddGatherScatter AddGatherScatter;
+
+  const int rank = gfs.gridView().comm().rank();
+  Plan plan(gfs,iftype,Dune::ForwardCommunication);
+  bool passed = true;
+
+  // the second exchange reuses the plan and its buffers
+  for (int repeat = 0; repeat < 2; ++repeat)
+    {
+      V x(gfs,0.0);
+      for (std::size_t i = 0; i < x.base().N(); ++i)
+        x.base()[i] = 1000.0*rank + i + repeat;
+      V y(x);
+
+      plan.communicate(x,AddGatherScatter());
+      Dune::PDELab::GenericDataHandle<GFS,V,AddGatherScatter> handle(gfs,y,AddGatherScatter());
+      gfs.gridView().communicate(handle,iftype,Dune::ForwardCommunication);
+
+      const double norm = gfs.gridView().comm().max(y.infinity_norm());
+      x -= y;
+      const double difference = gfs.gridView().comm().max(x.infinity_norm());
+      if (rank == 0)
+        std::cout << name << ": difference " << difference << " of " << norm << std::endl;
+      passed &= norm > 0.0 && difference == 0.0;
+    }
+  return passed;
+}
+
+template<typename GFS>
+bool compareAll (GFS& gfs, const std::string& name)
+{
+  bool passed = true;
+  passed &= compare<double>(gfs,Dune::All_All_Interface,name + " All_All");
+  passed &= compare<double>(gfs,Dune::InteriorBorder_All_Interface,name + " InteriorBorder_All");
+  passed &= compare<double>(gfs,Dune::InteriorBorder_InteriorBorder_Interface,name + " InteriorBorder_InteriorBorder");
+  passed &= compare<float>(gfs,Dune::All_All_Interface,name + " All_All float");
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    Dune::FieldVector<double,2> L(1.0);
+    Dune::FieldVector<int,2> N(16);
+    Dune::FieldVector<bool,2> B(false);
+    typedef Dune::YaspGrid<2> Grid;
+    Grid grid(Dune::MPIHelper::getCommunicator(),L,N,B,1);
+    typedef Grid::LeafGridView GV;
+    const GV& gv=grid.leafView();
+
+    // the plan only exchanges messages with more than one process, see
+    // testcommunicationplan-parallel.sh
+    if (grid.comm().size() == 1)
+      std::cout << "running on one process, use mpirun -np <procs> ./testcommunicationplan"
+                << " to test the exchange" << std::endl;
+
+    bool passed = true;
+
+    // dofs on the vertices
+    Q1PoissonProblem<GV> q1(gv);
+    passed &= compareAll(q1.gfs,"Q1");
+
+    // dofs on the elements, which are shared in the overlap
+    QkDGPoissonProblem<GV,1> dg(gv);
+    passed &= compareAll(dg.gfs,"DG Q1");
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
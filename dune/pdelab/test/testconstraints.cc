@@ -110,6 +110,42 @@ void testp1 (const GV& gv)
   BType b(gv);
   Dune::PDELab::constraints(b,p1gfs,p1cg);
 
+  // the flat representation must agree with the maps
+  const P1C& cp1cg = p1cg;
+  if (!cp1cg.compressed() || cp1cg.constrainedIndices().size() != cp1cg.size())
+    DUNE_THROW(Dune::Exception,"constraints container not compressed after constraints()");
+  for (typename P1C::const_iterator cit = cp1cg.begin(); cit != cp1cg.end(); ++cit)
+    {
+      const std::size_t p = cp1cg.position(cit->first);
+      if (!cp1cg.isConstrained(cit->first) || p == P1C::npos
+          || cp1cg.constrainedIndices()[p] != cit->first
+          || cp1cg.rowSize(p) != cit->second.size())
+        DUNE_THROW(Dune::Exception,"flat constraints differ from the maps");
+    }
+  for (std::size_t i=0; i<p1gfs.globalSize(); ++i)
+    if (cp1cg.isConstrained(i) != (cp1cg.find(i) != cp1cg.end()))
+      DUNE_THROW(Dune::Exception,"constrained index table differs from the maps");
+
+  // read access through the mutable map interface keeps the flat representation
+  if (p1cg.find(0) != p1cg.end() && p1cg.begin() != p1cg.end() && !p1cg.compressed())
+    DUNE_THROW(Dune::Exception,"reading the maps discarded the flat constraints");
+
+  // every modification of the maps drops it until compress() is called again
+  if (!p1cg.empty())
+    {
+      const typename P1C::key_type i = p1cg.begin()->first;
+      p1cg[i];
+      if (p1cg.compressed())
+        DUNE_THROW(Dune::Exception,"operator[] kept the flat constraints");
+      p1cg.compress();
+      p1cg.erase(i);
+      if (p1cg.compressed() || p1cg.isConstrained(i))
+        DUNE_THROW(Dune::Exception,"erase() kept the flat constraints");
+      Dune::PDELab::constraints(b,p1gfs,p1cg);
+      if (!p1cg.compressed() || !p1cg.isConstrained(i))
+        DUNE_THROW(Dune::Exception,"constraints() did not restore the flat constraints");
+    }
+
   // set Dirichlet nodes to zero
   Dune::PDELab::set_nonconstrained_dofs(p1cg,0.0,p1xg);
 
@@ -0,0 +1,209 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<algorithm>
+#include<cmath>
+#include<iostream>
+#include<string>
+#include<vector>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/parallel/collectivecommunication.hh>
+
+#include"../adaptivity/adaptivity.hh"
+
+// error indicators with the interface of a vector container
+class Indicators
+{
+public:
+  typedef double ElementType;
+
+  explicit Indicators (std::size_t n) : values(n,0.0) {}
+
+  std::size_t N () const { return values.size(); }
+  double& operator[] (std::size_t i) { return values[i]; }
+  const double& operator[] (std::size_t i) const { return values[i]; }
+
+  double one_norm () const
+  {
+    double sum = 0.0;
+    for (std::size_t i=0; i<values.size(); i++)
+      sum += std::abs(values[i]);
+    return sum;
+  }
+
+  double infinity_norm () const
+  {
+    double max = 0.0;
+    for (std::size_t i=0; i<values.size(); i++)
+      max = std::max(max,std::abs(values[i]));
+    return max;
+  }
+
+private:
+  std::vector<double> values;
+};
+
+// the bisection error_fraction() and element_fraction() used before the
+// histogram selection, weighting by the indicator or by one (count)
+void bisection (const Indicators& x, double alpha, double beta,
+                double& eta_alpha, double& eta_beta, bool count)
+{
+  const int steps=20;
+  double total_error = count ? x.N() : x.one_norm();
+  double max_error = x.infinity_norm();
+  double eta_alpha_left = 0.0;
+  double eta_alpha_right = max_error;
+  double eta_beta_left = 0.0;
+  double eta_beta_right = max_error;
+  for (int j=1; j<=steps; j++)
+    {
+      eta_alpha = 0.5*(eta_alpha_left+eta_alpha_right);
+      eta_beta = 0.5*(eta_beta_left+eta_beta_right);
+      double sum_alpha=0.0;
+      double sum_beta=0.0;
+      for (unsigned int i=0; i<x.N(); i++)
+        {
+          if (x[i]>=eta_alpha) sum_alpha += count ? 1.0 : x[i];
+          if (x[i]< eta_beta) sum_beta += count ? 1.0 : x[i];
+        }
+      if (std::abs(alpha-sum_alpha/total_error) <= 0.01 && std::abs(beta-sum_beta/total_error) <= 0.01) break;
+      if (sum_alpha>alpha*total_error)
+        eta_alpha_left = eta_alpha;
+      else
+        eta_alpha_right = eta_alpha;
+      if (sum_beta>beta*total_error)
+        eta_beta_right = eta_beta;
+      else
+        eta_beta_left = eta_beta;
+    }
+}
+
+// the fraction of the total weight of the elements marked by eta
+double fraction (const Indicators& x, double eta, bool above, bool count)
+{
+  double marked = 0.0;
+  double total = 0.0;
+  for (std::size_t i=0; i<x.N(); i++)
+    {
+      const double w = count ? 1.0 : x[i];
+      total += w;
+      if (above ? x[i] >= eta : x[i] < eta)
+        marked += w;
+    }
+  return marked / total;
+}
+
+// the histogram selection must meet the tolerance of 1% of the total
+// weight, or at least do as well as the bisection where that did not
+bool compare (const Indicators& x, double alpha, double beta, bool count, const std::string& name)
+{
+  double eta_alpha, eta_beta, old_alpha, old_beta;
+  if (count)
+    Dune::PDELab::element_fraction(x,alpha,beta,eta_alpha,eta_beta);
+  else
+    Dune::PDELab::error_fraction(x,alpha,beta,eta_alpha,eta_beta);
+  bisection(x,alpha,beta,old_alpha,old_beta,count);
+
+  const double refine = fraction(x,eta_alpha,true,count);
+  const double coarsen = fraction(x,eta_beta,false,count);
+  const double old_refine = fraction(x,old_alpha,true,count);
+  const double old_coarsen = fraction(x,old_beta,false,count);
+
+  std::cout << name << (count ? " elements" : " error") << " alpha=" << alpha << " beta=" << beta
+            << ": refine " << refine << " (bisection " << old_refine << ")"
+            << ", coarsen " << coarsen << " (bisection " << old_coarsen << ")" << std::endl;
+
+  const double tolerance = 0.01 + 1e-12;
+  const bool passed =
+    std::abs(refine-alpha) <= std::max(tolerance,std::abs(old_refine-alpha)+1e-12)
+    && std::abs(coarsen-beta) <= std::max(tolerance,std::abs(old_coarsen-beta)+1e-12);
+  if (!passed)
+    std::cerr << "failed: " << name << std::endl;
+  return passed;
+}
+
+bool compareAll (const Indicators& x, const std::string& name)
+{
+  const double fractions[][2] = { {0.0,0.0}, {0.3,0.1}, {0.5,0.5}, {0.9,0.05}, {1.0,1.0} };
+  bool passed = true;
+  for (int i=0; i<5; i++)
+    for (int count=0; count<2; count++)
+      passed &= compare(x,fractions[i][0],fractions[i][1],count,name);
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    const std::size_t n = 1000;
+    bool passed = true;
+
+    // pseudo random indicators, uniform and with few large ones
+    Indicators uniform(n), skewed(n), equal(n);
+    unsigned long seed = 12345;
+    for (std::size_t i=0; i<n; i++)
+      {
+        seed = (1103515245*seed + 12345) % 2147483648ul;
+        const double r = double(seed) / 2147483648.0;
+        uniform[i] = r;
+        skewed[i] = r*r*r;
+        equal[i] = 1.0;
+      }
+    passed &= compareAll(uniform,"uniform");
+    passed &= compareAll(skewed,"skewed");
+    passed &= compareAll(equal,"all equal");
+
+    // only the interior elements are weighted
+    std::vector<bool> interior(n);
+    Indicators selected(0);
+    std::vector<double> values;
+    for (std::size_t i=0; i<n; i++)
+      {
+        interior[i] = i % 3 != 0;
+        if (interior[i])
+          values.push_back(uniform[i]);
+      }
+    selected = Indicators(values.size());
+    for (std::size_t i=0; i<values.size(); i++)
+      selected[i] = values[i];
+
+    Dune::CollectiveCommunication<Dune::No_Comm> comm;
+    double eta_alpha, eta_beta, masked_alpha, masked_beta;
+    Dune::PDELab::error_fraction(selected,0.3,0.1,eta_alpha,eta_beta);
+    Dune::PDELab::error_fraction(uniform,0.3,0.1,masked_alpha,masked_beta,interior,comm);
+    if (eta_alpha != masked_alpha || eta_beta != masked_beta)
+      {
+        std::cerr << "failed: the error fraction depends on the masked elements" << std::endl;
+        passed = false;
+      }
+    Dune::PDELab::element_fraction(selected,0.3,0.1,eta_alpha,eta_beta);
+    Dune::PDELab::element_fraction(uniform,0.3,0.1,masked_alpha,masked_beta,interior,comm);
+    if (eta_alpha != masked_alpha || eta_beta != masked_beta)
+      {
+        std::cerr << "failed: the element fraction depends on the masked elements" << std::endl;
+        passed = false;
+      }
+    if (Dune::PDELab::interior_error(uniform,interior,comm) != selected.one_norm())
+      {
+        std::cerr << "failed: the interior error includes masked elements" << std::endl;
+        passed = false;
+      }
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
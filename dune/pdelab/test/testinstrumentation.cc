@@ -0,0 +1,84 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#define DUNE_PDELAB_INSTRUMENTATION 1
+
+#include<iostream>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../common/instrumentation.hh"
+#include"poissonproblem.hh"
+
+bool check (Dune::PDELab::AssemblyPhase::Type phase, unsigned long expected)
+{
+  const unsigned long calls = Dune::PDELab::assemblyProfile().calls(phase);
+  if (calls == expected)
+    return true;
+  std::cerr << "phase " << Dune::PDELab::AssemblyPhase::name(phase) << " recorded "
+            << calls << " calls instead of " << expected << std::endl;
+  return false;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    const int n = 8;
+    Dune::FieldVector<double,2> L(1.0);
+    Dune::FieldVector<int,2> N(n);
+    Dune::FieldVector<bool,2> B(false);
+    Dune::YaspGrid<2> grid(L,N,B,0);
+    typedef Dune::YaspGrid<2>::LeafGridView GV;
+    const GV& gv=grid.leafView();
+
+    // Neumann boundary everywhere, so no constraints are assembled
+    typedef Q1PoissonProblem<GV,Dune::PDELab::NoConstraints> Problem;
+    Problem problem(gv,false);
+    typedef Problem::GFS GFS;
+    const GFS& gfs = problem.gfs;
+
+    typedef Dune::PDELab::GridOperator<GFS,GFS,Problem::LOP,Problem::MB,double,double,double> GO;
+    GO go(gfs,gfs,problem.lop);
+
+    GO::Traits::Domain x(gfs,1.0);
+    GO::Traits::Range r(gfs,0.0);
+
+    Dune::PDELab::assemblyProfile().reset();
+    go.residual(x,r);
+
+    // one timed section per cell and kind of work, the volume terms
+    // of the test and the trial space are timed separately
+    const unsigned long cells = n*n;
+    bool passed = true;
+    passed &= check(Dune::PDELab::AssemblyPhase::total,1);
+    passed &= check(Dune::PDELab::AssemblyPhase::constraints,1);
+    passed &= check(Dune::PDELab::AssemblyPhase::bind,2*cells);
+    passed &= check(Dune::PDELab::AssemblyPhase::volume,2*cells);
+    passed &= check(Dune::PDELab::AssemblyPhase::loadCoefficients,cells);
+    passed &= check(Dune::PDELab::AssemblyPhase::scatter,cells);
+    passed &= check(Dune::PDELab::AssemblyPhase::boundary,4*n);
+    passed &= check(Dune::PDELab::AssemblyPhase::skeleton,0);
+
+    Dune::PDELab::assemblyProfile().report(std::cout,gv.comm());
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
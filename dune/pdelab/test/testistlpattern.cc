@@ -0,0 +1,131 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<cstddef>
+#include<iostream>
+#include<set>
+#include<string>
+#include<vector>
+#include<dune/common/exceptions.hh>
+
+#include"../backend/istlmatrixbackend.hh"
+
+// links of a band matrix with duplicates, added in descending and in
+// scattered order like the local patterns of neighboring elements
+class BandLinks
+{
+public:
+  BandLinks (std::size_t n_, std::size_t width_) : n(n_), width(width_) {}
+
+  std::size_t globalSizeU () const
+  {
+    return n;
+  }
+
+  std::size_t globalSizeV () const
+  {
+    return n;
+  }
+
+  template<typename P>
+  void fill_pattern (P& pattern) const
+  {
+    for (std::size_t pass = 0; pass < 2; ++pass)
+      for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t k = 0; k <= 2*width; ++k)
+          {
+            // descending in the first pass, scattered in the second one
+            const std::size_t l = pass == 0 ? 2*width - k : (3*k) % (2*width + 1);
+            if (i + l >= width && i + l - width < n)
+              pattern.add_link(i,i + l - width);
+          }
+  }
+
+  //! the expected set of column blocks of block row i
+  std::set<std::size_t> columns (std::size_t i, std::size_t rowblock, std::size_t colblock) const
+  {
+    std::set<std::size_t> result;
+    for (std::size_t r = i*rowblock; r < (i+1)*rowblock && r < n; ++r)
+      for (std::size_t c = (r >= width ? r - width : 0); c <= r + width && c < n; ++c)
+        result.insert(c / colblock);
+    return result;
+  }
+
+private:
+  std::size_t n;
+  std::size_t width;
+};
+
+bool check (bool condition, const std::string& message)
+{
+  if (!condition)
+    std::cerr << "failed: " << message << std::endl;
+  return condition;
+}
+
+template<int BLOCKSIZE>
+bool test (const BandLinks& links, const std::string& name)
+{
+  typedef Dune::PDELab::ISTLBCRSMatrixBackend<BLOCKSIZE,BLOCKSIZE> MB;
+  typedef typename MB::Pattern Pattern;
+  typedef typename MB::template Matrix<double> M;
+  typedef typename M::BaseT::ConstRowIterator RowIterator;
+  typedef typename M::BaseT::ConstColIterator ColIterator;
+
+  bool passed = true;
+
+  // the rows hold every column block once and in ascending order after finalize()
+  Pattern pattern(links.globalSizeV()/BLOCKSIZE,links.globalSizeU()/BLOCKSIZE);
+  links.fill_pattern(pattern);
+  pattern.finalize();
+  for (std::size_t i = 0; i < pattern.size(); ++i)
+    {
+      const std::set<std::size_t> expected = links.columns(i,BLOCKSIZE,BLOCKSIZE);
+      passed &= check(std::vector<std::size_t>(expected.begin(),expected.end())
+                      == std::vector<std::size_t>(pattern[i].begin(),pattern[i].end()),
+                      name + ": pattern row is sorted and free of duplicates");
+    }
+
+  // the matrix is set up from the finalized pattern
+  M m(links);
+  std::size_t nonzeros = 0;
+  for (RowIterator row = m.base().begin(); row != m.base().end(); ++row)
+    {
+      const std::set<std::size_t> expected = links.columns(row.index(),BLOCKSIZE,BLOCKSIZE);
+      std::vector<std::size_t> columns;
+      for (ColIterator col = row->begin(); col != row->end(); ++col)
+        columns.push_back(col.index());
+      passed &= check(std::vector<std::size_t>(expected.begin(),expected.end()) == columns,
+                      name + ": matrix row has the expected columns");
+      nonzeros += columns.size();
+    }
+  passed &= check(nonzeros == pattern.nonzeros() && nonzeros == m.patternStatistics().nonzeros,
+                  name + ": number of nonzero blocks");
+
+  std::cout << name << ": " << nonzeros << " nonzero blocks in " << pattern.size()
+            << " rows" << std::endl;
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    BandLinks links(60,3);
+    bool passed = true;
+    passed &= test<1>(links,"block size 1");
+    passed &= test<2>(links,"block size 2");
+    passed &= test<3>(links,"block size 3");
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,185 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<algorithm>
+#include<iostream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/common/shared_ptr.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+#ifdef HAVE_ALUGRID
+#include<dune/grid/alugrid.hh>
+#endif
+
+#include"../adaptivity/adaptivity.hh"
+#include"../backend/backendselector.hh"
+#include"../backend/istlvectorbackend.hh"
+#include"../common/function.hh"
+#include"../finiteelementmap/p1fem.hh"
+#include"../gridfunctionspace/gridfunctionspace.hh"
+#include"../gridfunctionspace/interpolate.hh"
+
+#include"gridexamples.hh"
+#include"poissonproblem.hh"
+
+// linear function, which is represented exactly on every partition
+template<typename GV, typename RF>
+class U
+  : public Dune::PDELab::AnalyticGridFunctionBase<Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1>,
+                                                  U<GV,RF> >
+{
+public:
+  typedef Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1> Traits;
+  typedef Dune::PDELab::AnalyticGridFunctionBase<Traits,U<GV,RF> > BaseT;
+
+  U (const GV& gv) : BaseT(gv) {}
+  inline void evaluateGlobal (const typename Traits::DomainType& x,
+                              typename Traits::RangeType& y) const
+  {
+    y = 1.0;
+    for (int i=0; i<GV::dimension; i++)
+      y += (i+1.0)*x[i];
+  }
+};
+
+// save two vectors, clear them and rebuild them on the unchanged grid
+bool testRoundTrip ()
+{
+  Dune::FieldVector<double,2> L(1.0);
+  Dune::FieldVector<int,2> N(8);
+  Dune::FieldVector<bool,2> B(false);
+  typedef Dune::YaspGrid<2> Grid;
+  Grid grid(L,N,B,0);
+  typedef Grid::LeafGridView GV;
+  const GV& gv=grid.leafView();
+
+  typedef Q1PoissonProblem<GV> Problem;
+  Problem problem(gv);
+  typedef Problem::GO::Traits::Domain V;
+  V x1(problem.gfs,0.0);
+  Dune::PDELab::interpolate(problem.f,problem.gfs,x1);
+  V x2(x1);
+  x2 *= -2.0;
+  const V y1(x1);
+  const V y2(x2);
+
+  typedef Dune::PDELab::MigrationDataHandle<Grid,Problem::GFS,V> Handle;
+  Handle handle(grid,problem.gfs);
+  handle.addVector(x1);
+  handle.addVector(x2);
+
+  bool passed = true;
+  handle.backup();
+  x1 = 0.0;
+  x2 = 0.0;
+  problem.gfs.update();
+  handle.restore();
+  x1 -= y1;
+  x2 -= y2;
+  std::cout << "round trip: difference " << x1.infinity_norm() << " and "
+            << x2.infinity_norm() << " of " << y1.infinity_norm() << std::endl;
+  passed &= y1.infinity_norm() > 0.0 && x1.infinity_norm() == 0.0 && x2.infinity_norm() == 0.0;
+
+  // the saved coefficients are dropped by discard()
+  handle.backup();
+  handle.discard();
+  bool thrown = false;
+  try {
+    handle.restore();
+  }
+  catch (Dune::Exception&) {
+    thrown = true;
+  }
+  if (!thrown)
+    std::cerr << "failed: restore() after discard() did not notice the missing data" << std::endl;
+  passed &= thrown;
+
+  return passed;
+}
+
+// refine the elements of the first process, redistribute the grid and
+// check the moved vectors against the interpolation on the new partition
+template<typename Grid>
+bool testBalance (Dune::shared_ptr<Grid> grid, const std::string& name)
+{
+  typedef typename Grid::LeafGridView GV;
+  typedef typename GV::template Codim<0>::template Partition<Dune::Interior_Partition>::Iterator Iterator;
+  typedef Dune::PDELab::P1LocalFiniteElementMap<typename Grid::ctype,double,Grid::dimension> FEM;
+  FEM fem;
+  typedef Dune::PDELab::GridFunctionSpace<GV,FEM,Dune::PDELab::NoConstraints,
+    Dune::PDELab::ISTLVectorBackend<1> > GFS;
+  typedef typename Dune::PDELab::BackendVectorSelector<GFS,double>::Type V;
+
+  grid->globalRefine(1);
+  if (grid->comm().rank() == 0)
+    {
+      GV gv = grid->leafView();
+      for (Iterator it = gv.template begin<0,Dune::Interior_Partition>();
+           it != gv.template end<0,Dune::Interior_Partition>(); ++it)
+        grid->mark(1,*it);
+    }
+  grid->preAdapt();
+  grid->adapt();
+  grid->postAdapt();
+
+  GFS gfs(grid->leafView(),fem);
+  U<GV,double> u(grid->leafView());
+  V x1(gfs,0.0);
+  Dune::PDELab::interpolate(u,gfs,x1);
+  V x2(x1);
+  x2 *= 3.0;
+
+  const double before = Dune::PDELab::load_imbalance(grid->leafView());
+  const bool changed = Dune::PDELab::balance_grid(*grid,gfs,x1,x2,1);
+  const double after = Dune::PDELab::load_imbalance(grid->leafView());
+
+  // the vectors are rebuilt on the new partition
+  U<GV,double> v(grid->leafView());
+  V y(gfs,0.0);
+  Dune::PDELab::interpolate(v,gfs,y);
+  const double norm = y.infinity_norm();
+  x1 -= y;
+  y *= 3.0;
+  x2 -= y;
+  const double difference = grid->comm().max(std::max(x1.infinity_norm(),x2.infinity_norm()));
+
+  if (grid->comm().rank() == 0)
+    std::cout << name << ": " << (changed ? "changed" : "unchanged") << ", imbalance " << before
+              << " -> " << after << ", difference " << difference << std::endl;
+
+  bool passed = grid->comm().max(norm) > 0.0 && difference <= 1e-12;
+  if (grid->comm().size() > 1)
+    passed &= changed && after < before;
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    bool passed = testRoundTrip();
+
+#ifdef HAVE_ALUGRID
+    passed &= testBalance(KuhnTriangulatedUnitCubeMaker<Dune::ALUGrid<3,3,Dune::simplex,Dune::nonconforming> >::create(),
+                          "alu-cube");
+#endif // HAVE_ALUGRID
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
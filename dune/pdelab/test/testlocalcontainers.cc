@@ -0,0 +1,120 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include<cmath>
+#include<cstddef>
+#include<iostream>
+#include<vector>
+
+#include"../common/alignedallocator.hh"
+#include"../gridfunctionspace/localvector.hh"
+#include"../gridoperatorspace/localmatrix.hh"
+
+// stands in for a child of a LocalFunctionSpace tree, which only
+// needs to map its DOFs into the local containers
+struct DummyLFS
+{
+  DummyLFS (std::size_t offset_, std::size_t size_)
+    : offset(offset_), n(size_)
+  {}
+
+  std::size_t size () const
+  {
+    return n;
+  }
+
+  std::size_t localIndex (std::size_t i) const
+  {
+    return offset + i;
+  }
+
+  std::size_t offset;
+  std::size_t n;
+};
+
+bool aligned (const void* p)
+{
+  return reinterpret_cast<std::size_t>(p) % DUNE_PDELAB_SIMD_ALIGNMENT == 0;
+}
+
+bool check (bool condition, const char* what)
+{
+  if (!condition)
+    std::cerr << "check failed: " << what << std::endl;
+  return condition;
+}
+
+int main ()
+{
+  typedef Dune::PDELab::LocalVector<double> LV;
+  typedef Dune::PDELab::LocalMatrix<double> LM;
+
+  // two children with sizes that are no multiple of the SIMD width
+  const std::size_t n = 2*LV::simd_width + 3;
+  const DummyLFS first(0,n);
+  const DummyLFS second(n,n+1);
+  const std::size_t size = first.size() + second.size();
+
+  std::vector<double> values(size);
+  for (std::size_t i = 0; i < size; ++i)
+    values[i] = 1.0 + 0.25*i;
+
+  bool passed = true;
+
+  // vector: range accumulation against single entries
+  LV r(size,0.0), r_range(size,0.0);
+  passed &= check(aligned(&r.base()[0]),"LocalVector storage is aligned");
+  {
+    LV::WeightedAccumulationView view = r.weightedAccumulationView(0.5);
+    LV::WeightedAccumulationView view_range = r_range.weightedAccumulationView(0.5);
+    for (std::size_t i = 0; i < second.size(); ++i)
+      view.accumulate(second,i,values[i]);
+    view_range.accumulateRange(second,0,second.size(),&values[0]);
+    for (std::size_t i = 0; i < LV::simd_width; ++i)
+      view.accumulate(first,1+i,values[i]);
+    view_range.accumulateBlock<LV::simd_width>(first,1,&values[0]);
+    passed &= check(view_range.modified(),"range accumulation marks the view as modified");
+  }
+  for (std::size_t i = 0; i < size; ++i)
+    passed &= check(std::abs(r.base()[i] - r_range.base()[i]) < 1e-14,"LocalVector accumulateRange");
+
+  // matrix: rows are aligned and padded
+  LM m(size,size,0.0), m_row(size,size,0.0);
+  passed &= check(m.rowStride() % LM::simd_width == 0,"LocalMatrix row stride is padded");
+  passed &= check(m.rowStride() >= m.ncols(),"LocalMatrix row stride covers a row");
+  for (std::size_t i = 0; i < size; ++i)
+    passed &= check(aligned(&m.getEntry(i,0)),"LocalMatrix rows are aligned");
+  {
+    LM::WeightedAccumulationView view = m.weightedAccumulationView(2.0);
+    LM::WeightedAccumulationView view_row = m_row.weightedAccumulationView(2.0);
+    for (std::size_t i = 0; i < first.size(); ++i)
+      {
+        for (std::size_t j = 0; j < second.size(); ++j)
+          view.accumulate(first,i,second,j,values[i+j]);
+        view_row.accumulateRow(first,i,second,0,second.size(),&values[i]);
+      }
+    for (std::size_t j = 0; j < LM::simd_width; ++j)
+      view.accumulate(second,1,first,2+j,values[j]);
+    view_row.accumulateRowBlock<LM::simd_width>(second,1,first,2,&values[0]);
+  }
+  for (std::size_t i = 0; i < size; ++i)
+    for (std::size_t j = 0; j < size; ++j)
+      passed &= check(std::abs(m.getEntry(i,j) - m_row.getEntry(i,j)) < 1e-14,"LocalMatrix accumulateRow");
+
+  // matrix vector products on the padded layout
+  std::vector<double> y(size,0.0);
+  m.umv(values,y);
+  for (std::size_t i = 0; i < size; ++i)
+    {
+      double expected = 0.0;
+      for (std::size_t j = 0; j < size; ++j)
+        expected += m.getEntry(i,j) * values[j];
+      passed &= check(std::abs(y[i] - expected) < 1e-10 * (1.0 + std::abs(expected)),"LocalMatrix umv");
+    }
+
+  return passed ? 0 : 1;
+}
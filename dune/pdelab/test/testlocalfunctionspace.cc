@@ -3,6 +3,7 @@
 #include "config.h"
 #endif
 #include<iostream>
+#include<string>
 #include<vector>
 #include<dune/common/parallel/mpihelper.hh>
 #include<dune/common/exceptions.hh>
@@ -92,6 +93,112 @@ void test (const GV& gv)
 	}
 }
 
+// compare binds with and without the precomputed element index table
+template<class GV>
+bool testElementIndexCache (const GV& gv)
+{
+  typedef Dune::PDELab::Q22DLocalFiniteElementMap<float,double> Q22DFEM;
+  Q22DFEM q22dfem;
+
+  typedef Dune::PDELab::GridFunctionSpace<GV,Q22DFEM> Q2GFS;
+  Q2GFS q2gfs(gv,q22dfem);
+  Q2GFS cachedq2gfs(gv,q22dfem);
+  cachedq2gfs.setElementIndexCaching(true);
+  bool passed = cachedq2gfs.elementIndexCache().hasMultiIndices();
+
+  typename Dune::PDELab::LocalFunctionSpace<Q2GFS> lfs(q2gfs);
+  typename Dune::PDELab::LocalFunctionSpace<Q2GFS> cachedlfs(cachedq2gfs);
+
+  typedef typename GV::Traits::template Codim<0>::Iterator ElementIterator;
+  for (ElementIterator it = gv.template begin<0>();
+       it!=gv.template end<0>(); ++it)
+    {
+      lfs.bind(*it);
+      cachedlfs.bind(*it);
+      if (lfs.size() != cachedlfs.size())
+        {
+          passed = false;
+          continue;
+        }
+      for (std::size_t i = 0; i < lfs.size(); ++i)
+        passed &= lfs.globalIndex(i) == cachedlfs.globalIndex(i)
+          && lfs.multiIndex(i) == cachedlfs.multiIndex(i);
+    }
+  if (!passed)
+    std::cerr << "failed: the element index table differs from the regular bind" << std::endl;
+  return passed;
+}
+
+// bind a reused local function space and fresh ones to all elements,
+// before and after an update of the space
+template<class LFS, class GFS, class GV>
+bool compareFixedLayoutBind (GFS& gfs, const GV& gv, const std::string& name)
+{
+  LFS lfs(gfs);
+  bool passed = true;
+
+  typedef typename GV::Traits::template Codim<0>::Iterator ElementIterator;
+  for (int pass = 0; pass < 2; ++pass)
+    {
+      // a changed space must not reuse the layout
+      if (pass > 0)
+        gfs.update();
+      for (ElementIterator it = gv.template begin<0>();
+           it!=gv.template end<0>(); ++it)
+        {
+          LFS reference(gfs);
+          reference.bind(*it);
+          lfs.bind(*it);
+          if (lfs.size() != reference.size()
+              || lfs.localVectorSize() != reference.localVectorSize())
+            {
+              passed = false;
+              continue;
+            }
+          for (std::size_t i = 0; i < lfs.size(); ++i)
+            passed &= lfs.globalIndex(i) == reference.globalIndex(i)
+              && lfs.multiIndex(i) == reference.multiIndex(i);
+        }
+    }
+  if (!passed)
+    std::cerr << "failed: " << name << ": the fixed size bind differs from the regular bind" << std::endl;
+  return passed;
+}
+
+// compare the binds of a reused local function space, which take the fixed
+// size path after the first element, with binds of fresh ones
+template<class GV>
+bool testFixedLayoutBind (const GV& gv)
+{
+  typedef Dune::PDELab::Q22DLocalFiniteElementMap<float,double> Q22DFEM;
+  Q22DFEM q22dfem;
+  typedef Dune::PDELab::Q12DLocalFiniteElementMap<float,double> Q12DFEM;
+  Q12DFEM q12dfem;
+
+  typedef Dune::PDELab::GridFunctionSpace<GV,Q22DFEM> Q2GFS;
+  Q2GFS q2gfs(gv,q22dfem);
+  typedef Dune::PDELab::GridFunctionSpace<GV,Q12DFEM> Q1GFS;
+  Q1GFS q1gfs(gv,q12dfem);
+  typedef Dune::PDELab::PowerGridFunctionSpace<Q2GFS,2,
+    Dune::PDELab::GridFunctionSpaceLexicographicMapper> PowerGFS;
+  PowerGFS powergfs(q2gfs);
+  typedef Dune::PDELab::CompositeGridFunctionSpace<Dune::PDELab::GridFunctionSpaceLexicographicMapper,
+    PowerGFS,Q1GFS> CompositeGFS;
+  CompositeGFS compositegfs(powergfs,q1gfs);
+
+  // the space with a fixed number of DOFs per entity computes its indices differently
+  typedef Dune::PDELab::GridFunctionSpace<GV,Q22DFEM,Dune::PDELab::NoConstraints,
+    Dune::PDELab::StdVectorBackend,Dune::PDELab::GridFunctionRestrictedMapper> RestrictedQ2GFS;
+  RestrictedQ2GFS restrictedq2gfs(gv,q22dfem);
+
+  bool passed = compositegfs.fixedSize() && restrictedq2gfs.fixedSize();
+  if (!passed)
+    std::cerr << "failed: the spaces do not report a fixed size" << std::endl;
+  passed &= compareFixedLayoutBind<Dune::PDELab::LocalFunctionSpace<CompositeGFS> >(compositegfs,gv,"composite");
+  passed &= compareFixedLayoutBind<Dune::PDELab::LocalFunctionSpace<RestrictedQ2GFS> >(restrictedq2gfs,gv,"restricted Q2");
+  return passed;
+}
+
 int main(int argc, char** argv)
 {
   try{
@@ -106,9 +213,10 @@ int main(int argc, char** argv)
     grid.globalRefine(1);
 
 	test(grid.leafView());
+	bool passed = testElementIndexCache(grid.leafView());
+	passed &= testFixedLayoutBind(grid.leafView());
 
-	// test passed
-	return 0;
+	return passed ? 0 : 1;
 
   }
   catch (Dune::Exception &e){
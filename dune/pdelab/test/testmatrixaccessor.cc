@@ -0,0 +1,152 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<iostream>
+#include<sstream>
+#include<string>
+#include<vector>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../gridfunctionspace/localfunctionspace.hh"
+#include"poissonproblem.hh"
+
+// add a local matrix with some zero entries by single entries to m1 and by
+// rows to m2; the row-wise accessor keeps its storage in scratch like the
+// local assembler engines do
+template<typename MB, typename M, typename LFS, typename S>
+void add (M& m1, M& m2, const LFS& lfsv, const LFS& lfsu, S& scratch, std::size_t& seed)
+{
+  typedef typename MB::template Accessor<LFS,LFS,double> Accessor;
+  Accessor entrywise(m1,lfsv,lfsu);
+  Accessor rowwise(m2,lfsv,lfsu,scratch);
+  std::vector<double> row(lfsu.size());
+  for (std::size_t i=0; i<lfsv.size(); ++i)
+    {
+      for (std::size_t j=0; j<lfsu.size(); ++j)
+        {
+          ++seed;
+          row[j] = (seed % 3 == 0) ? 0.0 : 1.0 + seed % 7;
+          entrywise.add(i,j,row[j]);
+        }
+      rowwise.addRow(i,&row[0]);
+    }
+}
+
+// compare Accessor::addRow() with Accessor::add() on the sparsity pattern of go
+template<typename GO>
+bool compare (const GO& go, bool skeleton, const std::string& name)
+{
+  typedef typename GO::Traits::TrialGridFunctionSpace GFS;
+  typedef typename GO::Traits::MatrixBackend MB;
+  typedef typename GO::Traits::Jacobian M;
+  typedef typename GFS::Traits::GridViewType GV;
+  typedef typename GV::template Codim<0>::Iterator ElementIterator;
+  typedef typename GV::IntersectionIterator IntersectionIterator;
+  typedef Dune::PDELab::LocalFunctionSpace<GFS> LFS;
+
+  const GFS& gfs = go.trialGridFunctionSpace();
+  const GV& gv = gfs.gridView();
+
+  M m1(go);
+  M m2(go);
+  m1 = 0.0;
+  m2 = 0.0;
+
+  // the columns of the neighbors are resolved for the rows of the cell
+  LFS lfsv(gfs);
+  LFS lfsu(gfs);
+  typename MB::template AccessorScratch<double> scratch;
+  std::size_t seed = 0;
+  for (ElementIterator it = gv.template begin<0>(); it!=gv.template end<0>(); ++it)
+    {
+      lfsv.bind(*it);
+      lfsu.bind(*it);
+      add<MB>(m1,m2,lfsv,lfsu,scratch,seed);
+      if (!skeleton)
+        continue;
+      for (IntersectionIterator iit = gv.ibegin(*it); iit!=gv.iend(*it); ++iit)
+        if (iit->neighbor())
+          {
+            lfsu.bind(*(iit->outside()));
+            add<MB>(m1,m2,lfsv,lfsu,scratch,seed);
+          }
+    }
+
+  const double norm = m1.base().infinity_norm();
+  m2.base() -= m1.base();
+
+  std::cout << name << ": difference " << m2.base().infinity_norm()
+            << " of " << norm << std::endl;
+
+  return norm > 0.0 && m2.base().infinity_norm() == 0.0;
+}
+
+// discontinuous Q1 elements with the given block size of vectors and matrices
+template<int blocksize, typename GV>
+bool testBlocked (const GV& gv)
+{
+  typedef Dune::PDELab::QkDGLocalFiniteElementMap<typename GV::Grid::ctype,double,1,GV::dimension> FEM;
+  FEM fem;
+  typedef Dune::PDELab::GridFunctionSpace<GV,FEM,Dune::PDELab::NoConstraints,
+    Dune::PDELab::ISTLVectorBackend<blocksize> > GFS;
+  GFS gfs(gv,fem);
+
+  typedef Dune::PDELab::ConvectionDiffusionModelProblem<GV,double> Param;
+  Param param;
+  typedef Dune::PDELab::ConvectionDiffusionDG<Param,FEM> LOP;
+  LOP lop(param);
+
+  typedef Dune::PDELab::ISTLBCRSMatrixBackend<blocksize,blocksize> MB;
+  typedef Dune::PDELab::GridOperator<GFS,GFS,LOP,MB,double,double,double> GO;
+  GO go(gfs,gfs,lop);
+
+  std::stringstream name;
+  name << "DG Q1 with blocks of size " << blocksize;
+  return compare(go,true,name.str());
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    Dune::FieldVector<double,2> L(1.0);
+    Dune::FieldVector<int,2> N(6);
+    Dune::FieldVector<bool,2> B(false);
+    Dune::YaspGrid<2> grid(L,N,B,0);
+    typedef Dune::YaspGrid<2>::LeafGridView GV;
+    const GV& gv=grid.leafView();
+
+    bool passed = true;
+
+    {
+      typedef Q1PoissonProblem<GV> Problem;
+      Problem problem(gv);
+      Problem::GO go(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+      passed &= compare(go,false,"Q1");
+    }
+
+    // a cell spans two blocks
+    passed &= testBlocked<2>(gv);
+    // a cell is one block
+    passed &= testBlocked<4>(gv);
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
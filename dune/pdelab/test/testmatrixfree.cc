@@ -0,0 +1,169 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<algorithm>
+#include<iostream>
+#include<sstream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../backend/seqistlsolverbackend.hh"
+#include"poissonproblem.hh"
+
+// compare the matrix-free operator and solver with their assembled counterparts
+template<typename GO>
+bool compare (const GO& go, const std::string& name)
+{
+  typedef typename GO::Traits::Domain DV;
+  typedef typename GO::Traits::Range RV;
+  typedef typename GO::Traits::Jacobian M;
+
+  DV x(go.trialGridFunctionSpace());
+  for (std::size_t i=0; i<x.flatsize(); ++i)
+    x.base()[i] = 1.0 + 0.1 * i;
+
+  M m(go);
+  m = 0.0;
+  go.jacobian(x,m);
+
+  // operator application
+  RV y1(go.testGridFunctionSpace(),0.0);
+  RV y2(go.testGridFunctionSpace(),0.0);
+  m.base().mv(x.base(),y1.base());
+  Dune::PDELab::ISTLMatrixFreeOperator<GO> op(go);
+  op.apply(x,y2);
+  y2 -= y1;
+
+  // linear solve with right hand side from the residual at zero
+  DV x0(go.trialGridFunctionSpace(),0.0);
+  RV r(go.testGridFunctionSpace(),0.0);
+  go.residual(x0,r);
+
+  DV z1(go.trialGridFunctionSpace(),0.0);
+  DV z2(go.trialGridFunctionSpace(),0.0);
+  Dune::PDELab::ISTLBackend_SEQ_CG_SSOR assembled(5000,0);
+  assembled.apply(m,z1,r,1e-12);
+  Dune::PDELab::ISTLBackend_SEQ_MatrixFree_CG_BlockJac<GO> matrixfree(go,5000,0);
+  matrixfree.apply(z2,r,1e-12);
+  z2 -= z1;
+
+  // the interface of the matrix based backends yields the same solution
+  DV z3(go.trialGridFunctionSpace(),0.0);
+  matrixfree.apply(m,z3,r,1e-12);
+  z3 -= z1;
+
+  std::cout << name << ": " << matrixfree.blockDiagonal().blocks() << " blocks, "
+            << matrixfree.result().iterations << " iterations, operator difference "
+            << y2.infinity_norm() << ", solution difference "
+            << std::max(z2.infinity_norm(),z3.infinity_norm()) << std::endl;
+
+  return matrixfree.result().converged && y2.infinity_norm() < 1e-10
+    && z2.infinity_norm() < 1e-8 && z3.infinity_norm() < 1e-8;
+}
+
+template<typename GV>
+bool testQ1 (const GV& gv)
+{
+  typedef Q1PoissonProblem<GV> Problem;
+  Problem problem(gv);
+
+  typedef typename Problem::GO GO;
+  GO go(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+
+  return compare(go,"Q1");
+}
+
+// the skeleton terms couple the element blocks, which the preconditioner neglects
+template<int k, typename GV>
+bool testQkDG (const GV& gv)
+{
+  typedef QkDGPoissonProblem<GV,k> Problem;
+  Problem problem(gv);
+
+  typedef typename Problem::GO GO;
+  GO go(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+
+  std::stringstream name;
+  name << "Q" << k << " SIPG";
+  return compare(go,name.str());
+}
+
+// the blocks are set up again after an update of the space, even if its size is unchanged
+template<typename GV>
+bool testUpdate (const GV& gv)
+{
+  typedef Q1PoissonProblem<GV> Problem;
+  Problem problem(gv);
+
+  typedef typename Problem::GO GO;
+  typedef typename GO::Traits::Domain DV;
+  typedef typename GO::Traits::Range RV;
+  GO go(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+  Dune::PDELab::ISTLBackend_SEQ_MatrixFree_CG_BlockJac<GO> matrixfree(go,5000,0);
+
+  bool passed = true;
+  for (int i=0; i<2; ++i)
+    {
+      DV x0(problem.gfs,0.0);
+      RV r(problem.gfs,0.0);
+      go.residual(x0,r);
+      DV z(problem.gfs,0.0);
+      matrixfree.apply(z,r,1e-12);
+      passed &= matrixfree.result().converged
+        && matrixfree.blockDiagonal().updateCount() == problem.gfs.updateCount();
+      problem.gfs.update();
+    }
+
+  std::cout << "update: block structure " << (passed ? "rebuilt" : "outdated") << std::endl;
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    bool passed = true;
+
+    {
+      Dune::FieldVector<double,2> L(1.0);
+      Dune::FieldVector<int,2> N(16);
+      Dune::FieldVector<bool,2> B(false);
+      Dune::YaspGrid<2> grid(L,N,B,0);
+      typedef Dune::YaspGrid<2>::LeafGridView GV;
+      const GV& gv=grid.leafView();
+      passed &= testQ1(gv);
+      passed &= testQkDG<2>(gv);
+      passed &= testUpdate(gv);
+    }
+
+    {
+      Dune::FieldVector<double,3> L(1.0);
+      Dune::FieldVector<int,3> N(6);
+      Dune::FieldVector<bool,3> B(false);
+      Dune::YaspGrid<3> grid(L,N,B,0);
+      typedef Dune::YaspGrid<3>::LeafGridView GV;
+      const GV& gv=grid.leafView();
+      passed &= testQ1(gv);
+      passed &= testQkDG<2>(gv);
+    }
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
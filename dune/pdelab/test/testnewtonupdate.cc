@@ -0,0 +1,126 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<iostream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../backend/seqistlsolverbackend.hh"
+#include"../newton/newton.hh"
+#include"poissonproblem.hh"
+
+template<typename GO, typename LS>
+void configure (Dune::PDELab::Newton<GO,LS,typename GO::Traits::Domain>& newton)
+{
+  newton.setVerbosityLevel(0);
+  newton.setReduction(1e-10);
+  newton.setMinLinearReduction(1e-12);
+  newton.setMaxIterations(30);
+}
+
+// solve with newton, which keeps its matrix and work vectors from the
+// previous solves, and with a fresh solver, and compare the results
+template<typename GO, typename LS>
+bool compare (GO& go, LS& ls, Dune::PDELab::Newton<GO,LS,typename GO::Traits::Domain>& newton,
+              const std::string& name)
+{
+  typedef typename GO::Traits::Domain V;
+
+  V u(go.trialGridFunctionSpace(),0.0);
+  newton.apply(u);
+
+  Dune::PDELab::Newton<GO,LS,V> fresh(go,ls);
+  configure(fresh);
+  V v(go.trialGridFunctionSpace(),0.0);
+  fresh.apply(v);
+
+  const double norm = v.infinity_norm();
+  u -= v;
+  std::cout << name << ": " << go.trialGridFunctionSpace().globalSize() << " dofs, "
+            << newton.result().iterations << "/" << fresh.result().iterations
+            << " iterations, difference " << u.infinity_norm() << " of " << norm << std::endl;
+
+  const bool passed = newton.result().converged
+    && newton.result().iterations == fresh.result().iterations
+    && norm > 0.0 && u.infinity_norm() <= 1e-12 * norm;
+  if (!passed)
+    std::cerr << "failed: " << name << ": kept solver differs from a fresh one" << std::endl;
+  return passed;
+}
+
+// nonlinear reaction diffusion problem, solved twice before and twice
+// after the grid is refined and the space updated
+bool testUpdate ()
+{
+  Dune::FieldVector<double,2> L(1.0);
+  Dune::FieldVector<int,2> N(4);
+  Dune::FieldVector<bool,2> B(false);
+  typedef Dune::YaspGrid<2> Grid;
+  Grid grid(L,N,B,0);
+  typedef Grid::LeafGridView GV;
+  const GV& gv=grid.leafView();
+
+  typedef ReactionParameters<GV,double> Param;
+  Param param;
+  typedef Dune::PDELab::BCTypeParam_CD<Param> BCType;
+  BCType bctype(gv,param);
+
+  typedef Q1PoissonProblem<GV> Problem;
+  Problem problem(gv);
+  Problem::C cg;
+  Dune::PDELab::constraints(bctype,problem.gfs,cg);
+
+  typedef Dune::PDELab::ConvectionDiffusion<Param> LOP;
+  LOP lop(param);
+  typedef Dune::PDELab::GridOperator<Problem::GFS,Problem::GFS,LOP,Problem::MB,
+    double,double,double,Problem::C,Problem::C> GO;
+  GO go(problem.gfs,cg,problem.gfs,cg,lop);
+
+  typedef Dune::PDELab::ISTLBackend_SEQ_BCGS_SSOR LS;
+  LS ls(5000,0);
+  Dune::PDELab::Newton<GO,LS,GO::Traits::Domain> newton(go,ls);
+  configure(newton);
+
+  bool passed = true;
+  passed &= compare(go,ls,newton,"first solve");
+  passed &= compare(go,ls,newton,"second solve");
+
+  grid.globalRefine(1);
+  problem.gfs.update();
+  Dune::PDELab::constraints(bctype,problem.gfs,cg);
+  passed &= compare(go,ls,newton,"first solve after refinement");
+  passed &= compare(go,ls,newton,"second solve after refinement");
+
+  // a discarded linear system is set up again
+  newton.discardLinearSystem();
+  passed &= compare(go,ls,newton,"solve after discardLinearSystem()");
+
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    bool passed = testUpdate();
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
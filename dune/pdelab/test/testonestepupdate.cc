@@ -0,0 +1,224 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<iostream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../backend/seqistlsolverbackend.hh"
+#include"../gridfunctionspace/interpolate.hh"
+#include"../gridoperator/onestep.hh"
+#include"../instationary/onestep.hh"
+#include"../localoperator/l2.hh"
+#include"../stationary/linearproblem.hh"
+#include"poissonproblem.hh"
+
+bool check (bool condition, const std::string& message)
+{
+  if (!condition)
+    std::cerr << "failed: " << message << std::endl;
+  return condition;
+}
+
+// heat equation with conforming Q1 elements
+template<typename GV, bool implicit>
+struct HeatProblem
+{
+  typedef Q1PoissonProblem<GV> Problem;
+  typedef typename Problem::GFS GFS;
+  typedef typename Problem::C C;
+  typedef typename Problem::GO GO;
+  typedef Dune::PDELab::L2 MLOP;
+  typedef Dune::PDELab::GridOperator<GFS,GFS,MLOP,typename Problem::MB,double,double,double,C,C> MGO;
+  typedef Dune::PDELab::OneStepGridOperator<GO,MGO,implicit> IGO;
+  typedef typename IGO::Traits::Domain V;
+
+  explicit HeatProblem (const GV& gv)
+    : problem(gv), mlop(2),
+      go(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop),
+      mgo(problem.gfs,problem.cg,problem.gfs,problem.cg,mlop),
+      igo(go,mgo)
+  {}
+
+  // update the space and the constraints after the grid has changed
+  void update ()
+  {
+    problem.gfs.update();
+    Dune::PDELab::constraints(problem.constraintsparameters,problem.gfs,problem.cg);
+  }
+
+  Problem problem;
+  MLOP mlop;
+  GO go;
+  MGO mgo;
+  IGO igo;
+};
+
+// take a few steps with osm and with a fresh stepper and compare the results
+template<typename Heat, typename OSM>
+bool compareSteps (Heat& heat, OSM& osm, OSM& fresh, double dt, const std::string& name)
+{
+  typedef typename Heat::V V;
+
+  V x0(heat.problem.gfs,0.0);
+  Dune::PDELab::interpolate(heat.problem.f,heat.problem.gfs,x0);
+
+  V x(x0), xnew(x0);
+  V y(x0), ynew(x0);
+  double time = 0.0;
+  for (int step = 0; step < 3; ++step)
+    {
+      osm.apply(time,dt,x,xnew);
+      x = xnew;
+      fresh.apply(time,dt,y,ynew);
+      y = ynew;
+      time += dt;
+    }
+
+  const double norm = y.infinity_norm();
+  x -= y;
+  std::cout << name << ": " << heat.problem.gfs.globalSize() << " dofs, difference "
+            << x.infinity_norm() << " of " << norm << std::endl;
+  return check(norm > 0.0 && x.infinity_norm() <= 1e-12 * norm,
+               name + ": kept stepper matches a fresh one");
+}
+
+// the pool keeps its vectors until the space is updated
+template<typename Grid>
+bool testPool (Grid& grid)
+{
+  typedef typename Grid::LeafGridView GV;
+  typedef HeatProblem<GV,true> Heat;
+  typedef typename Heat::V V;
+  Heat heat(grid.leafView());
+
+  Dune::PDELab::VectorPool<V> pool;
+  const V* first = &pool.get(0,heat.problem.gfs);
+  bool passed = true;
+  passed &= check(&pool.get(0,heat.problem.gfs) == first,
+                  "pool: vector is kept without update");
+  passed &= check(pool.get(2,heat.problem.gfs).flatsize() == heat.problem.gfs.globalSize()
+                  && pool.size() == 3,
+                  "pool: vector is allocated on first use");
+
+  const std::size_t size = heat.problem.gfs.globalSize();
+  grid.globalRefine(1);
+  heat.update();
+  passed &= check(heat.problem.gfs.globalSize() > size, "pool: refined space is larger");
+  for (std::size_t i = 0; i < pool.size(); ++i)
+    passed &= check(pool.get(i,heat.problem.gfs).flatsize() == heat.problem.gfs.globalSize(),
+                    "pool: vector is resized after update");
+  return passed;
+}
+
+// the implicit stepper keeps its stage vectors across the refinement of the grid
+template<typename Grid>
+bool testImplicit (Grid& grid)
+{
+  typedef typename Grid::LeafGridView GV;
+  typedef HeatProblem<GV,true> Heat;
+  typedef typename Heat::IGO IGO;
+  typedef typename Heat::V V;
+  typedef Dune::PDELab::ISTLBackend_SEQ_CG_SSOR LS;
+  typedef Dune::PDELab::StationaryLinearProblemSolver<IGO,LS,V> PDESolver;
+  typedef Dune::PDELab::OneStepMethod<double,IGO,PDESolver,V,V> OSM;
+
+  Heat heat(grid.leafView());
+  LS ls(5000,0);
+  PDESolver pdesolver(heat.igo,ls,1e-12);
+  // a scheme with intermediate stages
+  Dune::PDELab::Alexander2Parameter<double> method;
+  OSM osm(method,heat.igo,pdesolver);
+  osm.setVerbosityLevel(0);
+
+  bool passed = true;
+  for (int refinement = 0; refinement < 2; ++refinement)
+    {
+      if (refinement > 0)
+        {
+          grid.globalRefine(1);
+          heat.update();
+        }
+      OSM fresh(method,heat.igo,pdesolver);
+      fresh.setVerbosityLevel(0);
+      passed &= compareSteps(heat,osm,fresh,0.1,refinement > 0 ? "implicit, refined" : "implicit");
+    }
+  return passed;
+}
+
+// the explicit stepper keeps its stage and residual vectors and its
+// matrix across the refinement of the grid
+template<typename Grid>
+bool testExplicit (Grid& grid)
+{
+  typedef typename Grid::LeafGridView GV;
+  typedef HeatProblem<GV,false> Heat;
+  typedef typename Heat::IGO IGO;
+  typedef typename Heat::V V;
+  typedef Dune::PDELab::ISTLBackend_SEQ_CG_SSOR LS;
+  typedef Dune::PDELab::ExplicitOneStepMethod<double,IGO,LS,V,V> OSM;
+
+  Heat heat(grid.leafView());
+  LS ls(5000,0);
+  // a scheme with an intermediate stage
+  Dune::PDELab::HeunParameter<double> method;
+  OSM osm(method,heat.igo,ls);
+  osm.setVerbosityLevel(0);
+
+  bool passed = true;
+  for (int refinement = 0; refinement < 2; ++refinement)
+    {
+      if (refinement > 0)
+        {
+          grid.globalRefine(1);
+          heat.update();
+        }
+      OSM fresh(method,heat.igo,ls);
+      fresh.setVerbosityLevel(0);
+      passed &= compareSteps(heat,osm,fresh,1e-3,refinement > 0 ? "explicit, refined" : "explicit");
+    }
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    Dune::FieldVector<double,2> L(1.0);
+    Dune::FieldVector<int,2> N(4);
+    Dune::FieldVector<bool,2> B(false);
+
+    bool passed = true;
+    {
+      Dune::YaspGrid<2> grid(L,N,B,0);
+      passed &= testPool(grid);
+    }
+    {
+      Dune::YaspGrid<2> grid(L,N,B,0);
+      passed &= testImplicit(grid);
+    }
+    {
+      Dune::YaspGrid<2> grid(L,N,B,0);
+      passed &= testExplicit(grid);
+    }
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,111 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<iostream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../localoperator/pattern.hh"
+#include"poissonproblem.hh"
+
+// Poisson operator which additionally couples the dofs of neighboring cells
+template<typename F, typename B, typename J>
+class SkeletonCoupledPoisson
+  : public Dune::PDELab::Poisson<F,B,J,2>,
+    public Dune::PDELab::FullSkeletonPattern
+{
+public:
+  enum { doPatternSkeleton = true };
+
+  SkeletonCoupledPoisson (const F& f, const B& b, const J& j)
+    : Dune::PDELab::Poisson<F,B,J,2>(f,b,j)
+  {}
+};
+
+bool check (bool condition, const std::string& message)
+{
+  if (!condition)
+    std::cerr << "failed: " << message << std::endl;
+  return condition;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    Dune::FieldVector<double,2> L(1.0);
+    Dune::FieldVector<int,2> N(8);
+    Dune::FieldVector<bool,2> B(false);
+    Dune::YaspGrid<2> grid(L,N,B,0);
+    typedef Dune::YaspGrid<2>::LeafGridView GV;
+    const GV& gv=grid.leafView();
+
+    typedef Q1PoissonProblem<GV> Problem;
+    Problem problem(gv);
+
+    typedef Problem::GO GO;
+    GO go1(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+    Problem::LOP lop2(problem.f,problem.constraintsparameters,problem.f);
+    GO go2(problem.gfs,problem.cg,problem.gfs,problem.cg,lop2);
+
+    typedef SkeletonCoupledPoisson<Problem::FType,ConstraintsParameters,Problem::FType> SLOP;
+    SLOP slop(problem.f,problem.constraintsparameters,problem.f);
+    typedef Dune::PDELab::GridOperator<Problem::GFS,Problem::GFS,SLOP,Problem::MB,
+      double,double,double,Problem::C,Problem::C> SGO;
+    SGO sgo(problem.gfs,problem.cg,problem.gfs,problem.cg,slop);
+
+    GO::PatternCache cache;
+    go1.setPatternCache(&cache);
+    go2.setPatternCache(&cache);
+    sgo.setPatternCache(&cache);
+
+    bool passed = true;
+
+    // operators with the same couplings share one pattern
+    GO::Traits::Jacobian m1(go1);
+    GO::Traits::Jacobian m2(go2);
+    passed &= check(cache.size() == 1 && cache.misses() == 1 && cache.hits() == 1,
+                    "the second operator reuses the pattern of the first");
+    passed &= check(m1.base().nonzeroes() == m2.base().nonzeroes(),
+                    "the shared pattern has the same number of nonzeroes");
+    passed &= check(cache.memory() < m1.patternStatistics().pattern_memory,
+                    "the cache holds less memory than the pattern it was built from");
+
+    // additional couplings result in a pattern of their own
+    SGO::Traits::Jacobian m3(sgo);
+    passed &= check(cache.size() == 2 && cache.misses() == 2 && cache.hits() == 1,
+                    "the operator with skeleton couplings does not reuse the pattern");
+    passed &= check(m3.base().nonzeroes() > m1.base().nonzeroes(),
+                    "the skeleton couplings add nonzeroes");
+
+    // an update of the space invalidates its patterns
+    problem.gfs.update();
+    GO::Traits::Jacobian m4(go1);
+    passed &= check(cache.size() == 2 && cache.misses() == 3 && cache.hits() == 1,
+                    "the pattern is set up again after an update of the space");
+    passed &= check(m4.base().nonzeroes() == m1.base().nonzeroes(),
+                    "the new pattern matches the old one on the unchanged grid");
+
+    std::cout << cache.size() << " patterns, " << cache.hits() << " hits, "
+              << cache.misses() << " misses, " << cache.memory() << " bytes" << std::endl;
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,175 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<iostream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../backend/istlmatrixbackend.hh"
+#include"../backend/istlvectorbackend.hh"
+#include"../finiteelementmap/qkdg.hh"
+#include"../gridfunctionspace/gridfunctionspace.hh"
+#include"../gridoperator/gridoperator.hh"
+#include"../localoperator/linearacousticsdg.hh"
+#include"../localoperator/linearacousticsparameter.hh"
+#include"../localoperator/maxwelldg.hh"
+#include"../localoperator/maxwellparameter.hh"
+
+// assemble residual and jacobian with tabulated and with freshly
+// evaluated basis functions; the operator is shared by both runs
+template<typename GO, typename LOP>
+bool compare (const GO& go, LOP& lop, const std::string& name)
+{
+  typedef typename GO::Traits::Domain DV;
+  typedef typename GO::Traits::Range RV;
+  typedef typename GO::Traits::Jacobian M;
+
+  DV x(go.trialGridFunctionSpace());
+  for (std::size_t i=0; i<x.flatsize(); ++i)
+    x.base()[i] = 1.0 + 0.01 * (i % 97);
+
+  // the first run fills the tables, the second one uses them
+  lop.setBasisCaching(true);
+  RV r1(go.testGridFunctionSpace(),0.0);
+  go.residual(x,r1);
+  r1 = 0.0;
+  go.residual(x,r1);
+  M m1(go);
+  m1 = 0.0;
+  go.jacobian(x,m1);
+
+  lop.setBasisCaching(false);
+  RV r2(go.testGridFunctionSpace(),0.0);
+  go.residual(x,r2);
+  M m2(go);
+  m2 = 0.0;
+  go.jacobian(x,m2);
+
+  const double rnorm = r2.infinity_norm();
+  const double mnorm = m2.base().infinity_norm();
+  r2 -= r1;
+  m2.base() -= m1.base();
+
+  std::cout << name << ": residual difference " << r2.infinity_norm() << " of " << rnorm
+            << ", jacobian difference " << m2.base().infinity_norm() << " of " << mnorm
+            << std::endl;
+
+  return rnorm > 0.0 && mnorm > 0.0
+    && r2.infinity_norm() <= 1e-12 * rnorm && m2.base().infinity_norm() <= 1e-12 * mnorm;
+}
+
+// DG space with one component per unknown of the system
+template<typename GV, int k, int m>
+struct DGSystemSpace
+{
+  typedef Dune::PDELab::QkDGLocalFiniteElementMap<typename GV::Grid::ctype,double,k,GV::dimension> FEM;
+  typedef Dune::PDELab::GridFunctionSpace<GV,FEM,Dune::PDELab::NoConstraints,
+    Dune::PDELab::ISTLVectorBackend<1> > ComponentGFS;
+  typedef Dune::PDELab::PowerGridFunctionSpace<ComponentGFS,m> GFS;
+  typedef typename GFS::template ConstraintsContainer<double>::Type C;
+  typedef Dune::PDELab::ISTLBCRSMatrixBackend<1,1> MB;
+
+  explicit DGSystemSpace (const GV& gv)
+    : componentgfs(gv,fem), gfs(componentgfs)
+  {}
+
+  FEM fem;
+  ComponentGFS componentgfs;
+  GFS gfs;
+  C cg;
+};
+
+template<typename GV>
+bool testLinearAcoustics (const GV& gv)
+{
+  typedef DGSystemSpace<GV,2,GV::dimension+1> Space;
+  Space space(gv);
+  typedef Dune::PDELab::LinearAcousticsModelProblem<GV,double> Param;
+  Param param;
+
+  typedef Dune::PDELab::DGLinearAcousticsSpatialOperator<Param,typename Space::FEM> SLOP;
+  SLOP slop(param);
+  typedef Dune::PDELab::GridOperator<typename Space::GFS,typename Space::GFS,SLOP,
+    typename Space::MB,double,double,double,typename Space::C,typename Space::C> SGO;
+  SGO sgo(space.gfs,space.cg,space.gfs,space.cg,slop);
+
+  typedef Dune::PDELab::DGLinearAcousticsTemporalOperator<Param,typename Space::FEM> TLOP;
+  TLOP tlop(param);
+  typedef Dune::PDELab::GridOperator<typename Space::GFS,typename Space::GFS,TLOP,
+    typename Space::MB,double,double,double,typename Space::C,typename Space::C> TGO;
+  TGO tgo(space.gfs,space.cg,space.gfs,space.cg,tlop);
+
+  bool passed = true;
+  passed &= compare(sgo,slop,"linear acoustics spatial");
+  passed &= compare(tgo,tlop,"linear acoustics temporal");
+  return passed;
+}
+
+template<typename GV>
+bool testMaxwell (const GV& gv)
+{
+  typedef DGSystemSpace<GV,1,2*GV::dimension> Space;
+  Space space(gv);
+  typedef Dune::PDELab::MaxwellModelProblem<GV,double> Param;
+  Param param;
+
+  typedef Dune::PDELab::DGMaxwellSpatialOperator<Param,typename Space::FEM> SLOP;
+  SLOP slop(param);
+  typedef Dune::PDELab::GridOperator<typename Space::GFS,typename Space::GFS,SLOP,
+    typename Space::MB,double,double,double,typename Space::C,typename Space::C> SGO;
+  SGO sgo(space.gfs,space.cg,space.gfs,space.cg,slop);
+
+  typedef Dune::PDELab::DGMaxwellTemporalOperator<Param,typename Space::FEM> TLOP;
+  TLOP tlop(param);
+  typedef Dune::PDELab::GridOperator<typename Space::GFS,typename Space::GFS,TLOP,
+    typename Space::MB,double,double,double,typename Space::C,typename Space::C> TGO;
+  TGO tgo(space.gfs,space.cg,space.gfs,space.cg,tlop);
+
+  bool passed = true;
+  passed &= compare(sgo,slop,"maxwell spatial");
+  passed &= compare(tgo,tlop,"maxwell temporal");
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    bool passed = true;
+
+    {
+      Dune::FieldVector<double,2> L(1.0);
+      Dune::FieldVector<int,2> N(4);
+      Dune::FieldVector<bool,2> B(false);
+      Dune::YaspGrid<2> grid(L,N,B,0);
+      passed &= testLinearAcoustics(grid.leafView());
+    }
+
+    {
+      Dune::FieldVector<double,3> L(1.0);
+      Dune::FieldVector<int,3> N(2);
+      Dune::FieldVector<bool,3> B(false);
+      Dune::YaspGrid<3> grid(L,N,B,0);
+      passed &= testMaxwell(grid.leafView());
+    }
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,250 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<iostream>
+#include<sstream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/common/fmatrix.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../finiteelementmap/qkdg.hh"
+#include"../gridfunctionspace/gridfunctionspace.hh"
+#include"../constraints/constraints.hh"
+#include"../gridoperator/gridoperator.hh"
+#include"../backend/istlvectorbackend.hh"
+#include"../backend/istlmatrixbackend.hh"
+#include"../localoperator/convectiondiffusiondg.hh"
+#include"../localoperator/diffusiondg.hh"
+#include"poissonproblem.hh"
+
+// model problem with convection and reaction
+template<typename GV, typename RF>
+class Parameters
+  : public Dune::PDELab::ConvectionDiffusionModelProblem<GV,RF>
+{
+public:
+  typedef Dune::PDELab::ConvectionDiffusionParameterTraits<GV,RF> Traits;
+
+  typename Traits::RangeType
+  b (const typename Traits::ElementType& e, const typename Traits::DomainType& x) const
+  {
+    typename Traits::RangeType v(1.0);
+    v[0] = 1.0 + e.geometry().global(x)[1];
+    return v;
+  }
+
+  typename Traits::RangeFieldType
+  c (const typename Traits::ElementType& e, const typename Traits::DomainType& x) const
+  {
+    return 1.0 + e.geometry().global(x)[0];
+  }
+};
+
+// anisotropic permeability, DiffusionDG evaluates it at the cell centers
+template<typename GV, typename RF>
+class Permeability
+  : public Dune::PDELab::AnalyticGridFunctionBase<
+  Dune::PDELab::GridFunctionTraits<GV,RF,GV::dimension*GV::dimension,
+                                   Dune::FieldMatrix<RF,GV::dimension,GV::dimension> >,
+  Permeability<GV,RF> >
+{
+public:
+  typedef Dune::PDELab::GridFunctionTraits<GV,RF,GV::dimension*GV::dimension,
+                                           Dune::FieldMatrix<RF,GV::dimension,GV::dimension> > Traits;
+  typedef Dune::PDELab::AnalyticGridFunctionBase<Traits,Permeability<GV,RF> > BaseT;
+
+  Permeability (const GV& gv) : BaseT(gv) {}
+  inline void evaluateGlobal (const typename Traits::DomainType& x,
+                              typename Traits::RangeType& y) const
+  {
+    for (int i=0; i<GV::dimension; i++)
+      for (int j=0; j<GV::dimension; j++)
+        y[i][j] = (i==j) ? 1.0 + x[i] : 0.1;
+  }
+};
+
+// Dirichlet boundary everywhere, in the interface expected by DiffusionDG
+class BoundaryType
+{
+public:
+  template<typename I>
+  bool isDirichlet (const I& ig, const Dune::FieldVector<typename I::ctype, I::dimension-1>& x) const
+  {
+    return true;
+  }
+
+  template<typename I>
+  bool isNeumann (const I& ig, const Dune::FieldVector<typename I::ctype, I::dimension-1>& x) const
+  {
+    return false;
+  }
+};
+
+// compare the residuals computed by two grid operators
+template<typename GO1, typename GO2>
+bool compareResidual (const GO1& go1, const GO2& go2, const std::string& name)
+{
+  typedef typename GO1::Traits::Domain DV;
+  typedef typename GO1::Traits::Range RV;
+
+  DV x(go1.trialGridFunctionSpace());
+  for (std::size_t i=0; i<x.flatsize(); ++i)
+    x.base()[i] = 1.0 + 0.1 * (i % 17);
+
+  RV r1(go1.testGridFunctionSpace(),0.0);
+  RV r2(go1.testGridFunctionSpace(),0.0);
+  go1.residual(x,r1);
+  go2.residual(x,r2);
+  r2 -= r1;
+
+  std::cout << name << ": residual difference " << r2.infinity_norm() << std::endl;
+
+  return r2.infinity_norm() < 1e-10 * r1.infinity_norm();
+}
+
+// compare residual and jacobian application computed by two grid operators
+template<typename GO1, typename GO2>
+bool compare (const GO1& go1, const GO2& go2, const std::string& name)
+{
+  typedef typename GO1::Traits::Domain DV;
+  typedef typename GO1::Traits::Range RV;
+
+  DV x(go1.trialGridFunctionSpace());
+  for (std::size_t i=0; i<x.flatsize(); ++i)
+    x.base()[i] = 1.0 + 0.1 * (i % 17);
+
+  RV r1(go1.testGridFunctionSpace(),0.0);
+  RV r2(go1.testGridFunctionSpace(),0.0);
+  go1.residual(x,r1);
+  go2.residual(x,r2);
+  r2 -= r1;
+
+  // the reference differences the residual, so allow for its truncation error
+  RV y1(go1.testGridFunctionSpace(),0.0);
+  RV y2(go1.testGridFunctionSpace(),0.0);
+  go1.jacobian_apply(x,y1);
+  go2.jacobian_apply(x,y2);
+  y2 -= y1;
+
+  std::cout << name << ": residual difference " << r2.infinity_norm()
+            << ", jacobian application difference " << y2.infinity_norm() / y1.infinity_norm()
+            << std::endl;
+
+  return r2.infinity_norm() < 1e-10 * r1.infinity_norm()
+    && y2.infinity_norm() < 1e-5 * y1.infinity_norm();
+}
+
+template<int k, typename GV>
+bool testQk (const GV& gv)
+{
+  typedef Dune::PDELab::QkDGLocalFiniteElementMap<typename GV::Grid::ctype,double,k,GV::dimension> FEM;
+  FEM fem;
+  typedef Dune::PDELab::GridFunctionSpace<GV,FEM,Dune::PDELab::NoConstraints,
+    Dune::PDELab::ISTLVectorBackend<1> > GFS;
+  GFS gfs(gv,fem);
+
+  typedef Parameters<GV,double> Param;
+  Param param;
+  typedef Dune::PDELab::ConvectionDiffusionDG<Param,FEM> LOP;
+  LOP lop(param,Dune::PDELab::ConvectionDiffusionDGMethod::SIPG,
+          Dune::PDELab::ConvectionDiffusionDGWeights::weightsOn,2.0);
+  typedef Dune::PDELab::SumFactorizedConvectionDiffusionDG<Param,FEM> SFLOP;
+  SFLOP sflop(param,Dune::PDELab::ConvectionDiffusionDGMethod::SIPG,
+              Dune::PDELab::ConvectionDiffusionDGWeights::weightsOn,2.0);
+
+  typedef Dune::PDELab::ISTLBCRSMatrixBackend<1,1> MB;
+  typedef Dune::PDELab::GridOperator<GFS,GFS,LOP,MB,double,double,double> GO;
+  typedef Dune::PDELab::GridOperator<GFS,GFS,SFLOP,MB,double,double,double> SFGO;
+  GO go(gfs,gfs,lop);
+  SFGO sfgo(gfs,gfs,sflop);
+
+  std::stringstream name;
+  name << "Q" << k << " in " << GV::dimension << "D";
+  return compare(go,sfgo,name.str());
+}
+
+// DiffusionDG has no jacobian application, its sum-factorized version
+// only replaces the residual
+template<int k, typename GV>
+bool testDiffusionQk (const GV& gv)
+{
+  typedef Dune::PDELab::QkDGLocalFiniteElementMap<typename GV::Grid::ctype,double,k,GV::dimension> FEM;
+  FEM fem;
+  typedef Dune::PDELab::GridFunctionSpace<GV,FEM,Dune::PDELab::NoConstraints,
+    Dune::PDELab::ISTLVectorBackend<1> > GFS;
+  GFS gfs(gv,fem);
+
+  typedef Permeability<GV,double> KType;
+  KType kf(gv);
+  typedef F<GV,double> FType;
+  FType f(gv);
+  BoundaryType bctype;
+
+  // SIPG
+  const int method = 2;
+  typedef Dune::PDELab::DiffusionDG<KType,FType,BoundaryType,FType,FType> LOP;
+  LOP lop(kf,f,bctype,f,f,method);
+  typedef Dune::PDELab::SumFactorizedDiffusionDG<KType,FType,BoundaryType,FType,FType,FEM> SFLOP;
+  SFLOP sflop(kf,f,bctype,f,f,method);
+
+  typedef Dune::PDELab::ISTLBCRSMatrixBackend<1,1> MB;
+  typedef Dune::PDELab::GridOperator<GFS,GFS,LOP,MB,double,double,double> GO;
+  typedef Dune::PDELab::GridOperator<GFS,GFS,SFLOP,MB,double,double,double> SFGO;
+  GO go(gfs,gfs,lop);
+  SFGO sfgo(gfs,gfs,sflop);
+
+  std::stringstream name;
+  name << "DiffusionDG Q" << k << " in " << GV::dimension << "D";
+  return compareResidual(go,sfgo,name.str());
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    bool passed = true;
+
+    {
+      Dune::FieldVector<double,2> L(1.0);
+      L[1] = 2.0;
+      Dune::FieldVector<int,2> N(8);
+      Dune::FieldVector<bool,2> B(false);
+      Dune::YaspGrid<2> grid(L,N,B,0);
+      typedef Dune::YaspGrid<2>::LeafGridView GV;
+      const GV& gv=grid.leafView();
+      passed &= testQk<1>(gv);
+      passed &= testQk<3>(gv);
+      passed &= testDiffusionQk<2>(gv);
+    }
+
+    {
+      Dune::FieldVector<double,3> L(1.0);
+      Dune::FieldVector<int,3> N(3);
+      Dune::FieldVector<bool,3> B(false);
+      Dune::YaspGrid<3> grid(L,N,B,0);
+      typedef Dune::YaspGrid<3>::LeafGridView GV;
+      const GV& gv=grid.leafView();
+      passed &= testQk<2>(gv);
+      passed &= testDiffusionQk<2>(gv);
+    }
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
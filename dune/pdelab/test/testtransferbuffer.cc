@@ -0,0 +1,160 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<cmath>
+#include<iostream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/common/shared_ptr.hh>
+#include<dune/istl/bvector.hh>
+#ifdef HAVE_ALUGRID
+#include<dune/grid/alugrid.hh>
+#endif
+#ifdef HAVE_UG
+#include<dune/grid/uggrid.hh>
+#endif
+
+#include"../adaptivity/adaptivity.hh"
+#include"../backend/backendselector.hh"
+#include"../backend/istlvectorbackend.hh"
+#include"../common/function.hh"
+#include"../finiteelementmap/p12dfem.hh"
+#include"../gridfunctionspace/gridfunctionspace.hh"
+#include"../gridfunctionspace/interpolate.hh"
+
+#include"gridexamples.hh"
+
+// smooth function with some structure inside the unit square
+template<typename GV, typename RF>
+class U
+  : public Dune::PDELab::AnalyticGridFunctionBase<Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1>,
+                                                  U<GV,RF> >
+{
+public:
+  typedef Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1> Traits;
+  typedef Dune::PDELab::AnalyticGridFunctionBase<Traits,U<GV,RF> > BaseT;
+
+  U (const GV& gv) : BaseT(gv) {}
+  inline void evaluateGlobal (const typename Traits::DomainType& x,
+                              typename Traits::RangeType& y) const
+  {
+    y = std::sin(3.0*x[0]) * std::exp(-2.0*x[1]);
+  }
+};
+
+// refine the left half of the domain and coarsen the right one, which
+// moves after every cycle
+template<typename Grid>
+void mark (Grid& grid, double split)
+{
+  typedef typename Grid::LeafGridView GV;
+  typedef typename GV::template Codim<0>::Iterator Iterator;
+  GV gv = grid.leafView();
+  for (Iterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+    {
+      const double x = it->geometry().center()[0];
+      if (x < split)
+        grid.mark(1,*it);
+      else if (it->level() > 0)
+        grid.mark(-1,*it);
+    }
+}
+
+// adapt the grid and transfer one copy of the solution through the
+// MapType overloads of GridAdaptor and one through the TransferBuffer
+template<typename Grid>
+bool test (Dune::shared_ptr<Grid> grid, const std::string& name)
+{
+  typedef typename Grid::LeafGridView GV;
+  typedef Dune::PDELab::P12DLocalFiniteElementMap<typename Grid::ctype,double> FEM;
+  FEM fem;
+  typedef Dune::PDELab::GridFunctionSpace<GV,FEM,Dune::PDELab::NoConstraints,
+    Dune::PDELab::ISTLVectorBackend<1> > GFS;
+  typedef typename Dune::PDELab::BackendVectorSelector<GFS,double>::Type V;
+  typedef Dune::PDELab::L2Projection<GFS,V> Projection;
+  typedef Dune::PDELab::GridAdaptor<Grid,GFS,V,Projection> Adaptor;
+
+  grid->globalRefine(3);
+  GFS gfs(grid->leafView(),fem);
+  V u1(gfs,0.0);
+  U<GV,double> u(grid->leafView());
+  Dune::PDELab::interpolate(u,gfs,u1);
+  V u2(u1);
+
+  bool passed = true;
+  const double splits[] = { 0.5, 0.25, 0.75 };
+  for (int cycle = 0; cycle < 3; ++cycle)
+    {
+      mark(*grid,splits[cycle]);
+
+      Projection projection;
+      Adaptor mapAdaptor;
+      Adaptor bufferAdaptor;
+      typename Adaptor::MapType transferMap;
+      typename Adaptor::TransferBuffer transferBuffer;
+
+      grid->preAdapt();
+      mapAdaptor.backupData(*grid,gfs,projection,u1,transferMap);
+      bufferAdaptor.backupData(*grid,gfs,projection,u2,transferBuffer);
+      grid->adapt();
+      gfs.update();
+      u1 = V(gfs,0.0);
+      mapAdaptor.replayData(*grid,gfs,projection,u1,transferMap);
+      u2 = V(gfs,0.0);
+      bufferAdaptor.replayData(*grid,gfs,projection,u2,transferBuffer);
+      grid->postAdapt();
+
+      const double norm = u1.infinity_norm();
+      u2 -= u1;
+      std::cout << name << " cycle " << cycle << ": " << grid->leafView().size(0)
+                << " elements, difference " << u2.infinity_norm()
+                << " of " << norm << std::endl;
+      passed &= norm > 0.0 && u2.infinity_norm() <= 1e-10 * norm;
+
+      // continue with the same solution on both paths
+      u2 = u1;
+    }
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    // default exitcode 77 (=skipped); returned in case none of the
+    // supported adaptive grids were found
+    int result = 77;
+
+#ifdef HAVE_ALUGRID
+    if (result == 77)
+      result = 0;
+    if (!test(TriangulatedUnitSquareMaker<Dune::ALUGrid<2,2,Dune::simplex,Dune::nonconforming> >::create(),
+              "alu-square"))
+      result = 1;
+#endif // HAVE_ALUGRID
+
+#ifdef HAVE_UG
+    if (result == 77)
+      result = 0;
+    if (!test(TriangulatedUnitSquareMaker<Dune::UGGrid<2> >::create(),"ug-square"))
+      result = 1;
+#endif // HAVE_UG
+
+    return result;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
@@ -2,6 +2,7 @@
 #ifdef HAVE_CONFIG_H
 #include "config.h"     
 #endif
+#include<cmath>
 #include<iostream>
 #include<vector>
 #include<dune/common/parallel/mpihelper.hh>
@@ -157,6 +158,58 @@ void testinterpolate (const GV& gv)
   vtkwriter.write("interpolated",Dune::VTK::ascii);
 }
 
+// evaluating a discrete function at several points of the same cell
+template<class GV>
+void testevaluateall (const GV& gv)
+{
+  typedef Dune::PDELab::Q22DLocalFiniteElementMap<typename GV::Grid::ctype,double> Q22DFEM;
+  Q22DFEM q22dfem;
+  typedef Dune::PDELab::GridFunctionSpace<GV,Q22DFEM> Q2GFS;
+  Q2GFS q2gfs(gv,q22dfem);
+  typedef typename Dune::PDELab::BackendVectorSelector<Q2GFS, double>::Type V;
+  V xg(q2gfs);
+  typedef F<GV,double> FType;
+  FType f(gv);
+  Dune::PDELab::interpolate(f,q2gfs,xg);
+
+  typedef Dune::PDELab::DiscreteGridFunction<Q2GFS,V> DGF;
+  DGF dgf(q2gfs,xg);
+  typedef Dune::PDELab::DiscreteGridFunctionGradient<Q2GFS,V> DGFG;
+  DGFG dgfg(q2gfs,xg);
+
+  std::vector<typename DGF::Traits::DomainType> x(3);
+  x[0] = 0.25;
+  x[1][0] = 0.5; x[1][1] = 0.75;
+  x[2] = 1.0;
+
+  std::vector<typename DGF::Traits::RangeType> y;
+  std::vector<typename DGFG::Traits::RangeType> gy;
+  typename DGF::Traits::RangeType yi;
+  typename DGFG::Traits::RangeType gyi;
+  typedef typename GV::template Codim<0>::Iterator Iterator;
+  for (Iterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+    {
+      dgf.evaluateAll(*it,x,y);
+      dgfg.evaluateAll(*it,x,gy);
+      for (std::size_t k=0; k<x.size(); k++)
+        {
+          dgf.evaluate(*it,x[k],yi);
+          dgfg.evaluate(*it,x[k],gyi);
+          gyi -= gy[k];
+          if (std::abs(yi[0]-y[k][0]) > 1e-14 || gyi.two_norm() > 1e-14)
+            exit(1);
+        }
+    }
+
+  // the coefficients are read again although the cell is still bound
+  const typename GV::template Codim<0>::Iterator it = gv.template begin<0>();
+  dgf.evaluate(*it,x[1],yi);
+  xg = 1.0;
+  dgf.evaluate(*it,x[1],yi);
+  if (std::abs(yi[0]-1.0) > 1e-14)
+    exit(1);
+}
+
 template<typename GV, typename RF>
 class One
   : public Dune::PDELab::AnalyticGridFunctionBase<Dune::PDELab::AnalyticGridFunctionTraits<GV,RF,1>,
@@ -334,6 +387,7 @@ int main(int argc, char** argv)
 
 	testq1(grid.leafView());
     testinterpolate(grid.leafView());
+    testevaluateall(grid.leafView());
     testtaylorhood(grid.levelView(1));
 
 	// test passed
@@ -0,0 +1,162 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include<iostream>
+#include<string>
+#include<dune/common/parallel/mpihelper.hh>
+#include<dune/common/exceptions.hh>
+#include<dune/common/fvector.hh>
+#include<dune/grid/yaspgrid.hh>
+#include<dune/istl/bvector.hh>
+
+#include"../localoperator/convectiondiffusionfem.hh"
+#include"poissonproblem.hh"
+
+// convection-diffusion-reaction problem with varying coefficients
+template<typename GV, typename RF>
+class Parameters
+  : public Dune::PDELab::ConvectionDiffusionModelProblem<GV,RF>
+{
+public:
+  typedef Dune::PDELab::ConvectionDiffusionParameterTraits<GV,RF> Traits;
+
+  typename Traits::PermTensorType
+  A (const typename Traits::ElementType& e, const typename Traits::DomainType& x) const
+  {
+    typename Traits::DomainType xglobal = e.geometry().global(x);
+    typename Traits::PermTensorType I;
+    for (std::size_t i=0; i<Traits::dimDomain; i++)
+      for (std::size_t j=0; j<Traits::dimDomain; j++)
+        I[i][j] = (i==j) ? 1.0 + xglobal[i] : 0.1;
+    return I;
+  }
+
+  typename Traits::RangeType
+  b (const typename Traits::ElementType& e, const typename Traits::DomainType& x) const
+  {
+    typename Traits::RangeType v(0.0);
+    v[0] = e.geometry().global(x)[1];
+    return v;
+  }
+
+  typename Traits::RangeFieldType
+  c (const typename Traits::ElementType& e, const typename Traits::DomainType& x) const
+  {
+    return e.geometry().global(x)[0];
+  }
+
+  typename Traits::RangeFieldType
+  f (const typename Traits::ElementType& e, const typename Traits::DomainType& x) const
+  {
+    return e.geometry().global(x).two_norm2();
+  }
+};
+
+// compare residual and jacobian with and without batched volume assembly
+template<typename GO>
+bool compare (GO& go, double jacobian_tolerance, const std::string& name)
+{
+  typedef typename GO::Traits::Domain DV;
+  typedef typename GO::Traits::Range RV;
+  typedef typename GO::Traits::Jacobian M;
+
+  DV x(go.trialGridFunctionSpace());
+  for (std::size_t i=0; i<x.flatsize(); ++i)
+    x.base()[i] = 1.0 + 0.1 * i;
+
+  RV r1(go.testGridFunctionSpace(),0.0);
+  RV r2(go.testGridFunctionSpace(),0.0);
+  M m1(go);
+  M m2(go);
+  m1 = 0.0;
+  m2 = 0.0;
+
+  go.assembler().setVolumeBatching(false);
+  go.residual(x,r1);
+  go.jacobian(x,m1);
+
+  go.assembler().setVolumeBatching(true);
+  go.residual(x,r2);
+  go.jacobian(x,m2);
+  go.assembler().setVolumeBatching(false);
+
+  r2 -= r1;
+  m2.base() -= m1.base();
+
+  std::cout << name << ": residual difference " << r2.infinity_norm()
+            << ", jacobian difference " << m2.base().infinity_norm() << std::endl;
+
+  return r2.infinity_norm() < 1e-10 && m2.base().infinity_norm() < jacobian_tolerance;
+}
+
+template<typename GV>
+bool testQ1 (const GV& gv)
+{
+  typedef Q1PoissonProblem<GV> Problem;
+  Problem problem(gv);
+  typedef typename Problem::GFS GFS;
+  typedef typename Problem::C C;
+  bool passed = true;
+
+  // the cell by cell jacobian of Poisson is computed by numerical differentiation
+  {
+    typename Problem::GO go(problem.gfs,problem.cg,problem.gfs,problem.cg,problem.lop);
+    passed &= compare(go,1e-5,"Poisson Q1");
+  }
+
+  {
+    typedef Parameters<GV,double> Param;
+    Param param;
+    typedef Dune::PDELab::ConvectionDiffusionFEM<Param,typename Problem::FEM> LOP;
+    LOP lop(param);
+    typedef Dune::PDELab::GridOperator<GFS,GFS,LOP,typename Problem::MB,double,double,double,C,C> GO;
+    GO go(problem.gfs,problem.cg,problem.gfs,problem.cg,lop);
+    passed &= compare(go,1e-10,"ConvectionDiffusionFEM Q1");
+  }
+
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  try{
+    //Maybe initialize Mpi
+    Dune::MPIHelper::instance(argc, argv);
+
+    bool passed = true;
+
+    // the number of cells is no multiple of the batch size
+    {
+      Dune::FieldVector<double,2> L(1.0);
+      Dune::FieldVector<int,2> N(17);
+      Dune::FieldVector<bool,2> B(false);
+      Dune::YaspGrid<2> grid(L,N,B,0);
+      typedef Dune::YaspGrid<2>::LeafGridView GV;
+      const GV& gv=grid.leafView();
+      passed &= testQ1(gv);
+    }
+
+    {
+      Dune::FieldVector<double,3> L(1.0);
+      Dune::FieldVector<int,3> N(5);
+      Dune::FieldVector<bool,3> B(false);
+      Dune::YaspGrid<3> grid(L,N,B,0);
+      typedef Dune::YaspGrid<3>::LeafGridView GV;
+      const GV& gv=grid.leafView();
+      passed &= testQ1(gv);
+    }
+
+    return passed ? 0 : 1;
+  }
+  catch (Dune::Exception &e){
+    std::cerr << "Dune reported error: " << e << std::endl;
+    return 1;
+  }
+  catch (...){
+    std::cerr << "Unknown exception thrown!" << std::endl;
+    return 1;
+  }
+}
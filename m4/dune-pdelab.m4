@@ -7,8 +7,15 @@ AC_DEFUN([DUNE_PDELAB_CHECKS],
   AC_REQUIRE([DUNE_PATH_PETSC])
   AC_REQUIRE([DUNE_EIGEN])
   AC_REQUIRE([DUNE_FUNC_POSIX_CLOCK])
+  AC_REQUIRE([DUNE_PDELAB_PTHREAD])
+  # OpenMP is optional and only used by the thread parallel assemblers
+  AC_LANG_PUSH([C++])
+  AC_OPENMP
+  AC_LANG_POP([C++])
   DUNE_ADD_MODULE_DEPS([dune-pdelab], [POSIX_CLOCK],
     [$POSIX_CLOCK_CPPFLAGS], [$POSIX_CLOCK_LDFLAGS], [$POSIX_CLOCK_LIBS])
+  DUNE_ADD_MODULE_DEPS([dune-pdelab], [PTHREAD],
+    [$PTHREAD_CPPFLAGS], [$PTHREAD_LDFLAGS], [$PTHREAD_LIBS])
 ])
 
 # Additional checks needed to find the module
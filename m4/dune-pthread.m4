@@ -0,0 +1,76 @@
+dnl DUNE_PDELAB_PTHREAD
+dnl ------------------------------------------------------
+dnl Check whether POSIX threads are available.  They are optional and only
+dnl used by the asynchronous VTK writer.  The result is recorded as follows:
+dnl
+dnl shell variables:
+dnl   dune_cv_lib_pthread
+dnl     linker options to get the required library
+dnl     "no" if no suitable library was found
+dnl
+dnl defines:
+dnl   HAVE_PTHREAD
+dnl     undef or ENABLE_PTHREAD
+dnl
+dnl automake conditionals:
+dnl   PTHREAD
+dnl
+dnl Makefile variables:
+dnl   PTHREAD_CPPFLAGS
+dnl     -DENABLE_PTHREAD
+dnl   PTHREAD_LDFLAGS
+dnl   PTHREAD_LIBS
+AC_DEFUN([DUNE_PDELAB_PTHREAD], [
+  AC_LANG_PUSH([C])
+
+  AC_CACHE_CHECK(
+    [for library required for pthread_create()],
+    [dune_cv_lib_pthread],
+    [
+      dune_cv_lib_pthread=no
+      _DUNE_PTHREAD_CHECK_LIB([""])
+      _DUNE_PTHREAD_CHECK_LIB([-pthread])
+      _DUNE_PTHREAD_CHECK_LIB([-lpthread])
+    ])
+  AS_CASE(["$dune_cv_lib_pthread"],
+    [no], [
+      AC_SUBST([PTHREAD_CPPFLAGS], [])
+      AC_SUBST([PTHREAD_LDFLAGS],  [])
+      AC_SUBST([PTHREAD_LIBS],     [])
+    ],
+    [
+      AC_DEFINE([HAVE_PTHREAD], [ENABLE_PTHREAD],
+        [Define if POSIX threads are available])
+
+      AC_SUBST([PTHREAD_CPPFLAGS], [-DENABLE_PTHREAD])
+      AC_SUBST([PTHREAD_LDFLAGS],  [])
+      AC_SUBST([PTHREAD_LIBS],     ["$dune_cv_lib_pthread"])
+    ])
+  AM_CONDITIONAL([PTHREAD], [test x"$dune_cv_lib_pthread" != xno])
+
+  AC_LANG_POP([C])
+])
+
+AC_DEFUN([_DUNE_PTHREAD_CHECK_LIB], [
+  AS_CASE(["$dune_cv_lib_pthread"],
+    [no], [
+      dune_save_LIBS="$LIBS"
+      LIBS=$1" $LIBS"
+      AC_LINK_IFELSE([_DUNE_PTHREAD_TESTPROG],
+        [dune_cv_lib_pthread=$1],
+        [dune_cv_lib_pthread=no])
+      LIBS="$dune_save_LIBS"
+    ])
+])
+
+dnl Generate test
+AC_DEFUN([_DUNE_PTHREAD_TESTPROG], [dnl
+    AC_LANG_PROGRAM(
+[[#include <pthread.h>
+
+static void *run(void *arg) { return arg; }
+]],
+[[pthread_t thread;
+pthread_create(&thread, 0, &run, 0);
+pthread_join(thread, 0);
+]])])